@@ -0,0 +1,17 @@
+#version 450
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec3 inColor;
+// Per instance (VK_VERTEX_INPUT_RATE_INSTANCE)
+layout(location = 2) in vec4 inPositionScale;
+
+layout(location = 0) out vec3 outColor;
+
+layout(push_constant) uniform DrawParams {
+    mat4 viewProj;
+} params;
+
+void main() {
+    vec3 worldPos = inPos * inPositionScale.w + inPositionScale.xyz;
+    gl_Position = params.viewProj * vec4(worldPos, 1.0);
+    outColor = inColor;
+}
@@ -0,0 +1,17 @@
+#version 450
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 outColor;
+
+// DrawStressApp::PerDraw, delivered by PerDrawData as push constants
+layout(push_constant) uniform PerDraw {
+    mat4 viewProj;
+    vec4 positionScale;
+} draw;
+
+void main() {
+    vec3 worldPos = inPos * draw.positionScale.w + draw.positionScale.xyz;
+    gl_Position = draw.viewProj * vec4(worldPos, 1.0);
+    outColor = inColor;
+}
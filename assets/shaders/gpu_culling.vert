@@ -0,0 +1,29 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec3 inNormal;
+
+layout(location = 0) out vec3 outNormal;
+layout(location = 1) out vec3 outColor;
+
+struct Instance {
+    vec4 positionScale;
+    vec4 color;
+};
+
+layout(set = 0, binding = 1) readonly buffer Instances { Instance instances[]; } g_instances[];
+
+layout(push_constant) uniform DrawParams {
+    mat4 viewProj;
+    uint instanceBuffer;
+} params;
+
+void main() {
+    // GpuCuller writes the object index into firstInstance
+    Instance instance = g_instances[params.instanceBuffer].instances[gl_InstanceIndex];
+    vec3 worldPos = inPos * instance.positionScale.w + instance.positionScale.xyz;
+    gl_Position = params.viewProj * vec4(worldPos, 1.0);
+    outNormal = inNormal;
+    outColor = instance.color.rgb;
+}
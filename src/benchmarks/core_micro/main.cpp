@@ -0,0 +1,313 @@
+// Microbenchmarks for the core library's hot paths: memory type lookup, buffer creation and
+// mapping, pipeline builds with and without the pipeline cache, shader module loading, command
+// buffer recording and swapchain acquire/present. Each case is timed in batches large enough
+// to measure, and the median and minimum time per call of several batches are printed.
+//
+//   CoreMicroBenchmark [--filter text] [--headless]
+//
+// Runs on any Vulkan 1.3 ICD, e.g. lavapipe via VK_DRIVER_FILES. Without a display (or with
+// --headless) the swapchain cases are skipped. Mesa keeps its own shader cache on disk; set
+// MESA_SHADER_CACHE_DISABLE=true so "no cache" pipeline builds really compile.
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include "core/asset_path.h"
+#include "core/buffer_resource.h"
+#include "core/command_buffer.h"
+#include "core/glfw_surface_provider.h"
+#include "core/graphics_pipeline_builder.h"
+#include "core/pipeline_layout_cache.h"
+#include "core/shader_compiler.h"
+#include "core/shader_loader.h"
+#include "core/shader_reflection.h"
+#include "core/swapchain.h"
+#include "core/vulkan_context.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A batch is grown until it takes at least this long
+constexpr double MinBatchMs = 2.0;
+constexpr uint32_t BatchCount = 15;
+constexpr uint64_t MaxBatchSize = 1ull << 24;
+
+constexpr VkDeviceSize BufferSize = 64 * 1024;
+constexpr VkDeviceSize MappedWriteSize = 4 * 1024;
+
+// Results written here cannot be optimized away
+volatile uint64_t g_sink = 0;
+
+std::string g_filter;
+
+double TimeBatchMs(const std::function<void()>& function, uint64_t batchSize)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < batchSize; ++i) {
+        function();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+void Run(const char* name, const std::function<void()>& function)
+{
+    if (!g_filter.empty() && std::strstr(name, g_filter.c_str()) == nullptr) {
+        return;
+    }
+    // Warms caches and finds the batch size
+    uint64_t batchSize = 1;
+    while (TimeBatchMs(function, batchSize) < MinBatchMs && batchSize < MaxBatchSize) {
+        batchSize *= 2;
+    }
+    std::vector<double> nsPerCall;
+    for (uint32_t batch = 0; batch < BatchCount; ++batch) {
+        nsPerCall.push_back(TimeBatchMs(function, batchSize) * 1.0e6 / double(batchSize));
+    }
+    std::sort(nsPerCall.begin(), nsPerCall.end());
+    std::printf("  %-44s %12.1f ns %12.1f ns %10llu\n", name, nsPerCall[BatchCount / 2],
+                nsPerCall.front(), static_cast<unsigned long long>(batchSize));
+}
+
+void BenchFindMemoryType()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    VkMemoryRequirements requirements{.size = BufferSize, .alignment = 256,
+                                      .memoryTypeBits = ~0u};
+    Run("FindMemoryType device local", [&] {
+        g_sink = g_sink + vulkanCtx.FindMemoryType(requirements,
+                                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    });
+    Run("FindMemoryType host visible | coherent", [&] {
+        g_sink = g_sink + vulkanCtx.FindMemoryType(requirements,
+                                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    });
+}
+
+void BenchBuffers()
+{
+    Run("VertexBuffer create + destroy, device local", [] {
+        auto buffer = VertexBuffer::Create(BufferSize, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        g_sink = g_sink + (buffer != nullptr);
+    });
+    Run("VertexBuffer create + destroy, host visible", [] {
+        auto buffer = VertexBuffer::Create(BufferSize, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                           VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        g_sink = g_sink + (buffer != nullptr);
+    });
+    Run("StagingBuffer create + destroy", [] {
+        auto buffer = StagingBuffer::Create(BufferSize);
+        g_sink = g_sink + (buffer != nullptr);
+    });
+
+    auto buffer = VertexBuffer::Create(BufferSize, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (!buffer) {
+        std::printf("  host visible vertex buffer not available, map cases skipped\n");
+        return;
+    }
+    Run("VertexBuffer Map + Unmap", [&] {
+        g_sink = g_sink + reinterpret_cast<uintptr_t>(buffer->Map());
+        buffer->Unmap();
+    });
+    std::vector<uint8_t> data(MappedWriteSize, 0x5a);
+    Run("VertexBuffer Map + 4 KiB write + Unmap", [&] {
+        if (void* mapped = buffer->Map()) {
+            std::memcpy(mapped, data.data(), data.size());
+        }
+        buffer->Unmap();
+    });
+}
+
+struct ShaderModules {
+    VkShaderModule vert = VK_NULL_HANDLE;
+    VkShaderModule frag = VK_NULL_HANDLE;
+    ShaderReflection vertReflection{};
+    ShaderReflection fragReflection{};
+};
+
+bool LoadShaders(ShaderModules& shaders, std::string& vertSpvPath)
+{
+    const auto vertPath = GetAssetPath(AssetType::Shader, "draw_stress.vert");
+    const auto fragPath = GetAssetPath(AssetType::Shader, "draw_stress.frag");
+    if (!loader::UpdateSpirvFile(vertPath) || !loader::UpdateSpirvFile(fragPath)) {
+        return false;
+    }
+    vertSpvPath = vertPath.string() + ".spv";
+    shaders.vert = loader::LoadShaderModule(vertSpvPath, &shaders.vertReflection);
+    shaders.frag = loader::LoadShaderModule(fragPath.string() + ".spv", &shaders.fragReflection);
+    return shaders.vert != VK_NULL_HANDLE && shaders.frag != VK_NULL_HANDLE;
+}
+
+void BenchShadersAndPipelines()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+
+    ShaderModules shaders;
+    std::string vertSpvPath;
+    if (!LoadShaders(shaders, vertSpvPath)) {
+        std::printf("  draw_stress shaders not found or not compiled, shader and pipeline cases "
+                    "skipped\n");
+        return;
+    }
+
+    Run("LoadShaderModule (file + create + destroy)", [&] {
+        VkShaderModule module = loader::LoadShaderModule(vertSpvPath);
+        vkDestroyShaderModule(device, module, allocator);
+    });
+    Run("LoadShaderModule with reflection", [&] {
+        ShaderReflection reflection{};
+        VkShaderModule module = loader::LoadShaderModule(vertSpvPath, &reflection);
+        vkDestroyShaderModule(device, module, allocator);
+    });
+
+    auto layout = vulkanCtx.GetPipelineLayoutCache().GetPipelineLayout(
+        {&shaders.vertReflection, &shaders.fragReflection});
+    auto buildPipeline = [&](VkPipelineCache cache) {
+        GraphicsPipelineBuilder builder{};
+        builder.AddShaderStage(VK_SHADER_STAGE_VERTEX_BIT, shaders.vert);
+        builder.AddShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, shaders.frag);
+        builder.SetVertexInputInstanced(shaders.vertReflection, 2);
+        builder.SetViewport({1280, 720});
+        builder.SetDepthStencilState(VkPipelineDepthStencilStateCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+            .depthTestEnable = VK_TRUE,
+            .depthWriteEnable = VK_TRUE,
+            .depthCompareOp = VK_COMPARE_OP_LESS,
+        });
+        builder.SetPipelineLayout(layout.pipelineLayout);
+        builder.SetPipelineCache(cache);
+        builder.UseDynamicRendering(VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_D32_SFLOAT);
+        VkPipeline pipeline = builder.Build();
+        g_sink = g_sink + (pipeline != VK_NULL_HANDLE);
+        vkDestroyPipeline(device, pipeline, allocator);
+    };
+    Run("GraphicsPipelineBuilder::Build, no cache", [&] { buildPipeline(VK_NULL_HANDLE); });
+    // The first build fills the cache, every later one hits it
+    Run("GraphicsPipelineBuilder::Build, pipeline cache",
+        [&] { buildPipeline(vulkanCtx.GetPipelineCache()); });
+
+    vkDestroyShaderModule(device, shaders.vert, allocator);
+    vkDestroyShaderModule(device, shaders.frag, allocator);
+}
+
+void BenchCommandBuffers()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto commandBuffer = vulkanCtx.CreateCommandBuffer();
+    Run("CommandBuffer Begin + End + Reset", [&] {
+        commandBuffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        commandBuffer->End();
+        commandBuffer->Reset();
+    });
+    // The CommandBuffer destructor frees it
+    Run("CreateCommandBuffer + free", [&] {
+        auto transient = vulkanCtx.CreateCommandBuffer();
+        g_sink = g_sink + (transient != nullptr);
+    });
+}
+
+void BenchSwapchain()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    vulkanCtx.RecreateSwapchain();
+    auto& swapchain = vulkanCtx.GetSwapchain();
+    VkImageSubresourceRange colorRange{
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+    // FIFO presentation, so this is bound by the display refresh rate
+    Run("AcquireNextImage + empty frame + SubmitPresent", [&] {
+        glfwPollEvents();
+        if (vulkanCtx.AcquireNextImage() != VK_SUCCESS) {
+            return;
+        }
+        auto& commandBuffer = vulkanCtx.GetCurrentFrameContext()->commandBuffer;
+        commandBuffer->Begin();
+        commandBuffer->TransitionLayout(swapchain->GetCurrentImage(), colorRange,
+                                        ImageLayoutTransition::FromUndefinedToColorAttachment());
+        commandBuffer->TransitionLayout(swapchain->GetCurrentImage(), colorRange,
+                                        ImageLayoutTransition::FromColorToPresent());
+        commandBuffer->End();
+        vulkanCtx.SubmitPresent();
+    });
+    vkDeviceWaitIdle(vulkanCtx.GetVkDevice());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bool headless = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            g_filter = argv[++i];
+        }
+        else {
+            std::printf("usage: CoreMicroBenchmark [--filter text] [--headless]\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto assetPath = FindAssetRootPath();
+    if (!assetPath.empty()) {
+        SetAssetRootPath(assetPath);
+    }
+
+    GLFWwindow* window = nullptr;
+    if (!headless && glfwInit() == GLFW_TRUE) {
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+        window = glfwCreateWindow(640, 360, "CoreMicroBenchmark", nullptr, nullptr);
+    }
+    GLFWSurfaceProvider surfaceProvider{window};
+
+    auto& vulkanCtx = VulkanContext::Get();
+    if (window) {
+        vulkanCtx.GetWindowSystemExtensions = [](auto& extensionList) {
+            uint32_t extCount = 0;
+            const char** extensions = glfwGetRequiredInstanceExtensions(&extCount);
+            if (extCount > 0) {
+                extensionList.insert(extensionList.end(), extensions, extensions + extCount);
+            }
+        };
+    }
+    else {
+        vulkanCtx.GetWindowSystemExtensions = [](auto&) {};
+    }
+    vulkanCtx.Initialize("CoreMicroBenchmark", window ? &surfaceProvider : nullptr);
+
+    std::printf("%s\n", vulkanCtx.GetPhysicalDeviceProperties().deviceName);
+    std::printf("  %-44s %15s %15s %10s\n", "case", "median/call", "min/call", "batch");
+    BenchFindMemoryType();
+    BenchBuffers();
+    BenchShadersAndPipelines();
+    BenchCommandBuffers();
+    if (window) {
+        BenchSwapchain();
+    }
+    else {
+        std::printf("  no window; swapchain cases skipped\n");
+    }
+
+    vulkanCtx.Cleanup();
+    if (window) {
+        glfwDestroyWindow(window);
+    }
+    glfwTerminate();
+    return EXIT_SUCCESS;
+}
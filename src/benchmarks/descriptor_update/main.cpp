@@ -0,0 +1,143 @@
+// Descriptor update throughput: classic descriptor sets vs VK_EXT_descriptor_buffer.
+// Runs headless (no window or swapchain); only CPU-side allocate + write cost is measured.
+#include "core/vulkan_context.h"
+#include "core/descriptor_allocator.h"
+#include "core/gpu_memory_tracker.h"
+#include "core/pipeline_layout_cache.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t FrameCount = 200;
+constexpr uint32_t SetsPerFrame = 2000;
+constexpr VkDeviceSize UniformRange = 256;
+
+struct TestBuffer {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+};
+
+TestBuffer CreateTestBuffer(VkDeviceSize size)
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    const bool deviceAddress = vulkanCtx.IsDescriptorBufferSupported();
+
+    TestBuffer result{};
+    VkBufferCreateInfo bufferInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = size,
+        .usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                 (deviceAddress ? VkBufferUsageFlags(VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
+                                : VkBufferUsageFlags(0)),
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    vkCreateBuffer(device, &bufferInfo, allocator, &result.buffer);
+
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device, result.buffer, &memRequirements);
+    VkMemoryAllocateFlagsInfo flagsInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+        .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+    };
+    result.memory = vulkanCtx.AllocateMemory(
+        memRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::Buffer,
+        "DescriptorUpdateTestBuffer", deviceAddress ? &flagsInfo : nullptr);
+    vkBindBufferMemory(device, result.buffer, result.memory, 0);
+    return result;
+}
+
+const char* BackendName(DescriptorAllocator::Backend backend)
+{
+    return backend == DescriptorAllocator::Backend::DescriptorBuffer ? "descriptor buffer"
+                                                                     : "descriptor sets";
+}
+
+void Run(DescriptorAllocator::Backend requested, const TestBuffer& buffer)
+{
+    DescriptorAllocator allocator;
+    if (!allocator.Initialize(requested, 1 << 20, SetsPerFrame)) {
+        std::printf("%-18s: failed to initialize\n", BackendName(requested));
+        return;
+    }
+    if (allocator.GetBackend() != requested) {
+        std::printf("%-18s: not supported on this device, skipped\n", BackendName(requested));
+        allocator.Cleanup();
+        return;
+    }
+
+    // One uniform buffer + one storage buffer per set, a typical per-draw layout
+    std::vector<VkDescriptorSetLayoutBinding> bindings = {
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        },
+        {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        },
+    };
+    VkDescriptorSetLayout layout =
+        VulkanContext::Get().GetPipelineLayoutCache().GetDescriptorSetLayout(
+            bindings, allocator.GetLayoutCreateFlags());
+
+    uint64_t descriptorCount = 0;
+    uint32_t failedAllocations = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FrameCount; ++frame) {
+        allocator.BeginFrame(frame);
+        for (uint32_t i = 0; i < SetsPerFrame; ++i) {
+            auto allocation = allocator.Allocate(layout);
+            if (!allocation.valid) {
+                ++failedAllocations;
+                continue;
+            }
+            VkDeviceSize offset = (i % 64) * UniformRange;
+            allocator.WriteBuffer(allocation, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                  buffer.buffer, offset, UniformRange);
+            allocator.WriteBuffer(allocation, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                  buffer.buffer, offset, UniformRange);
+            descriptorCount += 2;
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%-18s: %8.2f ms, %7.2f M descriptors/s, %.1f ns per set", BackendName(requested),
+                elapsed * 1000.0, descriptorCount / elapsed / 1.0e6,
+                elapsed * 1.0e9 / (double(FrameCount) * SetsPerFrame));
+    if (failedAllocations > 0) {
+        std::printf(" (%u allocations failed)", failedAllocations);
+    }
+    std::printf("\n");
+    allocator.Cleanup();
+}
+
+} // namespace
+
+int main()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    vulkanCtx.GetWindowSystemExtensions = [](auto&) {};
+    vulkanCtx.Initialize("DescriptorUpdateBenchmark", nullptr);
+
+    std::printf("%u frames x %u sets x 2 descriptors\n", FrameCount, SetsPerFrame);
+
+    TestBuffer buffer = CreateTestBuffer(UniformRange * 64);
+    Run(DescriptorAllocator::Backend::DescriptorSets, buffer);
+    Run(DescriptorAllocator::Backend::DescriptorBuffer, buffer);
+
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    vkDestroyBuffer(device, buffer.buffer, allocator);
+    vulkanCtx.FreeMemory(buffer.memory);
+    vulkanCtx.Cleanup();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+// Frustum culling throughput: an array-of-structs box loop against FrustumCuller's scalar,
+// SSE and AVX2 paths over structure-of-arrays bounds, on one thread and on a JobSystem.
+// CPU only; no Vulkan device is created.
+#include "core/frustum_culler.h"
+#include "core/job_system.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Repeats until at least this much time has been measured
+constexpr double MinMeasureMs = 200.0;
+constexpr float WorldExtent = 500.0f;
+
+struct Box {
+    float min[3];
+    float max[3];
+};
+
+// Right-handed perspective at the origin looking down -Z, 0..1 depth, column-major
+void MakeViewProjection(float m[16])
+{
+    const float nearZ = 0.1f, farZ = 1000.0f;
+    const float f = 1.0f / std::tan(0.5f * 1.0471976f);
+    for (int i = 0; i < 16; ++i) {
+        m[i] = 0.0f;
+    }
+    m[0] = f / (16.0f / 9.0f);
+    m[5] = f;
+    m[10] = farZ / (nearZ - farZ);
+    m[11] = -1.0f;
+    m[14] = farZ * nearZ / (nearZ - farZ);
+}
+
+// The straightforward per-object loop the culler replaces
+uint32_t CullAos(const std::vector<Box>& boxes, const float planes[6][4],
+                 std::vector<uint32_t>& visible)
+{
+    visible.clear();
+    for (uint32_t i = 0; i < boxes.size(); ++i) {
+        const Box& box = boxes[i];
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; ++p) {
+            // Corner furthest along the plane normal
+            float distance = planes[p][3];
+            for (int axis = 0; axis < 3; ++axis) {
+                distance += planes[p][axis] * (planes[p][axis] >= 0.0f ? box.max[axis]
+                                                                       : box.min[axis]);
+            }
+            inside = distance >= 0.0f;
+        }
+        if (inside) {
+            visible.push_back(i);
+        }
+    }
+    return static_cast<uint32_t>(visible.size());
+}
+
+template <typename Fn>
+double MeasureMs(Fn&& fn)
+{
+    uint32_t iterations = 0;
+    double totalMs = 0.0;
+    while (totalMs < MinMeasureMs || iterations < 3) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        totalMs +=
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                .count();
+        ++iterations;
+    }
+    return totalMs / iterations;
+}
+
+void Run(uint32_t objectCount, FrustumCuller& serial, FrustumCuller& parallel)
+{
+    std::mt19937 rng{objectCount};
+    std::uniform_real_distribution<float> position{-WorldExtent, WorldExtent};
+    std::uniform_real_distribution<float> size{0.5f, 4.0f};
+    std::vector<Box> boxes(objectCount);
+    for (auto& box : boxes) {
+        for (int axis = 0; axis < 3; ++axis) {
+            box.min[axis] = position(rng);
+            box.max[axis] = box.min[axis] + size(rng);
+        }
+    }
+    for (FrustumCuller* culler : {&serial, &parallel}) {
+        culler->SetObjectCount(objectCount);
+        for (uint32_t i = 0; i < objectCount; ++i) {
+            culler->SetBounds(i, boxes[i].min, boxes[i].max);
+        }
+    }
+
+    float viewProjection[16];
+    MakeViewProjection(viewProjection);
+    float planes[6][4];
+    FrustumCuller::ExtractFrustumPlanes(viewProjection, planes);
+
+    std::vector<uint32_t> aosVisible;
+    const double aosMs = MeasureMs([&] { CullAos(boxes, planes, aosVisible); });
+    std::printf("%8u objects, %6zu visible\n", objectCount, aosVisible.size());
+    std::printf("    %-8s 1 thread  %8.3f ms\n", "AoS", aosMs);
+
+    const FrustumCuller::Path paths[] = {FrustumCuller::Path::Scalar, FrustumCuller::Path::SSE,
+                                         FrustumCuller::Path::AVX2};
+    for (auto path : paths) {
+        if (path > FrustumCuller::GetBestPath()) {
+            continue;
+        }
+        serial.SetPath(path);
+        parallel.SetPath(path);
+        size_t visibleCount = 0;
+        const double serialMs =
+            MeasureMs([&] { visibleCount = serial.Cull(viewProjection).size(); });
+        const double parallelMs = MeasureMs([&] { parallel.Cull(viewProjection); });
+        std::printf("    %-8s 1 thread  %8.3f ms (%5.1fx) | %2u threads %8.3f ms (%5.1fx)%s\n",
+                    FrustumCuller::GetPathName(path), serialMs, aosMs / serialMs,
+                    parallel.GetThreadCount(), parallelMs, aosMs / parallelMs,
+                    visibleCount == aosVisible.size() ? "" : "  MISMATCH");
+    }
+}
+
+} // namespace
+
+int main()
+{
+    JobSystem jobSystem;
+    jobSystem.Initialize(JobSystem::Settings{.ioThreadCount = 0});
+    auto serial = std::make_unique<FrustumCuller>();
+    auto parallel = std::make_unique<FrustumCuller>(&jobSystem);
+    std::printf("best path %s, chunk %u objects\n",
+                FrustumCuller::GetPathName(FrustumCuller::GetBestPath()),
+                FrustumCuller::ChunkSize);
+    for (uint32_t objectCount : {10000u, 100000u, 1000000u}) {
+        Run(objectCount, *serial, *parallel);
+    }
+    return EXIT_SUCCESS;
+}
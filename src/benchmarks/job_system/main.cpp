@@ -0,0 +1,225 @@
+// JobSystem against std::async on the workloads the library hands to it: many small independent
+// jobs, a tree of nested jobs, a data-parallel loop, and several threads submitting uneven jobs
+// at once. Every std::async call uses std::launch::async, i.e. one thread per task.
+// CPU only; no Vulkan device is created.
+#include "core/job_system.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Repeats until at least this much time has been measured
+constexpr double MinMeasureMs = 200.0;
+
+constexpr uint32_t SmallJobCount = 10000;
+constexpr uint32_t TreeDepth = 10;
+constexpr uint32_t LoopCount = 4 * 1024 * 1024;
+constexpr uint32_t ProducerCount = 4;
+
+template <typename Fn>
+double MeasureMs(Fn&& fn)
+{
+    uint32_t iterations = 0;
+    double totalMs = 0.0;
+    while (totalMs < MinMeasureMs || iterations < 3) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        totalMs +=
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                .count();
+        ++iterations;
+    }
+    return totalMs / iterations;
+}
+
+// A dependent chain of cost * 8 square roots that the optimizer cannot drop
+float Work(uint32_t seed, uint32_t cost)
+{
+    float value = float(seed);
+    for (uint32_t i = 0; i < cost * 8; ++i) {
+        value = std::sqrt(value * 1.0001f + 1.0f);
+    }
+    return value;
+}
+
+void Report(const char* name, double asyncMs, double jobMs, bool match)
+{
+    std::printf("    %-26s std::async %9.3f ms | JobSystem %8.3f ms (%6.1fx)%s\n", name, asyncMs,
+                jobMs, asyncMs / jobMs, match ? "" : "  MISMATCH");
+}
+
+void FanOut(JobSystem& jobs)
+{
+    std::vector<float> results(SmallJobCount);
+    const double asyncMs = MeasureMs([&] {
+        std::vector<std::future<void>> futures;
+        futures.reserve(SmallJobCount);
+        for (uint32_t i = 0; i < SmallJobCount; ++i) {
+            futures.push_back(
+                std::async(std::launch::async, [&, i] { results[i] = Work(i, 100); }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+    });
+    const float expected = results[SmallJobCount - 1];
+    std::fill(results.begin(), results.end(), 0.0f);
+
+    const double jobMs = MeasureMs([&] {
+        JobCounter counter;
+        for (uint32_t i = 0; i < SmallJobCount; ++i) {
+            jobs.Submit([&, i] { results[i] = Work(i, 100); }, &counter);
+        }
+        jobs.Wait(counter);
+    });
+    Report("10k small jobs", asyncMs, jobMs, results[SmallJobCount - 1] == expected);
+}
+
+uint32_t AsyncTree(uint32_t depth)
+{
+    if (depth == 0) {
+        Work(depth, 50);
+        return 1;
+    }
+    auto left = std::async(std::launch::async, AsyncTree, depth - 1);
+    const uint32_t right = AsyncTree(depth - 1);
+    return left.get() + right;
+}
+
+// Children are submitted against the parent's counter, so one Wait covers the whole tree
+void JobTree(JobSystem& jobs, JobCounter& counter, std::atomic<uint32_t>& leaves, uint32_t depth)
+{
+    if (depth == 0) {
+        Work(depth, 50);
+        leaves.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    for (uint32_t child = 0; child < 2; ++child) {
+        jobs.Submit([&, depth] { JobTree(jobs, counter, leaves, depth - 1); }, &counter);
+    }
+}
+
+void NestedTree(JobSystem& jobs)
+{
+    uint32_t asyncLeaves = 0;
+    const double asyncMs = MeasureMs([&] { asyncLeaves = AsyncTree(TreeDepth); });
+
+    std::atomic<uint32_t> leaves{0};
+    const double jobMs = MeasureMs([&] {
+        leaves = 0;
+        JobCounter counter;
+        jobs.Submit([&] { JobTree(jobs, counter, leaves, TreeDepth); }, &counter);
+        jobs.Wait(counter);
+    });
+    Report("binary tree, 1k leaves", asyncMs, jobMs, leaves == asyncLeaves);
+}
+
+void ParallelLoop(JobSystem& jobs)
+{
+    std::vector<float> input(LoopCount);
+    for (uint32_t i = 0; i < LoopCount; ++i) {
+        input[i] = float(i % 1000);
+    }
+    std::vector<float> asyncOutput(LoopCount);
+    std::vector<float> jobOutput(LoopCount);
+    auto kernel = [&](std::vector<float>& output, uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            output[i] = std::sqrt(input[i]) * 0.5f + 1.0f;
+        }
+    };
+
+    // The usual hand-split: one task per hardware thread
+    const uint32_t taskCount = std::max(std::thread::hardware_concurrency(), 1u);
+    const double asyncMs = MeasureMs([&] {
+        std::vector<std::future<void>> futures;
+        for (uint32_t task = 0; task < taskCount; ++task) {
+            const uint32_t begin = uint32_t(uint64_t(LoopCount) * task / taskCount);
+            const uint32_t end = uint32_t(uint64_t(LoopCount) * (task + 1) / taskCount);
+            futures.push_back(std::async(std::launch::async,
+                                         [&, begin, end] { kernel(asyncOutput, begin, end); }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+    });
+    const double jobMs = MeasureMs([&] {
+        jobs.ParallelFor(LoopCount, 4096,
+                         [&](uint32_t begin, uint32_t end) { kernel(jobOutput, begin, end); });
+    });
+    Report("parallel for, 4M elements", asyncMs, jobMs, asyncOutput == jobOutput);
+}
+
+// Producers submit at the same time; every 16th job is 50x as expensive as the rest
+void Contention(JobSystem& jobs)
+{
+    constexpr uint32_t JobsPerProducer = SmallJobCount / ProducerCount;
+    auto cost = [](uint32_t i) { return i % 16 == 0 ? 500u : 10u; };
+    std::atomic<uint32_t> asyncDone{0};
+    const double asyncMs = MeasureMs([&] {
+        asyncDone = 0;
+        std::vector<std::thread> producers;
+        for (uint32_t p = 0; p < ProducerCount; ++p) {
+            producers.emplace_back([&] {
+                std::vector<std::future<void>> futures;
+                for (uint32_t i = 0; i < JobsPerProducer; ++i) {
+                    futures.push_back(std::async(std::launch::async, [&, i] {
+                        Work(i, cost(i));
+                        asyncDone.fetch_add(1, std::memory_order_relaxed);
+                    }));
+                }
+                for (auto& future : futures) {
+                    future.get();
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+    });
+
+    std::atomic<uint32_t> jobDone{0};
+    const double jobMs = MeasureMs([&] {
+        jobDone = 0;
+        std::vector<std::thread> producers;
+        for (uint32_t p = 0; p < ProducerCount; ++p) {
+            producers.emplace_back([&] {
+                JobCounter counter;
+                for (uint32_t i = 0; i < JobsPerProducer; ++i) {
+                    jobs.Submit(
+                        [&, i] {
+                            Work(i, cost(i));
+                            jobDone.fetch_add(1, std::memory_order_relaxed);
+                        },
+                        &counter);
+                }
+                jobs.Wait(counter);
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+    });
+    Report("4 producers, uneven jobs", asyncMs, jobMs, asyncDone == jobDone);
+}
+
+} // namespace
+
+int main()
+{
+    JobSystem jobs;
+    jobs.Initialize(JobSystem::Settings{.ioThreadCount = 0});
+    std::printf("%u hardware threads, JobSystem on %u threads\n",
+                std::thread::hardware_concurrency(), jobs.GetThreadCount());
+    FanOut(jobs);
+    NestedTree(jobs);
+    ParallelLoop(jobs);
+    Contention(jobs);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,93 @@
+// Render queue sorting: radix sort vs std::stable_sort on packed 64-bit keys, and the
+// pipeline / material / mesh switches saved by sorting a randomly ordered draw list.
+// CPU only; no Vulkan device is created and no commands are recorded.
+#include "core/render_queue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t FrameCount = 100;
+constexpr uint32_t PipelineCount = 16;
+constexpr uint32_t MaterialCount = 256;
+constexpr uint32_t MeshCount = 64;
+
+double ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+void Run(uint32_t drawCount)
+{
+    RenderQueue queue;
+    for (uint32_t i = 0; i < PipelineCount; ++i) {
+        queue.RegisterPipeline(VK_NULL_HANDLE, VK_NULL_HANDLE);
+    }
+    for (uint32_t i = 0; i < MaterialCount; ++i) {
+        queue.RegisterMaterial(VK_NULL_HANDLE, 1);
+    }
+    for (uint32_t i = 0; i < MeshCount; ++i) {
+        queue.RegisterMesh(VK_NULL_HANDLE, VK_NULL_HANDLE);
+    }
+
+    // Scene-like distribution: each material belongs to one pipeline
+    std::mt19937 rng{drawCount};
+    std::uniform_int_distribution<uint32_t> materialDist{0, MaterialCount - 1};
+    std::uniform_int_distribution<uint32_t> meshDist{0, MeshCount - 1};
+    std::uniform_real_distribution<float> depthDist{0.1f, 500.0f};
+    std::vector<uint64_t> keys(drawCount);
+    for (auto& key : keys) {
+        const uint32_t material = materialDist(rng);
+        const uint32_t depth = SortKey::QuantizeDepth(depthDist(rng), 0.1f, 500.0f);
+        key = SortKey::Make(0, material % PipelineCount, material, depth, meshDist(rng));
+    }
+
+    double radixMs = 0.0;
+    for (uint32_t frame = 0; frame < FrameCount; ++frame) {
+        queue.Reset();
+        for (uint32_t i = 0; i < drawCount; ++i) {
+            queue.Submit(keys[i], RenderQueue::DrawArgs{.indexCount = 36});
+        }
+        auto start = std::chrono::steady_clock::now();
+        queue.Sort();
+        radixMs += ElapsedMs(start);
+    }
+
+    // Same pairs through the comparison sort the queue replaces
+    std::vector<RenderQueue::KeyIndex> pairs(drawCount);
+    double stdMs = 0.0;
+    for (uint32_t frame = 0; frame < FrameCount; ++frame) {
+        for (uint32_t i = 0; i < drawCount; ++i) {
+            pairs[i] = {keys[i], i};
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::stable_sort(pairs.begin(), pairs.end(),
+                         [](const auto& a, const auto& b) { return a.key < b.key; });
+        stdMs += ElapsedMs(start);
+    }
+
+    const auto& stats = queue.GetStats();
+    std::printf("%7u draws: radix %7.3f ms, std::stable_sort %7.3f ms | switches "
+                "pipeline %6u -> %3u, material %6u -> %3u, mesh %6u -> %6u\n",
+                drawCount, radixMs / FrameCount, stdMs / FrameCount,
+                stats.unsortedPipelineSwitches, stats.pipelineSwitches,
+                stats.unsortedMaterialSwitches, stats.materialSwitches,
+                stats.unsortedMeshSwitches, stats.meshSwitches);
+}
+
+} // namespace
+
+int main()
+{
+    std::printf("%u pipelines, %u materials, %u meshes, %u frames per size\n", PipelineCount,
+                MaterialCount, MeshCount, FrameCount);
+    for (uint32_t drawCount : {1000u, 10000u, 100000u, 1000000u}) {
+        Run(drawCount);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,264 @@
+#include "bench_harness.h"
+#include "host_memory.h"
+#include "core/command_buffer.h"
+#include "core/host_allocator.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedMs(Clock::time_point begin, Clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// Unlike a swapchain image the color target is shared by every frame in flight, so the previous
+// frame's attachment writes have to finish first
+ImageLayoutTransition FromPreviousFrameToColorAttachment()
+{
+    return {
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        .srcStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        .dstStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+    };
+}
+
+} // namespace
+
+void BenchHarness::Initialize(const Settings& settings)
+{
+    m_settings = settings;
+    auto& vulkanCtx = VulkanContext::Get();
+    vulkanCtx.CreateOffscreenFrames();
+
+    m_colorTarget = ColorTarget::Create(settings.extent, ColorFormat);
+    m_depthBuffer = DepthBuffer::Create(settings.extent, DepthFormat);
+    if (!m_colorTarget || !m_depthBuffer) {
+        throw std::runtime_error("Failed to create offscreen target.");
+    }
+    m_gpuTimerSupported = m_gpuTimer.Initialize(TimestampCount);
+
+    auto& hostAllocator = vulkanCtx.GetHostAllocator();
+    hostAllocator.SetHostAllocationCounter([] { return GetHostAllocationStats().count; });
+    hostAllocator.SetSteadyStateMode(settings.steadyState ? HostAllocator::SteadyStateMode::Report
+                                                          : HostAllocator::SteadyStateMode::Off);
+}
+
+void BenchHarness::Cleanup()
+{
+    vkDeviceWaitIdle(VulkanContext::Get().GetVkDevice());
+    m_gpuTimer.Cleanup();
+    m_msaaDepth.reset();
+    m_msaaColor.reset();
+    m_samples = VK_SAMPLE_COUNT_1_BIT;
+    m_depthBuffer.reset();
+    m_colorTarget.reset();
+}
+
+SceneResult BenchHarness::Run(const std::string& name, IBenchScene& scene,
+                              VkSampleCountFlagBits samples)
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    SetSampleCount(samples);
+    scene.Initialize(BenchTarget{
+        .extent = m_settings.extent,
+        .colorFormat = ColorFormat,
+        .depthFormat = DepthFormat,
+        .samples = samples,
+    });
+
+    const uint32_t measureBegin = m_settings.warmupFrames;
+    const uint32_t measureEnd = measureBegin + m_settings.measuredFrames;
+    auto isMeasured = [&](int64_t frameNumber) {
+        return frameNumber >= int64_t(measureBegin) && frameNumber < int64_t(measureEnd);
+    };
+
+    std::vector<double> cpuMs;
+    std::vector<double> frameMs;
+    std::vector<double> gpuMs;
+    cpuMs.reserve(m_settings.measuredFrames);
+    frameMs.reserve(m_settings.measuredFrames);
+    gpuMs.reserve(m_settings.measuredFrames);
+    uint64_t submits = 0;
+    uint64_t driverAllocations = 0;
+    HostAllocationStats allocations{};
+    auto& hostAllocator = vulkanCtx.GetHostAllocator();
+
+    // Frame number each slot last recorded, to attribute its timestamps when they come back
+    int64_t slotFrame[VulkanContext::MaxInflightFrame];
+    std::fill(std::begin(slotFrame), std::end(slotFrame), -1);
+
+    // Timestamps lag MaxInflightFrame frames, so a few unmeasured frames collect the last ones
+    const uint32_t frameCount = measureEnd + VulkanContext::MaxInflightFrame;
+    for (uint32_t frameNumber = 0; frameNumber < frameCount; ++frameNumber) {
+        const auto frameStart = Clock::now();
+        // BeginOffscreenFrame closes the previous frame's allocation counters, so the last
+        // measured frame is checked by the first unmeasured one
+        if (frameNumber == measureBegin) {
+            hostAllocator.BeginSteadyState();
+        }
+        vulkanCtx.BeginOffscreenFrame();
+        if (frameNumber == measureEnd) {
+            hostAllocator.EndSteadyState();
+        }
+        const auto cpuStart = Clock::now();
+        const auto allocationsBefore = GetHostAllocationStats();
+        const uint64_t submitsBefore = vulkanCtx.GetSubmitCount();
+        const uint64_t driverAllocationsBefore = hostAllocator.GetTotalAllocations();
+
+        const uint32_t frameIndex = vulkanCtx.GetCurrentFrameIndex();
+        auto& commandBuffer = *vulkanCtx.GetCurrentFrameContext()->commandBuffer;
+        commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        if (m_gpuTimerSupported) {
+            m_gpuTimer.BeginFrame(commandBuffer);
+            const double elapsedMs = m_gpuTimer.GetElapsedMs(FrameBegin, FrameEnd);
+            if (elapsedMs >= 0.0 && isMeasured(slotFrame[frameIndex])) {
+                gpuMs.push_back(elapsedMs);
+            }
+            slotFrame[frameIndex] = frameNumber;
+        }
+        RecordFrame(commandBuffer, scene, frameIndex, frameNumber);
+        commandBuffer.End();
+        vulkanCtx.SubmitOffscreenFrame();
+        const auto cpuEnd = Clock::now();
+
+        if (isMeasured(frameNumber)) {
+            cpuMs.push_back(ElapsedMs(cpuStart, cpuEnd));
+            frameMs.push_back(ElapsedMs(frameStart, cpuEnd));
+            submits += vulkanCtx.GetSubmitCount() - submitsBefore;
+            driverAllocations += hostAllocator.GetTotalAllocations() - driverAllocationsBefore;
+            const auto allocationsAfter = GetHostAllocationStats();
+            allocations.count += allocationsAfter.count - allocationsBefore.count;
+            allocations.bytes += allocationsAfter.bytes - allocationsBefore.bytes;
+        }
+    }
+    vkDeviceWaitIdle(vulkanCtx.GetVkDevice());
+    scene.Cleanup();
+
+    VkDeviceSize msaaCommitted = 0;
+    for (const auto& target : {m_msaaColor, m_msaaDepth}) {
+        if (target) {
+            msaaCommitted += target->GetCommittedBytes();
+        }
+    }
+
+    const double frames = std::max(m_settings.measuredFrames, 1u);
+    SceneResult result;
+    result.name = name;
+    result.samples = static_cast<uint32_t>(samples);
+    result.cpuMs = FrameStats::FromSamples(std::move(cpuMs));
+    result.frameMs = FrameStats::FromSamples(std::move(frameMs));
+    result.gpuMs = FrameStats::FromSamples(std::move(gpuMs));
+    result.submitsPerFrame = double(submits) / frames;
+    result.allocationsPerFrame = double(allocations.count) / frames;
+    result.allocatedBytesPerFrame = double(allocations.bytes) / frames;
+    result.driverAllocationsPerFrame = double(driverAllocations) / frames;
+    result.msaaCommittedMb = double(msaaCommitted) / (1024.0 * 1024.0);
+    result.peakMemoryMb = GetPeakResidentMemoryMb();
+    return result;
+}
+
+uint64_t BenchHarness::GetSteadyStateViolations() const
+{
+    return VulkanContext::Get().GetHostAllocator().GetSteadyStateViolations();
+}
+
+void BenchHarness::SetSampleCount(VkSampleCountFlagBits samples)
+{
+    if (samples == m_samples) {
+        return;
+    }
+    m_msaaColor.reset();
+    m_msaaDepth.reset();
+    m_samples = VK_SAMPLE_COUNT_1_BIT;
+    if (samples == VK_SAMPLE_COUNT_1_BIT) {
+        return;
+    }
+    if ((VulkanContext::Get().GetSupportedSampleCounts() & samples) == 0) {
+        throw std::runtime_error("Unsupported sample count.");
+    }
+    m_msaaColor = MultisampleTarget::Create(m_settings.extent, ColorFormat, samples);
+    m_msaaDepth = MultisampleTarget::Create(m_settings.extent, DepthFormat, samples);
+    if (!m_msaaColor || !m_msaaDepth) {
+        throw std::runtime_error("Failed to create multisampled targets.");
+    }
+    m_samples = samples;
+}
+
+void BenchHarness::RecordFrame(CommandBuffer& commandBuffer, IBenchScene& scene,
+                               uint32_t frameIndex, uint32_t frameNumber)
+{
+    VkImageSubresourceRange colorRange{
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+    VkImageSubresourceRange depthRange = colorRange;
+    depthRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    // Both attachments are cleared, so the previous contents never need preserving. The
+    // resolve writes the color target in the color attachment output stage as well.
+    const bool multisampled = m_samples != VK_SAMPLE_COUNT_1_BIT;
+    commandBuffer.TransitionLayout(m_colorTarget->GetVkImage(), colorRange,
+                                   FromPreviousFrameToColorAttachment());
+    if (multisampled) {
+        commandBuffer.TransitionLayout(m_msaaColor->GetVkImage(), colorRange,
+                                       FromPreviousFrameToColorAttachment());
+    }
+    commandBuffer.TransitionLayout(
+        multisampled ? m_msaaDepth->GetVkImage() : m_depthBuffer->GetVkImage(), depthRange,
+        ImageLayoutTransition::FromUndefinedToDepthAttachment());
+
+    VkRenderingAttachmentInfo colorAttachment{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = m_colorTarget->GetVkImageView(),
+        .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+        .clearValue = VkClearValue{.color = {{0.1f, 0.1f, 0.12f, 1.0f}}},
+    };
+    VkRenderingAttachmentInfo depthAttachment{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = m_depthBuffer->GetVkImageView(),
+        .imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        .clearValue = VkClearValue{.depthStencil = {1.0f, 0}},
+    };
+    VkRenderingInfo renderingInfo{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .renderArea = {{0, 0}, m_settings.extent},
+        .layerCount = 1,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &colorAttachment,
+        .pDepthAttachment = &depthAttachment,
+    };
+    if (multisampled) {
+        // Samples are averaged into the color target when rendering ends and then discarded,
+        // so on tile-based GPUs they never leave tile memory
+        colorAttachment.imageView = m_msaaColor->GetVkImageView();
+        colorAttachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+        colorAttachment.resolveImageView = m_colorTarget->GetVkImageView();
+        colorAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.imageView = m_msaaDepth->GetVkImageView();
+    }
+
+    if (m_gpuTimerSupported) {
+        m_gpuTimer.WriteTimestamp(commandBuffer, FrameBegin, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    }
+    vkCmdBeginRendering(commandBuffer, &renderingInfo);
+    scene.RecordFrame(commandBuffer, frameIndex, frameNumber);
+    vkCmdEndRendering(commandBuffer);
+    if (m_gpuTimerSupported) {
+        m_gpuTimer.WriteTimestamp(commandBuffer, FrameEnd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "bench_report.h"
+#include "bench_scene.h"
+#include "core/gpu_timer.h"
+#include "core/image_resource.h"
+#include <memory>
+
+// Renders a scene headlessly into an offscreen color + depth target for a fixed number of
+// warm-up and measured frames, with MaxInflightFrame frames in flight as the samples do.
+// With MSAA the scene renders into transient multisampled targets that are resolved into the
+// color target at the end of rendering; neither multisampled target is ever stored.
+// Expects VulkanContext to be initialized without a surface.
+class BenchHarness {
+public:
+    static constexpr VkFormat ColorFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    static constexpr VkFormat DepthFormat = VK_FORMAT_D32_SFLOAT;
+
+    struct Settings {
+        VkExtent2D extent{1280, 720};
+        uint32_t warmupFrames = 100;
+        uint32_t measuredFrames = 1000;
+        // Measured frames must not allocate, on the host or in the driver
+        bool steadyState = false;
+    };
+
+    BenchHarness() = default;
+    ~BenchHarness() = default;
+
+    BenchHarness(const BenchHarness&) = delete;
+    BenchHarness& operator=(const BenchHarness&) = delete;
+
+    void Initialize(const Settings& settings);
+    void Cleanup();
+
+    // Initializes the scene, runs it and cleans it up again. samples must be one of
+    // VulkanContext::GetSupportedSampleCounts().
+    SceneResult Run(const std::string& name, IBenchScene& scene,
+                    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
+
+    // Measured frames that allocated, over every scene run so far (with Settings::steadyState)
+    uint64_t GetSteadyStateViolations() const;
+
+private:
+    enum Timestamp : uint32_t {
+        FrameBegin,
+        FrameEnd,
+        TimestampCount,
+    };
+
+    // Recreates the multisampled targets when the sample count changes; the device is idle
+    void SetSampleCount(VkSampleCountFlagBits samples);
+    void RecordFrame(CommandBuffer& commandBuffer, IBenchScene& scene, uint32_t frameIndex,
+                     uint32_t frameNumber);
+
+    Settings m_settings;
+    std::shared_ptr<ColorTarget> m_colorTarget;
+    std::shared_ptr<DepthBuffer> m_depthBuffer;
+    VkSampleCountFlagBits m_samples = VK_SAMPLE_COUNT_1_BIT;
+    std::shared_ptr<MultisampleTarget> m_msaaColor;
+    std::shared_ptr<MultisampleTarget> m_msaaDepth;
+    GpuTimer m_gpuTimer;
+    bool m_gpuTimerSupported = false;
+};
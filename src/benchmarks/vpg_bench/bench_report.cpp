@@ -0,0 +1,267 @@
+#include "bench_report.h"
+#include "core/json_reader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// Regressions smaller than these are treated as noise whatever the percentage
+constexpr double TimeAllowanceMs = 0.05;
+constexpr double CountAllowance = 0.5;
+constexpr double MemoryAllowanceMb = 4.0;
+
+std::string Escape(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        }
+        else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string FormatNumber(double value)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.4f", value);
+    return text;
+}
+
+void FormatStats(std::ostringstream& out, const char* key, const FrameStats& stats)
+{
+    out << "      \"" << key << "\": {\"samples\": " << stats.samples
+        << ", \"mean\": " << FormatNumber(stats.mean) << ", \"p50\": " << FormatNumber(stats.p50)
+        << ", \"p95\": " << FormatNumber(stats.p95) << ", \"p99\": " << FormatNumber(stats.p99)
+        << ", \"max\": " << FormatNumber(stats.max) << "},\n";
+}
+
+template <typename ParseMember>
+bool ParseObject(JsonReader& reader, ParseMember parseMember)
+{
+    if (!reader.BeginObject()) {
+        return false;
+    }
+    std::string_view key;
+    while (reader.NextMember(key)) {
+        if (!parseMember(key)) {
+            return false;
+        }
+    }
+    return !reader.HasError();
+}
+
+bool ParseStats(JsonReader& reader, FrameStats& stats)
+{
+    return ParseObject(reader, [&](std::string_view key) {
+        if (key == "samples") return reader.ReadUint(stats.samples);
+        if (key == "mean") return reader.ReadNumber(stats.mean);
+        if (key == "p50") return reader.ReadNumber(stats.p50);
+        if (key == "p95") return reader.ReadNumber(stats.p95);
+        if (key == "p99") return reader.ReadNumber(stats.p99);
+        if (key == "max") return reader.ReadNumber(stats.max);
+        return reader.SkipValue();
+    });
+}
+
+bool ParseScene(JsonReader& reader, SceneResult& scene)
+{
+    return ParseObject(reader, [&](std::string_view key) {
+        if (key == "name") return reader.ReadString(scene.name);
+        if (key == "samples") return reader.ReadUint(scene.samples);
+        if (key == "cpuMs") return ParseStats(reader, scene.cpuMs);
+        if (key == "frameMs") return ParseStats(reader, scene.frameMs);
+        if (key == "gpuMs") return ParseStats(reader, scene.gpuMs);
+        if (key == "submitsPerFrame") return reader.ReadNumber(scene.submitsPerFrame);
+        if (key == "allocationsPerFrame") return reader.ReadNumber(scene.allocationsPerFrame);
+        if (key == "allocatedBytesPerFrame") {
+            return reader.ReadNumber(scene.allocatedBytesPerFrame);
+        }
+        if (key == "driverAllocationsPerFrame") {
+            return reader.ReadNumber(scene.driverAllocationsPerFrame);
+        }
+        if (key == "msaaCommittedMb") return reader.ReadNumber(scene.msaaCommittedMb);
+        if (key == "peakMemoryMb") return reader.ReadNumber(scene.peakMemoryMb);
+        return reader.SkipValue();
+    });
+}
+
+struct Metric {
+    const char* name;
+    double baseline;
+    double current;
+    double allowance;
+};
+
+} // namespace
+
+FrameStats FrameStats::FromSamples(std::vector<double> samples)
+{
+    FrameStats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) {
+        const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * double(samples.size())));
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    stats.samples = static_cast<uint32_t>(samples.size());
+    stats.mean = sum / double(samples.size());
+    stats.p50 = percentile(50.0);
+    stats.p95 = percentile(95.0);
+    stats.p99 = percentile(99.0);
+    stats.max = samples.back();
+    return stats;
+}
+
+std::string FormatBenchReport(const BenchReport& report)
+{
+    std::ostringstream out;
+    out << "{\n";
+    out << "  \"device\": \"" << Escape(report.device) << "\",\n";
+    out << "  \"driverVersion\": \"" << Escape(report.driverVersion) << "\",\n";
+    out << "  \"width\": " << report.width << ",\n";
+    out << "  \"height\": " << report.height << ",\n";
+    out << "  \"warmupFrames\": " << report.warmupFrames << ",\n";
+    out << "  \"measuredFrames\": " << report.measuredFrames << ",\n";
+    out << "  \"scenes\": [\n";
+    for (size_t i = 0; i < report.scenes.size(); ++i) {
+        const auto& scene = report.scenes[i];
+        out << "    {\n";
+        out << "      \"name\": \"" << Escape(scene.name) << "\",\n";
+        out << "      \"samples\": " << scene.samples << ",\n";
+        FormatStats(out, "cpuMs", scene.cpuMs);
+        FormatStats(out, "frameMs", scene.frameMs);
+        FormatStats(out, "gpuMs", scene.gpuMs);
+        out << "      \"submitsPerFrame\": " << FormatNumber(scene.submitsPerFrame) << ",\n";
+        out << "      \"allocationsPerFrame\": " << FormatNumber(scene.allocationsPerFrame)
+            << ",\n";
+        out << "      \"allocatedBytesPerFrame\": " << FormatNumber(scene.allocatedBytesPerFrame)
+            << ",\n";
+        out << "      \"driverAllocationsPerFrame\": "
+            << FormatNumber(scene.driverAllocationsPerFrame) << ",\n";
+        out << "      \"msaaCommittedMb\": " << FormatNumber(scene.msaaCommittedMb) << ",\n";
+        out << "      \"peakMemoryMb\": " << FormatNumber(scene.peakMemoryMb) << "\n";
+        out << (i + 1 < report.scenes.size() ? "    },\n" : "    }\n");
+    }
+    out << "  ]\n";
+    out << "}\n";
+    return out.str();
+}
+
+bool WriteBenchReport(const std::filesystem::path& path, const BenchReport& report)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file << FormatBenchReport(report);
+    return file.good();
+}
+
+bool ReadBenchReport(const std::filesystem::path& path, BenchReport& report)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    const std::string json = text.str();
+
+    JsonReader reader(json);
+    return ParseObject(reader, [&](std::string_view key) {
+        if (key == "device") return reader.ReadString(report.device);
+        if (key == "driverVersion") return reader.ReadString(report.driverVersion);
+        if (key == "width") return reader.ReadUint(report.width);
+        if (key == "height") return reader.ReadUint(report.height);
+        if (key == "warmupFrames") return reader.ReadUint(report.warmupFrames);
+        if (key == "measuredFrames") return reader.ReadUint(report.measuredFrames);
+        if (key == "scenes") {
+            if (!reader.BeginArray()) {
+                return false;
+            }
+            while (reader.NextElement()) {
+                if (!ParseScene(reader, report.scenes.emplace_back())) {
+                    return false;
+                }
+            }
+            return !reader.HasError();
+        }
+        return reader.SkipValue();
+    });
+}
+
+uint32_t CompareBenchReports(const BenchReport& baseline, const BenchReport& current,
+                             double thresholdPercent)
+{
+    if (baseline.device != current.device) {
+        std::printf("note: baseline was recorded on \"%s\", this run is on \"%s\"\n",
+                    baseline.device.c_str(), current.device.c_str());
+    }
+    const double factor = 1.0 + thresholdPercent / 100.0;
+    uint32_t regressions = 0;
+    for (const auto& scene : current.scenes) {
+        auto it = std::find_if(baseline.scenes.begin(), baseline.scenes.end(),
+                               [&](const SceneResult& s) { return s.name == scene.name; });
+        if (it == baseline.scenes.end()) {
+            std::printf("  %-20s not in baseline\n", scene.name.c_str());
+            continue;
+        }
+        const SceneResult& base = *it;
+        std::vector<Metric> metrics = {
+            {"cpu p50 ms", base.cpuMs.p50, scene.cpuMs.p50, TimeAllowanceMs},
+            {"cpu p95 ms", base.cpuMs.p95, scene.cpuMs.p95, TimeAllowanceMs},
+            {"cpu p99 ms", base.cpuMs.p99, scene.cpuMs.p99, TimeAllowanceMs},
+            {"frame p50 ms", base.frameMs.p50, scene.frameMs.p50, TimeAllowanceMs},
+            {"submits/frame", base.submitsPerFrame, scene.submitsPerFrame, CountAllowance},
+            {"allocations/frame", base.allocationsPerFrame, scene.allocationsPerFrame,
+             CountAllowance},
+            {"driver allocs/frame", base.driverAllocationsPerFrame,
+             scene.driverAllocationsPerFrame, CountAllowance},
+            {"msaa committed MB", base.msaaCommittedMb, scene.msaaCommittedMb,
+             MemoryAllowanceMb},
+            {"peak memory MB", base.peakMemoryMb, scene.peakMemoryMb, MemoryAllowanceMb},
+        };
+        if (base.gpuMs.samples > 0 && scene.gpuMs.samples > 0) {
+            metrics.push_back({"gpu p50 ms", base.gpuMs.p50, scene.gpuMs.p50, TimeAllowanceMs});
+            metrics.push_back({"gpu p95 ms", base.gpuMs.p95, scene.gpuMs.p95, TimeAllowanceMs});
+        }
+        for (const auto& metric : metrics) {
+            if (metric.current > metric.baseline * factor + metric.allowance) {
+                const double change = metric.baseline > 0.0
+                                          ? (metric.current / metric.baseline - 1.0) * 100.0
+                                          : 100.0;
+                std::printf("  REGRESSION %-20s %-18s %10.3f -> %10.3f (%+.1f%%)\n",
+                            scene.name.c_str(), metric.name, metric.baseline, metric.current,
+                            change);
+                ++regressions;
+            }
+        }
+    }
+    for (const auto& base : baseline.scenes) {
+        auto it = std::find_if(current.scenes.begin(), current.scenes.end(),
+                               [&](const SceneResult& s) { return s.name == base.name; });
+        if (it == current.scenes.end()) {
+            std::printf("  %-20s in baseline but not run\n", base.name.c_str());
+        }
+    }
+    return regressions;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Distribution of per-frame samples in milliseconds; nearest-rank percentiles
+struct FrameStats {
+    uint32_t samples = 0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+
+    static FrameStats FromSamples(std::vector<double> samples);
+};
+
+struct SceneResult {
+    std::string name;
+    // Rasterization samples; above 1 the scene renders into resolved transient targets
+    uint32_t samples = 1;
+    // Recording and submission, without waiting for the frame slot
+    FrameStats cpuMs;
+    // Frame start to frame start, including the wait for the GPU
+    FrameStats frameMs;
+    // Empty when the queue has no timestamps
+    FrameStats gpuMs;
+    double submitsPerFrame = 0.0;
+    double allocationsPerFrame = 0.0;
+    double allocatedBytesPerFrame = 0.0;
+    // Made by the driver through VulkanContext's allocation callbacks
+    double driverAllocationsPerFrame = 0.0;
+    // Memory the driver committed to the multisampled targets; stays 0 with lazily allocated
+    // memory on tile-based GPUs
+    double msaaCommittedMb = 0.0;
+    // Process-wide, so it never drops from one scene to the next
+    double peakMemoryMb = 0.0;
+};
+
+struct BenchReport {
+    std::string device;
+    std::string driverVersion;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t warmupFrames = 0;
+    uint32_t measuredFrames = 0;
+    std::vector<SceneResult> scenes;
+};
+
+bool WriteBenchReport(const std::filesystem::path& path, const BenchReport& report);
+std::string FormatBenchReport(const BenchReport& report);
+bool ReadBenchReport(const std::filesystem::path& path, BenchReport& report);
+
+// Prints every metric of current that is worse than baseline by more than thresholdPercent
+// (plus a small absolute allowance for timer noise) and returns how many there were. Scenes
+// missing from either report are listed but not counted.
+uint32_t CompareBenchReports(const BenchReport& baseline, const BenchReport& current,
+                             double thresholdPercent);
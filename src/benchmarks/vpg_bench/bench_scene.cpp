@@ -0,0 +1,38 @@
+#include "bench_scene.h"
+#include <map>
+
+namespace {
+
+// Function-local so registration from other translation units' static initializers is safe
+std::map<std::string, BenchSceneFactory>& GetRegistry()
+{
+    static std::map<std::string, BenchSceneFactory> registry;
+    return registry;
+}
+
+} // namespace
+
+bool RegisterBenchScene(const char* name, BenchSceneFactory factory)
+{
+    GetRegistry()[name] = std::move(factory);
+    return true;
+}
+
+std::vector<std::string> GetBenchSceneNames()
+{
+    std::vector<std::string> names;
+    for (const auto& [name, factory] : GetRegistry()) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+std::unique_ptr<IBenchScene> CreateBenchScene(const std::string& name)
+{
+    auto& registry = GetRegistry();
+    auto it = registry.find(name);
+    if (it == registry.end()) {
+        return nullptr;
+    }
+    return it->second();
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Offscreen attachments the harness renders into; both are cleared at the start of every frame
+struct BenchTarget {
+    VkExtent2D extent{};
+    VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+    // Pipelines must rasterize with this many samples; above 1 the attachments are
+    // multisampled and resolved by the harness
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+};
+
+// A workload vpg_bench can run. The harness begins dynamic rendering, calls RecordFrame and ends
+// rendering, so a scene only records its draws. Scenes register themselves from their own
+// translation unit:
+//   const bool g_registered = RegisterBenchScene("clear", [] {
+//       return std::make_unique<ClearScene>();
+//   });
+class IBenchScene {
+public:
+    virtual ~IBenchScene() = default;
+
+    // Throws std::runtime_error on failure
+    virtual void Initialize(const BenchTarget& target) = 0;
+    // frameIndex is the frame slot in flight; frameNumber counts warm-up and measured frames
+    virtual void RecordFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex,
+                             uint32_t frameNumber) = 0;
+    // The device is idle
+    virtual void Cleanup() = 0;
+};
+
+using BenchSceneFactory = std::function<std::unique_ptr<IBenchScene>()>;
+
+// Returns true so the call can initialize a namespace-scope constant
+bool RegisterBenchScene(const char* name, BenchSceneFactory factory);
+// Sorted by name
+std::vector<std::string> GetBenchSceneNames();
+// nullptr for an unknown name
+std::unique_ptr<IBenchScene> CreateBenchScene(const std::string& name);
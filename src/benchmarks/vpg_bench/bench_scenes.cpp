@@ -0,0 +1,216 @@
+// Built-in scenes. Animation is driven by the frame number, not the clock, so every run records
+// the same work.
+#include "bench_scene.h"
+#include "core/asset_path.h"
+#include "core/command_buffer.h"
+#include "core/geometry_arena.h"
+#include "core/gltf_loader.h"
+#include "core/graphics_pipeline_builder.h"
+#include "core/instance_stream.h"
+#include "core/pipeline_layout_cache.h"
+#include "core/shader_compiler.h"
+#include "core/shader_loader.h"
+#include "core/shader_reflection.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint32_t CubeCount = 20000;
+constexpr float GridSpacing = 1.5f;
+// Frame number to animation time
+constexpr float SecondsPerFrame = 1.0f / 60.0f;
+
+// Attachments cleared by the harness and nothing else: the fixed cost of a frame
+class ClearScene : public IBenchScene {
+public:
+    void Initialize(const BenchTarget&) override {}
+    void RecordFrame(VkCommandBuffer, uint32_t, uint32_t) override {}
+    void Cleanup() override {}
+};
+
+// The DrawStress cube grid, as one instanced draw or one draw per cube
+class CubeScene : public IBenchScene {
+public:
+    explicit CubeScene(bool instanced) : m_instanced(instanced) {}
+
+    void Initialize(const BenchTarget& target) override;
+    void RecordFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex,
+                     uint32_t frameNumber) override;
+    void Cleanup() override;
+
+private:
+    struct Vertex {
+        glm::vec3 position;
+        glm::vec3 color;
+    };
+
+    struct Instance {
+        glm::vec4 positionScale;
+    };
+
+    void CreateGeometry();
+    void CreatePipeline(const BenchTarget& target);
+
+    bool m_instanced = false;
+    uint32_t m_gridSize = 1;
+    float m_aspect = 1.0f;
+
+    GeometryArena m_geometry;
+    GeometryAllocation m_cube;
+    InstanceStream m_instanceStream;
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_pipeline = VK_NULL_HANDLE;
+};
+
+void CubeScene::Initialize(const BenchTarget& target)
+{
+    m_gridSize = static_cast<uint32_t>(std::ceil(std::cbrt(double(CubeCount))));
+    m_aspect = float(target.extent.width) / float(target.extent.height);
+    CreateGeometry();
+    CreatePipeline(target);
+    if (!m_instanceStream.Initialize(sizeof(Instance), CubeCount)) {
+        throw std::runtime_error("Failed to create instance stream.");
+    }
+}
+
+void CubeScene::RecordFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex,
+                            uint32_t frameNumber)
+{
+    const float time = float(frameNumber) * SecondsPerFrame;
+    m_instanceStream.BeginFrame(frameIndex);
+    auto range = m_instanceStream.Allocate(CubeCount);
+    auto* instances = static_cast<Instance*>(range.mapped);
+    const float half = 0.5f * GridSpacing * float(m_gridSize - 1);
+    for (uint32_t i = 0; i < CubeCount; ++i) {
+        const uint32_t x = i % m_gridSize;
+        const uint32_t y = (i / m_gridSize) % m_gridSize;
+        const uint32_t z = i / (m_gridSize * m_gridSize);
+        const float bob = 0.25f * std::sin(time * 2.0f + float(i) * 0.37f);
+        instances[i].positionScale = glm::vec4(GridSpacing * float(x) - half,
+                                               GridSpacing * float(y) - half + bob,
+                                               GridSpacing * float(z) - half, 1.0f);
+    }
+
+    const float radius = 1.8f * GridSpacing * float(m_gridSize) + 2.0f;
+    const float angle = time * 0.2f;
+    const glm::vec3 eye{radius * std::cos(angle), 0.4f * radius, radius * std::sin(angle)};
+    const glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const glm::mat4 proj = glm::perspective(glm::radians(60.0f), m_aspect, 0.1f, 4.0f * radius);
+    const glm::mat4 viewProj = proj * view;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                       sizeof(viewProj), &viewProj);
+    m_geometry.Bind(commandBuffer);
+    m_instanceStream.Bind(commandBuffer, 1);
+    const auto vertexOffset = static_cast<int32_t>(m_cube.firstVertex);
+    if (m_instanced) {
+        vkCmdDrawIndexed(commandBuffer, m_cube.indexCount, range.count, m_cube.firstIndex,
+                         vertexOffset, range.firstInstance);
+        return;
+    }
+    for (uint32_t i = 0; i < range.count; ++i) {
+        vkCmdDrawIndexed(commandBuffer, m_cube.indexCount, 1, m_cube.firstIndex, vertexOffset,
+                         range.firstInstance + i);
+    }
+}
+
+void CubeScene::Cleanup()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    vkDestroyPipeline(vulkanCtx.GetVkDevice(), m_pipeline, vulkanCtx.GetAllocationCallbacks());
+    m_pipeline = VK_NULL_HANDLE;
+    m_instanceStream.Cleanup();
+    m_geometry.Cleanup();
+}
+
+void CubeScene::CreateGeometry()
+{
+    GltfVertexLayout layout{
+        .stride = sizeof(Vertex),
+        .attributes = {
+            {.semantic = "POSITION", .offset = offsetof(Vertex, position), .components = 3},
+            {.semantic = "COLOR_0", .offset = offsetof(Vertex, color), .components = 3,
+             .defaultValue = {1.0f, 1.0f, 1.0f, 1.0f}},
+        },
+    };
+    GltfModel model;
+    if (!loader::LoadGltf(GetAssetPath(AssetType::Model, "cube.gltf"), layout, model)) {
+        throw std::runtime_error("Failed to load cube.gltf.");
+    }
+    if (!m_geometry.Initialize(sizeof(Vertex), model.vertexCount, model.indexCount)) {
+        throw std::runtime_error("Failed to create geometry arena.");
+    }
+    m_cube = m_geometry.Allocate(model.vertexCount, model.indexCount);
+
+    auto& vulkanCtx = VulkanContext::Get();
+    auto commandBuffer = vulkanCtx.CreateCommandBuffer();
+    commandBuffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    m_geometry.RecordUpload(*commandBuffer, *model.staging, 0, model.indexOffset, m_cube);
+    commandBuffer->End();
+    vulkanCtx.SubmitAndWait(commandBuffer);
+}
+
+void CubeScene::CreatePipeline(const BenchTarget& target)
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    const auto vertPath = GetAssetPath(AssetType::Shader, "draw_stress.vert");
+    const auto fragPath = GetAssetPath(AssetType::Shader, "draw_stress.frag");
+    if (!loader::UpdateSpirvFile(vertPath) || !loader::UpdateSpirvFile(fragPath)) {
+        throw std::runtime_error("Failed to compile draw stress shaders.");
+    }
+
+    ShaderReflection vertReflection{};
+    ShaderReflection fragReflection{};
+    VkShaderModule vertShaderModule =
+        loader::LoadShaderModule(vertPath.string() + ".spv", &vertReflection);
+    VkShaderModule fragShaderModule =
+        loader::LoadShaderModule(fragPath.string() + ".spv", &fragReflection);
+    m_pipelineLayout = vulkanCtx.GetPipelineLayoutCache()
+                           .GetPipelineLayout({&vertReflection, &fragReflection})
+                           .pipelineLayout;
+
+    GraphicsPipelineBuilder builder{};
+    builder.AddShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vertShaderModule);
+    builder.AddShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragShaderModule);
+    builder.SetVertexInputInstanced(vertReflection, 2);
+    builder.SetViewport(target.extent);
+    builder.SetRasterizationState(VkPipelineRasterizationStateCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_BACK_BIT,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .lineWidth = 1.0f,
+    });
+    builder.SetDepthStencilState(VkPipelineDepthStencilStateCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = VK_TRUE,
+        .depthCompareOp = VK_COMPARE_OP_LESS,
+    });
+    builder.SetPipelineLayout(m_pipelineLayout);
+    builder.UseDynamicRendering(target.colorFormat, target.depthFormat);
+    builder.SetSampleCount(target.samples);
+    m_pipeline = builder.Build();
+
+    auto device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    vkDestroyShaderModule(device, vertShaderModule, allocator);
+    vkDestroyShaderModule(device, fragShaderModule, allocator);
+    if (m_pipeline == VK_NULL_HANDLE) {
+        throw std::runtime_error("Failed to create graphics pipeline.");
+    }
+}
+
+const bool g_clearRegistered =
+    RegisterBenchScene("clear", [] { return std::make_unique<ClearScene>(); });
+const bool g_cubesInstancedRegistered =
+    RegisterBenchScene("cubes_instanced", [] { return std::make_unique<CubeScene>(true); });
+const bool g_cubesIndividualRegistered =
+    RegisterBenchScene("cubes_individual", [] { return std::make_unique<CubeScene>(false); });
+
+} // namespace
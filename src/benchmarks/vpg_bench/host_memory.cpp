@@ -0,0 +1,117 @@
+#include "host_memory.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#   define NOMINMAX
+#   include <windows.h>
+#   include <psapi.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#   include <sys/resource.h>
+#endif
+
+namespace {
+
+std::atomic<uint64_t> g_allocationCount{0};
+std::atomic<uint64_t> g_allocatedBytes{0};
+
+void* Allocate(std::size_t size, std::size_t alignment)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    size = size == 0 ? 1 : size;
+    void* memory = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        memory = std::malloc(size);
+    }
+    else {
+#if defined(_WIN32)
+        memory = _aligned_malloc(size, alignment);
+#else
+        // aligned_alloc wants a multiple of the alignment
+        memory = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    }
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void Free(void* memory, std::size_t alignment)
+{
+#if defined(_WIN32)
+    if (alignment > alignof(std::max_align_t)) {
+        _aligned_free(memory);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(memory);
+}
+
+} // namespace
+
+// The array and nothrow forms forward to these by default
+void* operator new(std::size_t size)
+{
+    return Allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept
+{
+    Free(memory, alignof(std::max_align_t));
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    Free(memory, alignof(std::max_align_t));
+}
+
+void operator delete(void* memory, std::align_val_t alignment) noexcept
+{
+    Free(memory, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept
+{
+    Free(memory, static_cast<std::size_t>(alignment));
+}
+
+HostAllocationStats GetHostAllocationStats()
+{
+    return {g_allocationCount.load(std::memory_order_relaxed),
+            g_allocatedBytes.load(std::memory_order_relaxed)};
+}
+
+double GetPeakResidentMemoryMb()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return double(counters.PeakWorkingSetSize) / (1024.0 * 1024.0);
+    }
+    return 0.0;
+#elif defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+#   if defined(__APPLE__)
+    // Bytes on macOS, KiB elsewhere
+    return double(usage.ru_maxrss) / (1024.0 * 1024.0);
+#   else
+    return double(usage.ru_maxrss) / 1024.0;
+#   endif
+#else
+    return 0.0;
+#endif
+}
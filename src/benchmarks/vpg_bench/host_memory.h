@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+// Totals of every operator new in this process since start. The executable replaces the
+// global allocation functions to count them; allocations the driver makes with malloc are not
+// included.
+struct HostAllocationStats {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+HostAllocationStats GetHostAllocationStats();
+
+// Peak resident set size of the process in MiB; 0 where the platform does not report it
+double GetPeakResidentMemoryMb();
@@ -0,0 +1,267 @@
+// vpg_bench: runs registered scenes headlessly for a fixed number of warm-up and measured frames
+// and reports CPU / GPU frame time percentiles, submits, host allocations and peak memory as
+// JSON. With --compare the run is checked against a stored baseline and the exit code is the
+// number of regressions (capped at 125), so it can gate CI.
+//
+//   vpg_bench [--scene name]... [--warmup n] [--frames n] [--width w] [--height h]
+//             [--output results.json] [--compare baseline.json] [--threshold percent] [--list]
+//             [--memory-dump memory.json] [--steady-state] [--samples n]...
+//
+// --memory-dump writes GpuMemoryTracker's live allocations after the last scene has run, before
+// the harness releases its targets. --steady-state fails the run if any measured frame allocates,
+// through operator new or through the driver's allocation callbacks.
+//
+// --samples runs every scene once per MSAA sample count (default 1) and reports the extra runs
+// as scene@Nx, so GPU time and committed attachment memory can be compared per setting. Counts
+// the device does not support for color + depth attachments are rejected.
+//
+// Any Vulkan 1.3 ICD works. On machines without a GPU, point the loader at lavapipe:
+//   VK_DRIVER_FILES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json vpg_bench
+// (VK_ICD_FILENAMES on loaders older than 1.3.234).
+#include "bench_harness.h"
+#include "bench_report.h"
+#include "bench_scene.h"
+#include "core/asset_path.h"
+#include "core/gpu_memory_tracker.h"
+#include "core/vulkan_context.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::vector<std::string> scenes;
+    std::vector<VkSampleCountFlagBits> sampleCounts;
+    BenchHarness::Settings settings;
+    std::string outputPath;
+    std::string baselinePath;
+    std::string memoryDumpPath;
+    double thresholdPercent = 10.0;
+    bool list = false;
+};
+
+void PrintUsage()
+{
+    std::printf("usage: vpg_bench [--scene name]... [--warmup n] [--frames n] [--width w] "
+                "[--height h]\n"
+                "                 [--output results.json] [--compare baseline.json] "
+                "[--threshold percent] [--list]\n"
+                "                 [--memory-dump memory.json] [--steady-state] "
+                "[--samples n]...\n");
+}
+
+uint32_t ParseUint(const char* text)
+{
+    return static_cast<uint32_t>(std::strtoul(text, nullptr, 10));
+}
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        auto takesValue = [&](const char* name) {
+            if (std::strcmp(arg, name) != 0 || value == nullptr) {
+                return false;
+            }
+            ++i;
+            return true;
+        };
+        if (std::strcmp(arg, "--list") == 0) {
+            options.list = true;
+        }
+        else if (std::strcmp(arg, "--steady-state") == 0) {
+            options.settings.steadyState = true;
+        }
+        else if (takesValue("--scene")) {
+            options.scenes.push_back(value);
+        }
+        else if (takesValue("--samples")) {
+            const uint32_t samples = ParseUint(value);
+            if (samples == 0 || samples > 64 || (samples & (samples - 1)) != 0) {
+                std::printf("sample count must be a power of two up to 64: %s\n", value);
+                return false;
+            }
+            options.sampleCounts.push_back(static_cast<VkSampleCountFlagBits>(samples));
+        }
+        else if (takesValue("--warmup")) {
+            options.settings.warmupFrames = ParseUint(value);
+        }
+        else if (takesValue("--frames")) {
+            options.settings.measuredFrames = ParseUint(value);
+        }
+        else if (takesValue("--width")) {
+            options.settings.extent.width = ParseUint(value);
+        }
+        else if (takesValue("--height")) {
+            options.settings.extent.height = ParseUint(value);
+        }
+        else if (takesValue("--output")) {
+            options.outputPath = value;
+        }
+        else if (takesValue("--compare")) {
+            options.baselinePath = value;
+        }
+        else if (takesValue("--memory-dump")) {
+            options.memoryDumpPath = value;
+        }
+        else if (takesValue("--threshold")) {
+            options.thresholdPercent = std::strtod(value, nullptr);
+        }
+        else {
+            std::printf("unknown option or missing value: %s\n", arg);
+            return false;
+        }
+    }
+    const auto& extent = options.settings.extent;
+    return options.settings.measuredFrames > 0 && extent.width > 0 && extent.height > 0;
+}
+
+std::string FormatDriverVersion(const VkPhysicalDeviceProperties& properties)
+{
+    char text[64];
+    std::snprintf(text, sizeof(text), "%u.%u.%u (0x%08x)",
+                  VK_API_VERSION_MAJOR(properties.apiVersion),
+                  VK_API_VERSION_MINOR(properties.apiVersion),
+                  VK_API_VERSION_PATCH(properties.apiVersion), properties.driverVersion);
+    return text;
+}
+
+void PrintScene(const SceneResult& scene)
+{
+    std::printf("%-20s cpu p50 %7.3f p95 %7.3f p99 %7.3f ms | frame p50 %7.3f ms | ",
+                scene.name.c_str(), scene.cpuMs.p50, scene.cpuMs.p95, scene.cpuMs.p99,
+                scene.frameMs.p50);
+    if (scene.gpuMs.samples > 0) {
+        std::printf("gpu p50 %7.3f p95 %7.3f ms | ", scene.gpuMs.p50, scene.gpuMs.p95);
+    }
+    else {
+        std::printf("gpu n/a | ");
+    }
+    if (scene.samples > 1) {
+        std::printf("msaa committed %.1f MB | ", scene.msaaCommittedMb);
+    }
+    std::printf("%.1f submits, %.1f allocs/frame, %.1f driver allocs/frame, peak %.1f MB\n",
+                scene.submitsPerFrame, scene.allocationsPerFrame, scene.driverAllocationsPerFrame,
+                scene.peakMemoryMb);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+    if (options.list) {
+        for (const auto& name : GetBenchSceneNames()) {
+            std::printf("%s\n", name.c_str());
+        }
+        return EXIT_SUCCESS;
+    }
+    if (options.scenes.empty()) {
+        options.scenes = GetBenchSceneNames();
+    }
+    if (options.sampleCounts.empty()) {
+        options.sampleCounts.push_back(VK_SAMPLE_COUNT_1_BIT);
+    }
+
+    auto assetPath = FindAssetRootPath();
+    if (!assetPath.empty()) {
+        SetAssetRootPath(assetPath);
+    }
+
+    auto& vulkanCtx = VulkanContext::Get();
+    vulkanCtx.GetWindowSystemExtensions = [](auto&) {};
+    vulkanCtx.Initialize("vpg_bench", nullptr);
+
+    const auto& properties = vulkanCtx.GetPhysicalDeviceProperties();
+    BenchReport report;
+    report.device = properties.deviceName;
+    report.driverVersion = FormatDriverVersion(properties);
+    report.width = options.settings.extent.width;
+    report.height = options.settings.extent.height;
+    report.warmupFrames = options.settings.warmupFrames;
+    report.measuredFrames = options.settings.measuredFrames;
+    std::printf("%s, %ux%u, %u warm-up + %u measured frames\n", report.device.c_str(),
+                report.width, report.height, report.warmupFrames, report.measuredFrames);
+
+    const VkSampleCountFlags supportedSamples = vulkanCtx.GetSupportedSampleCounts();
+    for (VkSampleCountFlagBits samples : options.sampleCounts) {
+        if ((supportedSamples & samples) == 0) {
+            std::printf("%ux MSAA is not supported (supported mask 0x%x)\n",
+                        static_cast<uint32_t>(samples), supportedSamples);
+            vulkanCtx.Cleanup();
+            return EXIT_FAILURE;
+        }
+    }
+
+    int exitCode = EXIT_SUCCESS;
+    BenchHarness harness;
+    try {
+        harness.Initialize(options.settings);
+        for (const auto& name : options.scenes) {
+            for (VkSampleCountFlagBits samples : options.sampleCounts) {
+                auto scene = CreateBenchScene(name);
+                if (!scene) {
+                    std::printf("unknown scene %s (--list shows them)\n", name.c_str());
+                    exitCode = EXIT_FAILURE;
+                    break;
+                }
+                std::string resultName = name;
+                if (samples != VK_SAMPLE_COUNT_1_BIT) {
+                    resultName += "@" + std::to_string(static_cast<uint32_t>(samples)) + "x";
+                }
+                report.scenes.push_back(harness.Run(resultName, *scene, samples));
+                PrintScene(report.scenes.back());
+            }
+        }
+        if (!options.memoryDumpPath.empty() &&
+            !vulkanCtx.GetMemoryTracker().DumpJson(options.memoryDumpPath)) {
+            exitCode = EXIT_FAILURE;
+        }
+        if (options.settings.steadyState && harness.GetSteadyStateViolations() > 0) {
+            std::printf("%llu measured frame(s) allocated\n",
+                        static_cast<unsigned long long>(harness.GetSteadyStateViolations()));
+            exitCode = EXIT_FAILURE;
+        }
+    }
+    catch (const std::exception& e) {
+        std::printf("error: %s\n", e.what());
+        exitCode = EXIT_FAILURE;
+    }
+    harness.Cleanup();
+    vulkanCtx.Cleanup();
+
+    if (!options.outputPath.empty()) {
+        if (!WriteBenchReport(options.outputPath, report)) {
+            std::printf("failed to write %s\n", options.outputPath.c_str());
+            exitCode = EXIT_FAILURE;
+        }
+    }
+    else {
+        std::printf("%s", FormatBenchReport(report).c_str());
+    }
+
+    if (!options.baselinePath.empty() && exitCode == EXIT_SUCCESS) {
+        BenchReport baseline;
+        if (!ReadBenchReport(options.baselinePath, baseline)) {
+            std::printf("failed to read baseline %s\n", options.baselinePath.c_str());
+            return EXIT_FAILURE;
+        }
+        std::printf("compared with %s (threshold %.1f%%)\n", options.baselinePath.c_str(),
+                    options.thresholdPercent);
+        const uint32_t regressions =
+            CompareBenchReports(baseline, report, options.thresholdPercent);
+        std::printf("%u regression(s)\n", regressions);
+        exitCode = static_cast<int>(std::min(regressions, 125u));
+    }
+    return exitCode;
+}
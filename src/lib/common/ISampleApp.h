@@ -3,6 +3,8 @@
 class ISampleApp {
 public:
     virtual ~ISampleApp() = default;
+    // Before the window and the Vulkan device exist; for starting I/O early
+    virtual void OnPreInitialize() {}
     virtual void OnInitialize() = 0;
     virtual void OnDrawFrame() = 0;
     virtual void OnCleanup() = 0;
@@ -0,0 +1,206 @@
+#include "asset_archive.h"
+#include "core/lz4.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+AssetArchive g_archive;
+bool g_looseOverride = true;
+
+// Archive key of a path under the asset root, empty for anything outside it
+std::string ToArchiveKey(const std::filesystem::path& path)
+{
+    auto relative =
+        path.lexically_normal().lexically_relative(GetAssetRootPath().lexically_normal());
+    if (relative.empty() || *relative.begin() == "..") {
+        return {};
+    }
+    return relative.generic_string();
+}
+
+bool LoadLoose(const std::filesystem::path& path, MappedFile& file)
+{
+    std::error_code ec;
+    return std::filesystem::is_regular_file(path, ec) && file.Open(path);
+}
+
+} // namespace
+
+bool AssetArchive::Open(const std::filesystem::path& path)
+{
+    Close();
+    if (!m_file.Open(path)) {
+        return false;
+    }
+    const uint8_t* data = m_file.GetData();
+    const uint64_t size = m_file.GetSize();
+    auto fail = [&](const char* message) {
+        std::cerr << "[asset archive] " << path.filename().string() << ": " << message
+                  << std::endl;
+        Close();
+        return false;
+    };
+
+    if (size < sizeof(Header)) {
+        return fail("truncated header");
+    }
+    const auto* header = reinterpret_cast<const Header*>(data);
+    if (header->magic != Magic || header->version != Version) {
+        return fail("not a version 1 archive");
+    }
+    const uint64_t indexBytes = uint64_t(header->entryCount) * sizeof(Entry);
+    if (header->indexOffset % alignof(Entry) != 0 || header->indexOffset > size ||
+        indexBytes > size - header->indexOffset || header->nameTableOffset > size ||
+        header->nameTableSize > size - header->nameTableOffset) {
+        return fail("index out of range");
+    }
+    const auto* entries = reinterpret_cast<const Entry*>(data + header->indexOffset);
+    for (uint32_t i = 0; i < header->entryCount; ++i) {
+        const Entry& entry = entries[i];
+        if (entry.offset > size || entry.storedSize > size - entry.offset ||
+            uint64_t(entry.nameOffset) + entry.nameLength > header->nameTableSize ||
+            (i > 0 && entries[i - 1].hash > entry.hash)) {
+            return fail("corrupt index entry");
+        }
+        if ((entry.flags & EntryCompressed) == 0 && entry.storedSize != entry.size) {
+            return fail("raw entry size mismatch");
+        }
+    }
+
+    m_header = header;
+    m_entries = entries;
+    m_names = reinterpret_cast<const char*>(data + header->nameTableOffset);
+    return true;
+}
+
+void AssetArchive::Close()
+{
+    m_file.Close();
+    m_header = nullptr;
+    m_entries = nullptr;
+    m_names = nullptr;
+}
+
+const AssetArchive::Entry* AssetArchive::Find(std::string_view key) const
+{
+    if (m_header == nullptr) {
+        return nullptr;
+    }
+    const uint64_t hash = HashKey(key);
+    const Entry* end = m_entries + m_header->entryCount;
+    const Entry* entry = std::lower_bound(
+        m_entries, end, hash, [](const Entry& e, uint64_t value) { return e.hash < value; });
+    // Names settle the (unlikely) hash collisions
+    for (; entry != end && entry->hash == hash; ++entry) {
+        if (GetName(*entry) == key) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+std::string_view AssetArchive::GetName(const Entry& entry) const
+{
+    return {m_names + entry.nameOffset, entry.nameLength};
+}
+
+std::span<const uint8_t> AssetArchive::GetView(const Entry& entry) const
+{
+    if ((entry.flags & EntryCompressed) != 0) {
+        return {};
+    }
+    return {m_file.GetData() + entry.offset, static_cast<size_t>(entry.size)};
+}
+
+bool AssetArchive::Read(const Entry& entry, std::vector<uint8_t>& out) const
+{
+    out.resize(static_cast<size_t>(entry.size));
+    const uint8_t* stored = m_file.GetData() + entry.offset;
+    if ((entry.flags & EntryCompressed) == 0) {
+        if (!out.empty()) {
+            std::memcpy(out.data(), stored, out.size());
+        }
+        return true;
+    }
+    if (!lz4::Decompress(stored, static_cast<size_t>(entry.storedSize), out.data(), out.size())) {
+        std::cerr << "[asset archive] " << GetName(entry) << ": corrupt compressed data"
+                  << std::endl;
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+uint64_t AssetArchive::HashKey(std::string_view key)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : key) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool MountAssetArchive(const std::filesystem::path& archivePath)
+{
+    return g_archive.Open(archivePath);
+}
+
+void UnmountAssetArchive()
+{
+    g_archive.Close();
+}
+
+std::filesystem::path GetDefaultAssetArchivePath()
+{
+    auto root = GetAssetRootPath().lexically_normal();
+    if (!root.has_filename()) {
+        root = root.parent_path();
+    }
+    root += ".vpak";
+    return root;
+}
+
+void SetLooseAssetOverride(bool enabled)
+{
+    g_looseOverride = enabled;
+}
+
+bool LoadAsset(const std::filesystem::path& path, AssetData& data)
+{
+    data = AssetData{};
+    if ((g_looseOverride || !g_archive.IsOpen()) && LoadLoose(path, data.m_file)) {
+        data.m_bytes = {data.m_file.GetData(), data.m_file.GetSize()};
+        return true;
+    }
+
+    if (const auto* entry = g_archive.Find(ToArchiveKey(path))) {
+        data.m_bytes = g_archive.GetView(*entry);
+        if ((entry->flags & AssetArchive::EntryCompressed) != 0) {
+            if (!g_archive.Read(*entry, data.m_storage)) {
+                return false;
+            }
+            data.m_bytes = data.m_storage;
+        }
+        return true;
+    }
+
+    if (!g_looseOverride && g_archive.IsOpen() && LoadLoose(path, data.m_file)) {
+        data.m_bytes = {data.m_file.GetData(), data.m_file.GetSize()};
+        return true;
+    }
+    return false;
+}
+
+bool LoadAsset(AssetType type, const std::filesystem::path& fileName, AssetData& data)
+{
+    return LoadAsset(GetAssetPath(type, fileName), data);
+}
+
+bool AssetExists(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    return std::filesystem::is_regular_file(path, ec) ||
+           g_archive.Find(ToArchiveKey(path)) != nullptr;
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include "core/asset_path.h"
+#include "core/mapped_file.h"
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Packed asset archive (.vpak), written by the AssetPacker tool:
+//   Header | blobs, each BlobAlignment-aligned | Entry[entryCount] sorted by hash | names
+// Keys are asset paths relative to the asset root with '/' separators ("shaders/a.vert.spv").
+// Blobs are stored raw or LZ4 block-compressed. The archive is memory-mapped once; raw blobs
+// are handed out as views into the mapping.
+class AssetArchive {
+public:
+    static constexpr uint32_t Magic = 0x4B415056; // "VPAK"
+    static constexpr uint32_t Version = 1;
+    static constexpr uint32_t BlobAlignment = 16;
+
+    enum EntryFlags : uint32_t {
+        EntryCompressed = 1u << 0,
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t nameTableSize;
+        uint64_t indexOffset;
+        uint64_t nameTableOffset;
+    };
+
+    struct Entry {
+        uint64_t hash;
+        uint64_t offset;
+        uint64_t storedSize;
+        uint64_t size;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t flags;
+        uint32_t reserved;
+    };
+
+    AssetArchive() = default;
+    ~AssetArchive() = default;
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    // Maps the file and validates the header and every entry's range
+    bool Open(const std::filesystem::path& path);
+    void Close();
+    bool IsOpen() const { return m_header != nullptr; }
+
+    // Binary search of the hash index; nullptr when absent
+    const Entry* Find(std::string_view key) const;
+    std::string_view GetName(const Entry& entry) const;
+    uint32_t GetEntryCount() const { return m_header != nullptr ? m_header->entryCount : 0; }
+
+    // Bytes of a raw entry inside the mapping; empty for compressed entries
+    std::span<const uint8_t> GetView(const Entry& entry) const;
+    // Decompresses or copies the entry
+    bool Read(const Entry& entry, std::vector<uint8_t>& out) const;
+
+    // FNV-1a, shared with the packer
+    static uint64_t HashKey(std::string_view key);
+
+private:
+    MappedFile m_file;
+    const Header* m_header = nullptr;
+    const Entry* m_entries = nullptr;
+    const char* m_names = nullptr;
+};
+
+// Bytes of one asset: a view into a mapped loose file or the mounted archive, or owned
+// storage for compressed archive entries. Views stay valid while the archive is mounted.
+class AssetData {
+public:
+    const uint8_t* GetData() const { return m_bytes.data(); }
+    size_t GetSize() const { return m_bytes.size(); }
+    std::span<const uint8_t> GetBytes() const { return m_bytes; }
+    // No copy was made to produce the bytes
+    bool IsZeroCopy() const { return m_storage.empty() && !m_bytes.empty(); }
+
+private:
+    friend bool LoadAsset(const std::filesystem::path& path, AssetData& data);
+
+    MappedFile m_file;
+    std::vector<uint8_t> m_storage;
+    std::span<const uint8_t> m_bytes;
+};
+
+// Archive used by LoadAsset for paths under the asset root; replaces any mounted one.
+// Mount before loading starts and unmount after every AssetData view is released.
+bool MountAssetArchive(const std::filesystem::path& archivePath);
+void UnmountAssetArchive();
+
+// "<asset root>.vpak", the packer's default output next to the assets directory
+std::filesystem::path GetDefaultAssetArchivePath();
+
+// When enabled (the default), a loose file on disk wins over its archived copy, so edited
+// assets are picked up without repacking. Disabled, the archive is searched first and loose
+// files only fill in what it lacks.
+void SetLooseAssetOverride(bool enabled);
+
+// path is usually GetAssetPath(...); the archive is consulted for paths under the asset root
+bool LoadAsset(const std::filesystem::path& path, AssetData& data);
+bool LoadAsset(AssetType type, const std::filesystem::path& fileName, AssetData& data);
+bool AssetExists(const std::filesystem::path& path);
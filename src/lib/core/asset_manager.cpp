@@ -0,0 +1,456 @@
+#include "asset_manager.h"
+#include "core/asset_archive.h"
+#include "core/asset_path.h"
+#include "core/command_buffer.h"
+#include "core/shader_compiler.h"
+#include "core/shader_loader.h"
+#include "core/vulkan_context.h"
+#include <iostream>
+
+// A node of the job graph; owned by the queues and by the jobs that wait on it
+struct AssetJob {
+    std::function<AssetJobStatus()> run;
+    AssetJobThread thread = AssetJobThread::Worker;
+    uint32_t pendingDependencies = 0;
+    bool done = false;
+    // Also set before running when a dependency failed
+    bool failed = false;
+    std::vector<std::shared_ptr<AssetJob>> dependents;
+    // Published when this job finishes; only on the last job of an asset
+    std::shared_ptr<AssetSlotBase> slot;
+};
+
+namespace {
+
+bool Fail(const std::filesystem::path& fileName, const char* message)
+{
+    std::cerr << "[asset manager] " << fileName.string() << ": " << message << std::endl;
+    return false;
+}
+
+AssetJobStatus ToStatus(bool succeeded)
+{
+    return succeeded ? AssetJobStatus::Done : AssetJobStatus::Failed;
+}
+
+// Reads a byte of every page so a mapped file is resident before the decode touches it
+void TouchPages(const AssetData& data)
+{
+    constexpr size_t PageSize = 4096;
+    volatile uint8_t sink = 0;
+    for (size_t offset = 0; offset < data.GetSize(); offset += PageSize) {
+        sink = sink + data.GetData()[offset];
+    }
+}
+
+// State of one model load shared by its jobs. If dropped before delivery (failure or
+// Cleanup) it waits for a copy in flight and gives the arena ranges back.
+struct ModelUpload {
+    // Mapped by the read job, decoded and released by the decode job
+    GltfFiles files;
+    GltfModel model;
+    GeometryArena* arena = nullptr;
+    // Claimed by the decode job; cleared once the asset is delivered
+    GeometryAllocation geometry;
+    std::shared_ptr<CommandBuffer> commandBuffer;
+    VkFence fence = VK_NULL_HANDLE;
+
+    ~ModelUpload()
+    {
+        DestroyFence(true);
+        if (arena != nullptr) {
+            arena->FreeUnused(geometry);
+        }
+    }
+
+    void DestroyFence(bool wait)
+    {
+        if (fence == VK_NULL_HANDLE) {
+            return;
+        }
+        auto& vulkanCtx = VulkanContext::Get();
+        VkDevice device = vulkanCtx.GetVkDevice();
+        if (wait) {
+            vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+        }
+        vkDestroyFence(device, fence, vulkanCtx.GetAllocationCallbacks());
+        fence = VK_NULL_HANDLE;
+    }
+};
+
+} // namespace
+
+bool AssetManager::Initialize(JobSystem& jobSystem, const Settings& settings)
+{
+    m_settings = settings;
+    m_jobSystem = &jobSystem;
+    m_stop = false;
+    if (!settings.deviceReady) {
+        m_deviceGate = std::make_shared<AssetJob>();
+    }
+    return true;
+}
+
+void AssetManager::Cleanup()
+{
+    if (!m_jobSystem) {
+        return;
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    // Queued jobs see m_stop and return at once
+    m_jobSystem->Wait(m_runningJobs);
+    m_jobSystem = nullptr;
+    // Jobs still waiting hold the rest of the graph; dropping them frees it
+    m_deviceGate.reset();
+    m_renderQueue.clear();
+    m_finished.clear();
+    m_pendingAssets = 0;
+
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    for (auto pipeline : m_pipelines) {
+        vkDestroyPipeline(device, pipeline, allocator);
+    }
+    for (auto module : m_shaderModules) {
+        vkDestroyShaderModule(device, module, allocator);
+    }
+    m_pipelines.clear();
+    m_shaderModules.clear();
+}
+
+AssetHandle<ShaderAsset> AssetManager::LoadShader(const std::filesystem::path& fileName)
+{
+    AssetHandle<ShaderAsset> handle;
+    handle.m_slot = CreateSlot<ShaderAsset>();
+    auto spirv = std::make_shared<AssetData>();
+
+    // File: compile if the source is newer, map the SPIR-V and reflect it; needs no device
+    auto fileJob = AddJob(
+        [fileName, spirv, slot = handle.m_slot] {
+            auto path = GetAssetPath(AssetType::Shader, fileName);
+            if (path.extension() != ".spv") {
+                if (!loader::UpdateSpirvFile(path)) {
+                    return ToStatus(Fail(fileName, "compile failed"));
+                }
+                path += ".spv";
+            }
+            if (!LoadAsset(path, *spirv)) {
+                return ToStatus(Fail(fileName, "cannot open SPIR-V"));
+            }
+            const auto* code = reinterpret_cast<const uint32_t*>(spirv->GetData());
+            return ToStatus(loader::ReflectSpirv(code, spirv->GetSize() / sizeof(uint32_t),
+                                                 slot->value.reflection) ||
+                            Fail(fileName, "invalid SPIR-V"));
+        },
+        AssetJobThread::Io);
+
+    // Module
+    AddJob(
+        [this, fileName, spirv, slot = handle.m_slot] {
+            const auto* code = reinterpret_cast<const uint32_t*>(spirv->GetData());
+            slot->value.module = loader::CreateShaderModule(code, spirv->GetSize());
+            *spirv = AssetData{};
+            if (slot->value.module == VK_NULL_HANDLE) {
+                return ToStatus(Fail(fileName, "vkCreateShaderModule failed"));
+            }
+            std::lock_guard lock(m_mutex);
+            m_shaderModules.push_back(slot->value.module);
+            return AssetJobStatus::Done;
+        },
+        AssetJobThread::Worker, {fileJob}, handle.m_slot);
+    return handle;
+}
+
+AssetHandle<PipelineAsset> AssetManager::LoadPipeline(
+    const std::vector<AssetHandle<ShaderAsset>>& shaders, PipelineBuilder build)
+{
+    AssetHandle<PipelineAsset> handle;
+    handle.m_slot = CreateSlot<PipelineAsset>();
+
+    JobList dependencies;
+    std::vector<std::shared_ptr<AssetSlot<ShaderAsset>>> shaderSlots;
+    bool shaderFailed = false;
+    for (const auto& shader : shaders) {
+        shaderFailed |= shader.GetState() == AssetState::Failed;
+        if (auto job = shader.IsValid() ? shader.m_slot->job.lock() : nullptr) {
+            dependencies.push_back(std::move(job));
+        }
+        shaderSlots.push_back(shader.m_slot);
+    }
+
+    // Pipeline: vkCreateGraphicsPipelines is the expensive part and is free-threaded
+    AddJob(
+        [this, shaderFailed, shaderSlots = std::move(shaderSlots), build = std::move(build),
+         slot = handle.m_slot] {
+            if (shaderFailed) {
+                return AssetJobStatus::Failed;
+            }
+            std::vector<const ShaderAsset*> modules;
+            for (const auto& shaderSlot : shaderSlots) {
+                modules.push_back(&shaderSlot->value);
+            }
+            if (!build(modules, slot->value) || slot->value.pipeline == VK_NULL_HANDLE) {
+                std::cerr << "[asset manager] pipeline build failed" << std::endl;
+                return AssetJobStatus::Failed;
+            }
+            std::lock_guard lock(m_mutex);
+            m_pipelines.push_back(slot->value.pipeline);
+            return AssetJobStatus::Done;
+        },
+        AssetJobThread::Worker, dependencies, handle.m_slot);
+    return handle;
+}
+
+AssetHandle<ModelAsset> AssetManager::LoadModel(const std::filesystem::path& fileName,
+                                                const GltfVertexLayout& layout,
+                                                GeometryArena& arena, ModelProcessor process)
+{
+    AssetHandle<ModelAsset> handle;
+    handle.m_slot = CreateSlot<ModelAsset>();
+    auto upload = std::make_shared<ModelUpload>();
+
+    // Read: map the file and its external buffers and pull them into the page cache, which
+    // needs no device. The mappings go to the decode job.
+    auto readJob = AddJob(
+        [fileName, upload] {
+            auto& files = upload->files;
+            if (!loader::ReadGltfFiles(GetAssetPath(AssetType::Model, fileName), files)) {
+                return AssetJobStatus::Failed;
+            }
+            TouchPages(files.file);
+            for (const auto& buffer : files.buffers) {
+                TouchPages(buffer);
+            }
+            return AssetJobStatus::Done;
+        },
+        AssetJobThread::Io);
+
+    // Decode into staging, then claim the arena range (worker)
+    auto decodeJob = AddJob(
+        [fileName, layout, &arena, process = std::move(process), upload, slot = handle.m_slot,
+         jobSystem = m_jobSystem] {
+            auto& model = upload->model;
+            // Nested ParallelFor: the primitives are decoded by this JobSystem's workers
+            const bool decoded = loader::LoadGltf(GetAssetPath(AssetType::Model, fileName),
+                                                  upload->files, layout, model, jobSystem);
+            upload->files = GltfFiles{};
+            if (!decoded) {
+                return AssetJobStatus::Failed;
+            }
+            if (process && !process(model)) {
+                return ToStatus(Fail(fileName, "processing failed"));
+            }
+            slot->value.meshes = model.meshes;
+            slot->value.geometry = arena.Allocate(model.vertexCount, model.indexCount);
+            upload->arena = &arena;
+            upload->geometry = slot->value.geometry;
+            return ToStatus(slot->value.geometry.IsValid() ||
+                            Fail(fileName, "geometry arena is full"));
+        },
+        AssetJobThread::Worker, {readJob});
+
+    // Upload: record and submit on the render thread, then poll the fence each Update
+    AddJob(
+        [fileName, &arena, upload, slot = handle.m_slot] {
+            auto& vulkanCtx = VulkanContext::Get();
+            // The ranges go back to the arena with the upload state
+            auto fail = [&](const char* message) {
+                slot->value.geometry = GeometryAllocation{};
+                return ToStatus(Fail(fileName, message));
+            };
+            if (upload->fence == VK_NULL_HANDLE) {
+                upload->commandBuffer = vulkanCtx.CreateCommandBuffer();
+                upload->commandBuffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+                arena.RecordUpload(*upload->commandBuffer, *upload->model.staging, 0,
+                                   upload->model.indexOffset, slot->value.geometry);
+                upload->commandBuffer->End();
+
+                VkFenceCreateInfo fenceCI{
+                    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+                };
+                if (vkCreateFence(vulkanCtx.GetVkDevice(), &fenceCI,
+                                  vulkanCtx.GetAllocationCallbacks(),
+                                  &upload->fence) != VK_SUCCESS) {
+                    upload->fence = VK_NULL_HANDLE;
+                    return fail("vkCreateFence failed");
+                }
+                VkCommandBuffer vkCommandBuffer = upload->commandBuffer->Get();
+                VkSubmitInfo submitInfo{
+                    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                    .commandBufferCount = 1,
+                    .pCommandBuffers = &vkCommandBuffer,
+                };
+                if (vkQueueSubmit(vulkanCtx.GetGraphicsQueue(), 1, &submitInfo, upload->fence) !=
+                    VK_SUCCESS) {
+                    // Nothing was submitted, so the fence will never signal
+                    upload->DestroyFence(false);
+                    return fail("vkQueueSubmit failed");
+                }
+                return AssetJobStatus::Retry;
+            }
+            const VkResult status = vkGetFenceStatus(vulkanCtx.GetVkDevice(), upload->fence);
+            if (status == VK_NOT_READY) {
+                return AssetJobStatus::Retry;
+            }
+            upload->DestroyFence(false);
+            upload->commandBuffer.reset();
+            upload->model.staging.reset();
+            if (status != VK_SUCCESS) {
+                return fail("upload failed (device lost)");
+            }
+            // Delivered: the ranges now belong to the asset
+            upload->geometry = GeometryAllocation{};
+            return AssetJobStatus::Done;
+        },
+        AssetJobThread::Render, {decodeJob}, handle.m_slot);
+    return handle;
+}
+
+void AssetManager::OnDeviceReady()
+{
+    std::lock_guard lock(m_mutex);
+    if (auto gate = std::move(m_deviceGate)) {
+        Complete(gate, false);
+    }
+}
+
+void AssetManager::Update()
+{
+    // Render-thread jobs queued so far; those they make ready wait for the next Update
+    std::deque<std::shared_ptr<AssetJob>> jobs;
+    {
+        std::lock_guard lock(m_mutex);
+        jobs.swap(m_renderQueue);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    JobList retry;
+    bool ranAny = false;
+    while (!jobs.empty()) {
+        const double elapsedMs = std::chrono::duration<double, std::milli>(
+                                     std::chrono::steady_clock::now() - start)
+                                     .count();
+        if (ranAny && elapsedMs >= m_settings.renderThreadBudgetMs) {
+            break;
+        }
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+        const AssetJobStatus status = job->run();
+        ranAny = true;
+        if (status == AssetJobStatus::Retry) {
+            retry.push_back(std::move(job));
+            continue;
+        }
+        job->run = nullptr;
+        std::lock_guard lock(m_mutex);
+        Complete(job, status == AssetJobStatus::Failed);
+    }
+
+    JobList finished;
+    {
+        std::lock_guard lock(m_mutex);
+        // Over budget: the rest go first next time, ahead of retries and new arrivals
+        m_renderQueue.insert(m_renderQueue.begin(), jobs.begin(), jobs.end());
+        m_renderQueue.insert(m_renderQueue.end(), retry.begin(), retry.end());
+        finished.swap(m_finished);
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    for (auto& job : finished) {
+        auto& slot = *job->slot;
+        slot.state = job->failed ? AssetState::Failed : AssetState::Ready;
+        slot.loadMs = std::chrono::duration<double, std::milli>(now - slot.requestTime).count();
+        job->slot.reset();
+        --m_pendingAssets;
+    }
+}
+
+std::shared_ptr<AssetJob> AssetManager::AddJob(std::function<AssetJobStatus()> run,
+                                               AssetJobThread thread, const JobList& dependencies,
+                                               std::shared_ptr<AssetSlotBase> slot)
+{
+    auto job = std::make_shared<AssetJob>();
+    job->run = std::move(run);
+    job->thread = thread;
+    if (slot) {
+        slot->job = job;
+        job->slot = std::move(slot);
+        ++m_pendingAssets;
+    }
+
+    std::lock_guard lock(m_mutex);
+    if (m_deviceGate && thread != AssetJobThread::Io) {
+        m_deviceGate->dependents.push_back(job);
+        ++job->pendingDependencies;
+    }
+    for (const auto& dependency : dependencies) {
+        if (!dependency->done) {
+            dependency->dependents.push_back(job);
+            ++job->pendingDependencies;
+        }
+        else if (dependency->failed) {
+            job->failed = true;
+        }
+    }
+    if (job->pendingDependencies == 0) {
+        Schedule(job);
+    }
+    return job;
+}
+
+void AssetManager::Schedule(const std::shared_ptr<AssetJob>& job)
+{
+    if (job->failed) {
+        job->run = nullptr;
+        Complete(job, true);
+    }
+    else if (job->thread == AssetJobThread::Render) {
+        m_renderQueue.push_back(job);
+    }
+    else if (!m_stop) {
+        m_jobSystem->Submit([this, job] { RunJob(job); }, &m_runningJobs,
+                            job->thread == AssetJobThread::Io ? JobSystem::Affinity::Io
+                                                              : JobSystem::Affinity::Any);
+    }
+}
+
+void AssetManager::Complete(const std::shared_ptr<AssetJob>& job, bool failed)
+{
+    job->done = true;
+    job->failed = failed;
+    if (job->slot) {
+        m_finished.push_back(job);
+    }
+    auto dependents = std::move(job->dependents);
+    for (auto& dependent : dependents) {
+        dependent->failed |= failed;
+        if (--dependent->pendingDependencies == 0) {
+            Schedule(dependent);
+        }
+    }
+}
+
+void AssetManager::RunJob(const std::shared_ptr<AssetJob>& job)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_stop) {
+            return;
+        }
+    }
+    const AssetJobStatus status = job->run();
+    if (status != AssetJobStatus::Retry) {
+        // Captures are released outside the lock
+        job->run = nullptr;
+    }
+    std::lock_guard lock(m_mutex);
+    if (status == AssetJobStatus::Retry) {
+        Schedule(job);
+    }
+    else {
+        Complete(job, status == AssetJobStatus::Failed);
+    }
+}
@@ -0,0 +1,219 @@
+#pragma once
+#include "core/geometry_arena.h"
+#include "core/gltf_loader.h"
+#include "core/job_system.h"
+#include "core/shader_reflection.h"
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+enum class AssetState {
+    Pending,
+    Ready,
+    Failed,
+};
+
+// Result of one run of a job. Retry runs it again later: a render-thread job next Update
+// (e.g. polling an upload fence), a worker job after the queued ones.
+enum class AssetJobStatus {
+    Done,
+    Failed,
+    Retry,
+};
+
+// Where a job runs: blocking file access on the JobSystem's I/O threads, CPU work on its
+// workers, command recording and submission on the render thread in Update
+enum class AssetJobThread {
+    Io,
+    Worker,
+    Render,
+};
+
+struct AssetJob;
+
+struct AssetSlotBase {
+    // Written by AssetManager::Update only
+    AssetState state = AssetState::Pending;
+    // Last job of the asset's chain, for assets that depend on this one
+    std::weak_ptr<AssetJob> job;
+    std::chrono::steady_clock::time_point requestTime;
+    double loadMs = 0.0;
+};
+
+template <typename T>
+struct AssetSlot : AssetSlotBase {
+    T value{};
+};
+
+// Returned immediately by AssetManager; becomes Ready or Failed in a later
+// AssetManager::Update. Copies share the asset. Render thread only.
+template <typename T>
+class AssetHandle {
+public:
+    AssetHandle() = default;
+
+    bool IsValid() const { return m_slot != nullptr; }
+    AssetState GetState() const { return m_slot ? m_slot->state : AssetState::Failed; }
+    bool IsReady() const { return GetState() == AssetState::Ready; }
+    // Request to delivery, once no longer pending
+    double GetLoadMs() const { return m_slot ? m_slot->loadMs : 0.0; }
+
+    // Only while ready
+    const T& Get() const { return m_slot->value; }
+
+private:
+    friend class AssetManager;
+    std::shared_ptr<AssetSlot<T>> m_slot;
+};
+
+struct ShaderAsset {
+    VkShaderModule module = VK_NULL_HANDLE;
+    ShaderReflection reflection;
+};
+
+struct PipelineAsset {
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    // From the PipelineLayoutCache; not owned
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+};
+
+struct ModelAsset {
+    std::vector<GltfMesh> meshes;
+    // Range in the arena passed to LoadModel, uploaded and visible to vertex input; empty and
+    // returned to the arena if the load failed
+    GeometryAllocation geometry;
+};
+
+// Asynchronous asset loading as a graph of jobs. Every Load call returns a handle at once and
+// queues its steps: file I/O and CPU decode run on a JobSystem, command recording and queue
+// submission on the render thread in Update, and a step starts only when the steps it depends
+// on have finished. A chain such as
+//   shader file -> shader module -> pipeline       (LoadShader, LoadPipeline)
+//   glTF read + decode -> GPU upload -> fence      (LoadModel)
+// therefore overlaps I/O of one asset with decode of another and with transfers in flight.
+// Results are published in Update, so a handle only changes state between frames.
+//
+// Load functions and Update are called from the render thread. Shader modules and pipelines
+// are owned by the manager and destroyed in Cleanup.
+class AssetManager {
+public:
+    struct Settings {
+        // Render-thread job time per Update; at least one job always runs
+        double renderThreadBudgetMs = 2.0;
+        // false to start loading before VulkanContext::Initialize: I/O jobs run at once, jobs
+        // that touch the device wait for OnDeviceReady
+        bool deviceReady = true;
+    };
+
+    AssetManager() = default;
+    ~AssetManager() { Cleanup(); }
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    // jobSystem must outlive the manager
+    bool Initialize(JobSystem& jobSystem, const Settings& settings);
+    // Call after vkDeviceWaitIdle; waits for running jobs and drops unfinished loads
+    void Cleanup();
+
+    // GLSL sources are compiled to "<file>.spv" when stale; fileName may also name a .spv
+    AssetHandle<ShaderAsset> LoadShader(const std::filesystem::path& fileName);
+
+    // build runs on a worker once every shader is ready, with the shaders in the given order.
+    // It fills pipeline.pipeline and pipeline.layout.
+    using PipelineBuilder = std::function<bool(std::span<const ShaderAsset* const> shaders,
+                                               PipelineAsset& pipeline)>;
+    AssetHandle<PipelineAsset> LoadPipeline(const std::vector<AssetHandle<ShaderAsset>>& shaders,
+                                            PipelineBuilder build);
+
+    // process (optional) runs on the worker after decode, e.g. mesh::ProcessModel. The arena
+    // must outlive the load and use the (processed) layout's stride.
+    using ModelProcessor = std::function<bool(GltfModel& model)>;
+    AssetHandle<ModelAsset> LoadModel(const std::filesystem::path& fileName,
+                                      const GltfVertexLayout& layout, GeometryArena& arena,
+                                      ModelProcessor process = {});
+
+    // Generic two-step asset: work on a worker, then finish on the render thread (optional,
+    // may return Retry until e.g. a fence signals)
+    template <typename T>
+    AssetHandle<T> LoadCustom(std::function<bool(T&)> work,
+                              std::function<AssetJobStatus(T&)> finish = {});
+
+    // Releases the jobs held back by Settings::deviceReady = false, once the device and
+    // everything the loads use (e.g. the geometry arena) exist
+    void OnDeviceReady();
+
+    // Once per frame on the render thread: runs render-thread jobs within the budget and
+    // publishes finished assets
+    void Update();
+
+    uint32_t GetPendingCount() const { return m_pendingAssets; }
+
+private:
+    using JobList = std::vector<std::shared_ptr<AssetJob>>;
+
+    // Queues a job that runs once every job in dependencies is done; a failed dependency
+    // fails it without running. slot is given for the last job of an asset and is published
+    // when that job finishes.
+    std::shared_ptr<AssetJob> AddJob(std::function<AssetJobStatus()> run, AssetJobThread thread,
+                                     const JobList& dependencies = {},
+                                     std::shared_ptr<AssetSlotBase> slot = nullptr);
+    template <typename T>
+    std::shared_ptr<AssetSlot<T>> CreateSlot();
+
+    // m_mutex held
+    void Schedule(const std::shared_ptr<AssetJob>& job);
+    void Complete(const std::shared_ptr<AssetJob>& job, bool failed);
+
+    void RunJob(const std::shared_ptr<AssetJob>& job);
+
+    Settings m_settings;
+    JobSystem* m_jobSystem = nullptr;
+    // Io and Worker jobs submitted to the JobSystem and not yet finished
+    JobCounter m_runningJobs;
+    std::mutex m_mutex;
+    std::deque<std::shared_ptr<AssetJob>> m_renderQueue;
+    JobList m_finished;
+    // Not run; Worker and Render jobs depend on it until OnDeviceReady
+    std::shared_ptr<AssetJob> m_deviceGate;
+    bool m_stop = false;
+    uint32_t m_pendingAssets = 0;
+
+    // Created by jobs, destroyed in Cleanup
+    std::vector<VkShaderModule> m_shaderModules;
+    std::vector<VkPipeline> m_pipelines;
+};
+
+template <typename T>
+std::shared_ptr<AssetSlot<T>> AssetManager::CreateSlot()
+{
+    auto slot = std::make_shared<AssetSlot<T>>();
+    slot->requestTime = std::chrono::steady_clock::now();
+    return slot;
+}
+
+template <typename T>
+AssetHandle<T> AssetManager::LoadCustom(std::function<bool(T&)> work,
+                                        std::function<AssetJobStatus(T&)> finish)
+{
+    AssetHandle<T> handle;
+    handle.m_slot = CreateSlot<T>();
+    auto slot = handle.m_slot;
+    auto workJob = AddJob(
+        [slot, work = std::move(work)] {
+            return work(slot->value) ? AssetJobStatus::Done : AssetJobStatus::Failed;
+        },
+        AssetJobThread::Worker, {}, finish ? nullptr : slot);
+    if (finish) {
+        AddJob([slot, finish = std::move(finish)] { return finish(slot->value); },
+               AssetJobThread::Render, {workJob}, slot);
+    }
+    return handle;
+}
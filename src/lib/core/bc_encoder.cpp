@@ -0,0 +1,291 @@
+#include "bc_encoder.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#   define BC_ENCODER_SSE2 1
+#   include <emmintrin.h>
+#endif
+
+// Bounding-box encoders in the style of "Real-Time DXT Compression" (van Waveren): endpoints
+// come from the (inset) per-channel min/max and indices from a projection onto the box
+// diagonal. The min/max scan and the projection are the hot loops and have SSE2 paths.
+
+namespace {
+
+struct MinMax {
+    uint8_t min[4];
+    uint8_t max[4];
+};
+
+MinMax GetMinMax(const uint8_t* rgba)
+{
+    MinMax result{};
+#if BC_ENCODER_SSE2
+    __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba));
+    __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 16));
+    __m128i p2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 32));
+    __m128i p3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 48));
+    __m128i mn = _mm_min_epu8(_mm_min_epu8(p0, p1), _mm_min_epu8(p2, p3));
+    __m128i mx = _mm_max_epu8(_mm_max_epu8(p0, p1), _mm_max_epu8(p2, p3));
+    // Fold the four pixels in each register down to one
+    mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 8));
+    mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 4));
+    mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 8));
+    mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 4));
+    uint32_t mnBits = static_cast<uint32_t>(_mm_cvtsi128_si32(mn));
+    uint32_t mxBits = static_cast<uint32_t>(_mm_cvtsi128_si32(mx));
+    std::memcpy(result.min, &mnBits, 4);
+    std::memcpy(result.max, &mxBits, 4);
+#else
+    for (int c = 0; c < 4; ++c) {
+        result.min[c] = 255;
+        result.max[c] = 0;
+    }
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            result.min[c] = std::min(result.min[c], rgba[i * 4 + c]);
+            result.max[c] = std::max(result.max[c], rgba[i * 4 + c]);
+        }
+    }
+#endif
+    return result;
+}
+
+// Projects each pixel onto e0->e1 (first 'channels' channels) and returns t in [0, 1]
+void Project(const uint8_t* rgba, const int* e0, const int* e1, int channels, float* t)
+{
+    float axis[4] = {0, 0, 0, 0};
+    float lengthSq = 0.0f;
+    for (int c = 0; c < channels; ++c) {
+        axis[c] = static_cast<float>(e1[c] - e0[c]);
+        lengthSq += axis[c] * axis[c];
+    }
+    if (lengthSq <= 0.0f) {
+        std::fill(t, t + 16, 0.0f);
+        return;
+    }
+    const float invLengthSq = 1.0f / lengthSq;
+    const float base = axis[0] * e0[0] + axis[1] * e0[1] + axis[2] * e0[2] + axis[3] * e0[3];
+
+#if BC_ENCODER_SSE2
+    const __m128 ax = _mm_set1_ps(axis[0]), ay = _mm_set1_ps(axis[1]);
+    const __m128 az = _mm_set1_ps(axis[2]), aw = _mm_set1_ps(axis[3]);
+    const __m128 vBase = _mm_set1_ps(base), vInv = _mm_set1_ps(invLengthSq);
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    const __m128i mask = _mm_set1_epi32(0xff);
+    for (int i = 0; i < 16; i += 4) {
+        // Four pixels -> four SoA channel vectors
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + i * 4));
+        __m128 r = _mm_cvtepi32_ps(_mm_and_si128(px, mask));
+        __m128 g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 8), mask));
+        __m128 b = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 16), mask));
+        __m128 a = _mm_cvtepi32_ps(_mm_srli_epi32(px, 24));
+        __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, ax), _mm_mul_ps(g, ay)),
+                                _mm_add_ps(_mm_mul_ps(b, az), _mm_mul_ps(a, aw)));
+        __m128 v = _mm_mul_ps(_mm_sub_ps(dot, vBase), vInv);
+        _mm_storeu_ps(t + i, _mm_min_ps(_mm_max_ps(v, zero), one));
+    }
+#else
+    for (int i = 0; i < 16; ++i) {
+        float dot = 0.0f;
+        for (int c = 0; c < 4; ++c) {
+            dot += axis[c] * rgba[i * 4 + c];
+        }
+        t[i] = std::clamp((dot - base) * invLengthSq, 0.0f, 1.0f);
+    }
+#endif
+}
+
+uint16_t ToRgb565(const int* c)
+{
+    return static_cast<uint16_t>(((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3));
+}
+
+void FromRgb565(uint16_t v, int* c)
+{
+    c[0] = ((v >> 11) & 31) * 255 / 31;
+    c[1] = ((v >> 5) & 63) * 255 / 63;
+    c[2] = (v & 31) * 255 / 31;
+    c[3] = 0;
+}
+
+void EncodeColorBlock(const uint8_t* rgba, uint8_t* block)
+{
+    MinMax mm = GetMinMax(rgba);
+
+    // Inset the box by 1/16 to reduce the error at the extremes
+    int e0[4], e1[4];
+    for (int c = 0; c < 3; ++c) {
+        int inset = (mm.max[c] - mm.min[c]) >> 4;
+        e0[c] = mm.max[c] - inset;
+        e1[c] = mm.min[c] + inset;
+    }
+    e0[3] = e1[3] = 0;
+
+    uint16_t c0 = ToRgb565(e0);
+    uint16_t c1 = ToRgb565(e1);
+    if (c0 < c1) {
+        std::swap(c0, c1);
+    }
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        // Four-colour mode (c0 > c1): palette order e0, e1, 2/3 e0 + 1/3 e1, 1/3 e0 + 2/3 e1
+        int q0[4], q1[4];
+        FromRgb565(c0, q0);
+        FromRgb565(c1, q1);
+        float t[16];
+        Project(rgba, q0, q1, 3, t);
+        static constexpr uint32_t Remap[4] = {0, 2, 3, 1};
+        for (int i = 0; i < 16; ++i) {
+            uint32_t step = static_cast<uint32_t>(t[i] * 3.0f + 0.5f);
+            indices |= Remap[step] << (i * 2);
+        }
+    }
+    block[0] = static_cast<uint8_t>(c0 & 0xff);
+    block[1] = static_cast<uint8_t>(c0 >> 8);
+    block[2] = static_cast<uint8_t>(c1 & 0xff);
+    block[3] = static_cast<uint8_t>(c1 >> 8);
+    std::memcpy(block + 4, &indices, 4);
+}
+
+void EncodeSingleChannel(const uint8_t* rgba, uint32_t channel, uint8_t* block)
+{
+    int mn = 255, mx = 0;
+    for (int i = 0; i < 16; ++i) {
+        mn = std::min<int>(mn, rgba[i * 4 + channel]);
+        mx = std::max<int>(mx, rgba[i * 4 + channel]);
+    }
+
+    uint64_t bits = 0;
+    if (mx > mn) {
+        // Eight-value mode (a0 > a1): palette order a0, a1, then 6 interpolants from a0 to a1
+        static constexpr uint64_t Remap[8] = {1, 7, 6, 5, 4, 3, 2, 0};
+        const float scale = 7.0f / static_cast<float>(mx - mn);
+        for (int i = 0; i < 16; ++i) {
+            int step = static_cast<int>((rgba[i * 4 + channel] - mn) * scale + 0.5f);
+            bits |= Remap[step] << (i * 3);
+        }
+    }
+    block[0] = static_cast<uint8_t>(mx);
+    block[1] = static_cast<uint8_t>(mn);
+    for (int i = 0; i < 6; ++i) {
+        block[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+    }
+}
+
+// Little-endian bit writer for BC7
+struct BitWriter {
+    uint8_t* data;
+    uint32_t position = 0;
+
+    void Write(uint32_t value, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i, ++position) {
+            if ((value >> i) & 1) {
+                data[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+            }
+        }
+    }
+};
+
+} // namespace
+
+namespace bc {
+
+void EncodeBC1(const uint8_t* rgba, uint8_t* block)
+{
+    EncodeColorBlock(rgba, block);
+}
+
+void EncodeBC3(const uint8_t* rgba, uint8_t* block)
+{
+    EncodeSingleChannel(rgba, 3, block);
+    EncodeColorBlock(rgba, block + 8);
+}
+
+void EncodeBC4(const uint8_t* rgba, uint8_t* block, uint32_t channel)
+{
+    EncodeSingleChannel(rgba, channel, block);
+}
+
+void EncodeBC5(const uint8_t* rgba, uint8_t* block)
+{
+    EncodeSingleChannel(rgba, 0, block);
+    EncodeSingleChannel(rgba, 1, block + 8);
+}
+
+void EncodeBC7(const uint8_t* rgba, uint8_t* block)
+{
+    static constexpr int Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    MinMax mm = GetMinMax(rgba);
+
+    // 7-bit endpoints plus one shared p-bit each; pick the p-bit closest to the 8-bit target
+    int e[2][4];
+    uint32_t quantized[2][4];
+    uint32_t pbit[2];
+    const uint8_t* targets[2] = {mm.min, mm.max};
+    for (int n = 0; n < 2; ++n) {
+        int bestError = INT32_MAX;
+        for (uint32_t p = 0; p < 2; ++p) {
+            int error = 0;
+            uint32_t q[4];
+            for (int c = 0; c < 4; ++c) {
+                int v = (static_cast<int>(targets[n][c]) - static_cast<int>(p) + 1) / 2;
+                q[c] = static_cast<uint32_t>(std::clamp(v, 0, 127));
+                int diff = static_cast<int>((q[c] << 1) | p) - targets[n][c];
+                error += diff * diff;
+            }
+            if (error < bestError) {
+                bestError = error;
+                pbit[n] = p;
+                std::memcpy(quantized[n], q, sizeof(q));
+            }
+        }
+        for (int c = 0; c < 4; ++c) {
+            e[n][c] = static_cast<int>((quantized[n][c] << 1) | pbit[n]);
+        }
+    }
+
+    float t[16];
+    Project(rgba, e[0], e[1], 4, t);
+    uint32_t indices[16];
+    for (int i = 0; i < 16; ++i) {
+        int target = static_cast<int>(t[i] * 64.0f + 0.5f);
+        uint32_t best = 0;
+        for (uint32_t w = 1; w < 16; ++w) {
+            if (std::abs(Weights[w] - target) < std::abs(Weights[best] - target)) {
+                best = w;
+            }
+        }
+        indices[i] = best;
+    }
+
+    // The anchor index (pixel 0) is stored with 3 bits, so its MSB must be 0
+    if (indices[0] & 8) {
+        std::swap(quantized[0], quantized[1]);
+        std::swap(pbit[0], pbit[1]);
+        for (auto& index : indices) {
+            index = 15 - index;
+        }
+    }
+
+    std::memset(block, 0, 16);
+    BitWriter writer{block};
+    writer.Write(1u << 6, 7); // mode 6
+    for (int c = 0; c < 4; ++c) {
+        writer.Write(quantized[0][c], 7);
+        writer.Write(quantized[1][c], 7);
+    }
+    writer.Write(pbit[0], 1);
+    writer.Write(pbit[1], 1);
+    writer.Write(indices[0], 3);
+    for (int i = 1; i < 16; ++i) {
+        writer.Write(indices[i], 4);
+    }
+}
+
+} // namespace bc
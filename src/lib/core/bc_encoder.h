@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+
+// Real-time block-compression encoders. Each call encodes one 4x4 block.
+// Input is 16 RGBA8 pixels in row-major order (64 bytes).
+namespace bc {
+
+    // 8 bytes; colour only (alpha ignored)
+    void EncodeBC1(const uint8_t* rgba, uint8_t* block);
+    // 16 bytes; BC4 alpha + BC1 colour
+    void EncodeBC3(const uint8_t* rgba, uint8_t* block);
+    // 8 bytes; channel selects which of R/G/B/A is encoded
+    void EncodeBC4(const uint8_t* rgba, uint8_t* block, uint32_t channel = 0);
+    // 16 bytes; R and G as two BC4 blocks (normal maps)
+    void EncodeBC5(const uint8_t* rgba, uint8_t* block);
+    // 16 bytes; mode 6 (single subset RGBA, 4-bit indices)
+    void EncodeBC7(const uint8_t* rgba, uint8_t* block);
+
+} // namespace bc
@@ -0,0 +1,265 @@
+#include "bindless_resource_table.h"
+#include "core/pipeline_layout_cache.h"
+#include "core/vulkan_context.h"
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// Per-stage resources left to the other sets of a pipeline and to its colour attachments
+constexpr uint32_t ReservedPerStageResources = 64;
+
+} // namespace
+
+uint32_t BindlessResourceTable::IndexAllocator::Allocate()
+{
+    if (!freeList.empty()) {
+        uint32_t index = freeList.back();
+        freeList.pop_back();
+        return index;
+    }
+    if (next < capacity) {
+        return next++;
+    }
+    return InvalidIndex;
+}
+
+void BindlessResourceTable::Initialize()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+
+    // Clamp the requested array sizes to what the device allows for update-after-bind
+    VkPhysicalDeviceDescriptorIndexingProperties indexingProps{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES,
+    };
+    VkPhysicalDeviceProperties2 props{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &indexingProps,
+    };
+    vkGetPhysicalDeviceProperties2(vulkanCtx.GetVkPhysicalDevice(), &props);
+
+    const auto& limits = indexingProps;
+    uint32_t sampledImageCount =
+        std::min({DefaultSampledImageCount,
+                  limits.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                  limits.maxDescriptorSetUpdateAfterBindSampledImages});
+    uint32_t storageBufferCount =
+        std::min({DefaultStorageBufferCount,
+                  limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+                  limits.maxDescriptorSetUpdateAfterBindStorageBuffers});
+    const uint32_t samplerCount =
+        std::min({DefaultSamplerCount, limits.maxPerStageDescriptorUpdateAfterBindSamplers,
+                  limits.maxDescriptorSetUpdateAfterBindSamplers});
+
+    // Every binding is visible to all stages, so images and buffers together also count
+    // against the per-stage resource total (samplers do not); split it in proportion
+    const uint32_t resourceLimit = limits.maxPerStageUpdateAfterBindResources;
+    const uint64_t resourceBudget =
+        resourceLimit > ReservedPerStageResources ? resourceLimit - ReservedPerStageResources : 0;
+    const uint64_t requested = uint64_t(sampledImageCount) + storageBufferCount;
+    if (requested > resourceBudget) {
+        sampledImageCount = static_cast<uint32_t>(sampledImageCount * resourceBudget / requested);
+        storageBufferCount = static_cast<uint32_t>(resourceBudget - sampledImageCount);
+    }
+    if (sampledImageCount < DefaultSampledImageCount ||
+        storageBufferCount < DefaultStorageBufferCount || samplerCount < DefaultSamplerCount) {
+        std::cerr << "[bindless] device limits reduce the table to " << sampledImageCount
+                  << " images, " << storageBufferCount << " buffers, " << samplerCount
+                  << " samplers" << std::endl;
+    }
+    m_sampledImages = {.capacity = sampledImageCount};
+    m_storageBuffers = {.capacity = storageBufferCount};
+    m_samplers = {.capacity = samplerCount};
+
+    const VkShaderStageFlags allStages = VK_SHADER_STAGE_ALL;
+    std::vector<VkDescriptorSetLayoutBinding> bindings = {
+        {
+            .binding = SampledImageBinding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .descriptorCount = m_sampledImages.capacity,
+            .stageFlags = allStages,
+        },
+        {
+            .binding = StorageBufferBinding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = m_storageBuffers.capacity,
+            .stageFlags = allStages,
+        },
+        {
+            .binding = SamplerBinding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+            .descriptorCount = m_samplers.capacity,
+            .stageFlags = allStages,
+        },
+    };
+    // Slots may be empty, and may be rewritten while a previous frame still uses the set
+    const VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                                  VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                                  VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+    m_layout = vulkanCtx.GetPipelineLayoutCache().GetDescriptorSetLayout(
+        bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+        std::vector<VkDescriptorBindingFlags>(bindings.size(), bindingFlags));
+
+    std::array<VkDescriptorPoolSize, 3> poolSizes{
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, m_sampledImages.capacity},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_storageBuffers.capacity},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLER, m_samplers.capacity},
+    };
+    VkDescriptorPoolCreateInfo poolInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+        .maxSets = 1,
+        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+        .pPoolSizes = poolSizes.data(),
+    };
+    if (vkCreateDescriptorPool(device, &poolInfo, vulkanCtx.GetAllocationCallbacks(), &m_pool) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create bindless descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = m_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &m_layout,
+    };
+    if (vkAllocateDescriptorSets(device, &allocInfo, &m_descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate bindless descriptor set!");
+    }
+    vulkanCtx.SetDebugObjectName(reinterpret_cast<void*>(m_descriptorSet),
+                                 VK_OBJECT_TYPE_DESCRIPTOR_SET, "BindlessResourceTable");
+}
+
+void BindlessResourceTable::Cleanup()
+{
+    // The layout belongs to the PipelineLayoutCache
+    if (m_pool != VK_NULL_HANDLE) {
+        auto& vulkanCtx = VulkanContext::Get();
+        vkDestroyDescriptorPool(vulkanCtx.GetVkDevice(), m_pool,
+                                vulkanCtx.GetAllocationCallbacks());
+    }
+    m_pool = VK_NULL_HANDLE;
+    m_layout = VK_NULL_HANDLE;
+    m_descriptorSet = VK_NULL_HANDLE;
+    m_sampledImages = {};
+    m_storageBuffers = {};
+    m_samplers = {};
+}
+
+uint32_t BindlessResourceTable::RegisterSampledImage(VkImageView view, VkImageLayout layout)
+{
+    std::lock_guard lock(m_mutex);
+    uint32_t index = m_sampledImages.Allocate();
+    if (index != InvalidIndex) {
+        WriteImage(SampledImageBinding, index, {.imageView = view, .imageLayout = layout},
+                   VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+    }
+    return index;
+}
+
+uint32_t BindlessResourceTable::RegisterStorageBuffer(VkBuffer buffer, VkDeviceSize offset,
+                                                      VkDeviceSize range)
+{
+    std::lock_guard lock(m_mutex);
+    uint32_t index = m_storageBuffers.Allocate();
+    if (index == InvalidIndex) {
+        return index;
+    }
+
+    VkDescriptorBufferInfo bufferInfo{
+        .buffer = buffer,
+        .offset = offset,
+        .range = range,
+    };
+    VkWriteDescriptorSet write{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = m_descriptorSet,
+        .dstBinding = StorageBufferBinding,
+        .dstArrayElement = index,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .pBufferInfo = &bufferInfo,
+    };
+    vkUpdateDescriptorSets(VulkanContext::Get().GetVkDevice(), 1, &write, 0, nullptr);
+    return index;
+}
+
+uint32_t BindlessResourceTable::RegisterSampler(VkSampler sampler)
+{
+    std::lock_guard lock(m_mutex);
+    uint32_t index = m_samplers.Allocate();
+    if (index != InvalidIndex) {
+        WriteImage(SamplerBinding, index, {.sampler = sampler}, VK_DESCRIPTOR_TYPE_SAMPLER);
+    }
+    return index;
+}
+
+void BindlessResourceTable::UpdateSampledImage(uint32_t index, VkImageView view,
+                                               VkImageLayout layout)
+{
+    std::lock_guard lock(m_mutex);
+    WriteImage(SampledImageBinding, index, {.imageView = view, .imageLayout = layout},
+               VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+}
+
+void BindlessResourceTable::ReleaseSampledImage(uint32_t index)
+{
+    Release(&BindlessResourceTable::m_sampledImages, index);
+}
+
+void BindlessResourceTable::ReleaseStorageBuffer(uint32_t index)
+{
+    Release(&BindlessResourceTable::m_storageBuffers, index);
+}
+
+void BindlessResourceTable::ReleaseSampler(uint32_t index)
+{
+    Release(&BindlessResourceTable::m_samplers, index);
+}
+
+VkPipelineLayout
+BindlessResourceTable::GetPipelineLayout(const std::vector<VkPushConstantRange>& pushConstantRanges)
+{
+    static_assert(SetIndex == 0);
+    return VulkanContext::Get().GetPipelineLayoutCache().GetPipelineLayout({m_layout},
+                                                                           pushConstantRanges);
+}
+
+void BindlessResourceTable::Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+                                 VkPipelineLayout pipelineLayout) const
+{
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, SetIndex, 1,
+                            &m_descriptorSet, 0, nullptr);
+}
+
+void BindlessResourceTable::Release(IndexAllocator BindlessResourceTable::*allocator,
+                                    uint32_t index)
+{
+    if (index == InvalidIndex) {
+        return;
+    }
+    // Frames already recorded may still index this slot; recycle it once they retire
+    VulkanContext::Get().DeferDestroy([this, allocator, index] {
+        std::lock_guard lock(m_mutex);
+        (this->*allocator).freeList.push_back(index);
+    });
+}
+
+void BindlessResourceTable::WriteImage(uint32_t binding, uint32_t index,
+                                       const VkDescriptorImageInfo& imageInfo,
+                                       VkDescriptorType type)
+{
+    VkWriteDescriptorSet write{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = m_descriptorSet,
+        .dstBinding = binding,
+        .dstArrayElement = index,
+        .descriptorCount = 1,
+        .descriptorType = type,
+        .pImageInfo = &imageInfo,
+    };
+    vkUpdateDescriptorSets(VulkanContext::Get().GetVkDevice(), 1, &write, 0, nullptr);
+}
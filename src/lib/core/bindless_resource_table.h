@@ -0,0 +1,85 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// One global descriptor set of large update-after-bind arrays. Resources are registered once
+// and addressed from shaders by a stable 32-bit index passed in push constants, so draws
+// bind this set once per command buffer instead of one set per object.
+//
+// GLSL side (set = BindlessResourceTable::SetIndex):
+//   layout(set = 0, binding = 0) uniform texture2D g_textures[];
+//   layout(set = 0, binding = 1) buffer Buffers { uint data[]; } g_buffers[];
+//   layout(set = 0, binding = 2) uniform sampler g_samplers[];
+class BindlessResourceTable {
+public:
+    static constexpr uint32_t SetIndex = 0;
+    static constexpr uint32_t SampledImageBinding = 0;
+    static constexpr uint32_t StorageBufferBinding = 1;
+    static constexpr uint32_t SamplerBinding = 2;
+    static constexpr uint32_t InvalidIndex = ~0u;
+
+    // Requested capacities, clamped to the device's update-after-bind limits per type, per set
+    // and for all resources of a stage
+    static constexpr uint32_t DefaultSampledImageCount = 16384;
+    static constexpr uint32_t DefaultStorageBufferCount = 16384;
+    static constexpr uint32_t DefaultSamplerCount = 256;
+
+    BindlessResourceTable() = default;
+    ~BindlessResourceTable() = default;
+
+    BindlessResourceTable(const BindlessResourceTable&) = delete;
+    BindlessResourceTable& operator=(const BindlessResourceTable&) = delete;
+
+    void Initialize();
+    void Cleanup();
+
+    // Register functions return InvalidIndex when the table is full
+    uint32_t RegisterSampledImage(VkImageView view,
+                                  VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    uint32_t RegisterStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0,
+                                   VkDeviceSize range = VK_WHOLE_SIZE);
+    uint32_t RegisterSampler(VkSampler sampler);
+
+    // Points an already registered index at a new resource (e.g. a streamed-in mip chain)
+    void UpdateSampledImage(uint32_t index, VkImageView view,
+                            VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    // Indices are recycled only after every frame in flight has finished with them.
+    // Call from the render thread (uses VulkanContext::DeferDestroy).
+    void ReleaseSampledImage(uint32_t index);
+    void ReleaseStorageBuffer(uint32_t index);
+    void ReleaseSampler(uint32_t index);
+
+    VkDescriptorSetLayout GetLayout() const { return m_layout; }
+    VkDescriptorSet GetDescriptorSet() const { return m_descriptorSet; }
+
+    // Creates (or fetches from the cache) a pipeline layout with this table at SetIndex
+    VkPipelineLayout GetPipelineLayout(const std::vector<VkPushConstantRange>& pushConstantRanges);
+
+    void Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+              VkPipelineLayout pipelineLayout) const;
+
+private:
+    struct IndexAllocator {
+        uint32_t capacity = 0;
+        uint32_t next = 0;
+        std::vector<uint32_t> freeList;
+
+        uint32_t Allocate();
+    };
+
+    void Release(IndexAllocator BindlessResourceTable::*allocator, uint32_t index);
+    void WriteImage(uint32_t binding, uint32_t index, const VkDescriptorImageInfo& imageInfo,
+                    VkDescriptorType type);
+
+    std::mutex m_mutex;
+    VkDescriptorPool m_pool = VK_NULL_HANDLE;
+    VkDescriptorSetLayout m_layout = VK_NULL_HANDLE;
+    VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+
+    IndexAllocator m_sampledImages;
+    IndexAllocator m_storageBuffers;
+    IndexAllocator m_samplers;
+};
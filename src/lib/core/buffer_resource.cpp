@@ -1,4 +1,5 @@
 #include "core/buffer_resource.h"
+#include "core/gpu_memory_tracker.h"
 
 template <typename T>
 void BufferResource<T>::Creanup()
@@ -7,11 +8,11 @@ void BufferResource<T>::Creanup()
     VkDevice vkDevice = vulkanCtx.GetVkDevice();
 
     if (m_buffer != VK_NULL_HANDLE) {
-        vkDestroyBuffer(vkDevice, m_buffer, nullptr);
+        vkDestroyBuffer(vkDevice, m_buffer, vulkanCtx.GetAllocationCallbacks());
         m_buffer = VK_NULL_HANDLE;
     }
     if (m_memory != VK_NULL_HANDLE) {
-        vkFreeMemory(vkDevice, m_memory, nullptr);
+        vulkanCtx.FreeMemory(m_memory);
         m_memory = VK_NULL_HANDLE;
     }
     m_size = 0;
@@ -27,14 +28,24 @@ VkDescriptorBufferInfo BufferResource<T>::GetDescriptorInfo() const
     };
 }
 
+template <typename T>
+void BufferResource<T>::SetDebugName(const char* name)
+{
+    VulkanContext& vulkanCtx = VulkanContext::Get();
+    vulkanCtx.SetDebugObjectName(reinterpret_cast<void*>(m_buffer), VK_OBJECT_TYPE_BUFFER, name);
+    vulkanCtx.SetMemoryName(m_memory, name);
+}
+
 template <typename T>
 bool BufferResource<T>::CreateBuffer(const VkBufferCreateInfo& createInfo,
-                                            VkMemoryPropertyFlags memProps)
+                                     VkMemoryPropertyFlags memProps, GpuMemoryCategory category,
+                                     const char* name)
 {
     VulkanContext& vulkanCtx = VulkanContext::Get();
     VkDevice vkDevice = vulkanCtx.GetVkDevice();
 
-    auto result = vkCreateBuffer(vkDevice, &createInfo, nullptr, &m_buffer);
+    auto result =
+        vkCreateBuffer(vkDevice, &createInfo, vulkanCtx.GetAllocationCallbacks(), &m_buffer);
     if (result != VK_SUCCESS) {
         return false;
     }
@@ -42,14 +53,8 @@ bool BufferResource<T>::CreateBuffer(const VkBufferCreateInfo& createInfo,
     VkMemoryRequirements memRequirements;
     vkGetBufferMemoryRequirements(vkDevice, m_buffer, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = memRequirements.size,
-        .memoryTypeIndex = vulkanCtx.FindMemoryType(memRequirements, memProps)
-    };
-
-    result = vkAllocateMemory(vkDevice, &allocInfo, nullptr, &m_memory);
-    if (result != VK_SUCCESS) {
+    m_memory = vulkanCtx.AllocateMemory(memRequirements, memProps, category, name);
+    if (m_memory == VK_NULL_HANDLE) {
         return false;
     }
 
@@ -62,14 +67,13 @@ bool BufferResource<T>::CreateBuffer(const VkBufferCreateInfo& createInfo,
 
 bool VertexBuffer::Initialize(VkDeviceSize size, VkMemoryPropertyFlags memProps)
 {
-    auto& context = VulkanContext::Get();
     VkBufferCreateInfo bufferInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
                                   .size = size,
                                   .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
                                            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
                                   .sharingMode = VK_SHARING_MODE_EXCLUSIVE};
     SetAccessFlags(VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
-    return CreateBuffer(bufferInfo, memProps);
+    return CreateBuffer(bufferInfo, memProps, GpuMemoryCategory::Geometry, "VertexBuffer");
 }
 
 void* VertexBuffer::Map()
@@ -89,6 +93,65 @@ void VertexBuffer::Unmap()
     vkUnmapMemory(VulkanContext::Get().GetVkDevice(), m_memory);
 }
 
+bool IndexBuffer::Initialize(VkDeviceSize size, VkMemoryPropertyFlags memProps,
+                             VkIndexType indexType)
+{
+    VkBufferCreateInfo bufferInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                                  .size = size,
+                                  .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                                           VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                  .sharingMode = VK_SHARING_MODE_EXCLUSIVE};
+    SetAccessFlags(VK_ACCESS_INDEX_READ_BIT);
+    m_indexType = indexType;
+    return CreateBuffer(bufferInfo, memProps, GpuMemoryCategory::Geometry, "IndexBuffer");
+}
+
+void* IndexBuffer::Map()
+{
+    if (!(m_memProps & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+        return nullptr;
+
+    void* mapped = nullptr;
+    vkMapMemory(VulkanContext::Get().GetVkDevice(), m_memory, 0, m_size, 0, &mapped);
+    return mapped;
+}
+
+void IndexBuffer::Unmap()
+{
+    if (!(m_memProps & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+        return;
+    vkUnmapMemory(VulkanContext::Get().GetVkDevice(), m_memory);
+}
+
+bool StorageBuffer::Initialize(VkDeviceSize size, VkMemoryPropertyFlags memProps,
+                               VkBufferUsageFlags extraUsage)
+{
+    VkBufferCreateInfo bufferInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                                  .size = size,
+                                  .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                           VK_BUFFER_USAGE_TRANSFER_DST_BIT | extraUsage,
+                                  .sharingMode = VK_SHARING_MODE_EXCLUSIVE};
+    SetAccessFlags(VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+    return CreateBuffer(bufferInfo, memProps, GpuMemoryCategory::Buffer, "StorageBuffer");
+}
+
+void* StorageBuffer::Map()
+{
+    if (!(m_memProps & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+        return nullptr;
+
+    void* mapped = nullptr;
+    vkMapMemory(VulkanContext::Get().GetVkDevice(), m_memory, 0, m_size, 0, &mapped);
+    return mapped;
+}
+
+void StorageBuffer::Unmap()
+{
+    if (!(m_memProps & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+        return;
+    vkUnmapMemory(VulkanContext::Get().GetVkDevice(), m_memory);
+}
+
 void* StagingBuffer::Map()
 {
     void* mapped = nullptr;
@@ -106,13 +169,16 @@ void StagingBuffer::Unmap()
 bool StagingBuffer::Initialize(VkDeviceSize size)
 {
     VkBufferCreateInfo bufferInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-                                  .size = m_size,
+                                  .size = size,
                                   .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                                   .sharingMode = VK_SHARING_MODE_EXCLUSIVE};
     VkMemoryPropertyFlags memProps =
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
     SetAccessFlags(VK_ACCESS_HOST_WRITE_BIT);
-    return CreateBuffer(bufferInfo, memProps);
+    return CreateBuffer(bufferInfo, memProps, GpuMemoryCategory::Staging, "StagingBuffer");
 }
 
 template class BufferResource<VertexBuffer>;
+template class BufferResource<IndexBuffer>;
+template class BufferResource<StorageBuffer>;
+template class BufferResource<StagingBuffer>;
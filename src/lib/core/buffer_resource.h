@@ -38,10 +38,14 @@ public:
 
     VkDescriptorBufferInfo GetDescriptorInfo() const override;
 
+    // Names the buffer and its memory for debug tools and the GPU memory tracker
+    void SetDebugName(const char* name);
+
 protected:
     BufferResource() = default;
 
-    bool CreateBuffer(const VkBufferCreateInfo& createInfo, VkMemoryPropertyFlags memProps);
+    bool CreateBuffer(const VkBufferCreateInfo& createInfo, VkMemoryPropertyFlags memProps,
+                      GpuMemoryCategory category, const char* name);
 
     VkBuffer m_buffer{};
     VkDeviceMemory m_memory{};
@@ -74,6 +78,59 @@ public:
 
 };
 
+class IndexBuffer : public BufferResource<IndexBuffer> {
+    friend class GpuResourceBase<IndexBuffer>;
+    IndexBuffer() = default;
+
+public:
+    virtual ~IndexBuffer() = default;
+
+    virtual void* Map() override;
+    virtual void Unmap() override;
+
+    bool Initialize(VkDeviceSize size, VkMemoryPropertyFlags memProps,
+                    VkIndexType indexType = VK_INDEX_TYPE_UINT32);
+    VkIndexType GetIndexType() const { return m_indexType; }
+
+    static std::shared_ptr<IndexBuffer> Create(VkDeviceSize size, VkMemoryPropertyFlags memProps,
+                                               VkIndexType indexType = VK_INDEX_TYPE_UINT32)
+    {
+        auto buffer = GpuResourceBase::Create();
+        if (!buffer->Initialize(size, memProps, indexType)) {
+            return nullptr;
+        }
+        return buffer;
+    }
+
+private:
+    VkIndexType m_indexType = VK_INDEX_TYPE_UINT32;
+};
+
+// Shader-writable buffer (STORAGE | TRANSFER_DST); extraUsage adds e.g. INDIRECT_BUFFER
+class StorageBuffer : public BufferResource<StorageBuffer> {
+    friend class GpuResourceBase<StorageBuffer>;
+    StorageBuffer() = default;
+
+public:
+    virtual ~StorageBuffer() = default;
+
+    virtual void* Map() override;
+    virtual void Unmap() override;
+
+    bool Initialize(VkDeviceSize size, VkMemoryPropertyFlags memProps,
+                    VkBufferUsageFlags extraUsage = 0);
+
+    static std::shared_ptr<StorageBuffer> Create(VkDeviceSize size, VkMemoryPropertyFlags memProps,
+                                                 VkBufferUsageFlags extraUsage = 0)
+    {
+        auto buffer = GpuResourceBase::Create();
+        if (!buffer->Initialize(size, memProps, extraUsage)) {
+            return nullptr;
+        }
+        return buffer;
+    }
+};
+
 class StagingBuffer : public BufferResource<StagingBuffer> {
     friend class GpuResourceBase<StagingBuffer>;
 private:
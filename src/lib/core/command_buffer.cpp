@@ -34,4 +34,17 @@ void CommandBuffer::Reset()
 void CommandBuffer::TransitionLayout(VkImage image, const VkImageSubresourceRange& range,
                                      const ImageLayoutTransition& transition)
 {
+    VkImageMemoryBarrier barrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = transition.srcAccessMask,
+        .dstAccessMask = transition.dstAccessMask,
+        .oldLayout = transition.oldLayout,
+        .newLayout = transition.newLayout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = range,
+    };
+    vkCmdPipelineBarrier(m_commandBuffer, transition.srcStage, transition.dstStage, 0, 0, nullptr,
+                         0, nullptr, 1, &barrier);
 }
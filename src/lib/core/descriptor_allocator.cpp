@@ -0,0 +1,379 @@
+#include "descriptor_allocator.h"
+#include "core/gpu_memory_tracker.h"
+#include "core/vulkan_context.h"
+#include <array>
+
+namespace {
+
+template <typename T> T LoadDeviceFunction(VkDevice device, const char* name)
+{
+    return reinterpret_cast<T>(vkGetDeviceProcAddr(device, name));
+}
+
+VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+bool DescriptorAllocator::Initialize(Backend preferred, VkDeviceSize bytesPerFrame,
+                                     uint32_t setsPerFrame)
+{
+    m_backend = Backend::DescriptorSets;
+    if (preferred == Backend::DescriptorBuffer &&
+        VulkanContext::Get().IsDescriptorBufferSupported() &&
+        InitializeDescriptorBuffer(bytesPerFrame)) {
+        m_backend = Backend::DescriptorBuffer;
+        return true;
+    }
+
+    InitializeDescriptorSets(setsPerFrame);
+    return !m_framePools.empty();
+}
+
+void DescriptorAllocator::Cleanup()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    for (auto pool : m_framePools) {
+        vkDestroyDescriptorPool(device, pool, allocator);
+    }
+    m_framePools.clear();
+
+    if (m_memory != VK_NULL_HANDLE) {
+        vkUnmapMemory(device, m_memory);
+    }
+    vkDestroyBuffer(device, m_buffer, allocator);
+    vulkanCtx.FreeMemory(m_memory);
+    m_buffer = VK_NULL_HANDLE;
+    m_memory = VK_NULL_HANDLE;
+    m_mapped = nullptr;
+    m_layouts.clear();
+}
+
+VkDescriptorSetLayoutCreateFlags DescriptorAllocator::GetLayoutCreateFlags() const
+{
+    return m_backend == Backend::DescriptorBuffer
+               ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT
+               : 0;
+}
+
+VkPipelineCreateFlags DescriptorAllocator::GetPipelineCreateFlags() const
+{
+    return m_backend == Backend::DescriptorBuffer ? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT
+                                                  : 0;
+}
+
+void DescriptorAllocator::BeginFrame(uint32_t frameIndex)
+{
+    m_frameIndex = frameIndex % VulkanContext::MaxInflightFrame;
+    if (m_backend == Backend::DescriptorBuffer) {
+        m_head = 0;
+    }
+    else {
+        vkResetDescriptorPool(VulkanContext::Get().GetVkDevice(), m_framePools[m_frameIndex], 0);
+    }
+}
+
+DescriptorAllocator::Allocation DescriptorAllocator::Allocate(VkDescriptorSetLayout layout)
+{
+    Allocation allocation{.layout = layout};
+
+    if (m_backend == Backend::DescriptorBuffer) {
+        VkDeviceSize offset = AlignUp(m_head, m_props.descriptorBufferOffsetAlignment);
+        VkDeviceSize size = GetLayoutInfo(layout).size;
+        if (offset + size > m_bytesPerFrame) {
+            return allocation;
+        }
+        m_head = offset + size;
+        allocation.offset = m_frameIndex * m_bytesPerFrame + offset;
+        allocation.valid = true;
+        return allocation;
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = m_framePools[m_frameIndex],
+        .descriptorSetCount = 1,
+        .pSetLayouts = &layout,
+    };
+    VkDevice device = VulkanContext::Get().GetVkDevice();
+    allocation.valid = vkAllocateDescriptorSets(device, &allocInfo, &allocation.set) == VK_SUCCESS;
+    return allocation;
+}
+
+void DescriptorAllocator::WriteBuffer(const Allocation& allocation, uint32_t binding,
+                                      VkDescriptorType type, VkBuffer buffer,
+                                      VkDeviceSize offset, VkDeviceSize range)
+{
+    VkDevice device = VulkanContext::Get().GetVkDevice();
+
+    if (m_backend == Backend::DescriptorBuffer) {
+        VkBufferDeviceAddressInfo addressInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .buffer = buffer,
+        };
+        VkDescriptorAddressInfoEXT descriptorAddress{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
+            .address = vkGetBufferDeviceAddress(device, &addressInfo) + offset,
+            .range = range,
+        };
+        VkDescriptorGetInfoEXT getInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
+            .type = type,
+        };
+        if (type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+            getInfo.data.pUniformBuffer = &descriptorAddress;
+        }
+        else {
+            getInfo.data.pStorageBuffer = &descriptorAddress;
+        }
+        WriteDescriptor(allocation, binding, getInfo);
+        return;
+    }
+
+    VkDescriptorBufferInfo bufferInfo{
+        .buffer = buffer,
+        .offset = offset,
+        .range = range,
+    };
+    VkWriteDescriptorSet write{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = allocation.set,
+        .dstBinding = binding,
+        .descriptorCount = 1,
+        .descriptorType = type,
+        .pBufferInfo = &bufferInfo,
+    };
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
+
+void DescriptorAllocator::WriteImage(const Allocation& allocation, uint32_t binding,
+                                     VkDescriptorType type, const VkDescriptorImageInfo& imageInfo)
+{
+    if (m_backend == Backend::DescriptorBuffer) {
+        VkDescriptorGetInfoEXT getInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
+            .type = type,
+        };
+        switch (type) {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+            getInfo.data.pSampler = &imageInfo.sampler;
+            break;
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            getInfo.data.pCombinedImageSampler = &imageInfo;
+            break;
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            getInfo.data.pStorageImage = &imageInfo;
+            break;
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+            getInfo.data.pInputAttachmentImage = &imageInfo;
+            break;
+        default:
+            getInfo.data.pSampledImage = &imageInfo;
+            break;
+        }
+        WriteDescriptor(allocation, binding, getInfo);
+        return;
+    }
+
+    VkWriteDescriptorSet write{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = allocation.set,
+        .dstBinding = binding,
+        .descriptorCount = 1,
+        .descriptorType = type,
+        .pImageInfo = &imageInfo,
+    };
+    vkUpdateDescriptorSets(VulkanContext::Get().GetVkDevice(), 1, &write, 0, nullptr);
+}
+
+void DescriptorAllocator::BindBuffers(VkCommandBuffer commandBuffer) const
+{
+    if (m_backend != Backend::DescriptorBuffer) {
+        return;
+    }
+    VkDescriptorBufferBindingInfoEXT bindingInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+        .address = m_bufferAddress,
+        .usage = m_bufferUsage,
+    };
+    m_pfnCmdBindDescriptorBuffers(commandBuffer, 1, &bindingInfo);
+}
+
+void DescriptorAllocator::Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+                               VkPipelineLayout pipelineLayout, uint32_t setIndex,
+                               const Allocation& allocation) const
+{
+    if (m_backend == Backend::DescriptorBuffer) {
+        const uint32_t bufferIndex = 0;
+        m_pfnCmdSetDescriptorBufferOffsets(commandBuffer, bindPoint, pipelineLayout, setIndex, 1,
+                                           &bufferIndex, &allocation.offset);
+        return;
+    }
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, setIndex, 1,
+                            &allocation.set, 0, nullptr);
+}
+
+bool DescriptorAllocator::InitializeDescriptorBuffer(VkDeviceSize bytesPerFrame)
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+
+    m_pfnGetDescriptor = LoadDeviceFunction<PFN_vkGetDescriptorEXT>(device, "vkGetDescriptorEXT");
+    m_pfnGetLayoutSize = LoadDeviceFunction<PFN_vkGetDescriptorSetLayoutSizeEXT>(
+        device, "vkGetDescriptorSetLayoutSizeEXT");
+    m_pfnGetBindingOffset = LoadDeviceFunction<PFN_vkGetDescriptorSetLayoutBindingOffsetEXT>(
+        device, "vkGetDescriptorSetLayoutBindingOffsetEXT");
+    m_pfnCmdBindDescriptorBuffers = LoadDeviceFunction<PFN_vkCmdBindDescriptorBuffersEXT>(
+        device, "vkCmdBindDescriptorBuffersEXT");
+    m_pfnCmdSetDescriptorBufferOffsets = LoadDeviceFunction<PFN_vkCmdSetDescriptorBufferOffsetsEXT>(
+        device, "vkCmdSetDescriptorBufferOffsetsEXT");
+    if (!m_pfnGetDescriptor || !m_pfnGetLayoutSize || !m_pfnGetBindingOffset ||
+        !m_pfnCmdBindDescriptorBuffers || !m_pfnCmdSetDescriptorBufferOffsets) {
+        return false;
+    }
+
+    m_props = VkPhysicalDeviceDescriptorBufferPropertiesEXT{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT,
+    };
+    VkPhysicalDeviceProperties2 props{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &m_props,
+    };
+    vkGetPhysicalDeviceProperties2(vulkanCtx.GetVkPhysicalDevice(), &props);
+
+    // One ring segment per frame in flight
+    m_bytesPerFrame = AlignUp(bytesPerFrame, m_props.descriptorBufferOffsetAlignment);
+    m_bufferUsage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT |
+                    VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT |
+                    VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    VkBufferCreateInfo bufferInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = m_bytesPerFrame * VulkanContext::MaxInflightFrame,
+        .usage = m_bufferUsage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    if (vkCreateBuffer(device, &bufferInfo, allocator, &m_buffer) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device, m_buffer, &memRequirements);
+    VkMemoryAllocateFlagsInfo flagsInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+        .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+    };
+    m_memory = vulkanCtx.AllocateMemory(
+        memRequirements,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        GpuMemoryCategory::Descriptor, "DescriptorAllocatorRing", &flagsInfo);
+    if (m_memory == VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, m_buffer, allocator);
+        m_buffer = VK_NULL_HANDLE;
+        return false;
+    }
+    vkBindBufferMemory(device, m_buffer, m_memory, 0);
+
+    void* mapped = nullptr;
+    vkMapMemory(device, m_memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+    m_mapped = static_cast<uint8_t*>(mapped);
+
+    VkBufferDeviceAddressInfo addressInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+        .buffer = m_buffer,
+    };
+    m_bufferAddress = vkGetBufferDeviceAddress(device, &addressInfo);
+    vulkanCtx.SetDebugObjectName(reinterpret_cast<void*>(m_buffer), VK_OBJECT_TYPE_BUFFER,
+                                 "DescriptorAllocatorRing");
+    return true;
+}
+
+void DescriptorAllocator::InitializeDescriptorSets(uint32_t setsPerFrame)
+{
+    std::array<VkDescriptorPoolSize, 7> poolSizes{
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, setsPerFrame * 2},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, setsPerFrame * 2},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, setsPerFrame * 2},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, setsPerFrame * 2},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLER, setsPerFrame},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, setsPerFrame},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, setsPerFrame / 4 + 1},
+    };
+    VkDescriptorPoolCreateInfo poolInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .maxSets = setsPerFrame,
+        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+        .pPoolSizes = poolSizes.data(),
+    };
+
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    for (uint32_t i = 0; i < VulkanContext::MaxInflightFrame; ++i) {
+        VkDescriptorPool pool = VK_NULL_HANDLE;
+        if (vkCreateDescriptorPool(device, &poolInfo, allocator, &pool) != VK_SUCCESS) {
+            Cleanup();
+            return;
+        }
+        m_framePools.push_back(pool);
+    }
+}
+
+DescriptorAllocator::LayoutInfo& DescriptorAllocator::GetLayoutInfo(VkDescriptorSetLayout layout)
+{
+    auto it = m_layouts.find(layout);
+    if (it != m_layouts.end()) {
+        return it->second;
+    }
+    LayoutInfo info{};
+    m_pfnGetLayoutSize(VulkanContext::Get().GetVkDevice(), layout, &info.size);
+    return m_layouts.emplace(layout, std::move(info)).first->second;
+}
+
+VkDeviceSize DescriptorAllocator::GetBindingOffset(VkDescriptorSetLayout layout, uint32_t binding)
+{
+    constexpr VkDeviceSize NotQueried = ~VkDeviceSize(0);
+    auto& offsets = GetLayoutInfo(layout).bindingOffsets;
+    if (offsets.size() <= binding) {
+        offsets.resize(binding + 1, NotQueried);
+    }
+    if (offsets[binding] == NotQueried) {
+        m_pfnGetBindingOffset(VulkanContext::Get().GetVkDevice(), layout, binding,
+                              &offsets[binding]);
+    }
+    return offsets[binding];
+}
+
+size_t DescriptorAllocator::GetDescriptorSize(VkDescriptorType type) const
+{
+    switch (type) {
+    case VK_DESCRIPTOR_TYPE_SAMPLER:
+        return m_props.samplerDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+        return m_props.combinedImageSamplerDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        return m_props.sampledImageDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        return m_props.storageImageDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+        return m_props.uniformBufferDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        return m_props.storageBufferDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+        return m_props.inputAttachmentDescriptorSize;
+    default:
+        return 0;
+    }
+}
+
+void DescriptorAllocator::WriteDescriptor(const Allocation& allocation, uint32_t binding,
+                                          const VkDescriptorGetInfoEXT& getInfo)
+{
+    VkDeviceSize offset = allocation.offset + GetBindingOffset(allocation.layout, binding);
+    m_pfnGetDescriptor(VulkanContext::Get().GetVkDevice(), &getInfo,
+                       GetDescriptorSize(getInfo.type), m_mapped + offset);
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Transient per-frame descriptors. Everything allocated in a frame is recycled in one go the
+// next time that frame slot begins, so nothing is freed individually.
+//
+// Two backends:
+//  - DescriptorSets:   one descriptor pool per frame, reset with vkResetDescriptorPool.
+//  - DescriptorBuffer: VK_EXT_descriptor_buffer. Descriptors are written with vkGetDescriptorEXT
+//                      straight into a persistently mapped ring and bound by offset.
+// Layouts and pipelines used with this allocator must be created with GetLayoutCreateFlags() /
+// GetPipelineCreateFlags(). Not thread-safe; use from the render thread.
+class DescriptorAllocator {
+public:
+    enum class Backend {
+        DescriptorSets,
+        DescriptorBuffer,
+    };
+
+    struct Allocation {
+        VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+        VkDescriptorSet set = VK_NULL_HANDLE; // DescriptorSets
+        VkDeviceSize offset = 0;              // DescriptorBuffer, from the start of the ring
+        bool valid = false;
+    };
+
+    static constexpr VkDeviceSize DefaultBytesPerFrame = 1 << 20;
+    static constexpr uint32_t DefaultSetsPerFrame = 4096;
+
+    DescriptorAllocator() = default;
+    ~DescriptorAllocator() = default;
+
+    DescriptorAllocator(const DescriptorAllocator&) = delete;
+    DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+    // Uses DescriptorSets when DescriptorBuffer is requested but not supported by the device
+    bool Initialize(Backend preferred, VkDeviceSize bytesPerFrame = DefaultBytesPerFrame,
+                    uint32_t setsPerFrame = DefaultSetsPerFrame);
+    void Cleanup();
+
+    Backend GetBackend() const { return m_backend; }
+    VkDescriptorSetLayoutCreateFlags GetLayoutCreateFlags() const;
+    VkPipelineCreateFlags GetPipelineCreateFlags() const;
+
+    // Recycles what this frame slot allocated last time. Its fence must have been waited on.
+    void BeginFrame(uint32_t frameIndex);
+
+    // Returns an invalid allocation when this frame's budget is exhausted
+    Allocation Allocate(VkDescriptorSetLayout layout);
+
+    // With DescriptorBuffer, the buffer must have VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+    // and range must be explicit (not VK_WHOLE_SIZE)
+    void WriteBuffer(const Allocation& allocation, uint32_t binding, VkDescriptorType type,
+                     VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+    void WriteImage(const Allocation& allocation, uint32_t binding, VkDescriptorType type,
+                    const VkDescriptorImageInfo& imageInfo);
+
+    // Call once per command buffer before Bind (no-op for DescriptorSets)
+    void BindBuffers(VkCommandBuffer commandBuffer) const;
+    void Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+              VkPipelineLayout pipelineLayout, uint32_t setIndex,
+              const Allocation& allocation) const;
+
+private:
+    struct LayoutInfo {
+        VkDeviceSize size = 0;
+        std::vector<VkDeviceSize> bindingOffsets; // ~0 until queried
+    };
+
+    bool InitializeDescriptorBuffer(VkDeviceSize bytesPerFrame);
+    void InitializeDescriptorSets(uint32_t setsPerFrame);
+    LayoutInfo& GetLayoutInfo(VkDescriptorSetLayout layout);
+    VkDeviceSize GetBindingOffset(VkDescriptorSetLayout layout, uint32_t binding);
+    size_t GetDescriptorSize(VkDescriptorType type) const;
+    void WriteDescriptor(const Allocation& allocation, uint32_t binding,
+                         const VkDescriptorGetInfoEXT& getInfo);
+
+    Backend m_backend = Backend::DescriptorSets;
+    uint32_t m_frameIndex = 0;
+
+    // DescriptorSets
+    std::vector<VkDescriptorPool> m_framePools;
+
+    // DescriptorBuffer
+    VkBuffer m_buffer = VK_NULL_HANDLE;
+    VkDeviceMemory m_memory = VK_NULL_HANDLE;
+    uint8_t* m_mapped = nullptr;
+    VkDeviceAddress m_bufferAddress = 0;
+    VkBufferUsageFlags m_bufferUsage = 0;
+    VkDeviceSize m_bytesPerFrame = 0;
+    VkDeviceSize m_head = 0;
+    VkPhysicalDeviceDescriptorBufferPropertiesEXT m_props{};
+    std::unordered_map<VkDescriptorSetLayout, LayoutInfo> m_layouts;
+
+    PFN_vkGetDescriptorEXT m_pfnGetDescriptor = nullptr;
+    PFN_vkGetDescriptorSetLayoutSizeEXT m_pfnGetLayoutSize = nullptr;
+    PFN_vkGetDescriptorSetLayoutBindingOffsetEXT m_pfnGetBindingOffset = nullptr;
+    PFN_vkCmdBindDescriptorBuffersEXT m_pfnCmdBindDescriptorBuffers = nullptr;
+    PFN_vkCmdSetDescriptorBufferOffsetsEXT m_pfnCmdSetDescriptorBufferOffsets = nullptr;
+};
@@ -0,0 +1,185 @@
+#include "dynamic_resolution.h"
+#include "core/command_buffer.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+uint32_t ScaleDimension(uint32_t size, float scale)
+{
+    const uint32_t granularity = DynamicResolution::ExtentGranularity;
+    const uint32_t scaled = static_cast<uint32_t>(std::lround(float(size) * scale));
+    const uint32_t rounded = (scaled + granularity / 2) / granularity * granularity;
+    return std::clamp(rounded, std::min(granularity, size), size);
+}
+
+} // namespace
+
+bool DynamicResolution::Initialize(VkExtent2D outputExtent, VkFormat colorFormat,
+                                   VkFormat depthFormat, const Settings& settings)
+{
+    m_settings = settings;
+    m_settings.minScale = std::clamp(m_settings.minScale, 0.1f, 1.0f);
+    m_settings.maxScale = std::clamp(m_settings.maxScale, m_settings.minScale, 1.0f);
+    m_outputExtent = outputExtent;
+    m_scale = m_settings.maxScale;
+    m_fullResolutionMs = -1.0;
+
+    VkFormatProperties formatProps;
+    vkGetPhysicalDeviceFormatProperties(VulkanContext::Get().GetVkPhysicalDevice(), colorFormat,
+                                        &formatProps);
+    // The output is usually a swapchain image of the same format, so both ends of the blit
+    const VkFormatFeatureFlags features = formatProps.optimalTilingFeatures;
+    const VkFormatFeatureFlags blitFeatures =
+        VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+    if ((features & blitFeatures) != blitFeatures) {
+        std::cerr << "[dynamic resolution] color format " << colorFormat
+                  << " does not support blits" << std::endl;
+        return false;
+    }
+    m_filter = (features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != 0
+                   ? VK_FILTER_LINEAR
+                   : VK_FILTER_NEAREST;
+
+    m_colorTarget = ColorTarget::Create(outputExtent, colorFormat);
+    m_depthBuffer = DepthBuffer::Create(outputExtent, depthFormat);
+    if (!m_colorTarget || !m_depthBuffer) {
+        Cleanup();
+        return false;
+    }
+    m_colorTarget->SetDebugName("DynamicResolutionColor");
+    m_depthBuffer->SetDebugName("DynamicResolutionDepth");
+    return true;
+}
+
+void DynamicResolution::Cleanup()
+{
+    m_depthBuffer.reset();
+    m_colorTarget.reset();
+}
+
+void DynamicResolution::Update(double gpuMs, float renderedScale)
+{
+    if (gpuMs < 0.0 || renderedScale <= 0.0f) {
+        return;
+    }
+    // Projecting to full resolution keeps samples taken at different scales comparable, so
+    // the timestamps lagging a few frames behind the scale do not make the loop oscillate
+    const double fullMs = gpuMs / (double(renderedScale) * double(renderedScale));
+    m_fullResolutionMs = m_fullResolutionMs < 0.0
+                             ? fullMs
+                             : m_fullResolutionMs + m_settings.smoothing *
+                                                        (fullMs - m_fullResolutionMs);
+    if (m_fullResolutionMs <= 0.0) {
+        return;
+    }
+
+    const double predictedMs = m_fullResolutionMs * double(m_scale) * double(m_scale);
+    if (std::abs(predictedMs - m_settings.targetGpuMs) <=
+        m_settings.deadband * m_settings.targetGpuMs) {
+        return;
+    }
+    const float desired = std::clamp(
+        static_cast<float>(std::sqrt(m_settings.targetGpuMs / m_fullResolutionMs)),
+        m_settings.minScale, m_settings.maxScale);
+    m_scale += std::clamp(desired - m_scale, -m_settings.maxStep, m_settings.maxStep);
+}
+
+VkExtent2D DynamicResolution::GetRenderExtent() const
+{
+    return {ScaleDimension(m_outputExtent.width, m_scale),
+            ScaleDimension(m_outputExtent.height, m_scale)};
+}
+
+void DynamicResolution::BeginFrame(CommandBuffer& commandBuffer)
+{
+    VkImageSubresourceRange colorRange{
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+    VkImageSubresourceRange depthRange = colorRange;
+    depthRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+
+    // The color target is shared by every frame in flight: wait for the previous frame's blit
+    // to read it and its attachment writes to finish
+    commandBuffer.TransitionLayout(
+        m_colorTarget->GetVkImage(), colorRange,
+        ImageLayoutTransition{
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT |
+                        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .dstStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        });
+    commandBuffer.TransitionLayout(m_depthBuffer->GetVkImage(), depthRange,
+                                   ImageLayoutTransition::FromUndefinedToDepthAttachment());
+}
+
+void DynamicResolution::SetViewportAndScissor(VkCommandBuffer commandBuffer) const
+{
+    const VkExtent2D extent = GetRenderExtent();
+    VkViewport viewport{
+        .x = 0.0f,
+        .y = float(extent.height),
+        .width = float(extent.width),
+        .height = -float(extent.height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f,
+    };
+    VkRect2D scissor{
+        .offset = {0, 0},
+        .extent = extent,
+    };
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void DynamicResolution::RecordUpscale(CommandBuffer& commandBuffer, VkImage dstImage,
+                                      VkExtent2D dstExtent)
+{
+    VkImageSubresourceRange colorRange{
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+    commandBuffer.TransitionLayout(
+        m_colorTarget->GetVkImage(), colorRange,
+        ImageLayoutTransition{
+            .oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+            .srcStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .dstStage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+        });
+    // The swapchain acquire semaphore is waited on at COLOR_ATTACHMENT_OUTPUT, so the blit has
+    // to be chained behind that stage rather than TOP_OF_PIPE
+    commandBuffer.TransitionLayout(dstImage, colorRange,
+                                   ImageLayoutTransition{
+                                       .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                                       .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       .srcAccessMask = 0,
+                                       .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                                       .srcStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                       .dstStage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                   });
+
+    const VkExtent2D srcExtent = GetRenderExtent();
+    VkImageBlit region{
+        .srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+        .srcOffsets = {{0, 0, 0}, {int32_t(srcExtent.width), int32_t(srcExtent.height), 1}},
+        .dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+        .dstOffsets = {{0, 0, 0}, {int32_t(dstExtent.width), int32_t(dstExtent.height), 1}},
+    };
+    vkCmdBlitImage(commandBuffer, m_colorTarget->GetVkImage(),
+                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dstImage,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, m_filter);
+}
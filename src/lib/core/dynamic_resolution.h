@@ -0,0 +1,78 @@
+#pragma once
+#include "core/image_resource.h"
+#include <memory>
+
+class CommandBuffer;
+
+// Renders the scene into an offscreen color + depth target at a fraction of the output extent
+// and upscales it with a linear blit. The fraction follows the measured GPU frame time:
+//   dynamicResolution.Update(gpuMs, scaleTheMeasuredFrameUsed);
+//   dynamicResolution.BeginFrame(cmd);
+//   ... render GetRenderExtent() pixels into GetColorTarget() / GetDepthBuffer(), after
+//   SetViewportAndScissor (pipelines need dynamic viewport and scissor) ...
+//   dynamicResolution.RecordUpscale(cmd, swapchainImage, swapchainExtent);
+// The targets are allocated once at the output extent; only the rendered area changes, so
+// changing the scale never reallocates or rebuilds pipelines.
+class DynamicResolution {
+public:
+    struct Settings {
+        // GPU time per frame the controller steers towards; leave headroom below the frame
+        // interval since the measurement lags the scale it was taken at
+        double targetGpuMs = 14.0;
+        float minScale = 0.5f;
+        float maxScale = 1.0f;
+        // Largest change of the scale per frame
+        float maxStep = 0.05f;
+        // Exponential smoothing of the measured time, 0..1 (1 takes every sample as-is)
+        double smoothing = 0.2;
+        // Predicted times within this fraction of the target leave the scale alone
+        double deadband = 0.05;
+    };
+
+    // Rendered extents are rounded to this many pixels
+    static constexpr uint32_t ExtentGranularity = 8;
+
+    DynamicResolution() = default;
+    ~DynamicResolution() = default;
+
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    // outputExtent is the largest render extent and the size RecordUpscale blits to
+    bool Initialize(VkExtent2D outputExtent, VkFormat colorFormat, VkFormat depthFormat,
+                    const Settings& settings);
+    void Cleanup();
+
+    // Feeds the GPU time of one frame and the scale that frame was rendered at. GPU time is
+    // assumed to grow with the rendered pixel count. Negative times are ignored.
+    void Update(double gpuMs, float renderedScale);
+
+    float GetScale() const { return m_scale; }
+    // The scale applied to the output extent, rounded to ExtentGranularity
+    VkExtent2D GetRenderExtent() const;
+    VkExtent2D GetOutputExtent() const { return m_outputExtent; }
+
+    ColorTarget& GetColorTarget() { return *m_colorTarget; }
+    DepthBuffer& GetDepthBuffer() { return *m_depthBuffer; }
+
+    // Transitions both targets for rendering; their previous contents are discarded
+    void BeginFrame(CommandBuffer& commandBuffer);
+    // Viewport (flipped like GraphicsPipelineBuilder::SetViewport) and scissor covering
+    // GetRenderExtent()
+    void SetViewportAndScissor(VkCommandBuffer commandBuffer) const;
+    // Blits the rendered area over all of dstImage, which is left in TRANSFER_DST_OPTIMAL
+    // (see ImageLayoutTransition::FromTransferDstToPresent)
+    void RecordUpscale(CommandBuffer& commandBuffer, VkImage dstImage, VkExtent2D dstExtent);
+
+private:
+    Settings m_settings;
+    VkExtent2D m_outputExtent{};
+    std::shared_ptr<ColorTarget> m_colorTarget;
+    std::shared_ptr<DepthBuffer> m_depthBuffer;
+    // NEAREST when the color format cannot be filtered linearly
+    VkFilter m_filter = VK_FILTER_LINEAR;
+
+    float m_scale = 1.0f;
+    // Smoothed GPU time projected to full resolution; negative until the first sample
+    double m_fullResolutionMs = -1.0;
+};
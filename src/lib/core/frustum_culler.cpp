@@ -0,0 +1,354 @@
+#include "frustum_culler.h"
+#include "core/job_system.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <new>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define FRUSTUM_CULLER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC emits SSE / AVX intrinsics without /arch flags
+#define FRUSTUM_CULLER_TARGET_SSE
+#define FRUSTUM_CULLER_TARGET_AVX2
+#else
+#include <cpuid.h>
+// Only these functions are compiled for the wider instruction sets; callers check the CPU first
+#define FRUSTUM_CULLER_TARGET_SSE __attribute__((target("sse2")))
+#define FRUSTUM_CULLER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+constexpr std::align_val_t StreamAlignment{64};
+constexpr uint32_t FloatsPerCacheLine = 16;
+
+uint32_t AlignUp(uint32_t value, uint32_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+using Streams = const float* const*;
+using Planes = const float (&)[6][4];
+using AbsNormals = const float (&)[6][3];
+
+// Box is outside a plane when its center is further behind it than its projected radius
+uint32_t CullScalar(Streams streams, Planes planes, AbsNormals absNormals, uint32_t begin,
+                    uint32_t end, uint32_t* out)
+{
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; ++i) {
+        bool visible = true;
+        for (uint32_t p = 0; p < 6; ++p) {
+            const float distance = planes[p][0] * streams[0][i] + planes[p][1] * streams[1][i] +
+                                   planes[p][2] * streams[2][i] + planes[p][3] +
+                                   absNormals[p][0] * streams[3][i] +
+                                   absNormals[p][1] * streams[4][i] +
+                                   absNormals[p][2] * streams[5][i];
+            // Written so NaN padding is never visible
+            visible &= distance >= 0.0f;
+        }
+        // Unconditional store; only visible objects advance the output
+        out[count] = i;
+        count += visible;
+    }
+    return count;
+}
+
+#if FRUSTUM_CULLER_X86
+
+FRUSTUM_CULLER_TARGET_SSE
+uint32_t CullSse(Streams streams, Planes planes, AbsNormals absNormals, uint32_t begin,
+                 uint32_t end, uint32_t* out)
+{
+    const __m128 zero = _mm_setzero_ps();
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i += 4) {
+        const __m128 cx = _mm_load_ps(streams[0] + i);
+        const __m128 cy = _mm_load_ps(streams[1] + i);
+        const __m128 cz = _mm_load_ps(streams[2] + i);
+        const __m128 ex = _mm_load_ps(streams[3] + i);
+        const __m128 ey = _mm_load_ps(streams[4] + i);
+        const __m128 ez = _mm_load_ps(streams[5] + i);
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (uint32_t p = 0; p < 6; ++p) {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p][0]), cx),
+                                         _mm_set1_ps(planes[p][3]));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes[p][1]), cy));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes[p][2]), cz));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(absNormals[p][0]), ex));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(absNormals[p][1]), ey));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(absNormals[p][2]), ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+        }
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            out[count] = i + lane;
+            count += (mask >> lane) & 1;
+        }
+    }
+    return count;
+}
+
+FRUSTUM_CULLER_TARGET_AVX2
+uint32_t CullAvx2(Streams streams, Planes planes, AbsNormals absNormals, uint32_t begin,
+                  uint32_t end, uint32_t* out)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    uint32_t count = 0;
+    // Chunks are multiples of 16 objects, so there is no 4-wide tail
+    for (uint32_t i = begin; i < end; i += 8) {
+        const __m256 cx = _mm256_load_ps(streams[0] + i);
+        const __m256 cy = _mm256_load_ps(streams[1] + i);
+        const __m256 cz = _mm256_load_ps(streams[2] + i);
+        const __m256 ex = _mm256_load_ps(streams[3] + i);
+        const __m256 ey = _mm256_load_ps(streams[4] + i);
+        const __m256 ez = _mm256_load_ps(streams[5] + i);
+        __m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+        for (uint32_t p = 0; p < 6; ++p) {
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p][0]), cx),
+                                            _mm256_set1_ps(planes[p][3]));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(planes[p][1]), cy));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(planes[p][2]), cz));
+            distance =
+                _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(absNormals[p][0]), ex));
+            distance =
+                _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(absNormals[p][1]), ey));
+            distance =
+                _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(absNormals[p][2]), ez));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+        }
+        const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+        for (uint32_t lane = 0; lane < 8; ++lane) {
+            out[count] = i + lane;
+            count += (mask >> lane) & 1;
+        }
+    }
+    return count;
+}
+
+void Cpuid(uint32_t leaf, uint32_t regs[4])
+{
+#if defined(_MSC_VER)
+    int values[4];
+    __cpuidex(values, static_cast<int>(leaf), 0);
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = static_cast<uint32_t>(values[i]);
+    }
+#else
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// XCR0: which register states the OS saves on context switch
+uint64_t ReadXcr0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t low = 0, high = 0;
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return (uint64_t(high) << 32) | low;
+#endif
+}
+
+FrustumCuller::Path DetectPath()
+{
+    uint32_t regs[4] = {};
+    Cpuid(0, regs);
+    const uint32_t maxLeaf = regs[0];
+    Cpuid(1, regs);
+    const bool sse2 = (regs[3] & (1u << 26)) != 0;
+    const bool osxsave = (regs[2] & (1u << 27)) != 0;
+    const bool avx = (regs[2] & (1u << 28)) != 0;
+    // AVX also needs the OS to preserve the YMM registers
+    if (avx && osxsave && (ReadXcr0() & 0x6) == 0x6 && maxLeaf >= 7) {
+        Cpuid(7, regs);
+        if ((regs[1] & (1u << 5)) != 0) {
+            return FrustumCuller::Path::AVX2;
+        }
+    }
+    return sse2 ? FrustumCuller::Path::SSE : FrustumCuller::Path::Scalar;
+}
+
+#else
+
+FrustumCuller::Path DetectPath()
+{
+    return FrustumCuller::Path::Scalar;
+}
+
+#endif
+
+} // namespace
+
+FrustumCuller::FrustumCuller(JobSystem* jobSystem)
+    : m_jobSystem(jobSystem)
+{
+    m_path = GetBestPath();
+}
+
+FrustumCuller::~FrustumCuller()
+{
+    ::operator delete(m_bounds, StreamAlignment);
+}
+
+uint32_t FrustumCuller::GetThreadCount() const
+{
+    return m_jobSystem ? m_jobSystem->GetThreadCount() : 1;
+}
+
+void FrustumCuller::SetObjectCount(uint32_t count)
+{
+    const uint32_t required = AlignUp(count, FloatsPerCacheLine);
+    if (required > m_capacity) {
+        Reallocate(std::max(required, m_capacity * 2));
+    }
+    // Removed and newly added slots are invisible until their bounds are set
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const uint32_t first = std::min(count, m_objectCount);
+    const uint32_t last = std::max(count, m_objectCount);
+    for (uint32_t stream = CenterX; stream <= CenterZ; ++stream) {
+        std::fill(GetStream(Stream(stream)) + first, GetStream(Stream(stream)) + last, nan);
+    }
+    m_objectCount = count;
+}
+
+void FrustumCuller::SetBounds(uint32_t index, const float min[3], const float max[3])
+{
+    for (uint32_t axis = 0; axis < 3; ++axis) {
+        GetStream(Stream(CenterX + axis))[index] = (min[axis] + max[axis]) * 0.5f;
+        GetStream(Stream(ExtentX + axis))[index] = (max[axis] - min[axis]) * 0.5f;
+    }
+}
+
+void FrustumCuller::Reallocate(uint32_t capacity)
+{
+    auto* bounds = static_cast<float*>(
+        ::operator new(size_t(capacity) * StreamCount * sizeof(float), StreamAlignment));
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    for (uint32_t stream = 0; stream < StreamCount; ++stream) {
+        float* dst = bounds + size_t(stream) * capacity;
+        if (m_objectCount > 0) {
+            std::memcpy(dst, GetStream(Stream(stream)), m_objectCount * sizeof(float));
+        }
+        std::fill(dst + m_objectCount, dst + capacity, stream <= CenterZ ? nan : 0.0f);
+    }
+    ::operator delete(m_bounds, StreamAlignment);
+    m_bounds = bounds;
+    m_capacity = capacity;
+    m_visible.resize(capacity);
+}
+
+std::span<const uint32_t> FrustumCuller::Cull(const float* viewProjection)
+{
+    if (m_objectCount == 0) {
+        return {};
+    }
+    ExtractFrustumPlanes(viewProjection, m_frustum.planes);
+    for (uint32_t p = 0; p < 6; ++p) {
+        for (uint32_t axis = 0; axis < 3; ++axis) {
+            m_frustum.absNormals[p][axis] = std::abs(m_frustum.planes[p][axis]);
+        }
+    }
+
+    const uint32_t paddedCount = AlignUp(m_objectCount, FloatsPerCacheLine);
+    m_chunkCount = (paddedCount + ChunkSize - 1) / ChunkSize;
+    m_chunkVisible.resize(m_chunkCount);
+    if (m_jobSystem) {
+        m_jobSystem->ParallelFor(m_chunkCount, 1, [this](uint32_t begin, uint32_t end) {
+            CullChunks(begin, end);
+        });
+    } else {
+        CullChunks(0, m_chunkCount);
+    }
+
+    // Chunks are in object order, so the compacted list stays ascending
+    uint32_t visibleCount = m_chunkVisible[0];
+    for (uint32_t chunk = 1; chunk < m_chunkCount; ++chunk) {
+        std::memmove(m_visible.data() + visibleCount, m_visible.data() + chunk * ChunkSize,
+                     m_chunkVisible[chunk] * sizeof(uint32_t));
+        visibleCount += m_chunkVisible[chunk];
+    }
+    return {m_visible.data(), visibleCount};
+}
+
+void FrustumCuller::CullChunks(uint32_t firstChunk, uint32_t lastChunk)
+{
+    const uint32_t paddedCount = AlignUp(m_objectCount, FloatsPerCacheLine);
+    for (uint32_t chunk = firstChunk; chunk < lastChunk; ++chunk) {
+        const uint32_t begin = chunk * ChunkSize;
+        const uint32_t end = std::min(begin + ChunkSize, paddedCount);
+        m_chunkVisible[chunk] = CullRange(begin, end, m_visible.data() + begin);
+    }
+}
+
+uint32_t FrustumCuller::CullRange(uint32_t begin, uint32_t end, uint32_t* out) const
+{
+    const float* streams[StreamCount];
+    for (uint32_t stream = 0; stream < StreamCount; ++stream) {
+        streams[stream] = GetStream(Stream(stream));
+    }
+    switch (m_path) {
+#if FRUSTUM_CULLER_X86
+    case Path::AVX2:
+        return CullAvx2(streams, m_frustum.planes, m_frustum.absNormals, begin, end, out);
+    case Path::SSE:
+        return CullSse(streams, m_frustum.planes, m_frustum.absNormals, begin, end, out);
+#endif
+    default:
+        return CullScalar(streams, m_frustum.planes, m_frustum.absNormals, begin, end, out);
+    }
+}
+
+void FrustumCuller::SetPath(Path path)
+{
+    m_path = path <= GetBestPath() ? path : GetBestPath();
+}
+
+FrustumCuller::Path FrustumCuller::GetBestPath()
+{
+    static const Path best = DetectPath();
+    return best;
+}
+
+const char* FrustumCuller::GetPathName(Path path)
+{
+    switch (path) {
+    case Path::Scalar:
+        return "scalar";
+    case Path::SSE:
+        return "SSE";
+    case Path::AVX2:
+        return "AVX2";
+    }
+    return "unknown";
+}
+
+void FrustumCuller::ExtractFrustumPlanes(const float* m, float planes[6][4])
+{
+    // Rows of the column-major matrix; clip space is x,y in [-w, w] and z in [0, w]
+    auto row = [m](int r, int c) { return m[c * 4 + r]; };
+    for (int c = 0; c < 4; ++c) {
+        planes[0][c] = row(3, c) + row(0, c); // left
+        planes[1][c] = row(3, c) - row(0, c); // right
+        planes[2][c] = row(3, c) + row(1, c); // bottom
+        planes[3][c] = row(3, c) - row(1, c); // top
+        planes[4][c] = row(2, c);             // near
+        planes[5][c] = row(3, c) - row(2, c); // far
+    }
+    // Normalized so distances compare directly with sphere radii and box extents
+    for (int p = 0; p < 6; ++p) {
+        const float length = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] +
+                                       planes[p][2] * planes[p][2]);
+        if (length > 0.0f) {
+            for (int c = 0; c < 4; ++c) {
+                planes[p][c] /= length;
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class JobSystem;
+
+// CPU frustum culling of axis-aligned bounding boxes. Bounds are stored as structure-of-arrays
+// float streams (center x/y/z, half extent x/y/z), 64-byte aligned, and tested 8 boxes per
+// iteration with AVX2, 4 with SSE, or one at a time, whichever the CPU supports. Large sets
+// are split into ChunkSize-object chunks that start on cache-line boundaries and are culled
+// in parallel on a JobSystem; the result is a compact, ascending list of visible indices:
+//   culler.SetObjectCount(count);
+//   culler.SetBounds(i, min, max);
+//   for (uint32_t index : culler.Cull(viewProjection)) { queue.Submit(...); }
+class FrustumCuller {
+public:
+    enum class Path {
+        Scalar,
+        SSE,
+        AVX2,
+    };
+
+    // Objects per work item; a multiple of 16 so every stream slice is cache-line aligned
+    static constexpr uint32_t ChunkSize = 4096;
+
+    // Chunks are spread over jobSystem's threads; nullptr culls on the calling thread only
+    explicit FrustumCuller(JobSystem* jobSystem = nullptr);
+    ~FrustumCuller();
+
+    FrustumCuller(const FrustumCuller&) = delete;
+    FrustumCuller& operator=(const FrustumCuller&) = delete;
+
+    // Keeps the bounds of the first min(old, new) objects
+    void SetObjectCount(uint32_t count);
+    void SetBounds(uint32_t index, const float min[3], const float max[3]);
+    uint32_t GetObjectCount() const { return m_objectCount; }
+
+    // Visible object indices, valid until the next Cull or SetObjectCount. viewProjection is
+    // a column-major 4x4 matrix with 0..1 clip depth.
+    std::span<const uint32_t> Cull(const float* viewProjection);
+
+    // Defaults to the best supported path; unsupported requests fall back to it
+    void SetPath(Path path);
+    Path GetPath() const { return m_path; }
+    static Path GetBestPath();
+    static const char* GetPathName(Path path);
+
+    // Threads a Cull runs on, including the caller
+    uint32_t GetThreadCount() const;
+
+    // Normalized planes (left, right, bottom, top, near, far) as (nx, ny, nz, d), inside
+    // when dot(n, p) + d >= 0
+    static void ExtractFrustumPlanes(const float* m, float planes[6][4]);
+
+private:
+    enum Stream : uint32_t {
+        CenterX,
+        CenterY,
+        CenterZ,
+        ExtentX,
+        ExtentY,
+        ExtentZ,
+        StreamCount,
+    };
+
+    // Planes with |n| precomputed for the box radius term
+    struct Frustum {
+        float planes[6][4];
+        float absNormals[6][3];
+    };
+
+    void Reallocate(uint32_t capacity);
+    const float* GetStream(Stream stream) const { return m_bounds + size_t(stream) * m_capacity; }
+    float* GetStream(Stream stream) { return m_bounds + size_t(stream) * m_capacity; }
+
+    void CullChunks(uint32_t firstChunk, uint32_t lastChunk);
+    uint32_t CullRange(uint32_t begin, uint32_t end, uint32_t* out) const;
+
+    uint32_t m_objectCount = 0;
+    // Object slots per stream, a multiple of 16; slots past m_objectCount hold NaN centers,
+    // which fail every plane test
+    uint32_t m_capacity = 0;
+    float* m_bounds = nullptr;
+    Path m_path = Path::Scalar;
+
+    JobSystem* m_jobSystem = nullptr;
+
+    // Per-Cull state shared with the jobs
+    Frustum m_frustum{};
+    uint32_t m_chunkCount = 0;
+    std::vector<uint32_t> m_chunkVisible;
+    // Each chunk writes its visible indices at its own offset; compacted after the join
+    std::vector<uint32_t> m_visible;
+};
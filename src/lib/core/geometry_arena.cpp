@@ -0,0 +1,145 @@
+#include "geometry_arena.h"
+#include "core/command_buffer.h"
+#include <cstring>
+
+bool GeometryArena::Initialize(uint32_t vertexStride, uint32_t maxVertices, uint32_t maxIndices)
+{
+    m_vertexStride = vertexStride;
+    m_vertexBuffer = VertexBuffer::Create(VkDeviceSize(maxVertices) * vertexStride,
+                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_indexBuffer = IndexBuffer::Create(VkDeviceSize(maxIndices) * sizeof(uint32_t),
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (!m_vertexBuffer || !m_indexBuffer) {
+        Cleanup();
+        return false;
+    }
+    m_vertexBuffer->SetDebugName("GeometryArena vertices");
+    m_indexBuffer->SetDebugName("GeometryArena indices");
+
+    m_ranges = std::make_shared<Ranges>();
+    m_ranges->vertices.Initialize(maxVertices);
+    m_ranges->indices.Initialize(maxIndices);
+    return true;
+}
+
+void GeometryArena::Cleanup()
+{
+    m_vertexBuffer.reset();
+    m_indexBuffer.reset();
+    // Frees still pending keep the old ranges alive and only update those
+    m_ranges.reset();
+}
+
+GeometryAllocation GeometryArena::Allocate(uint32_t vertexCount, uint32_t indexCount)
+{
+    if (!m_ranges) {
+        return GeometryAllocation{};
+    }
+    auto& ranges = *m_ranges;
+    std::lock_guard lock(ranges.mutex);
+    GeometryAllocation allocation{};
+    allocation.firstVertex = ranges.vertices.Allocate(vertexCount);
+    if (allocation.firstVertex == RangeAllocator::InvalidOffset) {
+        return GeometryAllocation{};
+    }
+    // RangeAllocator rejects empty ranges; non-indexed meshes need no index space
+    allocation.firstIndex = indexCount > 0 ? ranges.indices.Allocate(indexCount) : 0;
+    if (allocation.firstIndex == RangeAllocator::InvalidOffset) {
+        ranges.vertices.Free(allocation.firstVertex, vertexCount);
+        return GeometryAllocation{};
+    }
+    allocation.vertexCount = vertexCount;
+    allocation.indexCount = indexCount;
+    return allocation;
+}
+
+void GeometryArena::Free(const GeometryAllocation& allocation)
+{
+    if (!allocation.IsValid() || !m_ranges) {
+        return;
+    }
+    // Recorded frames may still read the ranges
+    VulkanContext::Get().DeferDestroy(
+        [ranges = m_ranges, allocation] { FreeRanges(*ranges, allocation); });
+}
+
+void GeometryArena::FreeUnused(const GeometryAllocation& allocation)
+{
+    if (allocation.IsValid() && m_ranges) {
+        FreeRanges(*m_ranges, allocation);
+    }
+}
+
+void GeometryArena::FreeRanges(Ranges& ranges, const GeometryAllocation& allocation)
+{
+    std::lock_guard lock(ranges.mutex);
+    ranges.vertices.Free(allocation.firstVertex, allocation.vertexCount);
+    if (allocation.indexCount > 0) {
+        ranges.indices.Free(allocation.firstIndex, allocation.indexCount);
+    }
+}
+
+void GeometryArena::RecordUpload(CommandBuffer& commandBuffer, const StagingBuffer& staging,
+                                 VkDeviceSize vertexSrcOffset, VkDeviceSize indexSrcOffset,
+                                 const GeometryAllocation& allocation)
+{
+    VkBufferCopy vertexCopy{
+        .srcOffset = vertexSrcOffset,
+        .dstOffset = VkDeviceSize(allocation.firstVertex) * m_vertexStride,
+        .size = VkDeviceSize(allocation.vertexCount) * m_vertexStride,
+    };
+    vkCmdCopyBuffer(commandBuffer, staging.GetVkBuffer(), m_vertexBuffer->GetVkBuffer(), 1,
+                    &vertexCopy);
+    if (allocation.indexCount > 0) {
+        VkBufferCopy indexCopy{
+            .srcOffset = indexSrcOffset,
+            .dstOffset = VkDeviceSize(allocation.firstIndex) * sizeof(uint32_t),
+            .size = VkDeviceSize(allocation.indexCount) * sizeof(uint32_t),
+        };
+        vkCmdCopyBuffer(commandBuffer, staging.GetVkBuffer(), m_indexBuffer->GetVkBuffer(), 1,
+                        &indexCopy);
+    }
+
+    VkMemoryBarrier barrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT,
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &barrier, 0, nullptr, 0,
+                         nullptr);
+}
+
+bool GeometryArena::Upload(const GeometryAllocation& allocation, const void* vertices,
+                           const uint32_t* indices)
+{
+    const VkDeviceSize vertexBytes = VkDeviceSize(allocation.vertexCount) * m_vertexStride;
+    const VkDeviceSize indexBytes = VkDeviceSize(allocation.indexCount) * sizeof(uint32_t);
+    const VkDeviceSize indexOffset = (vertexBytes + 3) & ~VkDeviceSize(3);
+    auto staging = StagingBuffer::Create(indexOffset + indexBytes);
+    if (!staging) {
+        return false;
+    }
+    auto* mapped = static_cast<uint8_t*>(staging->Map());
+    std::memcpy(mapped, vertices, static_cast<size_t>(vertexBytes));
+    if (indexBytes > 0) {
+        std::memcpy(mapped + indexOffset, indices, static_cast<size_t>(indexBytes));
+    }
+    staging->Unmap();
+
+    auto& vulkanCtx = VulkanContext::Get();
+    auto commandBuffer = vulkanCtx.CreateCommandBuffer();
+    commandBuffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    RecordUpload(*commandBuffer, *staging, 0, indexOffset, allocation);
+    commandBuffer->End();
+    vulkanCtx.SubmitAndWait(commandBuffer);
+    return true;
+}
+
+void GeometryArena::Bind(VkCommandBuffer commandBuffer) const
+{
+    VkBuffer vertexBuffer = m_vertexBuffer->GetVkBuffer();
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+    vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer->GetVkBuffer(), 0, VK_INDEX_TYPE_UINT32);
+}
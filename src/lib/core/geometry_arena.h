@@ -0,0 +1,76 @@
+#pragma once
+#include "core/buffer_resource.h"
+#include "core/range_allocator.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+class CommandBuffer;
+
+// Sub-range of the arena's shared buffers. Indices are relative to firstVertex, which is
+// passed as vertexOffset:
+//   vkCmdDrawIndexed(cmd, indexCount, 1, firstIndex, int32_t(firstVertex), 0);
+// Non-indexed meshes have indexCount == 0 and firstIndex == 0.
+struct GeometryAllocation {
+    uint32_t firstVertex = RangeAllocator::InvalidOffset;
+    uint32_t vertexCount = 0;
+    uint32_t firstIndex = RangeAllocator::InvalidOffset;
+    uint32_t indexCount = 0;
+
+    bool IsValid() const { return firstVertex != RangeAllocator::InvalidOffset; }
+};
+
+// One device-local vertex buffer and one uint32 index buffer shared by every mesh of a
+// vertex format, so all of them draw with a single bind (and can be batched into
+// multi-draw / indirect calls).
+class GeometryArena {
+public:
+    GeometryArena() = default;
+    ~GeometryArena() = default;
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    bool Initialize(uint32_t vertexStride, uint32_t maxVertices, uint32_t maxIndices);
+    void Cleanup();
+
+    // Invalid allocation when either buffer is out of space. Thread-safe.
+    GeometryAllocation Allocate(uint32_t vertexCount, uint32_t indexCount);
+    // Ranges are reused once every frame in flight has finished with them. Render thread.
+    void Free(const GeometryAllocation& allocation);
+    // Reuses the ranges at once; only for ranges no submitted frame has drawn from, e.g. a load
+    // dropped before delivery. Thread-safe.
+    void FreeUnused(const GeometryAllocation& allocation);
+
+    // Records copies from staging (vertices at vertexSrcOffset, uint32 indices at
+    // indexSrcOffset) into the allocation, followed by a barrier for vertex input
+    void RecordUpload(CommandBuffer& commandBuffer, const StagingBuffer& staging,
+                      VkDeviceSize vertexSrcOffset, VkDeviceSize indexSrcOffset,
+                      const GeometryAllocation& allocation);
+    // Stages and uploads synchronously
+    bool Upload(const GeometryAllocation& allocation, const void* vertices, const uint32_t* indices);
+
+    // Binds the vertex buffer at binding 0 and the index buffer
+    void Bind(VkCommandBuffer commandBuffer) const;
+
+    uint32_t GetVertexStride() const { return m_vertexStride; }
+    const std::shared_ptr<VertexBuffer>& GetVertexBuffer() const { return m_vertexBuffer; }
+    const std::shared_ptr<IndexBuffer>& GetIndexBuffer() const { return m_indexBuffer; }
+
+private:
+    uint32_t m_vertexStride = 0;
+    std::shared_ptr<VertexBuffer> m_vertexBuffer;
+    std::shared_ptr<IndexBuffer> m_indexBuffer;
+
+    // Shared with pending deferred frees, which may run after Cleanup or the arena's
+    // destruction (VulkanContext::Cleanup flushes them last)
+    struct Ranges {
+        std::mutex mutex;
+        RangeAllocator vertices;
+        RangeAllocator indices;
+    };
+    std::shared_ptr<Ranges> m_ranges;
+
+    static void FreeRanges(Ranges& ranges, const GeometryAllocation& allocation);
+};
@@ -0,0 +1,680 @@
+#include "gltf_loader.h"
+#include "core/asset_archive.h"
+#include "core/buffer_resource.h"
+#include "core/job_system.h"
+#include "core/json_reader.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+constexpr uint32_t GlbMagic = 0x46546C67;     // "glTF"
+constexpr uint32_t GlbChunkJson = 0x4E4F534A; // "JSON"
+constexpr uint32_t GlbChunkBin = 0x004E4942;  // "BIN\0"
+constexpr uint32_t ModeTriangles = 4;
+
+enum ComponentType : uint32_t {
+    Byte = 5120,
+    UnsignedByte = 5121,
+    Short = 5122,
+    UnsignedShort = 5123,
+    UnsignedInt = 5125,
+    Float = 5126,
+};
+
+struct Buffer {
+    std::string uri;
+    uint64_t byteLength = 0;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+struct BufferView {
+    uint32_t buffer = 0;
+    uint64_t byteOffset = 0;
+    uint64_t byteLength = 0;
+    uint32_t byteStride = 0;
+};
+
+struct Accessor {
+    int32_t bufferView = -1;
+    uint64_t byteOffset = 0;
+    uint32_t componentType = Float;
+    bool normalized = false;
+    uint32_t count = 0;
+    uint32_t components = 1;
+    bool sparse = false;
+};
+
+struct Primitive {
+    std::vector<std::pair<std::string, uint32_t>> attributes;
+    int32_t indices = -1;
+    uint32_t mode = ModeTriangles;
+    int32_t material = -1;
+};
+
+struct Mesh {
+    std::string name;
+    std::vector<Primitive> primitives;
+};
+
+struct Document {
+    std::vector<Buffer> buffers;
+    std::vector<BufferView> bufferViews;
+    std::vector<Accessor> accessors;
+    std::vector<Mesh> meshes;
+};
+
+// Resolved accessor: first element and distance between elements
+struct AccessorData {
+    const uint8_t* data = nullptr;
+    uint32_t stride = 0;
+    uint32_t count = 0;
+    uint32_t componentType = Float;
+    uint32_t components = 1;
+    bool normalized = false;
+};
+
+double ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+uint32_t GetComponentSize(uint32_t componentType)
+{
+    switch (componentType) {
+    case Byte:
+    case UnsignedByte:
+        return 1;
+    case Short:
+    case UnsignedShort:
+        return 2;
+    case UnsignedInt:
+    case Float:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+uint32_t GetComponentCount(std::string_view type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT2") return 4;
+    if (type == "MAT3") return 9;
+    if (type == "MAT4") return 16;
+    return 0;
+}
+
+// ---- JSON ----
+
+template <typename T, typename ParseElement>
+bool ParseArray(JsonReader& reader, std::vector<T>& out, ParseElement parseElement)
+{
+    if (!reader.BeginArray()) {
+        return false;
+    }
+    while (reader.NextElement()) {
+        T& element = out.emplace_back();
+        if (!reader.BeginObject()) {
+            return false;
+        }
+        std::string_view key;
+        while (reader.NextMember(key)) {
+            if (!parseElement(key, element)) {
+                return false;
+            }
+        }
+    }
+    return !reader.HasError();
+}
+
+bool ParseUint64(JsonReader& reader, uint64_t& value)
+{
+    double number = 0.0;
+    if (!reader.ReadNumber(number) || number < 0.0) {
+        return false;
+    }
+    value = static_cast<uint64_t>(number);
+    return true;
+}
+
+bool ParsePrimitive(JsonReader& reader, std::string_view key, Primitive& primitive)
+{
+    if (key == "attributes") {
+        if (!reader.BeginObject()) {
+            return false;
+        }
+        std::string_view semantic;
+        while (reader.NextMember(semantic)) {
+            uint32_t accessor = 0;
+            if (!reader.ReadUint(accessor)) {
+                return false;
+            }
+            primitive.attributes.emplace_back(std::string(semantic), accessor);
+        }
+        return !reader.HasError();
+    }
+    if (key == "indices") return reader.ReadInt(primitive.indices);
+    if (key == "mode") return reader.ReadUint(primitive.mode);
+    if (key == "material") return reader.ReadInt(primitive.material);
+    return reader.SkipValue();
+}
+
+bool ParseDocument(std::string_view json, Document& doc)
+{
+    JsonReader reader(json);
+    if (!reader.BeginObject()) {
+        return false;
+    }
+    std::string_view section;
+    while (reader.NextMember(section)) {
+        bool ok = true;
+        if (section == "buffers") {
+            ok = ParseArray(reader, doc.buffers, [&](std::string_view key, Buffer& buffer) {
+                if (key == "uri") return reader.ReadString(buffer.uri);
+                if (key == "byteLength") return ParseUint64(reader, buffer.byteLength);
+                return reader.SkipValue();
+            });
+        }
+        else if (section == "bufferViews") {
+            ok = ParseArray(reader, doc.bufferViews, [&](std::string_view key, BufferView& view) {
+                if (key == "buffer") return reader.ReadUint(view.buffer);
+                if (key == "byteOffset") return ParseUint64(reader, view.byteOffset);
+                if (key == "byteLength") return ParseUint64(reader, view.byteLength);
+                if (key == "byteStride") return reader.ReadUint(view.byteStride);
+                return reader.SkipValue();
+            });
+        }
+        else if (section == "accessors") {
+            ok = ParseArray(reader, doc.accessors, [&](std::string_view key, Accessor& accessor) {
+                if (key == "bufferView") return reader.ReadInt(accessor.bufferView);
+                if (key == "byteOffset") return ParseUint64(reader, accessor.byteOffset);
+                if (key == "componentType") return reader.ReadUint(accessor.componentType);
+                if (key == "normalized") return reader.ReadBool(accessor.normalized);
+                if (key == "count") return reader.ReadUint(accessor.count);
+                if (key == "type") {
+                    std::string type;
+                    if (!reader.ReadString(type)) {
+                        return false;
+                    }
+                    accessor.components = GetComponentCount(type);
+                    return accessor.components != 0;
+                }
+                if (key == "sparse") {
+                    accessor.sparse = true;
+                }
+                return reader.SkipValue();
+            });
+        }
+        else if (section == "meshes") {
+            ok = ParseArray(reader, doc.meshes, [&](std::string_view key, Mesh& mesh) {
+                if (key == "name") return reader.ReadString(mesh.name);
+                if (key == "primitives") {
+                    return ParseArray(reader, mesh.primitives,
+                                      [&](std::string_view primitiveKey, Primitive& primitive) {
+                                          return ParsePrimitive(reader, primitiveKey, primitive);
+                                      });
+                }
+                return reader.SkipValue();
+            });
+        }
+        else {
+            // Scenes, nodes, materials, ... are not needed for geometry
+            ok = reader.SkipValue();
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return !reader.HasError();
+}
+
+// ---- Buffers ----
+
+std::string DecodeUri(std::string_view uri)
+{
+    std::string path;
+    for (size_t i = 0; i < uri.size(); ++i) {
+        unsigned value = 0;
+        if (uri[i] == '%' && i + 2 < uri.size() &&
+            std::from_chars(uri.data() + i + 1, uri.data() + i + 3, value, 16).ptr == uri.data() + i + 3) {
+            path.push_back(static_cast<char>(value));
+            i += 2;
+        }
+        else {
+            path.push_back(uri[i]);
+        }
+    }
+    return path;
+}
+
+bool ResolveAccessor(const Document& doc, uint32_t index, AccessorData& out)
+{
+    if (index >= doc.accessors.size()) {
+        return false;
+    }
+    const auto& accessor = doc.accessors[index];
+    const uint32_t elementSize = GetComponentSize(accessor.componentType) * accessor.components;
+    if (accessor.sparse || accessor.bufferView < 0 || elementSize == 0 ||
+        static_cast<size_t>(accessor.bufferView) >= doc.bufferViews.size()) {
+        return false;
+    }
+    const auto& view = doc.bufferViews[accessor.bufferView];
+    if (view.buffer >= doc.buffers.size()) {
+        return false;
+    }
+    const auto& buffer = doc.buffers[view.buffer];
+    const uint32_t stride = view.byteStride != 0 ? view.byteStride : elementSize;
+    const uint64_t used = accessor.count == 0
+                              ? 0
+                              : accessor.byteOffset + uint64_t(stride) * (accessor.count - 1) + elementSize;
+    if (used > view.byteLength || view.byteOffset + view.byteLength > buffer.size) {
+        return false;
+    }
+    out = AccessorData{
+        .data = buffer.data + view.byteOffset + accessor.byteOffset,
+        .stride = stride,
+        .count = accessor.count,
+        .componentType = accessor.componentType,
+        .components = accessor.components,
+        .normalized = accessor.normalized,
+    };
+    return true;
+}
+
+// ---- Decode ----
+
+float ReadComponent(const uint8_t* src, uint32_t componentType, bool normalized)
+{
+    switch (componentType) {
+    case Float: {
+        float value;
+        std::memcpy(&value, src, sizeof(value));
+        return value;
+    }
+    case Byte: {
+        auto value = static_cast<int8_t>(*src);
+        return normalized ? std::max(value / 127.0f, -1.0f) : value;
+    }
+    case UnsignedByte:
+        return normalized ? *src / 255.0f : *src;
+    case Short: {
+        int16_t value;
+        std::memcpy(&value, src, sizeof(value));
+        return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+    }
+    case UnsignedShort: {
+        uint16_t value;
+        std::memcpy(&value, src, sizeof(value));
+        return normalized ? value / 65535.0f : value;
+    }
+    case UnsignedInt: {
+        uint32_t value;
+        std::memcpy(&value, src, sizeof(value));
+        return static_cast<float>(value);
+    }
+    default:
+        return 0.0f;
+    }
+}
+
+struct PrimitiveJob {
+    const Primitive* primitive = nullptr;
+    GltfPrimitive* output = nullptr;
+    AccessorData position;
+};
+
+bool DecodePrimitive(const Document& doc, const GltfVertexLayout& layout, const PrimitiveJob& job,
+                     uint8_t* vertices, uint32_t* indices)
+{
+    const auto& out = *job.output;
+    uint8_t* firstVertex = vertices + size_t(out.firstVertex) * layout.stride;
+
+    for (const auto& attribute : layout.attributes) {
+        AccessorData source{};
+        bool found = false;
+        for (const auto& [semantic, accessor] : job.primitive->attributes) {
+            if (semantic == attribute.semantic) {
+                if (!ResolveAccessor(doc, accessor, source) || source.count != out.vertexCount) {
+                    return false;
+                }
+                found = true;
+                break;
+            }
+        }
+
+        uint8_t* dst = firstVertex + attribute.offset;
+        if (!found) {
+            for (uint32_t v = 0; v < out.vertexCount; ++v, dst += layout.stride) {
+                std::memcpy(dst, attribute.defaultValue, attribute.components * sizeof(float));
+            }
+            continue;
+        }
+
+        const uint32_t copied = std::min(attribute.components, source.components);
+        const uint32_t componentSize = GetComponentSize(source.componentType);
+        const uint8_t* src = source.data;
+        for (uint32_t v = 0; v < out.vertexCount; ++v, src += source.stride, dst += layout.stride) {
+            float value[4];
+            if (source.componentType == Float) {
+                std::memcpy(value, src, copied * sizeof(float));
+            }
+            else {
+                for (uint32_t c = 0; c < copied; ++c) {
+                    value[c] = ReadComponent(src + c * componentSize, source.componentType,
+                                             source.normalized);
+                }
+            }
+            for (uint32_t c = copied; c < attribute.components; ++c) {
+                value[c] = attribute.defaultValue[c];
+            }
+            std::memcpy(dst, value, attribute.components * sizeof(float));
+        }
+    }
+
+    uint32_t* dstIndices = indices + out.firstIndex;
+    if (job.primitive->indices < 0) {
+        for (uint32_t i = 0; i < out.indexCount; ++i) {
+            dstIndices[i] = i;
+        }
+        return true;
+    }
+    AccessorData source{};
+    ResolveAccessor(doc, static_cast<uint32_t>(job.primitive->indices), source);
+    const uint8_t* src = source.data;
+    switch (source.componentType) {
+    case UnsignedByte:
+        for (uint32_t i = 0; i < out.indexCount; ++i, src += source.stride) {
+            dstIndices[i] = *src;
+        }
+        break;
+    case UnsignedShort:
+        for (uint32_t i = 0; i < out.indexCount; ++i, src += source.stride) {
+            uint16_t index;
+            std::memcpy(&index, src, sizeof(index));
+            dstIndices[i] = index;
+        }
+        break;
+    default:
+        if (source.stride == sizeof(uint32_t)) {
+            std::memcpy(dstIndices, src, size_t(out.indexCount) * sizeof(uint32_t));
+        }
+        else {
+            for (uint32_t i = 0; i < out.indexCount; ++i, src += source.stride) {
+                std::memcpy(&dstIndices[i], src, sizeof(uint32_t));
+            }
+        }
+        break;
+    }
+    for (uint32_t i = 0; i < out.indexCount; ++i) {
+        if (dstIndices[i] >= out.vertexCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Fail(const std::filesystem::path& path, const char* message)
+{
+    std::cerr << "[gltf] " << path.filename().string() << ": " << message << std::endl;
+    return false;
+}
+
+// Parses the container's JSON and points every buffer at its bytes: the GLB binary chunk or
+// files.buffers[i], which are mapped here when mapBuffers is set
+bool OpenDocument(const std::filesystem::path& path, GltfFiles& files, bool mapBuffers,
+                  Document& doc)
+{
+    const AssetData& file = files.file;
+    std::string_view json;
+    const uint8_t* glbBinary = nullptr;
+    size_t glbBinarySize = 0;
+    uint32_t magic = 0;
+    if (file.GetSize() >= 12) {
+        std::memcpy(&magic, file.GetData(), sizeof(magic));
+    }
+    if (magic == GlbMagic) {
+        size_t offset = 12;
+        while (offset + 8 <= file.GetSize()) {
+            uint32_t chunk[2];
+            std::memcpy(chunk, file.GetData() + offset, sizeof(chunk));
+            offset += 8;
+            if (offset + chunk[0] > file.GetSize()) {
+                return Fail(path, "truncated GLB chunk");
+            }
+            if (chunk[1] == GlbChunkJson && json.empty()) {
+                json = {reinterpret_cast<const char*>(file.GetData() + offset), chunk[0]};
+            }
+            else if (chunk[1] == GlbChunkBin && glbBinary == nullptr) {
+                glbBinary = file.GetData() + offset;
+                glbBinarySize = chunk[0];
+            }
+            offset += (chunk[0] + 3) & ~3u;
+        }
+    }
+    else {
+        json = {reinterpret_cast<const char*>(file.GetData()), file.GetSize()};
+    }
+
+    if (json.empty() || !ParseDocument(json, doc)) {
+        return Fail(path, "invalid glTF JSON");
+    }
+
+    // External buffers are mapped too (or viewed in the asset archive), so decode reads
+    // straight from the page cache
+    if (mapBuffers) {
+        files.buffers.clear();
+        files.buffers.resize(doc.buffers.size());
+    }
+    else if (files.buffers.size() != doc.buffers.size()) {
+        return Fail(path, "buffers were not read");
+    }
+    for (size_t i = 0; i < doc.buffers.size(); ++i) {
+        auto& buffer = doc.buffers[i];
+        if (buffer.uri.empty()) {
+            if (i != 0 || glbBinary == nullptr) {
+                return Fail(path, "buffer without uri outside a GLB");
+            }
+            buffer.data = glbBinary;
+            buffer.size = glbBinarySize;
+        }
+        else if (buffer.uri.starts_with("data:")) {
+            return Fail(path, "data: URIs are not supported");
+        }
+        else {
+            if (mapBuffers &&
+                !LoadAsset(path.parent_path() / DecodeUri(buffer.uri), files.buffers[i])) {
+                return Fail(path, "cannot open buffer file");
+            }
+            buffer.data = files.buffers[i].GetData();
+            buffer.size = files.buffers[i].GetSize();
+        }
+        if (buffer.size < buffer.byteLength) {
+            return Fail(path, "buffer shorter than byteLength");
+        }
+    }
+    return true;
+}
+
+// Everything after OpenDocument; parseStart is when parsing began, for the stats
+bool DecodeDocument(const std::filesystem::path& path, const Document& doc,
+                    const GltfVertexLayout& layout, GltfModel& model, JobSystem* jobSystem,
+                    std::chrono::steady_clock::time_point parseStart);
+
+} // namespace
+
+namespace loader {
+
+bool ReadGltfFiles(const std::filesystem::path& path, GltfFiles& files)
+{
+    files = GltfFiles{};
+    if (!LoadAsset(path, files.file)) {
+        return Fail(path, "cannot open file");
+    }
+    Document doc;
+    return OpenDocument(path, files, true, doc);
+}
+
+bool LoadGltf(const std::filesystem::path& path, GltfFiles& files,
+              const GltfVertexLayout& layout, GltfModel& model, JobSystem* jobSystem)
+{
+    const auto loadStart = std::chrono::steady_clock::now();
+    model = GltfModel{};
+    Document doc;
+    if (!OpenDocument(path, files, false, doc) ||
+        !DecodeDocument(path, doc, layout, model, jobSystem, loadStart)) {
+        return false;
+    }
+    model.stats.totalMs = ElapsedMs(loadStart);
+    return true;
+}
+
+bool LoadGltf(const std::filesystem::path& path, const GltfVertexLayout& layout, GltfModel& model,
+              JobSystem* jobSystem)
+{
+    const auto loadStart = std::chrono::steady_clock::now();
+    model = GltfModel{};
+
+    // Map the container; a .glb carries its JSON and first buffer in chunks
+    GltfFiles files;
+    if (!LoadAsset(path, files.file)) {
+        return Fail(path, "cannot open file");
+    }
+    model.stats.mapMs = ElapsedMs(loadStart);
+
+    const auto parseStart = std::chrono::steady_clock::now();
+    Document doc;
+    if (!OpenDocument(path, files, true, doc) ||
+        !DecodeDocument(path, doc, layout, model, jobSystem, parseStart)) {
+        return false;
+    }
+    model.stats.totalMs = ElapsedMs(loadStart);
+    return true;
+}
+
+} // namespace loader
+
+namespace {
+
+bool DecodeDocument(const std::filesystem::path& path, const Document& doc,
+                    const GltfVertexLayout& layout, GltfModel& model, JobSystem* jobSystem,
+                    std::chrono::steady_clock::time_point parseStart)
+{
+    // Assign every triangle-list primitive its place in the packed vertex / index ranges
+    std::vector<PrimitiveJob> jobs;
+    model.meshes.resize(doc.meshes.size());
+    for (size_t m = 0; m < doc.meshes.size(); ++m) {
+        model.meshes[m].name = doc.meshes[m].name;
+        model.meshes[m].primitives.reserve(doc.meshes[m].primitives.size());
+    }
+    for (size_t m = 0; m < doc.meshes.size(); ++m) {
+        for (const auto& primitive : doc.meshes[m].primitives) {
+            if (primitive.mode != ModeTriangles) {
+                continue;
+            }
+            PrimitiveJob job{.primitive = &primitive};
+            auto position = std::find_if(primitive.attributes.begin(), primitive.attributes.end(),
+                                         [](auto& attribute) { return attribute.first == "POSITION"; });
+            if (position == primitive.attributes.end() ||
+                !ResolveAccessor(doc, position->second, job.position)) {
+                return Fail(path, "primitive without a valid POSITION accessor");
+            }
+            uint32_t indexCount = job.position.count;
+            if (primitive.indices >= 0) {
+                AccessorData indices{};
+                if (!ResolveAccessor(doc, static_cast<uint32_t>(primitive.indices), indices) ||
+                    indices.components != 1 || indices.componentType == Float ||
+                    indices.componentType == Byte || indices.componentType == Short) {
+                    return Fail(path, "invalid index accessor");
+                }
+                indexCount = indices.count;
+            }
+
+            auto& output = model.meshes[m].primitives.emplace_back();
+            output.firstVertex = model.vertexCount;
+            output.vertexCount = job.position.count;
+            output.firstIndex = model.indexCount;
+            output.indexCount = indexCount;
+            output.material = primitive.material;
+            model.vertexCount += output.vertexCount;
+            model.indexCount += output.indexCount;
+            job.output = &output;
+            jobs.push_back(job);
+        }
+    }
+    model.stats.parseMs = ElapsedMs(parseStart);
+
+    auto phaseStart = std::chrono::steady_clock::now();
+    model.vertexBytes = VkDeviceSize(model.vertexCount) * layout.stride;
+    model.indexOffset = (model.vertexBytes + 3) & ~VkDeviceSize(3);
+    model.indexBytes = VkDeviceSize(model.indexCount) * sizeof(uint32_t);
+    if (model.vertexCount == 0) {
+        return Fail(path, "no triangle geometry");
+    }
+    model.staging = StagingBuffer::Create(model.indexOffset + model.indexBytes);
+    if (!model.staging) {
+        return Fail(path, "staging allocation failed");
+    }
+    auto* mapped = static_cast<uint8_t*>(model.staging->Map());
+    model.stats.stagingMs = ElapsedMs(phaseStart);
+
+    // Decode primitives in parallel; each writes a disjoint range of the staging buffer
+    phaseStart = std::chrono::steady_clock::now();
+    auto* indices = reinterpret_cast<uint32_t*>(mapped + model.indexOffset);
+    std::atomic<bool> failed{false};
+    uint32_t threadCount = 0;
+    if (jobSystem) {
+        const auto jobCount = static_cast<uint32_t>(jobs.size());
+        threadCount = std::min(jobSystem->GetThreadCount(), jobCount);
+        jobSystem->ParallelFor(jobCount, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end && !failed; ++i) {
+                if (!DecodePrimitive(doc, layout, jobs[i], mapped, indices)) {
+                    failed = true;
+                }
+            }
+        });
+    }
+    else {
+        std::atomic<size_t> nextJob{0};
+        auto worker = [&] {
+            size_t index;
+            while (!failed && (index = nextJob.fetch_add(1)) < jobs.size()) {
+                if (!DecodePrimitive(doc, layout, jobs[index], mapped, indices)) {
+                    failed = true;
+                }
+            }
+        };
+        threadCount = static_cast<uint32_t>(
+            std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), jobs.size()));
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < threadCount; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    model.staging->Unmap();
+    model.stats.decodeMs = ElapsedMs(phaseStart);
+    model.stats.decodeThreads = threadCount;
+    if (failed) {
+        model.staging.reset();
+        return Fail(path, "accessor decode failed");
+    }
+
+    return true;
+}
+
+} // namespace
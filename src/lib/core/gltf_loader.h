@@ -0,0 +1,88 @@
+#pragma once
+#include "core/asset_archive.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+class JobSystem;
+class StagingBuffer;
+
+// Interleaved float vertex layout the loader writes. Attributes missing from a primitive are
+// filled with defaultValue.
+struct GltfVertexLayout {
+    struct Attribute {
+        std::string semantic; // "POSITION", "NORMAL", "TEXCOORD_0", "COLOR_0", ...
+        uint32_t offset = 0;
+        uint32_t components = 3; // float components written, 1..4
+        float defaultValue[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    };
+
+    uint32_t stride = 0;
+    std::vector<Attribute> attributes;
+};
+
+struct GltfPrimitive {
+    uint32_t firstVertex = 0;
+    uint32_t vertexCount = 0;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int32_t material = -1;
+};
+
+struct GltfMesh {
+    std::string name;
+    std::vector<GltfPrimitive> primitives;
+};
+
+// Milliseconds per phase
+struct GltfLoadStats {
+    double mapMs = 0.0;
+    double parseMs = 0.0;
+    double stagingMs = 0.0;
+    double decodeMs = 0.0;
+    double totalMs = 0.0;
+    uint32_t decodeThreads = 0;
+};
+
+// Every primitive's vertices and uint32 indices packed in one staging buffer:
+// vertices at offset 0, indices at indexOffset. Index values are relative to the primitive.
+struct GltfModel {
+    std::vector<GltfMesh> meshes;
+    std::shared_ptr<StagingBuffer> staging;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    VkDeviceSize vertexBytes = 0;
+    VkDeviceSize indexOffset = 0;
+    VkDeviceSize indexBytes = 0;
+    GltfLoadStats stats;
+};
+
+// A .gltf / .glb and the external buffers it references, mapped by ReadGltfFiles
+struct GltfFiles {
+    AssetData file;
+    // One per glTF buffer; empty for the GLB binary chunk
+    std::vector<AssetData> buffers;
+};
+
+namespace loader {
+
+    // glTF 2.0 (.gltf + .bin) or binary (.glb). Buffers are memory-mapped, the JSON is read
+    // with a pull parser, and triangle-list primitives are decoded in parallel straight into
+    // the mapped staging buffer. Sparse accessors and data: URIs are not supported.
+    // Primitives are decoded with jobSystem->ParallelFor, which is safe from inside a job;
+    // without a JobSystem the loader starts one thread per hardware thread for the call.
+    bool LoadGltf(const std::filesystem::path& path, const GltfVertexLayout& layout,
+                  GltfModel& model, JobSystem* jobSystem = nullptr);
+
+    // The I/O half of LoadGltf, e.g. for an I/O thread: maps the file and its external buffers
+    // (the JSON is parsed to find them, and again by the decode)
+    bool ReadGltfFiles(const std::filesystem::path& path, GltfFiles& files);
+    // The decode half, from files filled by ReadGltfFiles; path is only used in messages
+    bool LoadGltf(const std::filesystem::path& path, GltfFiles& files,
+                  const GltfVertexLayout& layout, GltfModel& model,
+                  JobSystem* jobSystem = nullptr);
+
+} // namespace loader
@@ -0,0 +1,322 @@
+#include "gpu_culling.h"
+#include "core/asset_path.h"
+#include "core/bindless_resource_table.h"
+#include "core/command_buffer.h"
+#include "core/frustum_culler.h"
+#include "core/shader_compiler.h"
+#include "core/shader_loader.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+bool GpuCuller::Initialize(uint32_t maxObjects, uint32_t batchCount)
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    if (!vulkanCtx.IsDrawIndirectCountSupported()) {
+        std::cerr << "[gpu culling] drawIndirectCount / multiDrawIndirect not supported" << std::endl;
+        return false;
+    }
+    if (maxObjects == 0 || batchCount == 0) {
+        return false;
+    }
+    m_maxObjects = maxObjects;
+    m_objectCount = 0;
+    m_batchOffset.assign(batchCount, 0);
+    m_batchCapacity.assign(batchCount, 0);
+
+    const VkDeviceSize countBytes = VkDeviceSize(batchCount) * sizeof(uint32_t);
+    m_objects = StorageBuffer::Create(VkDeviceSize(maxObjects) * sizeof(GpuCullObject),
+                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_batches = StorageBuffer::Create(countBytes, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (!m_objects || !m_batches) {
+        Cleanup();
+        return false;
+    }
+    m_objects->SetDebugName("GpuCulling objects");
+    m_batches->SetDebugName("GpuCulling batches");
+
+    auto& bindless = vulkanCtx.GetBindlessResourceTable();
+    m_objectIndex = bindless.RegisterStorageBuffer(m_objects->GetVkBuffer());
+    m_batchIndex = bindless.RegisterStorageBuffer(m_batches->GetVkBuffer());
+
+    m_frames.resize(VulkanContext::MaxInflightFrame);
+    for (auto& frame : m_frames) {
+        frame.commands = StorageBuffer::Create(
+            VkDeviceSize(maxObjects) * sizeof(VkDrawIndexedIndirectCommand),
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+        frame.counts = StorageBuffer::Create(
+            countBytes, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+        frame.readback = StorageBuffer::Create(
+            countBytes, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        if (!frame.commands || !frame.counts || !frame.readback) {
+            Cleanup();
+            return false;
+        }
+        frame.commands->SetDebugName("GpuCulling commands");
+        frame.counts->SetDebugName("GpuCulling counts");
+        frame.readback->SetDebugName("GpuCulling readback");
+        auto* readback = static_cast<uint32_t*>(frame.readback->Map());
+        std::memset(readback, 0, static_cast<size_t>(countBytes));
+        frame.readbackData = readback;
+        frame.commandIndex = bindless.RegisterStorageBuffer(frame.commands->GetVkBuffer());
+        frame.countIndex = bindless.RegisterStorageBuffer(frame.counts->GetVkBuffer());
+    }
+    if (m_objectIndex == BindlessResourceTable::InvalidIndex ||
+        m_batchIndex == BindlessResourceTable::InvalidIndex ||
+        m_frames.back().countIndex == BindlessResourceTable::InvalidIndex) {
+        std::cerr << "[gpu culling] bindless table is full" << std::endl;
+        Cleanup();
+        return false;
+    }
+
+    if (!CreatePipeline()) {
+        Cleanup();
+        return false;
+    }
+    return true;
+}
+
+void GpuCuller::Cleanup()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto& bindless = vulkanCtx.GetBindlessResourceTable();
+    auto release = [&bindless](uint32_t& index) {
+        if (index != BindlessResourceTable::InvalidIndex) {
+            bindless.ReleaseStorageBuffer(index);
+            index = BindlessResourceTable::InvalidIndex;
+        }
+    };
+
+    if (m_pipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(vulkanCtx.GetVkDevice(), m_pipeline, vulkanCtx.GetAllocationCallbacks());
+        m_pipeline = VK_NULL_HANDLE;
+    }
+    // Owned by the pipeline layout cache
+    m_pipelineLayout = VK_NULL_HANDLE;
+
+    for (auto& frame : m_frames) {
+        release(frame.commandIndex);
+        release(frame.countIndex);
+        if (frame.readbackData != nullptr) {
+            frame.readback->Unmap();
+        }
+    }
+    m_frames.clear();
+    release(m_objectIndex);
+    release(m_batchIndex);
+    m_objects.reset();
+    m_batches.reset();
+
+    m_maxObjects = 0;
+    m_objectCount = 0;
+    m_batchOffset.clear();
+    m_batchCapacity.clear();
+}
+
+bool GpuCuller::SetObjects(const std::vector<GpuCullObject>& objects)
+{
+    if (objects.size() > m_maxObjects) {
+        std::cerr << "[gpu culling] " << objects.size() << " objects exceed capacity "
+                  << m_maxObjects << std::endl;
+        return false;
+    }
+
+    // Each batch gets exactly as many command slots as it has objects
+    const uint32_t batchCount = GetBatchCount();
+    std::fill(m_batchCapacity.begin(), m_batchCapacity.end(), 0u);
+    for (const auto& object : objects) {
+        if (object.batch >= batchCount) {
+            std::cerr << "[gpu culling] batch " << object.batch << " out of range" << std::endl;
+            return false;
+        }
+        ++m_batchCapacity[object.batch];
+    }
+    uint32_t offset = 0;
+    for (uint32_t batch = 0; batch < batchCount; ++batch) {
+        m_batchOffset[batch] = offset;
+        offset += m_batchCapacity[batch];
+    }
+
+    const VkDeviceSize objectBytes = VkDeviceSize(objects.size()) * sizeof(GpuCullObject);
+    const VkDeviceSize batchBytes = VkDeviceSize(batchCount) * sizeof(uint32_t);
+    auto staging = StagingBuffer::Create(objectBytes + batchBytes);
+    if (!staging) {
+        return false;
+    }
+    auto* mapped = static_cast<uint8_t*>(staging->Map());
+    if (objectBytes > 0) {
+        std::memcpy(mapped, objects.data(), static_cast<size_t>(objectBytes));
+    }
+    std::memcpy(mapped + objectBytes, m_batchOffset.data(), static_cast<size_t>(batchBytes));
+    staging->Unmap();
+
+    auto& vulkanCtx = VulkanContext::Get();
+    auto commandBuffer = vulkanCtx.CreateCommandBuffer();
+    commandBuffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    if (objectBytes > 0) {
+        VkBufferCopy objectCopy{.srcOffset = 0, .dstOffset = 0, .size = objectBytes};
+        vkCmdCopyBuffer(*commandBuffer, staging->GetVkBuffer(), m_objects->GetVkBuffer(), 1,
+                        &objectCopy);
+    }
+    VkBufferCopy batchCopy{.srcOffset = objectBytes, .dstOffset = 0, .size = batchBytes};
+    vkCmdCopyBuffer(*commandBuffer, staging->GetVkBuffer(), m_batches->GetVkBuffer(), 1,
+                    &batchCopy);
+    commandBuffer->End();
+    vulkanCtx.SubmitAndWait(commandBuffer);
+
+    m_objectCount = static_cast<uint32_t>(objects.size());
+    return true;
+}
+
+void GpuCuller::RecordCull(VkCommandBuffer commandBuffer, const float* viewProjection)
+{
+    auto& frame = m_frames[VulkanContext::Get().GetCurrentFrameIndex()];
+    const VkDeviceSize countBytes = VkDeviceSize(GetBatchCount()) * sizeof(uint32_t);
+
+    // The frame fence guarantees last use of this slot's buffers has finished
+    vkCmdFillBuffer(commandBuffer, frame.counts->GetVkBuffer(), 0, countBytes, 0);
+    VkMemoryBarrier fillBarrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &fillBarrier, 0, nullptr, 0,
+                         nullptr);
+
+    if (m_objectCount > 0) {
+        CullParams params{};
+        FrustumCuller::ExtractFrustumPlanes(viewProjection, params.planes);
+        params.objectCount = m_objectCount;
+        params.objectBuffer = m_objectIndex;
+        params.batchBuffer = m_batchIndex;
+        params.commandBuffer = frame.commandIndex;
+        params.countBuffer = frame.countIndex;
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+        VulkanContext::Get().GetBindlessResourceTable().Bind(
+            commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout);
+        vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                           sizeof(params), &params);
+        vkCmdDispatch(commandBuffer, (m_objectCount + WorkgroupSize - 1) / WorkgroupSize, 1, 1);
+    }
+
+    VkMemoryBarrier cullBarrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         1, &cullBarrier, 0, nullptr, 0, nullptr);
+
+    // Counts for statistics; read on the host once this frame slot comes around again
+    VkBufferCopy countCopy{.srcOffset = 0, .dstOffset = 0, .size = countBytes};
+    vkCmdCopyBuffer(commandBuffer, frame.counts->GetVkBuffer(), frame.readback->GetVkBuffer(), 1,
+                    &countCopy);
+    VkMemoryBarrier readbackBarrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &readbackBarrier, 0, nullptr, 0,
+                         nullptr);
+}
+
+void GpuCuller::RecordDraw(VkCommandBuffer commandBuffer, uint32_t batch) const
+{
+    if (batch >= GetBatchCount() || m_batchCapacity[batch] == 0) {
+        return;
+    }
+    const auto& frame = m_frames[VulkanContext::Get().GetCurrentFrameIndex()];
+    constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    vkCmdDrawIndexedIndirectCount(commandBuffer, frame.commands->GetVkBuffer(),
+                                  VkDeviceSize(m_batchOffset[batch]) * stride,
+                                  frame.counts->GetVkBuffer(),
+                                  VkDeviceSize(batch) * sizeof(uint32_t),
+                                  m_batchCapacity[batch], stride);
+}
+
+uint32_t GpuCuller::GetVisibleCount(uint32_t batch) const
+{
+    if (batch >= GetBatchCount()) {
+        return 0;
+    }
+    const auto& frame = m_frames[VulkanContext::Get().GetCurrentFrameIndex()];
+    return frame.readbackData[batch];
+}
+
+bool GpuCuller::IsSubgroupCullingSupported()
+{
+    VkPhysicalDeviceSubgroupProperties subgroupProps{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES,
+    };
+    VkPhysicalDeviceProperties2 props{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &subgroupProps,
+    };
+    vkGetPhysicalDeviceProperties2(VulkanContext::Get().GetVkPhysicalDevice(), &props);
+
+    const VkSubgroupFeatureFlags required = VK_SUBGROUP_FEATURE_BASIC_BIT |
+                                            VK_SUBGROUP_FEATURE_VOTE_BIT |
+                                            VK_SUBGROUP_FEATURE_ARITHMETIC_BIT |
+                                            VK_SUBGROUP_FEATURE_BALLOT_BIT;
+    return (subgroupProps.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) != 0 &&
+           (subgroupProps.supportedOperations & required) == required;
+}
+
+bool GpuCuller::CreatePipeline()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto device = vulkanCtx.GetVkDevice();
+
+    const bool subgroupCulling = IsSubgroupCullingSupported();
+    if (!subgroupCulling) {
+        std::cerr << "[gpu culling] subgroup arithmetic / ballot / vote not supported in compute; "
+                     "using one atomic per visible object"
+                  << std::endl;
+    }
+    const auto sourcePath = GetAssetPath(AssetType::Shader, subgroupCulling
+                                                                ? "gpu_cull.comp"
+                                                                : "gpu_cull_atomic.comp");
+    if (!loader::UpdateSpirvFile(sourcePath)) {
+        return false;
+    }
+    auto spvPath = sourcePath;
+    spvPath += ".spv";
+    VkShaderModule shaderModule = loader::LoadShaderModule(spvPath);
+    if (shaderModule == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    VkPushConstantRange pushConstantRange{
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(CullParams),
+    };
+    m_pipelineLayout = vulkanCtx.GetBindlessResourceTable().GetPipelineLayout({pushConstantRange});
+
+    VkComputePipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = shaderModule,
+            .pName = "main",
+        },
+        .layout = m_pipelineLayout,
+    };
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    auto result = vkCreateComputePipelines(device, vulkanCtx.GetPipelineCache(), 1, &pipelineInfo,
+                                           allocator, &m_pipeline);
+    vkDestroyShaderModule(device, shaderModule, allocator);
+    if (result != VK_SUCCESS) {
+        m_pipeline = VK_NULL_HANDLE;
+        return false;
+    }
+    vulkanCtx.SetDebugObjectName(reinterpret_cast<void*>(m_pipeline), VK_OBJECT_TYPE_PIPELINE,
+                                 "GpuCuller");
+    return true;
+}
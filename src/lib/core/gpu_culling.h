@@ -0,0 +1,101 @@
+#pragma once
+#include "core/buffer_resource.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Object record read by the culling shader (std430, 32 bytes)
+struct GpuCullObject {
+    // World-space bounding sphere
+    float center[3] = {};
+    float radius = 0.0f;
+    // Indexed draw arguments, e.g. from a GeometryAllocation
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int32_t vertexOffset = 0;
+    // Output range, one per pipeline; drawn together by RecordDraw(commandBuffer, batch)
+    uint32_t batch = 0;
+};
+static_assert(sizeof(GpuCullObject) == 32);
+
+// GPU-driven culling. A compute pass tests every object's bounding sphere against the
+// frustum and appends a VkDrawIndexedIndirectCommand per visible object to its batch's
+// range; each batch is then drawn with a single vkCmdDrawIndexedIndirectCount. The CPU cost
+// per frame does not depend on the number of objects.
+//
+// firstInstance of every command is the object's index, so vertex shaders fetch per-object
+// data with gl_InstanceIndex. Needs VulkanContext::IsDrawIndirectCountSupported(). Without
+// subgroup arithmetic, ballot and vote in compute shaders, gpu_cull_atomic.comp is used,
+// which takes one atomic per visible object instead of one per batch and subgroup.
+class GpuCuller {
+public:
+    static constexpr uint32_t WorkgroupSize = 64;
+
+    GpuCuller() = default;
+    ~GpuCuller() = default;
+
+    GpuCuller(const GpuCuller&) = delete;
+    GpuCuller& operator=(const GpuCuller&) = delete;
+
+    bool Initialize(uint32_t maxObjects, uint32_t batchCount);
+    void Cleanup();
+
+    // Replaces every object and uploads synchronously. Not for use while frames that
+    // reference the culler are in flight (load time, or after vkDeviceWaitIdle).
+    bool SetObjects(const std::vector<GpuCullObject>& objects);
+
+    // Resets this frame's counts and dispatches culling. Record outside rendering and before
+    // RecordDraw. viewProjection is a column-major 4x4 matrix with 0..1 clip depth.
+    void RecordCull(VkCommandBuffer commandBuffer, const float* viewProjection);
+
+    // One indirect-count draw for the batch; bind its pipeline and the index buffer first
+    void RecordDraw(VkCommandBuffer commandBuffer, uint32_t batch) const;
+
+    // Visible objects of the batch from the last completed frame in the current frame slot.
+    // Valid after VulkanContext::AcquireNextImage.
+    uint32_t GetVisibleCount(uint32_t batch) const;
+
+    uint32_t GetObjectCount() const { return m_objectCount; }
+    uint32_t GetBatchCount() const { return static_cast<uint32_t>(m_batchCapacity.size()); }
+
+private:
+    // Matches the push constant block in gpu_cull.comp
+    struct CullParams {
+        float planes[6][4];
+        uint32_t objectCount;
+        uint32_t objectBuffer;
+        uint32_t batchBuffer;
+        uint32_t commandBuffer;
+        uint32_t countBuffer;
+    };
+
+    // Indirect commands and counts are written every frame, so each frame in flight owns a set
+    struct FrameResources {
+        std::shared_ptr<StorageBuffer> commands;
+        std::shared_ptr<StorageBuffer> counts;
+        std::shared_ptr<StorageBuffer> readback;
+        const uint32_t* readbackData = nullptr;
+        uint32_t commandIndex = ~0u;
+        uint32_t countIndex = ~0u;
+    };
+
+    // Subgroup arithmetic, ballot and vote in the compute stage, as gpu_cull.comp uses them
+    static bool IsSubgroupCullingSupported();
+    bool CreatePipeline();
+
+    uint32_t m_maxObjects = 0;
+    uint32_t m_objectCount = 0;
+    // First command and number of command slots of each batch
+    std::vector<uint32_t> m_batchOffset;
+    std::vector<uint32_t> m_batchCapacity;
+
+    std::shared_ptr<StorageBuffer> m_objects;
+    std::shared_ptr<StorageBuffer> m_batches;
+    uint32_t m_objectIndex = ~0u;
+    uint32_t m_batchIndex = ~0u;
+    std::vector<FrameResources> m_frames;
+
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_pipeline = VK_NULL_HANDLE;
+};
@@ -0,0 +1,264 @@
+#include "gpu_memory_tracker.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// Usage has to fall this far below the callback fraction before the callback can fire again
+constexpr float BudgetHysteresis = 0.05f;
+
+std::string Escape(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        }
+        else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+void GpuMemoryTracker::Initialize(VkPhysicalDevice physicalDevice, bool memoryBudgetSupported)
+{
+    m_physicalDevice = physicalDevice;
+    m_budgetSupported = memoryBudgetSupported;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memoryProperties);
+
+    std::lock_guard lock(m_mutex);
+    m_heapBytes.assign(m_memoryProperties.memoryHeapCount, 0);
+    m_overBudget.assign(m_memoryProperties.memoryHeapCount, false);
+}
+
+void GpuMemoryTracker::OnAllocate(VkDeviceMemory memory, VkDeviceSize size,
+                                  uint32_t memoryTypeIndex, GpuMemoryCategory category,
+                                  const char* name)
+{
+    const uint32_t heap = m_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    std::lock_guard lock(m_mutex);
+    auto& allocation = m_allocations[memory];
+    allocation.name = name != nullptr ? name : "";
+    allocation.category = category;
+    allocation.size = size;
+    allocation.memoryType = memoryTypeIndex;
+    allocation.heap = heap;
+    allocation.frame = m_frame;
+    allocation.sequence = m_nextSequence++;
+
+    auto& totals = m_categories[static_cast<size_t>(category)];
+    totals.bytes += size;
+    ++totals.count;
+    if (heap < m_heapBytes.size()) {
+        m_heapBytes[heap] += size;
+    }
+}
+
+void GpuMemoryTracker::OnFree(VkDeviceMemory memory)
+{
+    std::lock_guard lock(m_mutex);
+    auto it = m_allocations.find(memory);
+    if (it == m_allocations.end()) {
+        return;
+    }
+    const auto& allocation = it->second;
+    auto& totals = m_categories[static_cast<size_t>(allocation.category)];
+    totals.bytes -= allocation.size;
+    --totals.count;
+    if (allocation.heap < m_heapBytes.size()) {
+        m_heapBytes[allocation.heap] -= allocation.size;
+    }
+    m_allocations.erase(it);
+}
+
+void GpuMemoryTracker::SetName(VkDeviceMemory memory, const char* name)
+{
+    std::lock_guard lock(m_mutex);
+    auto it = m_allocations.find(memory);
+    if (it != m_allocations.end()) {
+        it->second.name = name != nullptr ? name : "";
+    }
+}
+
+void GpuMemoryTracker::OnFrame()
+{
+    uint64_t frame = 0;
+    {
+        std::lock_guard lock(m_mutex);
+        frame = ++m_frame;
+    }
+    if (m_budgetCallback && frame % BudgetPollInterval == 0) {
+        PollBudget();
+    }
+}
+
+std::vector<GpuMemoryTracker::HeapInfo> GpuMemoryTracker::PollBudget()
+{
+    auto heaps = QueryHeaps();
+    if (!m_budgetCallback) {
+        return heaps;
+    }
+    m_overBudget.resize(heaps.size(), false);
+    for (uint32_t i = 0; i < heaps.size(); ++i) {
+        const auto& heap = heaps[i];
+        if (heap.budget == 0) {
+            continue;
+        }
+        const double fraction = double(heap.usage) / double(heap.budget);
+        if (!m_overBudget[i] && fraction >= m_budgetFraction) {
+            m_overBudget[i] = true;
+            m_budgetCallback(i, heap);
+        }
+        else if (m_overBudget[i] && fraction < m_budgetFraction - BudgetHysteresis) {
+            m_overBudget[i] = false;
+        }
+    }
+    return heaps;
+}
+
+void GpuMemoryTracker::SetBudgetCallback(float budgetFraction, BudgetCallback callback)
+{
+    m_budgetFraction = budgetFraction;
+    m_budgetCallback = std::move(callback);
+    std::fill(m_overBudget.begin(), m_overBudget.end(), false);
+}
+
+GpuMemoryTracker::CategoryTotals GpuMemoryTracker::GetCategoryTotals(
+    GpuMemoryCategory category) const
+{
+    std::lock_guard lock(m_mutex);
+    return m_categories[static_cast<size_t>(category)];
+}
+
+VkDeviceSize GpuMemoryTracker::GetTrackedBytes() const
+{
+    std::lock_guard lock(m_mutex);
+    VkDeviceSize bytes = 0;
+    for (const auto& totals : m_categories) {
+        bytes += totals.bytes;
+    }
+    return bytes;
+}
+
+uint32_t GpuMemoryTracker::GetAllocationCount() const
+{
+    std::lock_guard lock(m_mutex);
+    return static_cast<uint32_t>(m_allocations.size());
+}
+
+std::string GpuMemoryTracker::DumpJson() const
+{
+    const auto heaps = QueryHeaps();
+
+    std::lock_guard lock(m_mutex);
+    std::vector<const std::pair<const VkDeviceMemory, Allocation>*> allocations;
+    allocations.reserve(m_allocations.size());
+    for (const auto& entry : m_allocations) {
+        allocations.push_back(&entry);
+    }
+    std::sort(allocations.begin(), allocations.end(),
+              [](auto* a, auto* b) { return a->second.sequence < b->second.sequence; });
+
+    std::ostringstream out;
+    out << "{\n";
+    out << "  \"frame\": " << m_frame << ",\n";
+    out << "  \"budgetQueried\": " << (m_budgetSupported ? "true" : "false") << ",\n";
+    out << "  \"heaps\": [\n";
+    for (size_t i = 0; i < heaps.size(); ++i) {
+        const auto& heap = heaps[i];
+        const bool deviceLocal = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        out << "    {\"index\": " << i << ", \"deviceLocal\": " << (deviceLocal ? "true" : "false")
+            << ", \"size\": " << heap.size << ", \"budget\": " << heap.budget
+            << ", \"usage\": " << heap.usage << ", \"tracked\": " << heap.trackedBytes << "}"
+            << (i + 1 < heaps.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n";
+    out << "  \"categories\": {\n";
+    for (size_t i = 0; i < m_categories.size(); ++i) {
+        out << "    \"" << GetCategoryName(static_cast<GpuMemoryCategory>(i))
+            << "\": {\"bytes\": " << m_categories[i].bytes
+            << ", \"count\": " << m_categories[i].count << "}"
+            << (i + 1 < m_categories.size() ? ",\n" : "\n");
+    }
+    out << "  },\n";
+    out << "  \"allocations\": [\n";
+    for (size_t i = 0; i < allocations.size(); ++i) {
+        const auto& allocation = allocations[i]->second;
+        out << "    {\"name\": \"" << Escape(allocation.name) << "\", \"category\": \""
+            << GetCategoryName(allocation.category) << "\", \"size\": " << allocation.size
+            << ", \"memoryType\": " << allocation.memoryType << ", \"heap\": " << allocation.heap
+            << ", \"frame\": " << allocation.frame << "}"
+            << (i + 1 < allocations.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n";
+    out << "}\n";
+    return out.str();
+}
+
+bool GpuMemoryTracker::DumpJson(const std::filesystem::path& path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << DumpJson();
+    if (!file) {
+        std::cerr << "[memory] failed to write " << path.string() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+const char* GpuMemoryTracker::GetCategoryName(GpuMemoryCategory category)
+{
+    switch (category) {
+    case GpuMemoryCategory::Geometry: return "geometry";
+    case GpuMemoryCategory::Buffer: return "buffer";
+    case GpuMemoryCategory::Staging: return "staging";
+    case GpuMemoryCategory::Texture: return "texture";
+    case GpuMemoryCategory::RenderTarget: return "renderTarget";
+    case GpuMemoryCategory::Descriptor: return "descriptor";
+    default: return "unknown";
+    }
+}
+
+std::vector<GpuMemoryTracker::HeapInfo> GpuMemoryTracker::QueryHeaps() const
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+    };
+    if (m_budgetSupported) {
+        VkPhysicalDeviceMemoryProperties2 memoryProps2{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+            .pNext = &budgetProps,
+        };
+        vkGetPhysicalDeviceMemoryProperties2(m_physicalDevice, &memoryProps2);
+    }
+
+    std::vector<HeapInfo> heaps(m_memoryProperties.memoryHeapCount);
+    std::lock_guard lock(m_mutex);
+    for (uint32_t i = 0; i < heaps.size(); ++i) {
+        auto& heap = heaps[i];
+        heap.flags = m_memoryProperties.memoryHeaps[i].flags;
+        heap.size = m_memoryProperties.memoryHeaps[i].size;
+        heap.trackedBytes = i < m_heapBytes.size() ? m_heapBytes[i] : 0;
+        if (m_budgetSupported) {
+            heap.budget = budgetProps.heapBudget[i];
+            heap.usage = budgetProps.heapUsage[i];
+        }
+        else {
+            heap.budget = heap.size;
+            heap.usage = heap.trackedBytes;
+        }
+    }
+    return heaps;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class GpuMemoryCategory : uint32_t {
+    // Vertex and index buffers
+    Geometry,
+    // Uniform, storage and other shader-visible buffers
+    Buffer,
+    // Upload staging
+    Staging,
+    Texture,
+    // Color and depth attachments
+    RenderTarget,
+    // Descriptor buffers
+    Descriptor,
+    Count,
+};
+
+// Every VkDeviceMemory allocated through VulkanContext::AllocateMemory, tagged with a category
+// and a debug name, plus per-heap budgets from VK_EXT_memory_budget. Without the extension the
+// budget is the heap size and the usage is what this tracker has seen.
+//   vulkanCtx.GetMemoryTracker().SetBudgetCallback(0.9f, [](uint32_t heap, const auto& info) {
+//       textureCache.Trim();
+//   });
+//   vulkanCtx.GetMemoryTracker().DumpJson("memory.json");
+class GpuMemoryTracker {
+public:
+    struct HeapInfo {
+        VkMemoryHeapFlags flags = 0;
+        VkDeviceSize size = 0;
+        VkDeviceSize budget = 0;
+        // Whole process, including allocations this tracker has not seen
+        VkDeviceSize usage = 0;
+        VkDeviceSize trackedBytes = 0;
+    };
+
+    struct CategoryTotals {
+        VkDeviceSize bytes = 0;
+        uint32_t count = 0;
+    };
+
+    // Runs on the render thread when a heap's usage rises above the callback's fraction of its
+    // budget; it fires again only after usage has dropped back below the fraction
+    using BudgetCallback = std::function<void(uint32_t heapIndex, const HeapInfo& heap)>;
+
+    // Frames between budget queries in OnFrame
+    static constexpr uint32_t BudgetPollInterval = 30;
+
+    GpuMemoryTracker() = default;
+    ~GpuMemoryTracker() = default;
+
+    GpuMemoryTracker(const GpuMemoryTracker&) = delete;
+    GpuMemoryTracker& operator=(const GpuMemoryTracker&) = delete;
+
+    void Initialize(VkPhysicalDevice physicalDevice, bool memoryBudgetSupported);
+
+    // Thread-safe
+    void OnAllocate(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex,
+                    GpuMemoryCategory category, const char* name);
+    void OnFree(VkDeviceMemory memory);
+    void SetName(VkDeviceMemory memory, const char* name);
+
+    // Called by VulkanContext once per frame; polls the budget every BudgetPollInterval frames
+    void OnFrame();
+    // Queries the budget now and runs the callback for heaps that crossed the threshold
+    std::vector<HeapInfo> PollBudget();
+
+    void SetBudgetCallback(float budgetFraction, BudgetCallback callback);
+
+    CategoryTotals GetCategoryTotals(GpuMemoryCategory category) const;
+    VkDeviceSize GetTrackedBytes() const;
+    uint32_t GetAllocationCount() const;
+
+    // Heaps, category totals and every live allocation with its name, category, size, heap and
+    // the frame it was made in
+    std::string DumpJson() const;
+    bool DumpJson(const std::filesystem::path& path) const;
+
+    static const char* GetCategoryName(GpuMemoryCategory category);
+
+private:
+    struct Allocation {
+        std::string name;
+        GpuMemoryCategory category = GpuMemoryCategory::Buffer;
+        VkDeviceSize size = 0;
+        uint32_t memoryType = 0;
+        uint32_t heap = 0;
+        uint64_t frame = 0;
+        // Allocation order, so a dump sorts oldest first
+        uint64_t sequence = 0;
+    };
+
+    std::vector<HeapInfo> QueryHeaps() const;
+
+    VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+    bool m_budgetSupported = false;
+    VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<VkDeviceMemory, Allocation> m_allocations;
+    std::array<CategoryTotals, static_cast<size_t>(GpuMemoryCategory::Count)> m_categories{};
+    std::vector<VkDeviceSize> m_heapBytes;
+    uint64_t m_frame = 0;
+    uint64_t m_nextSequence = 0;
+
+    // Render thread only
+    float m_budgetFraction = 0.9f;
+    BudgetCallback m_budgetCallback;
+    std::vector<bool> m_overBudget;
+};
@@ -0,0 +1,96 @@
+#include "gpu_timer.h"
+#include "core/vulkan_context.h"
+
+bool GpuTimer::Initialize(uint32_t timestampCount)
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto physicalDevice = vulkanCtx.GetVkPhysicalDevice();
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+    const uint32_t validBits = families[vulkanCtx.GetGraphicsFamily()].timestampValidBits;
+    if (validBits == 0) {
+        return false;
+    }
+    m_validMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+    m_periodNs = vulkanCtx.GetPhysicalDeviceProperties().limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo poolInfo{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = timestampCount * VulkanContext::MaxInflightFrame,
+    };
+    if (vkCreateQueryPool(vulkanCtx.GetVkDevice(), &poolInfo, vulkanCtx.GetAllocationCallbacks(),
+                          &m_queryPool) != VK_SUCCESS) {
+        return false;
+    }
+    m_timestampCount = timestampCount;
+    m_written.assign(VulkanContext::MaxInflightFrame, std::vector<bool>(timestampCount, false));
+    m_results.assign(timestampCount, 0);
+    m_resultValid.assign(timestampCount, false);
+    return true;
+}
+
+void GpuTimer::Cleanup()
+{
+    if (m_queryPool != VK_NULL_HANDLE) {
+        auto& vulkanCtx = VulkanContext::Get();
+        vkDestroyQueryPool(vulkanCtx.GetVkDevice(), m_queryPool,
+                           vulkanCtx.GetAllocationCallbacks());
+        m_queryPool = VK_NULL_HANDLE;
+    }
+    m_timestampCount = 0;
+    m_written.clear();
+    m_results.clear();
+    m_resultValid.clear();
+}
+
+void GpuTimer::BeginFrame(VkCommandBuffer commandBuffer)
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    m_frameIndex = vulkanCtx.GetCurrentFrameIndex();
+    const uint32_t base = m_frameIndex * m_timestampCount;
+
+    // The slot's fence has been waited on, so written queries are complete
+    auto& written = m_written[m_frameIndex];
+    for (uint32_t i = 0; i < m_timestampCount; ++i) {
+        m_resultValid[i] = false;
+        if (!written[i]) {
+            continue;
+        }
+        uint64_t value = 0;
+        auto result = vkGetQueryPoolResults(vulkanCtx.GetVkDevice(), m_queryPool, base + i, 1,
+                                            sizeof(value), &value, sizeof(value),
+                                            VK_QUERY_RESULT_64_BIT);
+        if (result == VK_SUCCESS) {
+            m_results[i] = value & m_validMask;
+            m_resultValid[i] = true;
+        }
+        written[i] = false;
+    }
+
+    vkCmdResetQueryPool(commandBuffer, m_queryPool, base, m_timestampCount);
+}
+
+void GpuTimer::WriteTimestamp(VkCommandBuffer commandBuffer, uint32_t index,
+                              VkPipelineStageFlagBits stage)
+{
+    if (index >= m_timestampCount) {
+        return;
+    }
+    vkCmdWriteTimestamp(commandBuffer, stage, m_queryPool,
+                        m_frameIndex * m_timestampCount + index);
+    m_written[m_frameIndex][index] = true;
+}
+
+double GpuTimer::GetElapsedMs(uint32_t begin, uint32_t end) const
+{
+    if (begin >= m_timestampCount || end >= m_timestampCount || !m_resultValid[begin] ||
+        !m_resultValid[end]) {
+        return -1.0;
+    }
+    const uint64_t ticks = (m_results[end] - m_results[begin]) & m_validMask;
+    return double(ticks) * m_periodNs * 1e-6;
+}
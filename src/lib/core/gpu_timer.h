@@ -0,0 +1,47 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+// Timestamp queries with one set per frame in flight. Results are read without waiting when
+// the frame slot comes around again, i.e. they lag MaxInflightFrame frames behind:
+//   timer.BeginFrame(cmd);                 // first command of the frame
+//   timer.WriteTimestamp(cmd, 0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+//   ... work ...
+//   timer.WriteTimestamp(cmd, 1, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+//   double ms = timer.GetElapsedMs(0, 1);  // from the previous use of this slot
+class GpuTimer {
+public:
+    GpuTimer() = default;
+    ~GpuTimer() = default;
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    // Returns false when the graphics queue does not support timestamps
+    bool Initialize(uint32_t timestampCount);
+    void Cleanup();
+
+    // Fetches the current slot's previous results and resets its queries.
+    // Record after VulkanContext::AcquireNextImage (or BeginOffscreenFrame), before any
+    // WriteTimestamp of the frame.
+    void BeginFrame(VkCommandBuffer commandBuffer);
+
+    void WriteTimestamp(VkCommandBuffer commandBuffer, uint32_t index,
+                        VkPipelineStageFlagBits stage);
+
+    // Milliseconds between two timestamps of the last completed frame in this slot;
+    // negative when either was not written or is not available yet
+    double GetElapsedMs(uint32_t begin, uint32_t end) const;
+
+private:
+    VkQueryPool m_queryPool = VK_NULL_HANDLE;
+    uint32_t m_timestampCount = 0;
+    double m_periodNs = 1.0;
+    uint64_t m_validMask = ~0ull;
+    uint32_t m_frameIndex = 0;
+    // Queries written since the slot's last reset, per frame slot
+    std::vector<std::vector<bool>> m_written;
+    std::vector<uint64_t> m_results;
+    std::vector<bool> m_resultValid;
+};
@@ -1,9 +1,11 @@
 #include "graphics_pipeline_builder.h"
 #include "core/vulkan_context.h"
+#include "core/shader_reflection.h"
 
 GraphicsPipelineBuilder::GraphicsPipelineBuilder()
 {
     m_device = VulkanContext::Get().GetVkDevice();
+    m_pipelineCache = VulkanContext::Get().GetPipelineCache();
 
     m_inputAssemblyState = VkPipelineInputAssemblyStateCreateInfo{
         .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
@@ -94,17 +96,87 @@ GraphicsPipelineBuilder& GraphicsPipelineBuilder::SetVertexInput(
     for (uint32_t i = 0; i < attributeCount; ++i) {
         m_attributeDescriptions[i] = attributes[i];
     }
+    UpdateVertexInputInfo();
+
+    return *this;
+}
+
+GraphicsPipelineBuilder& GraphicsPipelineBuilder::SetVertexInput(const ShaderReflection& vertexShader,
+                                                                 uint32_t binding)
+{
+    VkVertexInputBindingDescription bindingDescription{};
+    std::vector<VkVertexInputAttributeDescription> attributes;
+    loader::BuildVertexInputState(vertexShader, binding, bindingDescription, attributes);
+    if (attributes.empty()) {
+        return SetVertexInput(nullptr, 0, nullptr, 0);
+    }
+    return SetVertexInput(&bindingDescription, 1, attributes.data(),
+                          static_cast<uint32_t>(attributes.size()));
+}
+
+GraphicsPipelineBuilder&
+GraphicsPipelineBuilder::SetVertexInputInstanced(const ShaderReflection& vertexShader,
+                                                 uint32_t firstInstanceLocation, uint32_t binding)
+{
+    m_bindingDescriptions.clear();
+    m_attributeDescriptions.clear();
+
+    // Inputs are sorted by location, so each binding is packed in location order
+    uint32_t strides[2] = {};
+    for (auto& input : vertexShader.vertexInputs) {
+        const uint32_t slot = input.location >= firstInstanceLocation ? 1 : 0;
+        m_attributeDescriptions.push_back({
+            .location = input.location,
+            .binding = binding + slot,
+            .format = input.format,
+            .offset = strides[slot],
+        });
+        strides[slot] += input.size;
+    }
+    if (strides[0] > 0) {
+        m_bindingDescriptions.push_back({binding, strides[0], VK_VERTEX_INPUT_RATE_VERTEX});
+    }
+    if (strides[1] > 0) {
+        m_bindingDescriptions.push_back({binding + 1, strides[1], VK_VERTEX_INPUT_RATE_INSTANCE});
+    }
+    UpdateVertexInputInfo();
+
+    return *this;
+}
+
+GraphicsPipelineBuilder& GraphicsPipelineBuilder::AddVertexBinding(uint32_t binding,
+                                                                   uint32_t stride,
+                                                                   VkVertexInputRate inputRate)
+{
+    m_bindingDescriptions.push_back({binding, stride, inputRate});
+    UpdateVertexInputInfo();
+
+    return *this;
+}
+
+GraphicsPipelineBuilder& GraphicsPipelineBuilder::AddVertexAttribute(uint32_t location,
+                                                                     uint32_t binding,
+                                                                     VkFormat format,
+                                                                     uint32_t offset)
+{
+    m_attributeDescriptions.push_back({location, binding, format, offset});
+    UpdateVertexInputInfo();
+
+    return *this;
+}
+
+void GraphicsPipelineBuilder::UpdateVertexInputInfo()
+{
+    // Vectors may have reallocated; refresh the pointers
     m_vertexInputInfo = VkPipelineVertexInputStateCreateInfo{
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0,
-        .vertexBindingDescriptionCount = bindingCount,
+        .vertexBindingDescriptionCount = static_cast<uint32_t>(m_bindingDescriptions.size()),
         .pVertexBindingDescriptions = m_bindingDescriptions.data(),
-        .vertexAttributeDescriptionCount = attributeCount,
+        .vertexAttributeDescriptionCount = static_cast<uint32_t>(m_attributeDescriptions.size()),
         .pVertexAttributeDescriptions = m_attributeDescriptions.data(),
     };
-
-    return *this;
 }
 
 GraphicsPipelineBuilder& GraphicsPipelineBuilder::SetViewport(VkExtent2D extent)
@@ -168,6 +240,18 @@ void GraphicsPipelineBuilder::SetDepthStencilState(
     m_depthStencilState = state;
 }
 
+GraphicsPipelineBuilder& GraphicsPipelineBuilder::AddDynamicState(VkDynamicState state)
+{
+    m_dynamicStates.push_back(state);
+    return *this;
+}
+
+GraphicsPipelineBuilder& GraphicsPipelineBuilder::SetSampleCount(VkSampleCountFlagBits samples)
+{
+    m_multisampleState.rasterizationSamples = samples;
+    return *this;
+}
+
 GraphicsPipelineBuilder& GraphicsPipelineBuilder::SetPipelineLayout(VkPipelineLayout layout)
 {
     m_pipelineLayout = layout;
@@ -175,6 +259,20 @@ GraphicsPipelineBuilder& GraphicsPipelineBuilder::SetPipelineLayout(VkPipelineLa
     return *this;
 }
 
+GraphicsPipelineBuilder& GraphicsPipelineBuilder::SetPipelineFlags(VkPipelineCreateFlags flags)
+{
+    m_pipelineFlags = flags;
+
+    return *this;
+}
+
+GraphicsPipelineBuilder& GraphicsPipelineBuilder::SetPipelineCache(VkPipelineCache cache)
+{
+    m_pipelineCache = cache;
+
+    return *this;
+}
+
 GraphicsPipelineBuilder& GraphicsPipelineBuilder::UseRenderPass(VkRenderPass renderPass,
                                                                 uint32_t subpass)
 {
@@ -199,6 +297,7 @@ VkPipeline GraphicsPipelineBuilder::Build()
 {
     VkGraphicsPipelineCreateInfo pipelineInfo{
         .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .flags = m_pipelineFlags,
         .stageCount = static_cast<uint32_t>(m_shaderStages.size()),
         .pStages = m_shaderStages.data(),
         .pVertexInputState = &m_vertexInputInfo,
@@ -211,6 +310,15 @@ VkPipeline GraphicsPipelineBuilder::Build()
         .layout = m_pipelineLayout,
     };
 
+    VkPipelineDynamicStateCreateInfo dynamicState{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .dynamicStateCount = static_cast<uint32_t>(m_dynamicStates.size()),
+        .pDynamicStates = m_dynamicStates.data(),
+    };
+    if (!m_dynamicStates.empty()) {
+        pipelineInfo.pDynamicState = &dynamicState;
+    }
+
     VkPipelineRenderingCreateInfo renderingInfo{};
     if (m_useRenderPass) {
         pipelineInfo.renderPass = m_renderPass;
@@ -232,10 +340,10 @@ VkPipeline GraphicsPipelineBuilder::Build()
         pipelineInfo.pTessellationState = &m_tessellationState;
     }
 
-    auto& vulkanCtx = VulkanContext::Get();
     VkPipeline pipeline = VK_NULL_HANDLE;
-    if (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) !=
-        VK_SUCCESS) {
+    const auto* allocator = VulkanContext::Get().GetAllocationCallbacks();
+    if (vkCreateGraphicsPipelines(m_device, m_pipelineCache, 1, &pipelineInfo, allocator,
+                                  &pipeline) != VK_SUCCESS) {
         return VK_NULL_HANDLE;
     }
 
@@ -2,6 +2,8 @@
 #include <vulkan/vulkan.h>
 #include <vector>
 
+struct ShaderReflection;
+
 class GraphicsPipelineBuilder {
 public:
     GraphicsPipelineBuilder();
@@ -16,10 +18,31 @@ public:
                                             const VkVertexInputAttributeDescription * attributes,
                                             uint32_t attributeCount);
 
+    // Derives a tightly packed, per-vertex input state from vertex shader reflection
+    GraphicsPipelineBuilder& SetVertexInput(const ShaderReflection& vertexShader,
+                                            uint32_t binding = 0);
+
+    // Like SetVertexInput(vertexShader), but inputs at firstInstanceLocation and above are
+    // packed into a second binding (binding + 1) with VK_VERTEX_INPUT_RATE_INSTANCE
+    GraphicsPipelineBuilder& SetVertexInputInstanced(const ShaderReflection& vertexShader,
+                                                     uint32_t firstInstanceLocation,
+                                                     uint32_t binding = 0);
+
+    // Appends to the current vertex input state, e.g. an instance-rate binding next to an
+    // explicit per-vertex layout
+    GraphicsPipelineBuilder& AddVertexBinding(uint32_t binding, uint32_t stride,
+                                              VkVertexInputRate inputRate);
+    GraphicsPipelineBuilder& AddVertexAttribute(uint32_t location, uint32_t binding,
+                                                VkFormat format, uint32_t offset);
+
     // Sets the viewport and scissor
     GraphicsPipelineBuilder& SetViewport(VkExtent2D extent);
     GraphicsPipelineBuilder& setViewport(const VkViewport& viewport, VkRect2D scisor);
 
+    // State set with vkCmdSet* while recording instead of baked into the pipeline, e.g.
+    // VK_DYNAMIC_STATE_VIEWPORT when the render area changes from frame to frame
+    GraphicsPipelineBuilder& AddDynamicState(VkDynamicState state);
+
     // Sets the color blend attachment state
     void SetColorBlendAttachment(const VkPipelineColorBlendAttachmentState& state);
 
@@ -29,9 +52,18 @@ public:
     // Sets the depth stencil state
     void SetDepthStencilState(const VkPipelineDepthStencilStateCreateInfo& state);
 
+    // Rasterization samples; must match the sample count of the attachments rendered to
+    GraphicsPipelineBuilder& SetSampleCount(VkSampleCountFlagBits samples);
+
     // Sets the pipeline layout
     GraphicsPipelineBuilder& SetPipelineLayout(VkPipelineLayout layout);
 
+    // Sets VkPipelineCreateFlags (e.g. DescriptorAllocator::GetPipelineCreateFlags())
+    GraphicsPipelineBuilder& SetPipelineFlags(VkPipelineCreateFlags flags);
+
+    // Defaults to VulkanContext::GetPipelineCache(); VK_NULL_HANDLE builds without a cache
+    GraphicsPipelineBuilder& SetPipelineCache(VkPipelineCache cache);
+
     // Sets the render pass and subpass
     GraphicsPipelineBuilder& UseRenderPass(VkRenderPass renderPass, uint32_t subpass);
 
@@ -48,6 +80,8 @@ public:
     SetTessellationState(const VkPipelineTessellationStateCreateInfo& state);
 
 private:
+    void UpdateVertexInputInfo();
+
     VkDevice m_device;
 
     std::vector<VkPipelineShaderStageCreateInfo> m_shaderStages;
@@ -66,11 +100,14 @@ private:
     VkPipelineColorBlendAttachmentState m_colorBlendAttachment{};
     VkPipelineColorBlendStateCreateInfo m_colorBlendState{};
     VkPipelineDepthStencilStateCreateInfo m_depthStencilState{};
+    std::vector<VkDynamicState> m_dynamicStates;
 
     bool m_tessellationEnabled = false;
     VkPipelineTessellationStateCreateInfo m_tessellationState{};
 
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipelineCreateFlags m_pipelineFlags = 0;
+    VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
     VkFormat m_colorFormat = VK_FORMAT_UNDEFINED;
     VkFormat m_depthFormat = VK_FORMAT_UNDEFINED;
 
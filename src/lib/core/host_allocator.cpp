@@ -0,0 +1,414 @@
+#include "host_allocator.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace {
+
+enum class BlockSource : uint8_t {
+    Heap,
+    Arena,
+    Pool,
+};
+
+// Stored right before every pointer handed to the driver
+struct alignas(16) BlockHeader {
+    // Arena or Pool the block came from
+    void* owner;
+    size_t size;
+    // User pointer minus block start
+    uint32_t offset;
+    BlockSource source;
+    uint8_t scope;
+};
+
+constexpr size_t HeaderSize = sizeof(BlockHeader);
+// malloc's guarantee, and the smallest alignment blocks are placed at
+constexpr size_t MinAlignment = 16;
+constexpr size_t PoolChunkSize = 64 << 10;
+constexpr size_t SmallestPoolBlock = 32;
+
+// Header of one malloc'd block, followed by ArenaSize bytes. The owning thread holds one
+// reference and every live block another, so a block freed on another thread after its owner
+// exited still finds the arena. Frees may come from any thread.
+struct alignas(16) Arena {
+    size_t head = 0;
+    std::atomic<uint32_t> references{1};
+
+    std::byte* GetBase() { return reinterpret_cast<std::byte*>(this + 1); }
+};
+
+Arena* CreateArena()
+{
+    void* block = std::malloc(sizeof(Arena) + HostAllocator::ArenaSize);
+    return block != nullptr ? new (block) Arena : nullptr;
+}
+
+void ReleaseArena(Arena* arena)
+{
+    if (arena->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        arena->~Arena();
+        std::free(arena);
+    }
+}
+
+// Drops the thread's reference when the thread exits
+struct ThreadArena {
+    Arena* arena = nullptr;
+
+    ~ThreadArena()
+    {
+        if (arena != nullptr) {
+            ReleaseArena(arena);
+        }
+    }
+};
+
+thread_local ThreadArena t_arena;
+
+BlockHeader* GetHeader(void* memory)
+{
+    return reinterpret_cast<BlockHeader*>(static_cast<std::byte*>(memory) - HeaderSize);
+}
+
+// Bytes a block needs so that an aligned user pointer with a header in front fits
+size_t GetBlockSize(size_t size, size_t alignment)
+{
+    return size + HeaderSize + std::max(alignment, MinAlignment) - MinAlignment;
+}
+
+// Places the header in block and returns the user pointer, or nullptr if size does not fit
+void* PlaceBlock(void* block, size_t capacity, size_t size, size_t alignment, void* owner,
+                 BlockSource source, VkSystemAllocationScope scope)
+{
+    const auto start = reinterpret_cast<uintptr_t>(block);
+    const uintptr_t mask = std::max(alignment, MinAlignment) - 1;
+    const uintptr_t user = (start + HeaderSize + mask) & ~mask;
+    if (user + size > start + capacity) {
+        return nullptr;
+    }
+    auto* memory = reinterpret_cast<void*>(user);
+    *GetHeader(memory) = BlockHeader{
+        .owner = owner,
+        .size = size,
+        .offset = static_cast<uint32_t>(user - start),
+        .source = source,
+        .scope = static_cast<uint8_t>(scope),
+    };
+    return memory;
+}
+
+void* GetBlockStart(void* memory)
+{
+    return static_cast<std::byte*>(memory) - GetHeader(memory)->offset;
+}
+
+} // namespace
+
+uint64_t HostAllocator::FrameStats::GetDriverAllocations() const
+{
+    uint64_t count = 0;
+    for (auto allocations : driverAllocations) {
+        count += allocations;
+    }
+    return count;
+}
+
+uint64_t HostAllocator::FrameStats::GetDriverHeapAllocations() const
+{
+    uint64_t count = 0;
+    for (auto allocations : driverHeapAllocations) {
+        count += allocations;
+    }
+    return count;
+}
+
+HostAllocator::HostAllocator()
+{
+    m_callbacks = VkAllocationCallbacks{
+        .pUserData = this,
+        .pfnAllocation = &HostAllocator::Allocation,
+        .pfnReallocation = &HostAllocator::Reallocation,
+        .pfnFree = &HostAllocator::Free,
+        .pfnInternalAllocation = &HostAllocator::InternalAllocation,
+        .pfnInternalFree = &HostAllocator::InternalFree,
+    };
+    for (size_t i = 0; i < m_pools.size(); ++i) {
+        m_pools[i].blockSize = SmallestPoolBlock << i;
+    }
+}
+
+HostAllocator::~HostAllocator()
+{
+    // Objects still alive at this point were leaked by the caller; their blocks go with the
+    // chunks
+    for (auto& pool : m_pools) {
+        for (void* chunk : pool.chunks) {
+            std::free(chunk);
+        }
+    }
+}
+
+void* VKAPI_CALL HostAllocator::Allocation(void* userData, size_t size, size_t alignment,
+                                           VkSystemAllocationScope scope)
+{
+    return static_cast<HostAllocator*>(userData)->Allocate(size, alignment, scope);
+}
+
+void* VKAPI_CALL HostAllocator::Reallocation(void* userData, void* original, size_t size,
+                                             size_t alignment, VkSystemAllocationScope scope)
+{
+    auto* self = static_cast<HostAllocator*>(userData);
+    if (original == nullptr) {
+        return self->Allocate(size, alignment, scope);
+    }
+    if (size == 0) {
+        self->Release(original);
+        return nullptr;
+    }
+    void* memory = self->Allocate(size, alignment, scope);
+    if (memory == nullptr) {
+        // The original stays valid
+        return nullptr;
+    }
+    std::memcpy(memory, original, std::min(size, GetHeader(original)->size));
+    self->Release(original);
+    return memory;
+}
+
+void VKAPI_CALL HostAllocator::Free(void* userData, void* memory)
+{
+    if (memory != nullptr) {
+        static_cast<HostAllocator*>(userData)->Release(memory);
+    }
+}
+
+void VKAPI_CALL HostAllocator::InternalAllocation(void* userData, size_t,
+                                                  VkInternalAllocationType,
+                                                  VkSystemAllocationScope scope)
+{
+    auto* self = static_cast<HostAllocator*>(userData);
+    self->m_counters[scope].internalAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void VKAPI_CALL HostAllocator::InternalFree(void*, size_t, VkInternalAllocationType,
+                                            VkSystemAllocationScope)
+{
+}
+
+void* HostAllocator::Allocate(size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+    if (size == 0) {
+        return nullptr;
+    }
+    auto& counters = m_counters[scope];
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.liveBytes.fetch_add(size, std::memory_order_relaxed);
+
+    void* memory = nullptr;
+    if (scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND) {
+        Arena*& arena = t_arena.arena;
+        if (arena == nullptr) {
+            arena = CreateArena();
+            counters.heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (arena != nullptr) {
+            // Only the owning thread adds references, so none of its blocks is live
+            if (arena->references.load(std::memory_order_acquire) == 1) {
+                arena->head = 0;
+            }
+            std::byte* base = arena->GetBase();
+            memory = PlaceBlock(base + arena->head, ArenaSize - arena->head, size, alignment,
+                                arena, BlockSource::Arena, scope);
+        }
+        if (memory != nullptr) {
+            arena->head = static_cast<std::byte*>(memory) + size - arena->GetBase();
+            arena->references.fetch_add(1, std::memory_order_relaxed);
+            return memory;
+        }
+        counters.heapFallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (scope == VK_SYSTEM_ALLOCATION_SCOPE_OBJECT) {
+        memory = AllocateFromPool(size, alignment, scope);
+        if (memory != nullptr) {
+            return memory;
+        }
+        counters.heapFallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+    memory = AllocateFromHeap(size, alignment, scope);
+    if (memory == nullptr) {
+        counters.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+    else {
+        counters.heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return memory;
+}
+
+void HostAllocator::Release(void* memory)
+{
+    const BlockHeader header = *GetHeader(memory);
+    auto& counters = m_counters[header.scope];
+    counters.frees.fetch_add(1, std::memory_order_relaxed);
+    counters.liveBytes.fetch_sub(header.size, std::memory_order_relaxed);
+
+    switch (header.source) {
+    case BlockSource::Arena:
+        // Rewound by the owning thread's next allocation once only its reference is left;
+        // freed here if that thread has exited
+        ReleaseArena(static_cast<Arena*>(header.owner));
+        break;
+    case BlockSource::Pool: {
+        auto& pool = *static_cast<Pool*>(header.owner);
+        void* block = GetBlockStart(memory);
+        std::lock_guard lock(pool.mutex);
+        *static_cast<void**>(block) = pool.freeList;
+        pool.freeList = block;
+        break;
+    }
+    case BlockSource::Heap:
+        std::free(GetBlockStart(memory));
+        break;
+    }
+}
+
+void* HostAllocator::AllocateFromPool(size_t size, size_t alignment,
+                                      VkSystemAllocationScope scope)
+{
+    const size_t blockSize = GetBlockSize(size, alignment);
+    if (blockSize > MaxPooledSize) {
+        return nullptr;
+    }
+    auto it = std::find_if(m_pools.begin(), m_pools.end(),
+                           [blockSize](const Pool& pool) { return pool.blockSize >= blockSize; });
+    auto& pool = *it;
+
+    void* block = nullptr;
+    {
+        std::lock_guard lock(pool.mutex);
+        if (pool.freeList == nullptr) {
+            auto* chunk = static_cast<std::byte*>(std::malloc(PoolChunkSize));
+            if (chunk == nullptr) {
+                return nullptr;
+            }
+            pool.chunks.push_back(chunk);
+            m_counters[scope].heapAllocations.fetch_add(1, std::memory_order_relaxed);
+            for (size_t offset = 0; offset + pool.blockSize <= PoolChunkSize;
+                 offset += pool.blockSize) {
+                *reinterpret_cast<void**>(chunk + offset) = pool.freeList;
+                pool.freeList = chunk + offset;
+            }
+        }
+        block = pool.freeList;
+        pool.freeList = *static_cast<void**>(block);
+    }
+    return PlaceBlock(block, pool.blockSize, size, alignment, &pool, BlockSource::Pool, scope);
+}
+
+void* HostAllocator::AllocateFromHeap(size_t size, size_t alignment,
+                                      VkSystemAllocationScope scope)
+{
+    const size_t capacity = GetBlockSize(size, alignment);
+    void* block = std::malloc(capacity);
+    if (block == nullptr) {
+        return nullptr;
+    }
+    return PlaceBlock(block, capacity, size, alignment, nullptr, BlockSource::Heap, scope);
+}
+
+void HostAllocator::OnFrame()
+{
+    FrameStats stats;
+    stats.frame = m_lastFrame.frame + 1;
+    for (uint32_t scope = 0; scope < ScopeCount; ++scope) {
+        const uint64_t total = m_counters[scope].allocations.load(std::memory_order_relaxed);
+        stats.driverAllocations[scope] = total - m_frameBaseline[scope];
+        m_frameBaseline[scope] = total;
+        const uint64_t heap = m_counters[scope].heapAllocations.load(std::memory_order_relaxed);
+        stats.driverHeapAllocations[scope] = heap - m_heapBaseline[scope];
+        m_heapBaseline[scope] = heap;
+    }
+    if (m_hostAllocationCounter) {
+        const uint64_t total = m_hostAllocationCounter();
+        stats.hostAllocations = total - m_hostBaseline;
+        m_hostBaseline = total;
+    }
+    m_lastFrame = stats;
+
+    if (!m_inSteadyState || m_steadyStateMode == SteadyStateMode::Off ||
+        (stats.GetDriverHeapAllocations() == 0 && stats.hostAllocations == 0)) {
+        return;
+    }
+    ++m_steadyStateViolations;
+    std::cerr << "[host-alloc] frame " << stats.frame << " hit the heap in steady state: driver";
+    for (uint32_t scope = 0; scope < ScopeCount; ++scope) {
+        std::cerr << " " << GetScopeName(static_cast<VkSystemAllocationScope>(scope)) << " "
+                  << stats.driverHeapAllocations[scope];
+    }
+    std::cerr << " (" << stats.GetDriverAllocations() << " callbacks), host "
+              << stats.hostAllocations << std::endl;
+    if (m_steadyStateMode == SteadyStateMode::Assert) {
+        std::abort();
+    }
+}
+
+HostAllocator::ScopeStats HostAllocator::GetScopeStats(VkSystemAllocationScope scope) const
+{
+    const auto& counters = m_counters[scope];
+    return ScopeStats{
+        .allocations = counters.allocations.load(std::memory_order_relaxed),
+        .frees = counters.frees.load(std::memory_order_relaxed),
+        .liveBytes = counters.liveBytes.load(std::memory_order_relaxed),
+        .heapFallbacks = counters.heapFallbacks.load(std::memory_order_relaxed),
+        .heapAllocations = counters.heapAllocations.load(std::memory_order_relaxed),
+        .internalAllocations = counters.internalAllocations.load(std::memory_order_relaxed),
+    };
+}
+
+uint64_t HostAllocator::GetTotalAllocations() const
+{
+    uint64_t count = 0;
+    for (const auto& counters : m_counters) {
+        count += counters.allocations.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+void HostAllocator::SetHostAllocationCounter(std::function<uint64_t()> counter)
+{
+    m_hostAllocationCounter = std::move(counter);
+    m_hostBaseline = m_hostAllocationCounter ? m_hostAllocationCounter() : 0;
+}
+
+void HostAllocator::BeginSteadyState()
+{
+    // Whatever was allocated before this call belongs to setup, not to the next frame
+    for (uint32_t scope = 0; scope < ScopeCount; ++scope) {
+        m_frameBaseline[scope] = m_counters[scope].allocations.load(std::memory_order_relaxed);
+        m_heapBaseline[scope] =
+            m_counters[scope].heapAllocations.load(std::memory_order_relaxed);
+    }
+    if (m_hostAllocationCounter) {
+        m_hostBaseline = m_hostAllocationCounter();
+    }
+    m_inSteadyState = true;
+}
+
+void HostAllocator::EndSteadyState()
+{
+    m_inSteadyState = false;
+}
+
+const char* HostAllocator::GetScopeName(VkSystemAllocationScope scope)
+{
+    switch (scope) {
+    case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND: return "command";
+    case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT: return "object";
+    case VK_SYSTEM_ALLOCATION_SCOPE_CACHE: return "cache";
+    case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE: return "device";
+    case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE: return "instance";
+    default: return "unknown";
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// VkAllocationCallbacks for the device and everything created from it.
+//
+// COMMAND-scope allocations only live for the duration of one vk* call, so they are bumped from
+// a per-thread arena that rewinds once everything in it has been freed. OBJECT-scope
+// allocations come from size-class pools. Other scopes, and anything too large for the arena or
+// the pools, fall through to malloc. Every allocation callback is counted per scope and per
+// frame, and so is every malloc behind them (heap blocks, pool chunks, arenas).
+//
+// Steady-state checking: between BeginSteadyState and EndSteadyState a frame that hits the heap,
+// in the driver's callbacks or (with SetHostAllocationCounter) in our own code, is reported or
+// aborts. Callbacks served by the arenas or pools do not count.
+class HostAllocator {
+public:
+    enum class SteadyStateMode {
+        Off,
+        // Logs every frame that allocates and counts it in GetSteadyStateViolations
+        Report,
+        // Logs and aborts on the first frame that allocates
+        Assert,
+    };
+
+    static constexpr uint32_t ScopeCount = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+    // Per thread, for COMMAND scope
+    static constexpr size_t ArenaSize = 256 << 10;
+    // Largest OBJECT-scope block served from a pool, header and alignment included
+    static constexpr size_t MaxPooledSize = 4096;
+
+    struct ScopeStats {
+        uint64_t allocations = 0;
+        uint64_t frees = 0;
+        uint64_t liveBytes = 0;
+        // Allocations the arena or pools could not serve
+        uint64_t heapFallbacks = 0;
+        // mallocs: heap blocks plus the pool chunks and arenas created for this scope
+        uint64_t heapAllocations = 0;
+        // Reported through pfnInternalAllocation (driver-owned executable memory etc.)
+        uint64_t internalAllocations = 0;
+    };
+
+    struct FrameStats {
+        uint64_t frame = 0;
+        // Allocation callbacks, wherever they were served from
+        std::array<uint64_t, ScopeCount> driverAllocations{};
+        // mallocs behind those callbacks
+        std::array<uint64_t, ScopeCount> driverHeapAllocations{};
+        uint64_t hostAllocations = 0;
+
+        uint64_t GetDriverAllocations() const;
+        uint64_t GetDriverHeapAllocations() const;
+    };
+
+    HostAllocator();
+    ~HostAllocator();
+
+    HostAllocator(const HostAllocator&) = delete;
+    HostAllocator& operator=(const HostAllocator&) = delete;
+
+    const VkAllocationCallbacks* GetCallbacks() const { return &m_callbacks; }
+
+    // Called by VulkanContext once per frame; closes the previous frame's counters
+    void OnFrame();
+    const FrameStats& GetLastFrameStats() const { return m_lastFrame; }
+    ScopeStats GetScopeStats(VkSystemAllocationScope scope) const;
+    // Driver allocations of every scope since construction
+    uint64_t GetTotalAllocations() const;
+
+    // Monotonic count of our own heap allocations, e.g. from a replaced operator new. Without
+    // one the steady-state check only covers the driver.
+    void SetHostAllocationCounter(std::function<uint64_t()> counter);
+
+    void SetSteadyStateMode(SteadyStateMode mode) { m_steadyStateMode = mode; }
+    // Frames closed after this call must not allocate, until EndSteadyState
+    void BeginSteadyState();
+    void EndSteadyState();
+    uint64_t GetSteadyStateViolations() const { return m_steadyStateViolations; }
+
+    static const char* GetScopeName(VkSystemAllocationScope scope);
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> frees{0};
+        std::atomic<uint64_t> liveBytes{0};
+        std::atomic<uint64_t> heapFallbacks{0};
+        std::atomic<uint64_t> heapAllocations{0};
+        std::atomic<uint64_t> internalAllocations{0};
+    };
+
+    // Fixed-size blocks carved from chunks. Objects may be freed on another thread than the
+    // one that created them, so each size class has its own lock rather than a thread owner.
+    struct Pool {
+        std::mutex mutex;
+        size_t blockSize = 0;
+        void* freeList = nullptr;
+        std::vector<void*> chunks;
+    };
+
+    static void* VKAPI_CALL Allocation(void* userData, size_t size, size_t alignment,
+                                       VkSystemAllocationScope scope);
+    static void* VKAPI_CALL Reallocation(void* userData, void* original, size_t size,
+                                         size_t alignment, VkSystemAllocationScope scope);
+    static void VKAPI_CALL Free(void* userData, void* memory);
+    static void VKAPI_CALL InternalAllocation(void* userData, size_t size,
+                                              VkInternalAllocationType type,
+                                              VkSystemAllocationScope scope);
+    static void VKAPI_CALL InternalFree(void* userData, size_t size,
+                                        VkInternalAllocationType type,
+                                        VkSystemAllocationScope scope);
+
+    void* Allocate(size_t size, size_t alignment, VkSystemAllocationScope scope);
+    void Release(void* memory);
+    void* AllocateFromPool(size_t size, size_t alignment, VkSystemAllocationScope scope);
+    static void* AllocateFromHeap(size_t size, size_t alignment, VkSystemAllocationScope scope);
+
+    VkAllocationCallbacks m_callbacks{};
+    std::array<Counters, ScopeCount> m_counters;
+    // 32 .. MaxPooledSize
+    std::array<Pool, 8> m_pools;
+
+    // Render thread only
+    FrameStats m_lastFrame;
+    std::array<uint64_t, ScopeCount> m_frameBaseline{};
+    std::array<uint64_t, ScopeCount> m_heapBaseline{};
+    uint64_t m_hostBaseline = 0;
+    std::function<uint64_t()> m_hostAllocationCounter;
+    SteadyStateMode m_steadyStateMode = SteadyStateMode::Off;
+    bool m_inSteadyState = false;
+    uint64_t m_steadyStateViolations = 0;
+};
@@ -35,3 +35,29 @@ ImageLayoutTransition ImageLayoutTransition::FromColorToPresent()
         .dstStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
     };
 }
+
+ImageLayoutTransition ImageLayoutTransition::FromUndefinedToDepthAttachment()
+{
+    return {
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+        .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        .srcStage = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        .dstStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                    VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+    };
+}
+
+ImageLayoutTransition ImageLayoutTransition::FromTransferDstToPresent()
+{
+    return {
+        .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = 0,
+        .srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+        .dstStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+    };
+}
@@ -17,4 +17,10 @@ struct  ImageLayoutTransition {
 
     // `惌CAEgPresentSrcCAEg
     static ImageLayoutTransition FromColorToPresent();
+
+    // Discards previous depth contents (LOAD_OP_CLEAR); waits for the last frame's depth writes
+    static ImageLayoutTransition FromUndefinedToDepthAttachment();
+
+    // After a copy or blit into a swapchain image
+    static ImageLayoutTransition FromTransferDstToPresent();
 };
\ No newline at end of file
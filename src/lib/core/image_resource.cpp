@@ -1,4 +1,12 @@
 #include "image_resource.h"
+#include "core/buffer_resource.h"
+#include "core/command_buffer.h"
+#include "core/gpu_memory_tracker.h"
+#include "core/texture_loader.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
 #include <stdexcept>
 
 
@@ -6,6 +14,7 @@ bool DepthBuffer::Initialize(VkExtent2D extent, VkFormat depthFormat)
 {
     auto& VulkanCtx = VulkanContext::Get();
     auto device = VulkanCtx.GetVkDevice();
+    const auto* allocator = VulkanCtx.GetAllocationCallbacks();
 
     m_format = depthFormat;
     m_extent = extent;
@@ -25,7 +34,7 @@ bool DepthBuffer::Initialize(VkExtent2D extent, VkFormat depthFormat)
         .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
     };
 
-    if (vkCreateImage(device, &createInfo, nullptr, &m_image) != VK_SUCCESS) {
+    if (vkCreateImage(device, &createInfo, allocator, &m_image) != VK_SUCCESS) {
         return false;
     }
 
@@ -33,12 +42,9 @@ bool DepthBuffer::Initialize(VkExtent2D extent, VkFormat depthFormat)
     vkGetImageMemoryRequirements(device, m_image, &memRequirements);
 
     VkMemoryPropertyFlags memProps = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-    VkMemoryAllocateInfo allocInfo{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = memRequirements.size,
-        .memoryTypeIndex = VulkanCtx.FindMemoryType(memRequirements, memProps),
-    };
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &m_memory) != VK_SUCCESS) {
+    m_memory = VulkanCtx.AllocateMemory(memRequirements, memProps,
+                                        GpuMemoryCategory::RenderTarget, "DepthBuffer");
+    if (m_memory == VK_NULL_HANDLE) {
         return false;
     }
 
@@ -61,7 +67,7 @@ bool DepthBuffer::Initialize(VkExtent2D extent, VkFormat depthFormat)
         .format = createInfo.format,
         .subresourceRange = m_subresourceRange,
     };
-    if (vkCreateImageView(device, &viewCrateInfo, nullptr, &m_imageView) != VK_SUCCESS) {
+    if (vkCreateImageView(device, &viewCrateInfo, allocator, &m_imageView) != VK_SUCCESS) {
         return false;
     }
     return true;
@@ -71,17 +77,503 @@ void DepthBuffer::Cleanup()
 {
     auto& VulkanCtx = VulkanContext::Get();
     auto device = VulkanCtx.GetVkDevice();
+    const auto* allocator = VulkanCtx.GetAllocationCallbacks();
+
+    if (m_imageView != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, m_imageView, allocator);
+        m_imageView = VK_NULL_HANDLE;
+    }
+    if (m_image != VK_NULL_HANDLE) {
+        vkDestroyImage(device, m_image, allocator);
+        m_image = VK_NULL_HANDLE;
+    }
+    if (m_memory != VK_NULL_HANDLE) {
+        VulkanCtx.FreeMemory(m_memory);
+        m_memory = VK_NULL_HANDLE;
+    }
+}
+
+bool ColorTarget::Initialize(VkExtent2D extent, VkFormat format)
+{
+    auto& VulkanCtx = VulkanContext::Get();
+    auto device = VulkanCtx.GetVkDevice();
+    const auto* allocator = VulkanCtx.GetAllocationCallbacks();
+
+    m_format = format;
+    m_extent = extent;
+    m_mipLevels = 1;
+
+    VkImageCreateInfo createInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = m_format,
+        .extent = {m_extent.width, m_extent.height, 1},
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+                 VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    if (vkCreateImage(device, &createInfo, allocator, &m_image) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device, m_image, &memRequirements);
+    m_memory = VulkanCtx.AllocateMemory(memRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                        GpuMemoryCategory::RenderTarget, "ColorTarget");
+    if (m_memory == VK_NULL_HANDLE) {
+        return false;
+    }
+    if (vkBindImageMemory(device, m_image, m_memory, 0) != VK_SUCCESS) {
+        return false;
+    }
+
+    m_subresourceRange = {
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+    VkImageViewCreateInfo viewCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = m_image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = m_format,
+        .subresourceRange = m_subresourceRange,
+    };
+    return vkCreateImageView(device, &viewCreateInfo, allocator, &m_imageView) == VK_SUCCESS;
+}
+
+void ColorTarget::Cleanup()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    if (m_imageView != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, m_imageView, allocator);
+        m_imageView = VK_NULL_HANDLE;
+    }
+    if (m_image != VK_NULL_HANDLE) {
+        vkDestroyImage(device, m_image, allocator);
+        m_image = VK_NULL_HANDLE;
+    }
+    if (m_memory != VK_NULL_HANDLE) {
+        VulkanContext::Get().FreeMemory(m_memory);
+        m_memory = VK_NULL_HANDLE;
+    }
+}
+
+bool MultisampleTarget::Initialize(VkExtent2D extent, VkFormat format,
+                                   VkSampleCountFlagBits samples)
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+
+    m_format = format;
+    m_extent = extent;
+    m_mipLevels = 1;
+    m_samples = samples;
+
+    VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    switch (format) {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+        aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+        usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        break;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        aspect = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        break;
+    default:
+        break;
+    }
+
+    VkImageCreateInfo createInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = m_format,
+        .extent = {m_extent.width, m_extent.height, 1},
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = m_samples,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = usage | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    if (vkCreateImage(device, &createInfo, allocator, &m_image) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device, m_image, &memRequirements);
+    VkMemoryPropertyFlags memProps = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    m_lazilyAllocated = vulkanCtx.HasMemoryType(
+        memRequirements, memProps | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+    if (m_lazilyAllocated) {
+        memProps |= VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+    }
+    m_memory = vulkanCtx.AllocateMemory(memRequirements, memProps,
+                                        GpuMemoryCategory::RenderTarget, "MultisampleTarget");
+    if (m_memory == VK_NULL_HANDLE) {
+        return false;
+    }
+    if (vkBindImageMemory(device, m_image, m_memory, 0) != VK_SUCCESS) {
+        return false;
+    }
+    m_size = memRequirements.size;
+
+    m_subresourceRange = {
+        .aspectMask = aspect,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+    VkImageViewCreateInfo viewCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = m_image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = m_format,
+        .subresourceRange = m_subresourceRange,
+    };
+    return vkCreateImageView(device, &viewCreateInfo, allocator, &m_imageView) == VK_SUCCESS;
+}
+
+void MultisampleTarget::Cleanup()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    if (m_imageView != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, m_imageView, allocator);
+        m_imageView = VK_NULL_HANDLE;
+    }
+    if (m_image != VK_NULL_HANDLE) {
+        vkDestroyImage(device, m_image, allocator);
+        m_image = VK_NULL_HANDLE;
+    }
+    if (m_memory != VK_NULL_HANDLE) {
+        vulkanCtx.FreeMemory(m_memory);
+        m_memory = VK_NULL_HANDLE;
+    }
+}
+
+VkDeviceSize MultisampleTarget::GetCommittedBytes() const
+{
+    if (!m_lazilyAllocated) {
+        return m_size;
+    }
+    VkDeviceSize committed = 0;
+    vkGetDeviceMemoryCommitment(VulkanContext::Get().GetVkDevice(), m_memory, &committed);
+    return committed;
+}
+
+bool Texture2D::Initialize(VkExtent2D extent, VkFormat format, uint32_t mipLevels)
+{
+    auto& VulkanCtx = VulkanContext::Get();
+    auto device = VulkanCtx.GetVkDevice();
+    const auto* allocator = VulkanCtx.GetAllocationCallbacks();
+
+    m_format = format;
+    m_extent = extent;
+    m_mipLevels = mipLevels == 0 ? GetFullMipCount(extent) : mipLevels;
+
+    VkImageCreateInfo createInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = m_format,
+        .extent = {m_extent.width, m_extent.height, 1},
+        .mipLevels = m_mipLevels,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                 VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    if (vkCreateImage(device, &createInfo, allocator, &m_image) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device, m_image, &memRequirements);
+    m_memory = VulkanCtx.AllocateMemory(memRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                        GpuMemoryCategory::Texture, "Texture2D");
+    if (m_memory == VK_NULL_HANDLE) {
+        return false;
+    }
+    if (vkBindImageMemory(device, m_image, m_memory, 0) != VK_SUCCESS) {
+        return false;
+    }
+
+    m_subresourceRange = {
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = m_mipLevels,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+    VkImageViewCreateInfo viewCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = m_image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = m_format,
+        .subresourceRange = m_subresourceRange,
+    };
+    if (vkCreateImageView(device, &viewCreateInfo, allocator, &m_imageView) != VK_SUCCESS) {
+        return false;
+    }
+
+    m_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    m_accessFlags = VK_ACCESS_NONE;
+    m_stageFlags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    return true;
+}
+
+void Texture2D::Cleanup()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
 
     if (m_imageView != VK_NULL_HANDLE) {
-        vkDestroyImageView(device, m_imageView, nullptr);
+        vkDestroyImageView(device, m_imageView, allocator);
         m_imageView = VK_NULL_HANDLE;
     }
     if (m_image != VK_NULL_HANDLE) {
-        vkDestroyImage(device, m_image, nullptr);
+        vkDestroyImage(device, m_image, allocator);
         m_image = VK_NULL_HANDLE;
     }
     if (m_memory != VK_NULL_HANDLE) {
-        vkFreeMemory(device, m_memory, nullptr);
+        VulkanContext::Get().FreeMemory(m_memory);
         m_memory = VK_NULL_HANDLE;
     }
 }
+
+VkDescriptorImageInfo Texture2D::GetDescriptorInfo(VkSampler sampler) const
+{
+    return VkDescriptorImageInfo{
+        .sampler = sampler,
+        .imageView = m_imageView,
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    };
+}
+
+void Texture2D::TransitionLayout(CommandBuffer& commandBuffer, VkImageLayout newLayout,
+                                 VkAccessFlags dstAccess, VkPipelineStageFlags dstStage)
+{
+    ImageLayoutTransition transition{
+        .oldLayout = m_layout,
+        .newLayout = newLayout,
+        .srcAccessMask = m_accessFlags,
+        .dstAccessMask = dstAccess,
+        .srcStage = m_stageFlags,
+        .dstStage = dstStage,
+    };
+    commandBuffer.TransitionLayout(m_image, m_subresourceRange, transition);
+
+    m_layout = newLayout;
+    m_accessFlags = dstAccess;
+    m_stageFlags = dstStage;
+}
+
+void Texture2D::GenerateMipmaps(CommandBuffer& commandBuffer)
+{
+    VkImageSubresourceRange levelRange = m_subresourceRange;
+    levelRange.levelCount = 1;
+
+    int32_t width = static_cast<int32_t>(m_extent.width);
+    int32_t height = static_cast<int32_t>(m_extent.height);
+    for (uint32_t level = 1; level < m_mipLevels; ++level) {
+        // Previous level: written by copy or blit -> blit source
+        levelRange.baseMipLevel = level - 1;
+        commandBuffer.TransitionLayout(m_image, levelRange, {
+            .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+            .srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+            .dstStage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+        });
+
+        int32_t nextWidth = std::max(width / 2, 1);
+        int32_t nextHeight = std::max(height / 2, 1);
+        VkImageBlit blit{
+            .srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1},
+            .srcOffsets = {{0, 0, 0}, {width, height, 1}},
+            .dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1},
+            .dstOffsets = {{0, 0, 0}, {nextWidth, nextHeight, 1}},
+        };
+        vkCmdBlitImage(commandBuffer, m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_image,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        commandBuffer.TransitionLayout(m_image, levelRange, {
+            .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            .srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+            .srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+            .dstStage = ShaderReadStages,
+        });
+        width = nextWidth;
+        height = nextHeight;
+    }
+
+    // The last level was only ever a blit destination
+    levelRange.baseMipLevel = m_mipLevels - 1;
+    commandBuffer.TransitionLayout(m_image, levelRange, {
+        .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        .srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+        .dstStage = ShaderReadStages,
+    });
+
+    m_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    m_accessFlags = VK_ACCESS_SHADER_READ_BIT;
+    m_stageFlags = ShaderReadStages;
+}
+
+bool Texture2D::CanGenerateMipmaps(VkFormat format)
+{
+    VkFormatProperties props{};
+    vkGetPhysicalDeviceFormatProperties(VulkanContext::Get().GetVkPhysicalDevice(), format, &props);
+    const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                                          VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                          VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (props.optimalTilingFeatures & required) == required;
+}
+
+uint32_t Texture2D::GetFullMipCount(VkExtent2D extent)
+{
+    return static_cast<uint32_t>(std::bit_width(std::max({extent.width, extent.height, 1u})));
+}
+
+std::shared_ptr<Texture2D> Texture2D::LoadFromFile(const std::filesystem::path& path, bool srgb,
+                                                   bool generateMipmaps)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return nullptr;
+    }
+    TextureFileInfo info{};
+    if (!loader::ReadTextureFileInfo(file, path, srgb, info)) {
+        return nullptr;
+    }
+
+    // Precomputed mips win; otherwise build the chain on the GPU when the format allows it
+    const bool hasMips = info.levels.size() > 1;
+    const bool generate = !hasMips && (generateMipmaps || info.requestsGeneratedMips) &&
+                          CanGenerateMipmaps(info.format);
+    const uint32_t mipLevels = hasMips ? static_cast<uint32_t>(info.levels.size())
+                                       : (generate ? 0 : 1);
+
+    auto staging = StagingBuffer::Create(info.totalSize);
+    if (!staging) {
+        return nullptr;
+    }
+    void* mapped = staging->Map();
+    const bool read = loader::ReadTextureLevels(file, info, mapped);
+    staging->Unmap();
+    if (!read) {
+        return nullptr;
+    }
+
+    auto texture = Create(info.extent, info.format, mipLevels);
+    if (!texture) {
+        return nullptr;
+    }
+
+    std::vector<VkBufferImageCopy> regions;
+    for (uint32_t level = 0; auto& fileLevel : info.levels) {
+        regions.push_back(VkBufferImageCopy{
+            .bufferOffset = fileLevel.dstOffset,
+            .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level++, 0, 1},
+            .imageExtent = {fileLevel.extent.width, fileLevel.extent.height, 1},
+        });
+    }
+    if (!texture->Upload(*staging, regions, generate)) {
+        return nullptr;
+    }
+    return texture;
+}
+
+std::shared_ptr<Texture2D> Texture2D::CreateFromMemory(VkExtent2D extent, VkFormat format,
+                                                       const void* pixels, bool generateMipmaps)
+{
+    const VkDeviceSize size = loader::GetImageByteSize(format, extent);
+    if (size == 0) {
+        return nullptr;
+    }
+    const bool generate = generateMipmaps && CanGenerateMipmaps(format);
+
+    auto staging = StagingBuffer::Create(size);
+    if (!staging) {
+        return nullptr;
+    }
+    std::memcpy(staging->Map(), pixels, static_cast<size_t>(size));
+    staging->Unmap();
+
+    auto texture = Create(extent, format, generate ? 0 : 1);
+    if (!texture) {
+        return nullptr;
+    }
+    std::vector<VkBufferImageCopy> regions = {{
+        .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+        .imageExtent = {extent.width, extent.height, 1},
+    }};
+    if (!texture->Upload(*staging, regions, generate)) {
+        return nullptr;
+    }
+    return texture;
+}
+
+void Texture2D::RecordUpload(CommandBuffer& commandBuffer, StagingBuffer& staging,
+                             const std::vector<VkBufferImageCopy>& regions)
+{
+    TransitionLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                     VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    vkCmdCopyBufferToImage(commandBuffer, staging.GetVkBuffer(), m_image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+    TransitionLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_SHADER_READ_BIT, ShaderReadStages);
+}
+
+bool Texture2D::Upload(StagingBuffer& staging, const std::vector<VkBufferImageCopy>& regions,
+                       bool generateMipmaps)
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto commandBuffer = vulkanCtx.CreateCommandBuffer();
+    commandBuffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+    if (generateMipmaps && m_mipLevels > 1) {
+        TransitionLayout(*commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        vkCmdCopyBufferToImage(*commandBuffer, staging.GetVkBuffer(), m_image,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(regions.size()), regions.data());
+        GenerateMipmaps(*commandBuffer);
+    }
+    else {
+        RecordUpload(*commandBuffer, staging, regions);
+    }
+
+    commandBuffer->End();
+    vulkanCtx.SubmitAndWait(commandBuffer);
+    return true;
+}
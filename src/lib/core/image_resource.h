@@ -1,6 +1,11 @@
 #pragma once
 #include "core/vulkan_context.h"
 #include "core/gpu_resource_base.h"
+#include <filesystem>
+#include <vector>
+
+class CommandBuffer;
+class StagingBuffer;
 
 class IImageResource {
 public:
@@ -35,6 +40,14 @@ public:
     virtual void SetLayout(VkImageLayout layout) { m_layout = layout; }
     virtual VkImageLayout GetLayout() const { return m_layout; }
 
+    // Names the image and its memory for debug tools and the GPU memory tracker
+    void SetDebugName(const char* name)
+    {
+        auto& vulkanCtx = VulkanContext::Get();
+        vulkanCtx.SetDebugObjectName(reinterpret_cast<void*>(m_image), VK_OBJECT_TYPE_IMAGE, name);
+        vulkanCtx.SetMemoryName(m_memory, name);
+    }
+
 protected:
     ImageResource() = default;
 
@@ -71,4 +84,130 @@ public:
 
 private:
     VkImageView m_imageView{};
-};
\ No newline at end of file
+};
+
+// Color attachment that can also be sampled or copied from, e.g. an offscreen render target
+class ColorTarget : public ImageResource<ColorTarget> {
+    friend class GpuResourceBase<ColorTarget>;
+
+public:
+    virtual ~ColorTarget() { Cleanup(); }
+    virtual void Cleanup() override;
+
+    bool Initialize(VkExtent2D extent, VkFormat format);
+    VkImageView GetVkImageView() const { return m_imageView; }
+
+    // Create, Initialize call once
+    static std::shared_ptr<ColorTarget> Create(VkExtent2D extent, VkFormat format)
+    {
+        auto image = GpuResourceBase::Create();
+        if (!image->Initialize(extent, format)) {
+            return nullptr;
+        }
+        return image;
+    }
+
+private:
+    VkImageView m_imageView{};
+};
+
+// Multisampled color or depth attachment that only lives within a render pass: it is resolved
+// into a single-sample image by vkCmdBeginRendering's resolve and stored with DONT_CARE. Backed
+// by lazily allocated memory where the device has it (tile-based GPUs then never commit any),
+// otherwise by ordinary device-local memory.
+class MultisampleTarget : public ImageResource<MultisampleTarget> {
+    friend class GpuResourceBase<MultisampleTarget>;
+
+public:
+    virtual ~MultisampleTarget() { Cleanup(); }
+    virtual void Cleanup() override;
+
+    // The aspect (color or depth) follows from format
+    bool Initialize(VkExtent2D extent, VkFormat format, VkSampleCountFlagBits samples);
+    VkImageView GetVkImageView() const { return m_imageView; }
+    VkSampleCountFlagBits GetSampleCount() const { return m_samples; }
+    bool IsLazilyAllocated() const { return m_lazilyAllocated; }
+    // Memory the driver has actually committed; for lazily allocated memory this stays 0 as
+    // long as the samples never leave tile memory
+    VkDeviceSize GetCommittedBytes() const;
+
+    // Create, Initialize call once
+    static std::shared_ptr<MultisampleTarget> Create(VkExtent2D extent, VkFormat format,
+                                                     VkSampleCountFlagBits samples)
+    {
+        auto image = GpuResourceBase::Create();
+        if (!image->Initialize(extent, format, samples)) {
+            return nullptr;
+        }
+        return image;
+    }
+
+private:
+    VkImageView m_imageView{};
+    VkSampleCountFlagBits m_samples = VK_SAMPLE_COUNT_1_BIT;
+    VkDeviceSize m_size = 0;
+    bool m_lazilyAllocated = false;
+};
+
+class Texture2D : public ImageResource<Texture2D> {
+    friend class GpuResourceBase<Texture2D>;
+
+public:
+    // Stages a sampled texture may be read from
+    static constexpr VkPipelineStageFlags ShaderReadStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    virtual ~Texture2D() { Cleanup(); }
+    virtual void Cleanup() override;
+
+    // mipLevels == 0 allocates the full mip chain
+    bool Initialize(VkExtent2D extent, VkFormat format, uint32_t mipLevels);
+    VkImageView GetVkImageView() const { return m_imageView; }
+    VkDescriptorImageInfo GetDescriptorInfo(VkSampler sampler = VK_NULL_HANDLE) const;
+
+    // Records a barrier over every mip from the tracked state and updates the tracked state
+    void TransitionLayout(CommandBuffer& commandBuffer, VkImageLayout newLayout,
+                          VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+
+    // Records a vkCmdBlitImage chain filling mips 1..N from mip 0. Expects every mip in
+    // TRANSFER_DST_OPTIMAL and leaves the image in SHADER_READ_ONLY_OPTIMAL.
+    void GenerateMipmaps(CommandBuffer& commandBuffer);
+
+    // True if the format supports linear blits in optimal tiling
+    static bool CanGenerateMipmaps(VkFormat format);
+    static uint32_t GetFullMipCount(VkExtent2D extent);
+
+    static std::shared_ptr<Texture2D> Create(VkExtent2D extent, VkFormat format,
+                                             uint32_t mipLevels = 1)
+    {
+        auto image = GpuResourceBase::Create();
+        if (!image->Initialize(extent, format, mipLevels)) {
+            return nullptr;
+        }
+        return image;
+    }
+
+    // KTX2 (precomputed mips are used as-is) or TGA. Pixel data is read straight into the
+    // mapped staging buffer. Blocks until the upload has completed.
+    static std::shared_ptr<Texture2D> LoadFromFile(const std::filesystem::path& path,
+                                                   bool srgb = true, bool generateMipmaps = true);
+
+    // Tightly packed mip 0 pixels in format
+    static std::shared_ptr<Texture2D> CreateFromMemory(VkExtent2D extent, VkFormat format,
+                                                       const void* pixels,
+                                                       bool generateMipmaps = true);
+
+    // Records the staging copy and the transition to SHADER_READ_ONLY_OPTIMAL without
+    // submitting. staging must stay alive until the command buffer has completed.
+    void RecordUpload(CommandBuffer& commandBuffer, StagingBuffer& staging,
+                      const std::vector<VkBufferImageCopy>& regions);
+
+private:
+    // Copies the regions from staging and either generates mips or transitions for sampling
+    bool Upload(StagingBuffer& staging, const std::vector<VkBufferImageCopy>& regions,
+                bool generateMipmaps);
+
+    VkImageView m_imageView{};
+    VkPipelineStageFlags m_stageFlags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+};
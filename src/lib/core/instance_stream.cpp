@@ -0,0 +1,56 @@
+#include "instance_stream.h"
+
+bool InstanceStream::Initialize(uint32_t stride, uint32_t maxInstancesPerFrame)
+{
+    m_stride = stride;
+    m_capacity = maxInstancesPerFrame;
+    m_buffer = VertexBuffer::Create(
+        VkDeviceSize(stride) * maxInstancesPerFrame * VulkanContext::MaxInflightFrame,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (!m_buffer) {
+        return false;
+    }
+    m_mapped = static_cast<uint8_t*>(m_buffer->Map());
+    m_buffer->SetDebugName("InstanceStream");
+    m_frameBase = 0;
+    m_head = 0;
+    return true;
+}
+
+void InstanceStream::Cleanup()
+{
+    if (m_mapped != nullptr) {
+        m_buffer->Unmap();
+        m_mapped = nullptr;
+    }
+    m_buffer.reset();
+    m_capacity = 0;
+    m_head = 0;
+}
+
+void InstanceStream::BeginFrame(uint32_t frameIndex)
+{
+    m_frameBase = (frameIndex % VulkanContext::MaxInflightFrame) * m_capacity;
+    m_head = 0;
+}
+
+InstanceStream::Range InstanceStream::Allocate(uint32_t count)
+{
+    if (count > m_capacity - m_head) {
+        return Range{};
+    }
+    Range range{
+        .mapped = m_mapped + (VkDeviceSize(m_frameBase) + m_head) * m_stride,
+        .firstInstance = m_head,
+        .count = count,
+    };
+    m_head += count;
+    return range;
+}
+
+void InstanceStream::Bind(VkCommandBuffer commandBuffer, uint32_t binding) const
+{
+    VkBuffer buffer = m_buffer->GetVkBuffer();
+    VkDeviceSize offset = VkDeviceSize(m_frameBase) * m_stride;
+    vkCmdBindVertexBuffers(commandBuffer, binding, 1, &buffer, &offset);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "core/buffer_resource.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <memory>
+
+// Host-visible per-instance vertex data (VK_VERTEX_INPUT_RATE_INSTANCE), rewritten every
+// frame. One segment per frame in flight, reset by BeginFrame once that frame's fence has been
+// waited on. The segment is bound once per frame; ranges are addressed with firstInstance:
+//   auto range = stream.Allocate(count);   // fill range.mapped
+//   stream.Bind(cmd, 1);
+//   vkCmdDrawIndexed(cmd, indexCount, range.count, firstIndex, vertexOffset, range.firstInstance);
+class InstanceStream {
+public:
+    struct Range {
+        void* mapped = nullptr;
+        uint32_t firstInstance = 0;
+        uint32_t count = 0;
+    };
+
+    InstanceStream() = default;
+    ~InstanceStream() = default;
+
+    InstanceStream(const InstanceStream&) = delete;
+    InstanceStream& operator=(const InstanceStream&) = delete;
+
+    bool Initialize(uint32_t stride, uint32_t maxInstancesPerFrame);
+    void Cleanup();
+
+    void BeginFrame(uint32_t frameIndex);
+
+    // Returns a range with mapped == nullptr when the frame segment is full
+    Range Allocate(uint32_t count);
+
+    // Binds the current frame's segment at the given vertex binding
+    void Bind(VkCommandBuffer commandBuffer, uint32_t binding) const;
+
+    uint32_t GetStride() const { return m_stride; }
+    uint32_t GetAllocatedCount() const { return m_head; }
+
+private:
+    std::shared_ptr<VertexBuffer> m_buffer;
+    uint8_t* m_mapped = nullptr;
+    uint32_t m_stride = 0;
+    uint32_t m_capacity = 0;
+    uint32_t m_frameBase = 0;
+    uint32_t m_head = 0;
+};
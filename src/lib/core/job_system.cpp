@@ -0,0 +1,498 @@
+#include "job_system.h"
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+#if defined(_WIN32)
+#   define NOMINMAX
+#   include <windows.h>
+#elif defined(__linux__)
+#   include <pthread.h>
+#   include <sched.h>
+#endif
+
+struct Job {
+    JobSystem::Function function;
+    // ParallelFor range, when function is empty
+    const JobSystem::RangeFunction* range = nullptr;
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    uint32_t minBatch = 1;
+    JobCounter* counter = nullptr;
+};
+
+// Chase-Lev deque of fixed capacity. Push and Pop are called by the owning thread only and
+// work at the bottom; Steal may be called from any thread and takes from the top.
+class JobSystem::WorkQueue {
+public:
+    static constexpr int64_t Capacity = 4096;
+
+    bool Push(Job* job)
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= Capacity) {
+            return false;
+        }
+        m_jobs[bottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job* Pop()
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Job* job = m_jobs[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last job: race the thieves for it
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                               std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* Steal()
+    {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        Job* job = m_jobs[top & (Capacity - 1)].load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+    // Owner only
+    bool IsEmpty() const
+    {
+        return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+private:
+    // Separate cache lines: thieves write top, the owner writes bottom
+    alignas(64) std::atomic<int64_t> m_top{0};
+    alignas(64) std::atomic<int64_t> m_bottom{0};
+    alignas(64) std::array<std::atomic<Job*>, Capacity> m_jobs{};
+};
+
+namespace {
+
+thread_local const JobSystem* t_jobSystem = nullptr;
+thread_local uint32_t t_threadIndex = JobSystem::NotAWorker;
+
+// Idle rounds before a worker goes to sleep
+constexpr uint32_t SpinCount = 64;
+
+// Job records moved between a thread's cache and the shared pool at a time
+constexpr size_t JobCacheBatch = 32;
+
+struct JobCache {
+    std::vector<Job*> jobs;
+
+    ~JobCache()
+    {
+        for (Job* job : jobs) {
+            delete job;
+        }
+    }
+};
+
+thread_local JobCache t_jobCache;
+
+uint32_t NextRandom()
+{
+    thread_local uint32_t state = 0x9e3779b9u ^ static_cast<uint32_t>(
+        std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void PinThread(std::thread& thread, uint32_t cpu)
+{
+#if defined(_WIN32)
+    SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << cpu);
+#elif defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpuSet), &cpuSet);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+void ReportDroppedException(const std::exception_ptr& exception)
+{
+    try {
+        std::rethrow_exception(exception);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[jobs] job without counter threw: " << e.what() << std::endl;
+    }
+    catch (...) {
+        std::cerr << "[jobs] job without counter threw an unknown exception" << std::endl;
+    }
+}
+
+} // namespace
+
+JobSystem::JobSystem() = default;
+
+JobSystem::~JobSystem()
+{
+    Cleanup();
+}
+
+bool JobSystem::Initialize(const Settings& settings)
+{
+    if (!m_queues.empty()) {
+        return false;
+    }
+    const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    uint32_t workerCount = settings.workerCount;
+    if (workerCount == AutoWorkerCount) {
+        workerCount = hardwareThreads - 1;
+    }
+
+    m_stop = false;
+    for (uint32_t i = 0; i <= workerCount; ++i) {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+    t_jobSystem = this;
+    t_threadIndex = 0;
+    for (uint32_t i = 1; i <= workerCount; ++i) {
+        m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+        if (settings.pinWorkers) {
+            PinThread(m_workers.back(), i % hardwareThreads);
+        }
+    }
+    for (uint32_t i = 0; i < settings.ioThreadCount; ++i) {
+        m_ioThreads.emplace_back(&JobSystem::IoLoop, this);
+    }
+    return true;
+}
+
+void JobSystem::Cleanup()
+{
+    if (m_queues.empty()) {
+        return;
+    }
+    Wait(m_outstanding);
+
+    m_stop = true;
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_sleepCondition.notify_all();
+    }
+    {
+        std::lock_guard lock(m_ioMutex);
+        m_ioCondition.notify_all();
+    }
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    for (auto& ioThread : m_ioThreads) {
+        ioThread.join();
+    }
+    m_workers.clear();
+    m_ioThreads.clear();
+    m_queues.clear();
+    for (Job* job : m_freeJobs) {
+        delete job;
+    }
+    m_freeJobs.clear();
+    if (t_jobSystem == this) {
+        t_jobSystem = nullptr;
+        t_threadIndex = NotAWorker;
+    }
+}
+
+uint32_t JobSystem::GetCurrentThreadIndex() const
+{
+    return t_jobSystem == this ? t_threadIndex : NotAWorker;
+}
+
+void JobSystem::Submit(Function function, JobCounter* counter, Affinity affinity)
+{
+    Job* job = CreateJob(counter);
+    job->function = std::move(function);
+    if (affinity == Affinity::Io && !m_ioThreads.empty()) {
+        std::lock_guard lock(m_ioMutex);
+        m_ioQueue.push_back(job);
+        m_ioCondition.notify_one();
+        return;
+    }
+    Push(job);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    const uint32_t self = GetCurrentThreadIndex();
+    while (!counter.IsDone()) {
+        if (Job* job = FindJob(self)) {
+            Execute(job, self);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+    // Every job counted against it has finished, so nothing writes the exception any more
+    if (counter.m_failed.load(std::memory_order_acquire)) {
+        std::exception_ptr exception = std::move(counter.m_exception);
+        counter.m_exception = nullptr;
+        counter.m_failed.store(false, std::memory_order_relaxed);
+        std::rethrow_exception(exception);
+    }
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t minBatch, const RangeFunction& function)
+{
+    if (count == 0) {
+        return;
+    }
+    minBatch = std::max(minBatch, 1u);
+    if (count <= minBatch || GetThreadCount() <= 1) {
+        function(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    Job* job = CreateJob(&counter);
+    job->range = &function;
+    job->end = count;
+    job->minBatch = minBatch;
+    const uint32_t self = GetCurrentThreadIndex();
+    if (self != NotAWorker) {
+        Execute(job, self);
+    }
+    else {
+        Push(job);
+    }
+    Wait(counter);
+}
+
+Job* JobSystem::CreateJob(JobCounter* counter)
+{
+    Job* job = AllocateJob();
+    job->counter = counter;
+    if (counter) {
+        counter->m_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_outstanding.m_count.fetch_add(1, std::memory_order_relaxed);
+    return job;
+}
+
+Job* JobSystem::AllocateJob()
+{
+    auto& cache = t_jobCache.jobs;
+    if (cache.empty()) {
+        std::lock_guard lock(m_poolMutex);
+        const size_t count = std::min(m_freeJobs.size(), JobCacheBatch);
+        cache.insert(cache.end(), m_freeJobs.end() - count, m_freeJobs.end());
+        m_freeJobs.resize(m_freeJobs.size() - count);
+    }
+    if (cache.empty()) {
+        return new Job;
+    }
+    Job* job = cache.back();
+    cache.pop_back();
+    return job;
+}
+
+void JobSystem::ReleaseJob(Job* job)
+{
+    *job = Job{};
+    // Jobs often finish on another thread than the one that created them; hand surplus
+    // records back so the creating thread's cache can refill
+    auto& cache = t_jobCache.jobs;
+    cache.push_back(job);
+    if (cache.size() >= 2 * JobCacheBatch) {
+        std::lock_guard lock(m_poolMutex);
+        m_freeJobs.insert(m_freeJobs.end(), cache.end() - JobCacheBatch, cache.end());
+        cache.resize(cache.size() - JobCacheBatch);
+    }
+}
+
+void JobSystem::Push(Job* job)
+{
+    // Counted first so a thief never sees the job before the count
+    m_queuedJobs.fetch_add(1);
+    const uint32_t self = GetCurrentThreadIndex();
+    if (self != NotAWorker) {
+        if (!m_queues[self]->Push(job)) {
+            m_queuedJobs.fetch_sub(1);
+            Execute(job, self);
+            return;
+        }
+    }
+    else {
+        std::lock_guard lock(m_sharedMutex);
+        m_sharedQueue.push_back(job);
+    }
+    if (m_sleepingWorkers.load() > 0) {
+        std::lock_guard lock(m_sleepMutex);
+        m_sleepCondition.notify_one();
+    }
+}
+
+Job* JobSystem::FindJob(uint32_t self)
+{
+    if (self != NotAWorker) {
+        if (Job* job = m_queues[self]->Pop()) {
+            m_queuedJobs.fetch_sub(1);
+            return job;
+        }
+    }
+    if (m_queuedJobs.load(std::memory_order_relaxed) == 0) {
+        return nullptr;
+    }
+    {
+        std::lock_guard lock(m_sharedMutex);
+        if (!m_sharedQueue.empty()) {
+            Job* job = m_sharedQueue.front();
+            m_sharedQueue.pop_front();
+            m_queuedJobs.fetch_sub(1);
+            return job;
+        }
+    }
+    // Start at a random victim so thieves spread over the deques
+    const uint32_t queueCount = GetThreadCount();
+    const uint32_t first = NextRandom() % queueCount;
+    for (uint32_t i = 0; i < queueCount; ++i) {
+        const uint32_t victim = (first + i) % queueCount;
+        if (victim == self) {
+            continue;
+        }
+        if (Job* job = m_queues[victim]->Steal()) {
+            m_queuedJobs.fetch_sub(1);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::Execute(Job* job, uint32_t self)
+{
+    // A throwing job still counts as finished, or its waiter would never return
+    std::exception_ptr exception;
+    try {
+        if (job->range) {
+            RunRange(*job, self);
+        }
+        else {
+            job->function();
+        }
+    }
+    catch (...) {
+        exception = std::current_exception();
+    }
+    JobCounter* counter = job->counter;
+    // Drops the captures before the waiter can return
+    ReleaseJob(job);
+    if (exception) {
+        if (!counter) {
+            ReportDroppedException(exception);
+        }
+        else if (!counter->m_failed.exchange(true, std::memory_order_acq_rel)) {
+            counter->m_exception = std::move(exception);
+        }
+    }
+    // Children submitted by the job were counted before this, so a parent's counter stays
+    // above zero until the whole tree is done
+    if (counter) {
+        counter->m_count.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    m_outstanding.m_count.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void JobSystem::RunRange(Job& job, uint32_t self)
+{
+    // Lazy binary splitting: offer half of the range only while everything offered before has
+    // been taken, otherwise keep working through it one minBatch at a time
+    uint32_t begin = job.begin;
+    uint32_t end = job.end;
+    while (begin < end) {
+        const bool canSplit = self != NotAWorker ? m_queues[self]->IsEmpty()
+                                                 : m_queuedJobs.load() == 0;
+        if (end - begin >= 2 * job.minBatch && canSplit) {
+            const uint32_t middle = begin + (end - begin) / 2;
+            Job* half = CreateJob(job.counter);
+            half->range = job.range;
+            half->begin = middle;
+            half->end = end;
+            half->minBatch = job.minBatch;
+            Push(half);
+            end = middle;
+            continue;
+        }
+        const uint32_t batchEnd = std::min(end, begin + job.minBatch);
+        (*job.range)(begin, batchEnd);
+        begin = batchEnd;
+    }
+}
+
+void JobSystem::WorkerLoop(uint32_t index)
+{
+    t_jobSystem = this;
+    t_threadIndex = index;
+    uint32_t idleRounds = 0;
+    while (true) {
+        if (Job* job = FindJob(index)) {
+            Execute(job, index);
+            idleRounds = 0;
+            continue;
+        }
+        if (m_stop) {
+            return;
+        }
+        if (++idleRounds < SpinCount) {
+            std::this_thread::yield();
+            continue;
+        }
+        // Pairs with Push: either this sees the queued job, or Push sees the sleeper
+        std::unique_lock lock(m_sleepMutex);
+        m_sleepingWorkers.fetch_add(1);
+        m_sleepCondition.wait(lock, [this] { return m_stop || m_queuedJobs.load() > 0; });
+        m_sleepingWorkers.fetch_sub(1);
+        idleRounds = 0;
+        if (m_stop) {
+            return;
+        }
+    }
+}
+
+void JobSystem::IoLoop()
+{
+    while (true) {
+        Job* job = nullptr;
+        {
+            std::unique_lock lock(m_ioMutex);
+            m_ioCondition.wait(lock, [this] { return m_stop || !m_ioQueue.empty(); });
+            if (m_ioQueue.empty()) {
+                return;
+            }
+            job = m_ioQueue.front();
+            m_ioQueue.pop_front();
+        }
+        Execute(job, NotAWorker);
+    }
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Job;
+
+// Number of unfinished jobs submitted against it. A job that submits children against the
+// counter it was submitted with keeps the counter above zero until all of them have finished,
+// so waiting on a parent's counter waits for the whole tree. The first exception thrown by a
+// job counted against it is kept for JobSystem::Wait to rethrow.
+class JobCounter {
+public:
+    JobCounter() = default;
+
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone() const { return m_count.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> m_count{0};
+    std::atomic<bool> m_failed{false};
+    std::exception_ptr m_exception;
+};
+
+// Work-stealing task scheduler shared by the library's parallel code. Every worker thread owns
+// a lock-free deque: it pushes and pops jobs at the bottom, idle workers steal from the top of
+// the others. The thread that calls Initialize owns deque 0 and runs jobs while it waits, so
+// the render thread helps instead of blocking. Jobs submitted from other threads go through a
+// shared queue. Affinity::Io jobs run on dedicated I/O threads only, so blocking file access
+// never holds up a worker.
+//   JobCounter counter;
+//   jobs.Submit([&] { Decode(a); }, &counter);
+//   jobs.Submit([&] { Decode(b); }, &counter);
+//   jobs.Wait(counter);
+//   jobs.ParallelFor(count, 256, [&](uint32_t begin, uint32_t end) { ... });
+class JobSystem {
+public:
+    enum class Affinity {
+        Any,
+        Io,
+    };
+
+    static constexpr uint32_t AutoWorkerCount = ~0u;
+    static constexpr uint32_t NotAWorker = ~0u;
+
+    struct Settings {
+        // Threads besides the initializing one; AutoWorkerCount = one per hardware thread,
+        // minus the initializing one
+        uint32_t workerCount = AutoWorkerCount;
+        // Threads that run Affinity::Io jobs
+        uint32_t ioThreadCount = 1;
+        // Pin worker i to logical CPU i, leaving CPU 0 to the initializing thread
+        bool pinWorkers = false;
+    };
+
+    using Function = std::function<void()>;
+    using RangeFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+    JobSystem();
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    bool Initialize(const Settings& settings);
+    // From the initializing thread; runs every job still queued, then joins the threads
+    void Cleanup();
+
+    // counter (optional) must outlive the job. Submitting from a worker pushes to its own
+    // deque; a job submitted to a full deque runs immediately. An exception thrown by a job
+    // without a counter is logged and dropped.
+    void Submit(Function function, JobCounter* counter = nullptr,
+                Affinity affinity = Affinity::Any);
+    // Runs other jobs until counter reaches zero; threads other than the workers steal. Then
+    // rethrows the first exception a job counted against it threw, if any.
+    void Wait(JobCounter& counter);
+
+    // Calls function on disjoint subranges covering [0, count) and returns when all are done.
+    // Ranges are split in halves only while the splitting thread has nothing else queued, so
+    // the batch size adapts to how many threads are idle; minBatch is the smallest range.
+    // Rethrows the first exception function threw once no range is running any more.
+    void ParallelFor(uint32_t count, uint32_t minBatch, const RangeFunction& function);
+
+    // Workers plus the initializing thread
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_queues.size()); }
+    uint32_t GetIoThreadCount() const { return static_cast<uint32_t>(m_ioThreads.size()); }
+    // 0 for the initializing thread, 1.. for workers, NotAWorker elsewhere
+    uint32_t GetCurrentThreadIndex() const;
+
+private:
+    class WorkQueue;
+
+    Job* CreateJob(JobCounter* counter);
+    Job* AllocateJob();
+    void ReleaseJob(Job* job);
+    void Push(Job* job);
+    Job* FindJob(uint32_t self);
+    void Execute(Job* job, uint32_t self);
+    void RunRange(Job& job, uint32_t self);
+
+    void WorkerLoop(uint32_t index);
+    void IoLoop();
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<bool> m_stop{false};
+
+    // Jobs waiting in any deque or the shared queue, for waking sleeping workers
+    std::atomic<uint32_t> m_queuedJobs{0};
+    std::atomic<uint32_t> m_sleepingWorkers{0};
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
+
+    // Jobs submitted from threads without a deque
+    std::mutex m_sharedMutex;
+    std::deque<Job*> m_sharedQueue;
+
+    std::vector<std::thread> m_ioThreads;
+    std::mutex m_ioMutex;
+    std::condition_variable m_ioCondition;
+    std::deque<Job*> m_ioQueue;
+
+    // Submitted and not yet finished, for Cleanup
+    JobCounter m_outstanding;
+
+    // Finished job records, exchanged in batches with the per-thread caches so a submit
+    // allocates nothing once the pool has warmed up
+    std::mutex m_poolMutex;
+    std::vector<Job*> m_freeJobs;
+};
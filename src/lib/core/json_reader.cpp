@@ -0,0 +1,281 @@
+#include "json_reader.h"
+#include <charconv>
+#include <cstdlib>
+
+JsonReader::Type JsonReader::Peek()
+{
+    SkipWhitespace();
+    if (m_error || m_position >= m_text.size()) {
+        return Type::Invalid;
+    }
+    switch (m_text[m_position]) {
+    case '{':
+        return Type::Object;
+    case '[':
+        return Type::Array;
+    case '"':
+        return Type::String;
+    case 't':
+    case 'f':
+        return Type::Bool;
+    case 'n':
+        return Type::Null;
+    default:
+        return Type::Number;
+    }
+}
+
+bool JsonReader::BeginObject()
+{
+    m_first = true;
+    return Expect('{');
+}
+
+bool JsonReader::NextMember(std::string_view& key)
+{
+    SkipWhitespace();
+    if (m_error || m_position >= m_text.size()) {
+        return Fail();
+    }
+    if (m_text[m_position] == '}') {
+        ++m_position;
+        m_first = false;
+        return false;
+    }
+    if (!m_first && !Expect(',')) {
+        return false;
+    }
+    m_first = false;
+    return ReadRawString(key) && Expect(':');
+}
+
+bool JsonReader::BeginArray()
+{
+    m_first = true;
+    return Expect('[');
+}
+
+bool JsonReader::NextElement()
+{
+    SkipWhitespace();
+    if (m_error || m_position >= m_text.size()) {
+        return Fail();
+    }
+    if (m_text[m_position] == ']') {
+        ++m_position;
+        m_first = false;
+        return false;
+    }
+    if (!m_first && !Expect(',')) {
+        return false;
+    }
+    m_first = false;
+    return true;
+}
+
+bool JsonReader::ReadString(std::string& value)
+{
+    std::string_view raw;
+    if (!ReadRawString(raw)) {
+        return false;
+    }
+    value.clear();
+    value.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '\\') {
+            value.push_back(raw[i]);
+            continue;
+        }
+        if (++i >= raw.size()) {
+            return Fail();
+        }
+        switch (raw[i]) {
+        case 'b': value.push_back('\b'); break;
+        case 'f': value.push_back('\f'); break;
+        case 'n': value.push_back('\n'); break;
+        case 'r': value.push_back('\r'); break;
+        case 't': value.push_back('\t'); break;
+        case 'u': {
+            if (i + 4 >= raw.size()) {
+                return Fail();
+            }
+            uint32_t code = 0;
+            auto [end, ec] = std::from_chars(raw.data() + i + 1, raw.data() + i + 5, code, 16);
+            if (ec != std::errc() || end != raw.data() + i + 5) {
+                return Fail();
+            }
+            i += 4;
+            // UTF-8 encode (surrogate pairs are passed through as two code points)
+            if (code < 0x80) {
+                value.push_back(static_cast<char>(code));
+            }
+            else if (code < 0x800) {
+                value.push_back(static_cast<char>(0xc0 | (code >> 6)));
+                value.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+            }
+            else {
+                value.push_back(static_cast<char>(0xe0 | (code >> 12)));
+                value.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                value.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+            }
+            break;
+        }
+        default:
+            // \" \\ \/
+            value.push_back(raw[i]);
+            break;
+        }
+    }
+    return true;
+}
+
+bool JsonReader::ReadNumber(double& value)
+{
+    SkipWhitespace();
+    if (m_error || m_position >= m_text.size()) {
+        return Fail();
+    }
+    // strtod needs a terminator; numbers are short, so copy into a local buffer
+    char buffer[64];
+    size_t length = 0;
+    while (m_position + length < m_text.size() && length < sizeof(buffer) - 1) {
+        char c = m_text[m_position + length];
+        if ((c < '0' || c > '9') && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E') {
+            break;
+        }
+        buffer[length++] = c;
+    }
+    buffer[length] = '\0';
+    char* end = nullptr;
+    value = std::strtod(buffer, &end);
+    if (length == 0 || end != buffer + length) {
+        return Fail();
+    }
+    m_position += length;
+    return true;
+}
+
+bool JsonReader::ReadUint(uint32_t& value)
+{
+    double number = 0.0;
+    if (!ReadNumber(number) || number < 0.0 || number > 4294967295.0) {
+        return Fail();
+    }
+    value = static_cast<uint32_t>(number);
+    return true;
+}
+
+bool JsonReader::ReadInt(int32_t& value)
+{
+    double number = 0.0;
+    if (!ReadNumber(number) || number < -2147483648.0 || number > 2147483647.0) {
+        return Fail();
+    }
+    value = static_cast<int32_t>(number);
+    return true;
+}
+
+bool JsonReader::ReadBool(bool& value)
+{
+    SkipWhitespace();
+    if (m_text.substr(m_position, 4) == "true") {
+        m_position += 4;
+        value = true;
+        return !m_error;
+    }
+    if (m_text.substr(m_position, 5) == "false") {
+        m_position += 5;
+        value = false;
+        return !m_error;
+    }
+    return Fail();
+}
+
+bool JsonReader::SkipValue()
+{
+    switch (Peek()) {
+    case Type::Object: {
+        BeginObject();
+        std::string_view key;
+        while (NextMember(key)) {
+            if (!SkipValue()) {
+                return false;
+            }
+        }
+        break;
+    }
+    case Type::Array:
+        BeginArray();
+        while (NextElement()) {
+            if (!SkipValue()) {
+                return false;
+            }
+        }
+        break;
+    case Type::String: {
+        std::string_view raw;
+        return ReadRawString(raw);
+    }
+    case Type::Number: {
+        double number;
+        return ReadNumber(number);
+    }
+    case Type::Bool: {
+        bool flag;
+        return ReadBool(flag);
+    }
+    case Type::Null:
+        if (m_text.substr(m_position, 4) != "null") {
+            return Fail();
+        }
+        m_position += 4;
+        break;
+    case Type::Invalid:
+        return Fail();
+    }
+    return !m_error;
+}
+
+void JsonReader::SkipWhitespace()
+{
+    while (m_position < m_text.size()) {
+        char c = m_text[m_position];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            break;
+        }
+        ++m_position;
+    }
+}
+
+bool JsonReader::Expect(char c)
+{
+    SkipWhitespace();
+    if (m_error || m_position >= m_text.size() || m_text[m_position] != c) {
+        return Fail();
+    }
+    ++m_position;
+    return true;
+}
+
+bool JsonReader::ReadRawString(std::string_view& value)
+{
+    if (!Expect('"')) {
+        return false;
+    }
+    const size_t start = m_position;
+    while (m_position < m_text.size() && m_text[m_position] != '"') {
+        m_position += m_text[m_position] == '\\' ? 2 : 1;
+    }
+    if (m_position >= m_text.size()) {
+        return Fail();
+    }
+    value = m_text.substr(start, m_position - start);
+    ++m_position;
+    return true;
+}
+
+bool JsonReader::Fail()
+{
+    m_error = true;
+    return false;
+}
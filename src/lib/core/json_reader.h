@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Forward-only pull parser over JSON text. Values are read in document order straight into
+// the caller's structures; nothing is materialised that the caller does not ask for.
+//
+//   reader.BeginObject();
+//   std::string_view key;
+//   while (reader.NextMember(key)) {
+//       if (key == "count") reader.ReadUint(count);
+//       else reader.SkipValue();
+//   }
+//
+// Errors are sticky: after the first one every call returns false.
+class JsonReader {
+public:
+    enum class Type {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object,
+        Invalid,
+    };
+
+    explicit JsonReader(std::string_view text) : m_text(text) {}
+
+    // Type of the next value without consuming it
+    Type Peek();
+
+    bool BeginObject();
+    // Reads the next key (returned raw, escapes are not decoded); false after the closing '}'
+    bool NextMember(std::string_view& key);
+    bool BeginArray();
+    // True while another element follows; false after the closing ']'
+    bool NextElement();
+
+    bool ReadString(std::string& value);
+    bool ReadNumber(double& value);
+    bool ReadUint(uint32_t& value);
+    bool ReadInt(int32_t& value);
+    bool ReadBool(bool& value);
+    bool SkipValue();
+
+    bool HasError() const { return m_error; }
+    size_t GetPosition() const { return m_position; }
+
+private:
+    void SkipWhitespace();
+    bool Expect(char c);
+    bool ReadRawString(std::string_view& value);
+    bool Fail();
+
+    std::string_view m_text;
+    size_t m_position = 0;
+    // Whether the container being iterated has produced its first entry
+    bool m_first = false;
+    bool m_error = false;
+};
@@ -0,0 +1,184 @@
+#include "lz4.h"
+#include <cstring>
+
+namespace {
+
+constexpr size_t MinMatch = 4;
+// The format ends every block with at least 5 literals, and no match starts in the last 12 bytes
+constexpr size_t LastLiterals = 5;
+constexpr size_t MatchFindLimit = 12;
+constexpr size_t MaxOffset = 65535;
+constexpr uint32_t HashLog = 12;
+
+uint32_t Read32(const uint8_t* p)
+{
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HashLog);
+}
+
+// Length continuation: 255-valued bytes followed by the remainder
+uint8_t* WriteLength(uint8_t* op, size_t length)
+{
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+// Token, literals and, when matchLength > 0, the match; nullptr when it would not fit
+uint8_t* WriteSequence(uint8_t* op, uint8_t* end, const uint8_t* literals, size_t literalLength,
+                       size_t offset, size_t matchLength)
+{
+    const size_t worstCase = 1 + literalLength / 255 + 1 + literalLength + 2 +
+                             matchLength / 255 + 1;
+    if (size_t(end - op) < worstCase) {
+        return nullptr;
+    }
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>((literalLength < 15 ? literalLength : 15) << 4);
+    if (literalLength >= 15) {
+        op = WriteLength(op, literalLength - 15);
+    }
+    if (literalLength > 0) {
+        std::memcpy(op, literals, literalLength);
+        op += literalLength;
+    }
+    if (matchLength == 0) {
+        return op;
+    }
+
+    *op++ = static_cast<uint8_t>(offset & 0xFF);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    const size_t code = matchLength - MinMatch;
+    *token |= static_cast<uint8_t>(code < 15 ? code : 15);
+    if (code >= 15) {
+        op = WriteLength(op, code - 15);
+    }
+    return op;
+}
+
+// Reads a length continuation; false when the input ends first
+bool ReadLength(const uint8_t* src, size_t srcSize, size_t& ip, size_t& length)
+{
+    uint8_t value;
+    do {
+        if (ip >= srcSize) {
+            return false;
+        }
+        value = src[ip++];
+        length += value;
+    } while (value == 255);
+    return true;
+}
+
+} // namespace
+
+namespace lz4 {
+
+size_t CompressBound(size_t srcSize)
+{
+    return srcSize + srcSize / 255 + 16;
+}
+
+size_t Compress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity)
+{
+    uint8_t* op = dst;
+    uint8_t* const end = dst + dstCapacity;
+    size_t anchor = 0;
+
+    if (srcSize > MatchFindLimit) {
+        // Position + 1 of the last occurrence of each hashed 4-byte sequence; 0 = none
+        uint32_t table[1u << HashLog] = {};
+        const size_t matchEnd = srcSize - LastLiterals;
+        const size_t searchEnd = srcSize - MatchFindLimit;
+        size_t ip = 0;
+        while (ip < searchEnd) {
+            const uint32_t sequence = Read32(src + ip);
+            const uint32_t hash = Hash(sequence);
+            const size_t candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(ip + 1);
+            if (candidate == 0 || ip - (candidate - 1) > MaxOffset ||
+                Read32(src + candidate - 1) != sequence) {
+                // Step faster through data that keeps failing to match
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            const size_t match = candidate - 1;
+            size_t length = MinMatch;
+            while (ip + length < matchEnd && src[match + length] == src[ip + length]) {
+                ++length;
+            }
+            op = WriteSequence(op, end, src + anchor, ip - anchor, ip - match, length);
+            if (op == nullptr) {
+                return 0;
+            }
+            ip += length;
+            anchor = ip;
+        }
+    }
+
+    op = WriteSequence(op, end, src + anchor, srcSize - anchor, 0, 0);
+    return op != nullptr ? size_t(op - dst) : 0;
+}
+
+bool Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+{
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < srcSize) {
+        const uint8_t token = src[ip++];
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !ReadLength(src, srcSize, ip, literalLength)) {
+            return false;
+        }
+        if (literalLength > srcSize - ip || literalLength > dstSize - op) {
+            return false;
+        }
+        if (literalLength > 0) {
+            std::memcpy(dst + op, src + ip, literalLength);
+            ip += literalLength;
+            op += literalLength;
+        }
+        if (ip == srcSize) {
+            // The last sequence has no match
+            break;
+        }
+
+        if (srcSize - ip < 2) {
+            return false;
+        }
+        const size_t offset = src[ip] | (size_t(src[ip + 1]) << 8);
+        ip += 2;
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadLength(src, srcSize, ip, matchLength)) {
+            return false;
+        }
+        matchLength += MinMatch;
+        if (offset == 0 || offset > op || matchLength > dstSize - op) {
+            return false;
+        }
+        const uint8_t* match = dst + op - offset;
+        if (offset >= matchLength) {
+            std::memcpy(dst + op, match, matchLength);
+        }
+        else {
+            // Overlapping copy repeats the last offset bytes
+            for (size_t i = 0; i < matchLength; ++i) {
+                dst[op + i] = match[i];
+            }
+        }
+        op += matchLength;
+    }
+    return op == dstSize;
+}
+
+} // namespace lz4
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// LZ4 block format (no frame header): greedy single-probe compressor, bounds-checked
+// decompressor. Output is readable by the reference LZ4_decompress_safe.
+namespace lz4 {
+
+    // Worst-case compressed size of srcSize bytes
+    size_t CompressBound(size_t srcSize);
+
+    // Returns the compressed size, or 0 when dstCapacity is too small
+    size_t Compress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity);
+
+    // dstSize must be the exact decompressed size; false on malformed input
+    bool Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+} // namespace lz4
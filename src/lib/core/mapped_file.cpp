@@ -0,0 +1,130 @@
+#include "mapped_file.h"
+#include <utility>
+
+#if defined(_WIN32)
+#   define NOMINMAX
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        Close();
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_isEmptyFile, other.m_isEmptyFile);
+#if defined(_WIN32)
+        std::swap(m_file, other.m_file);
+        std::swap(m_mapping, other.m_mapping);
+#endif
+    }
+    return *this;
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size == 0) {
+        m_isEmptyFile = true;
+        return true;
+    }
+
+    m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr) {
+        Close();
+        return false;
+    }
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != nullptr) {
+        CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+    m_isEmptyFile = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size == 0) {
+        close(fd);
+        m_isEmptyFile = true;
+        return true;
+    }
+
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if (data == MAP_FAILED) {
+        m_size = 0;
+        return false;
+    }
+    madvise(data, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const uint8_t*>(data);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_data != nullptr) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_isEmptyFile = false;
+}
+
+#endif
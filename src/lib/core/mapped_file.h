@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// Read-only memory mapping of a whole file. Pages are loaded on first touch, so large
+// buffers cost nothing until they are read.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    bool IsOpen() const { return m_data != nullptr || m_isEmptyFile; }
+    const uint8_t* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    // Zero-length files cannot be mapped but are still valid
+    bool m_isEmptyFile = false;
+#if defined(_WIN32)
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
@@ -0,0 +1,461 @@
+#include "mesh_processing.h"
+#include "core/buffer_resource.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <string_view>
+
+namespace {
+
+constexpr uint32_t Unused = ~0u;
+
+struct Adjacency {
+    // Triangles of vertex v: triangles[offsets[v] .. offsets[v] + counts[v])
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> triangles;
+};
+
+Adjacency BuildAdjacency(const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    Adjacency adjacency;
+    adjacency.counts.assign(vertexCount, 0);
+    adjacency.offsets.resize(vertexCount);
+    adjacency.triangles.resize(indexCount);
+    for (size_t i = 0; i < indexCount; ++i) {
+        ++adjacency.counts[indices[i]];
+    }
+    uint32_t offset = 0;
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacency.offsets[v] = offset;
+        offset += adjacency.counts[v];
+    }
+    std::vector<uint32_t> fill(vertexCount, 0);
+    for (size_t i = 0; i < indexCount; ++i) {
+        const uint32_t v = indices[i];
+        adjacency.triangles[adjacency.offsets[v] + fill[v]++] = static_cast<uint32_t>(i / 3);
+    }
+    return adjacency;
+}
+
+struct Vec3 {
+    float x, y, z;
+
+    Vec3 operator+(const Vec3& o) const { return {x + o.x, y + o.y, z + o.z}; }
+    Vec3 operator-(const Vec3& o) const { return {x - o.x, y - o.y, z - o.z}; }
+    Vec3 operator*(float s) const { return {x * s, y * s, z * s}; }
+    float Dot(const Vec3& o) const { return x * o.x + y * o.y + z * o.z; }
+    Vec3 Cross(const Vec3& o) const { return {y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x}; }
+};
+
+Vec3 LoadPosition(const uint8_t* positions, size_t stride, uint32_t vertex)
+{
+    Vec3 p;
+    std::memcpy(&p, positions + size_t(vertex) * stride, sizeof(p));
+    return p;
+}
+
+bool StartsWith(std::string_view value, std::string_view prefix)
+{
+    return value.substr(0, prefix.size()) == prefix;
+}
+
+uint8_t ToUnorm8(float value)
+{
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+int8_t ToSnorm8(float value)
+{
+    return static_cast<int8_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+}
+
+} // namespace
+
+namespace mesh {
+
+uint32_t SimulateVertexCache(const uint32_t* indices, size_t indexCount, uint32_t cacheSize)
+{
+    std::vector<uint32_t> fifo(cacheSize, Unused);
+    uint32_t head = 0;
+    uint32_t misses = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        if (std::find(fifo.begin(), fifo.end(), indices[i]) != fifo.end()) {
+            continue;
+        }
+        fifo[head] = indices[i];
+        head = (head + 1) % cacheSize;
+        ++misses;
+    }
+    return misses;
+}
+
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount,
+                         uint32_t cacheSize, std::vector<uint32_t>* clusters)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (clusters) {
+        clusters->clear();
+    }
+    if (triangleCount == 0) {
+        return;
+    }
+
+    const Adjacency adjacency = BuildAdjacency(indices, indexCount, vertexCount);
+    std::vector<uint32_t> live = adjacency.counts;
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(indexCount);
+
+    uint32_t timeStamp = cacheSize + 1;
+    size_t cursor = 0;
+
+    // Dead-end stack first (recently touched), then the next vertex in input order
+    auto skipDeadEnd = [&]() -> uint32_t {
+        while (!deadEnd.empty()) {
+            const uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0) {
+                return v;
+            }
+        }
+        while (cursor < vertexCount) {
+            if (live[cursor] > 0) {
+                return static_cast<uint32_t>(cursor);
+            }
+            ++cursor;
+        }
+        return Unused;
+    };
+
+    uint32_t fan = skipDeadEnd();
+    while (fan != Unused) {
+        candidates.clear();
+        const uint32_t* fanTriangles = &adjacency.triangles[adjacency.offsets[fan]];
+        for (uint32_t t = 0; t < adjacency.counts[fan]; ++t) {
+            const uint32_t triangle = fanTriangles[t];
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = true;
+            for (uint32_t k = 0; k < 3; ++k) {
+                const uint32_t v = indices[triangle * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (timeStamp - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = timeStamp++;
+                }
+            }
+        }
+
+        // Best next fan: a cached vertex whose remaining triangles will still fit in the cache
+        uint32_t next = Unused;
+        int64_t best = -1;
+        for (uint32_t v : candidates) {
+            if (live[v] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            if (timeStamp - cacheTime[v] + 2 * live[v] <= cacheSize) {
+                priority = timeStamp - cacheTime[v];
+            }
+            if (priority > best) {
+                best = priority;
+                next = v;
+            }
+        }
+        if (next == Unused) {
+            next = skipDeadEnd();
+            // The next fan starts cold: a safe place to cut a cluster for overdraw sorting
+            if (clusters && next != Unused && timeStamp - cacheTime[next] > cacheSize) {
+                clusters->push_back(static_cast<uint32_t>(output.size() / 3));
+            }
+        }
+        fan = next;
+    }
+
+    if (clusters && (clusters->empty() || clusters->front() != 0)) {
+        clusters->insert(clusters->begin(), 0);
+    }
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const uint8_t* positions,
+                      size_t positionStride, const std::vector<uint32_t>& clusters)
+{
+    const uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+    if (clusters.size() < 2) {
+        return;
+    }
+
+    struct Cluster {
+        uint32_t first;
+        uint32_t last;
+        Vec3 centroid;
+        Vec3 normal;
+        float area;
+        float sortKey;
+    };
+    std::vector<Cluster> sorted;
+    sorted.reserve(clusters.size());
+    Vec3 meshCentroid{0, 0, 0};
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        Cluster cluster{clusters[c], c + 1 < clusters.size() ? clusters[c + 1] : triangleCount,
+                        {0, 0, 0}, {0, 0, 0}, 0.0f, 0.0f};
+        for (uint32_t t = cluster.first; t < cluster.last; ++t) {
+            const Vec3 a = LoadPosition(positions, positionStride, indices[t * 3 + 0]);
+            const Vec3 b = LoadPosition(positions, positionStride, indices[t * 3 + 1]);
+            const Vec3 c3 = LoadPosition(positions, positionStride, indices[t * 3 + 2]);
+            const Vec3 n = (b - a).Cross(c3 - a);
+            const float area = std::sqrt(n.Dot(n)) * 0.5f;
+            cluster.centroid = cluster.centroid + (a + b + c3) * (area / 3.0f);
+            cluster.normal = cluster.normal + n;
+            cluster.area += area;
+        }
+        meshCentroid = meshCentroid + cluster.centroid;
+        meshArea += cluster.area;
+        if (cluster.area > 0.0f) {
+            cluster.centroid = cluster.centroid * (1.0f / cluster.area);
+        }
+        sorted.push_back(cluster);
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid = meshCentroid * (1.0f / meshArea);
+    }
+
+    // Occlusion potential: clusters far out along their own normal are likely to occlude
+    for (auto& cluster : sorted) {
+        const float length = std::sqrt(cluster.normal.Dot(cluster.normal));
+        cluster.sortKey = length > 0.0f
+                              ? (cluster.centroid - meshCentroid).Dot(cluster.normal * (1.0f / length))
+                              : 0.0f;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<uint32_t> reordered;
+    reordered.reserve(indexCount);
+    for (const auto& cluster : sorted) {
+        reordered.insert(reordered.end(), indices + size_t(cluster.first) * 3,
+                         indices + size_t(cluster.last) * 3);
+    }
+    std::copy(reordered.begin(), reordered.end(), indices);
+}
+
+uint32_t OptimizeVertexFetch(uint8_t* vertices, size_t vertexCount, size_t vertexSize,
+                             uint32_t* indices, size_t indexCount)
+{
+    std::vector<uint32_t> remap(vertexCount, Unused);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        uint32_t& slot = remap[indices[i]];
+        if (slot == Unused) {
+            slot = next++;
+        }
+        indices[i] = slot;
+    }
+
+    std::vector<uint8_t> copy(vertices, vertices + vertexCount * vertexSize);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        if (remap[v] != Unused) {
+            std::memcpy(vertices + size_t(remap[v]) * vertexSize, copy.data() + v * vertexSize,
+                        vertexSize);
+        }
+    }
+    return next;
+}
+
+QuantizedLayout BuildQuantizedLayout(const GltfVertexLayout& source, uint32_t binding)
+{
+    QuantizedLayout layout;
+    for (uint32_t location = 0; location < source.attributes.size(); ++location) {
+        const auto& attribute = source.attributes[location];
+        VkFormat format;
+        uint32_t size;
+        if (attribute.semantic == "POSITION") {
+            format = VK_FORMAT_R16G16B16A16_SFLOAT;
+            size = 8;
+        }
+        else if (attribute.semantic == "NORMAL" || attribute.semantic == "TANGENT") {
+            format = VK_FORMAT_R8G8B8A8_SNORM;
+            size = 4;
+        }
+        else if (StartsWith(attribute.semantic, "TEXCOORD_")) {
+            format = VK_FORMAT_R16G16_SFLOAT;
+            size = 4;
+        }
+        else if (StartsWith(attribute.semantic, "COLOR_")) {
+            format = VK_FORMAT_R8G8B8A8_UNORM;
+            size = 4;
+        }
+        else {
+            static constexpr VkFormat FloatFormats[4] = {
+                VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT,
+                VK_FORMAT_R32G32B32A32_SFLOAT};
+            format = FloatFormats[std::clamp(attribute.components, 1u, 4u) - 1];
+            size = attribute.components * 4;
+        }
+        layout.formats.push_back(format);
+        layout.offsets.push_back(layout.stride);
+        layout.attributes.push_back(VkVertexInputAttributeDescription{
+            .location = location,
+            .binding = binding,
+            .format = format,
+            .offset = layout.stride,
+        });
+        layout.stride += size;
+    }
+    layout.binding = VkVertexInputBindingDescription{
+        .binding = binding,
+        .stride = layout.stride,
+        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+    };
+    return layout;
+}
+
+void QuantizeVertices(const GltfVertexLayout& source, const uint8_t* src, uint32_t vertexCount,
+                      const QuantizedLayout& layout, uint8_t* dst)
+{
+    // Per-vertex temporaries make the in-place (dst == src) case safe
+    std::vector<uint8_t> packed(layout.stride);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        const uint8_t* vertex = src + size_t(v) * source.stride;
+        for (size_t a = 0; a < source.attributes.size(); ++a) {
+            const auto& attribute = source.attributes[a];
+            float value[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+            std::memcpy(value, vertex + attribute.offset, attribute.components * sizeof(float));
+            uint8_t* out = packed.data() + layout.offsets[a];
+            switch (layout.formats[a]) {
+            case VK_FORMAT_R16G16B16A16_SFLOAT:
+            case VK_FORMAT_R16G16_SFLOAT: {
+                const uint32_t count = layout.formats[a] == VK_FORMAT_R16G16_SFLOAT ? 2 : 4;
+                for (uint32_t c = 0; c < count; ++c) {
+                    const uint16_t half = FloatToHalf(value[c]);
+                    std::memcpy(out + c * 2, &half, 2);
+                }
+                break;
+            }
+            case VK_FORMAT_R8G8B8A8_SNORM:
+                for (uint32_t c = 0; c < 4; ++c) {
+                    out[c] = static_cast<uint8_t>(ToSnorm8(value[c]));
+                }
+                break;
+            case VK_FORMAT_R8G8B8A8_UNORM:
+                for (uint32_t c = 0; c < 4; ++c) {
+                    out[c] = ToUnorm8(value[c]);
+                }
+                break;
+            default:
+                std::memcpy(out, value, attribute.components * sizeof(float));
+                break;
+            }
+        }
+        std::memcpy(dst + size_t(v) * layout.stride, packed.data(), layout.stride);
+    }
+}
+
+uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (((bits >> 23) & 0xff) == 0xff) {
+        // Inf / NaN
+        return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    }
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7c00);
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        // Denormal: shift in the implicit bit, round to nearest
+        mantissa |= 0x800000;
+        const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+    uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+    // Round to nearest; a carry into the exponent is still the correct result
+    if (mantissa & 0x1000) {
+        ++half;
+    }
+    return static_cast<uint16_t>(half);
+}
+
+ProcessStats ProcessModel(GltfModel& model, const GltfVertexLayout& layout,
+                          const ProcessSettings& settings)
+{
+    ProcessStats stats;
+    stats.bytesPerVertexBefore = layout.stride;
+    stats.bytesPerVertexAfter = settings.quantize ? settings.quantize->stride : layout.stride;
+
+    const auto position = std::find_if(layout.attributes.begin(), layout.attributes.end(),
+                                       [](auto& attribute) { return attribute.semantic == "POSITION"; });
+    auto* mapped = static_cast<uint8_t*>(model.staging->Map());
+    auto* indices = reinterpret_cast<uint32_t*>(mapped + model.indexOffset);
+
+    // Vertices of primitives are compacted as they go: fetch optimization may drop unused
+    // vertices and quantization shrinks the stride. Destinations never overtake sources.
+    uint32_t packedVertex = 0;
+    for (auto& gltfMesh : model.meshes) {
+        for (auto& primitive : gltfMesh.primitives) {
+            uint8_t* vertices = mapped + size_t(primitive.firstVertex) * layout.stride;
+            uint32_t* primitiveIndices = indices + primitive.firstIndex;
+            stats.triangleCount += primitive.indexCount / 3;
+            stats.vertexInvocationsBefore +=
+                SimulateVertexCache(primitiveIndices, primitive.indexCount, settings.cacheSize);
+
+            std::vector<uint32_t> clusters;
+            if (settings.optimizeVertexCache) {
+                OptimizeVertexCache(primitiveIndices, primitive.indexCount, primitive.vertexCount,
+                                    settings.cacheSize, &clusters);
+            }
+            if (settings.optimizeOverdraw && settings.optimizeVertexCache &&
+                position != layout.attributes.end()) {
+                OptimizeOverdraw(primitiveIndices, primitive.indexCount,
+                                 vertices + position->offset, layout.stride, clusters);
+            }
+            stats.vertexInvocationsAfter +=
+                SimulateVertexCache(primitiveIndices, primitive.indexCount, settings.cacheSize);
+
+            if (settings.optimizeVertexFetch) {
+                primitive.vertexCount = OptimizeVertexFetch(vertices, primitive.vertexCount,
+                                                            layout.stride, primitiveIndices,
+                                                            primitive.indexCount);
+            }
+
+            const uint32_t stride = stats.bytesPerVertexAfter;
+            uint8_t* dst = mapped + size_t(packedVertex) * stride;
+            if (settings.quantize) {
+                QuantizeVertices(layout, vertices, primitive.vertexCount, *settings.quantize, dst);
+            }
+            else if (dst != vertices) {
+                std::memmove(dst, vertices, size_t(primitive.vertexCount) * stride);
+            }
+            primitive.firstVertex = packedVertex;
+            packedVertex += primitive.vertexCount;
+        }
+    }
+    model.staging->Unmap();
+
+    model.vertexCount = packedVertex;
+    model.vertexBytes = VkDeviceSize(packedVertex) * stats.bytesPerVertexAfter;
+    return stats;
+}
+
+} // namespace mesh
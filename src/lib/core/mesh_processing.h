@@ -0,0 +1,75 @@
+#pragma once
+#include "core/gltf_loader.h"
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Import-time mesh processing: triangle order for the post-transform cache and overdraw,
+// vertex order for fetch locality, and attribute quantization.
+namespace mesh {
+
+    // Vertex-shader invocations a FIFO post-transform cache of cacheSize entries would run
+    uint32_t SimulateVertexCache(const uint32_t* indices, size_t indexCount, uint32_t cacheSize);
+
+    // Tipsify (Sander et al. 2007). clusters receives the first triangle of each run that
+    // starts with a cold cache; those runs can be reordered without hurting cache hits.
+    void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount,
+                             uint32_t cacheSize, std::vector<uint32_t>* clusters = nullptr);
+
+    // Sorts the clusters from OptimizeVertexCache front-to-back by view-independent occlusion
+    // potential, so outward-facing parts that tend to hide the rest draw first
+    void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const uint8_t* positions,
+                          size_t positionStride, const std::vector<uint32_t>& clusters);
+
+    // Renumbers vertices in first-use order and moves the vertex data to match. Unreferenced
+    // vertices are dropped; returns the new vertex count.
+    uint32_t OptimizeVertexFetch(uint8_t* vertices, size_t vertexCount, size_t vertexSize,
+                                 uint32_t* indices, size_t indexCount);
+
+    // Packed formats per semantic: POSITION half4, NORMAL / TANGENT snorm8x4,
+    // TEXCOORD_n half2, COLOR_n unorm8x4, anything else unchanged fp32. All expand to floats
+    // in the input assembler, so shaders do not change.
+    struct QuantizedLayout {
+        uint32_t stride = 0;
+        std::vector<VkFormat> formats;
+        std::vector<uint32_t> offsets;
+        VkVertexInputBindingDescription binding{};
+        // Location i = attribute i of the source layout
+        std::vector<VkVertexInputAttributeDescription> attributes;
+    };
+
+    QuantizedLayout BuildQuantizedLayout(const GltfVertexLayout& source, uint32_t binding = 0);
+
+    // dst may alias src: the packed stride is never larger than the source stride
+    void QuantizeVertices(const GltfVertexLayout& source, const uint8_t* src, uint32_t vertexCount,
+                          const QuantizedLayout& layout, uint8_t* dst);
+
+    uint16_t FloatToHalf(float value);
+
+    struct ProcessSettings {
+        uint32_t cacheSize = 16;
+        bool optimizeVertexCache = true;
+        bool optimizeOverdraw = true;
+        bool optimizeVertexFetch = true;
+        // Packs the vertices in place; GltfModel::vertexBytes shrinks accordingly
+        const QuantizedLayout* quantize = nullptr;
+    };
+
+    struct ProcessStats {
+        uint32_t vertexInvocationsBefore = 0;
+        uint32_t vertexInvocationsAfter = 0;
+        uint32_t triangleCount = 0;
+        uint32_t bytesPerVertexBefore = 0;
+        uint32_t bytesPerVertexAfter = 0;
+
+        // Average cache miss ratio (vertex shader runs per triangle)
+        float GetAcmrBefore() const { return triangleCount ? float(vertexInvocationsBefore) / triangleCount : 0.0f; }
+        float GetAcmrAfter() const { return triangleCount ? float(vertexInvocationsAfter) / triangleCount : 0.0f; }
+    };
+
+    // Runs the enabled steps on every primitive of a loaded model, in its staging memory
+    ProcessStats ProcessModel(GltfModel& model, const GltfVertexLayout& layout,
+                              const ProcessSettings& settings);
+
+} // namespace mesh
@@ -0,0 +1,225 @@
+#include "per_draw_data.h"
+#include "core/gpu_memory_tracker.h"
+#include "core/pipeline_layout_cache.h"
+#include "core/vulkan_context.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+bool UniformRing::Initialize(VkDeviceSize bytesPerFrame)
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+
+    m_alignment = vulkanCtx.GetPhysicalDeviceProperties().limits.minUniformBufferOffsetAlignment;
+    m_bytesPerFrame = (bytesPerFrame + m_alignment - 1) & ~(m_alignment - 1);
+
+    VkBufferCreateInfo bufferInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = m_bytesPerFrame * VulkanContext::MaxInflightFrame,
+        .usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    if (vkCreateBuffer(device, &bufferInfo, allocator, &m_buffer) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device, m_buffer, &memRequirements);
+    m_memory = vulkanCtx.AllocateMemory(
+        memRequirements,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        GpuMemoryCategory::Buffer, "UniformRing");
+    if (m_memory == VK_NULL_HANDLE) {
+        Cleanup();
+        return false;
+    }
+    vkBindBufferMemory(device, m_buffer, m_memory, 0);
+
+    void* mapped = nullptr;
+    vkMapMemory(device, m_memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+    m_mapped = static_cast<uint8_t*>(mapped);
+    vulkanCtx.SetDebugObjectName(reinterpret_cast<void*>(m_buffer), VK_OBJECT_TYPE_BUFFER,
+                                 "UniformRing");
+    return true;
+}
+
+void UniformRing::Cleanup()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    if (m_mapped != nullptr) {
+        vkUnmapMemory(device, m_memory);
+        m_mapped = nullptr;
+    }
+    vkDestroyBuffer(device, m_buffer, allocator);
+    vulkanCtx.FreeMemory(m_memory);
+    m_buffer = VK_NULL_HANDLE;
+    m_memory = VK_NULL_HANDLE;
+}
+
+void UniformRing::BeginFrame(uint32_t frameIndex)
+{
+    m_frameBase = (frameIndex % VulkanContext::MaxInflightFrame) * m_bytesPerFrame;
+    m_head = 0;
+}
+
+UniformRing::Slice UniformRing::Allocate(VkDeviceSize size)
+{
+    VkDeviceSize offset = (m_head + m_alignment - 1) & ~(m_alignment - 1);
+    if (offset + size > m_bytesPerFrame) {
+        return Slice{};
+    }
+    m_head = offset + size;
+    return Slice{
+        .buffer = m_buffer,
+        .offset = m_frameBase + offset,
+        .mapped = m_mapped + m_frameBase + offset,
+    };
+}
+
+bool PerDrawData::Initialize(UniformRing& ring, uint32_t dataSize, VkShaderStageFlags stages,
+                             uint32_t setIndex, std::optional<Path> forcePath)
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    const auto& limits = vulkanCtx.GetPhysicalDeviceProperties().limits;
+
+    m_ring = &ring;
+    m_dataSize = dataSize;
+    m_stages = stages;
+    m_setIndex = setIndex;
+
+    // vkCmdPushConstants takes sizes in multiples of 4
+    const bool pushConstantsFit = dataSize <= limits.maxPushConstantsSize && dataSize % 4 == 0;
+    if (forcePath == Path::PushConstants && !pushConstantsFit) {
+        std::cerr << "[per draw data] " << dataSize
+                  << " bytes cannot be push constants (not a multiple of 4 or above "
+                  << limits.maxPushConstantsSize << ")" << std::endl;
+        return false;
+    }
+    if (forcePath == Path::PushConstants || (!forcePath && pushConstantsFit)) {
+        m_path = Path::PushConstants;
+        m_pushConstantRange = {.stageFlags = stages, .offset = 0, .size = dataSize};
+        return true;
+    }
+    if (dataSize > limits.maxUniformBufferRange) {
+        std::cerr << "[per draw data] " << dataSize << " bytes exceed maxUniformBufferRange"
+                  << std::endl;
+        return false;
+    }
+
+    const bool pushDescriptorFits =
+        vulkanCtx.IsPushDescriptorSupported() && dataSize <= MaxPushDescriptorSize;
+    if (forcePath == Path::PushDescriptor && !pushDescriptorFits) {
+        std::cerr << "[per draw data] push descriptors not supported or " << dataSize
+                  << " bytes above " << MaxPushDescriptorSize << std::endl;
+        return false;
+    }
+    if (forcePath != Path::DynamicUniform && pushDescriptorFits) {
+        m_pfnCmdPushDescriptorSet = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(
+            vkGetDeviceProcAddr(vulkanCtx.GetVkDevice(), "vkCmdPushDescriptorSetKHR"));
+    }
+
+    const bool pushDescriptor = m_pfnCmdPushDescriptorSet != nullptr;
+    if (forcePath == Path::PushDescriptor && !pushDescriptor) {
+        return false;
+    }
+    m_path = pushDescriptor ? Path::PushDescriptor : Path::DynamicUniform;
+    std::vector<VkDescriptorSetLayoutBinding> bindings = {{
+        .binding = 0,
+        .descriptorType = pushDescriptor ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+                                         : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+        .descriptorCount = 1,
+        .stageFlags = stages,
+    }};
+    m_setLayout = vulkanCtx.GetPipelineLayoutCache().GetDescriptorSetLayout(
+        bindings, pushDescriptor ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0);
+    if (pushDescriptor) {
+        return true;
+    }
+
+    // A single set over the whole ring; each draw only changes the dynamic offset
+    m_dynamicSet = vulkanCtx.AllocateDescriptorSet(m_setLayout);
+    if (m_dynamicSet == VK_NULL_HANDLE) {
+        return false;
+    }
+    VkDescriptorBufferInfo bufferInfo{
+        .buffer = ring.GetVkBuffer(),
+        .offset = 0,
+        .range = dataSize,
+    };
+    VkWriteDescriptorSet write{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = m_dynamicSet,
+        .dstBinding = 0,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+        .pBufferInfo = &bufferInfo,
+    };
+    vkUpdateDescriptorSets(vulkanCtx.GetVkDevice(), 1, &write, 0, nullptr);
+    return true;
+}
+
+void PerDrawData::Cleanup()
+{
+    // The set layout belongs to the PipelineLayoutCache
+    VulkanContext::Get().FreeDescriptorSet(m_dynamicSet);
+    m_dynamicSet = VK_NULL_HANDLE;
+    m_setLayout = VK_NULL_HANDLE;
+    m_pfnCmdPushDescriptorSet = nullptr;
+    m_ring = nullptr;
+}
+
+const char* PerDrawData::GetPathName(Path path)
+{
+    switch (path) {
+    case Path::PushConstants:
+        return "push constants";
+    case Path::PushDescriptor:
+        return "push descriptor";
+    case Path::DynamicUniform:
+        return "dynamic uniform";
+    default:
+        return "unknown";
+    }
+}
+
+bool PerDrawData::Push(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+                       VkPipelineLayout pipelineLayout, const void* data)
+{
+    if (m_path == Path::PushConstants) {
+        vkCmdPushConstants(commandBuffer, pipelineLayout, m_stages, 0, m_dataSize, data);
+        return true;
+    }
+
+    auto slice = m_ring->Allocate(m_dataSize);
+    if (slice.mapped == nullptr) {
+        return false;
+    }
+    std::memcpy(slice.mapped, data, m_dataSize);
+
+    if (m_path == Path::PushDescriptor) {
+        VkDescriptorBufferInfo bufferInfo{
+            .buffer = slice.buffer,
+            .offset = slice.offset,
+            .range = m_dataSize,
+        };
+        VkWriteDescriptorSet write{
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .pBufferInfo = &bufferInfo,
+        };
+        m_pfnCmdPushDescriptorSet(commandBuffer, bindPoint, pipelineLayout, m_setIndex, 1,
+                                  &write);
+        return true;
+    }
+
+    const uint32_t dynamicOffset = static_cast<uint32_t>(slice.offset);
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, m_setIndex, 1,
+                            &m_dynamicSet, 1, &dynamicOffset);
+    return true;
+}
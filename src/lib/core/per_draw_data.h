@@ -0,0 +1,101 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <optional>
+
+// Host-visible uniform memory sliced per draw. One segment per frame in flight, reset by
+// BeginFrame once that frame's fence has been waited on.
+class UniformRing {
+public:
+    struct Slice {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        void* mapped = nullptr;
+    };
+
+    static constexpr VkDeviceSize DefaultBytesPerFrame = 4 << 20;
+
+    UniformRing() = default;
+    ~UniformRing() = default;
+
+    UniformRing(const UniformRing&) = delete;
+    UniformRing& operator=(const UniformRing&) = delete;
+
+    bool Initialize(VkDeviceSize bytesPerFrame = DefaultBytesPerFrame);
+    void Cleanup();
+
+    void BeginFrame(uint32_t frameIndex);
+
+    // Returns a slice with mapped == nullptr when the frame segment is full
+    Slice Allocate(VkDeviceSize size);
+
+    VkBuffer GetVkBuffer() const { return m_buffer; }
+
+private:
+    VkBuffer m_buffer = VK_NULL_HANDLE;
+    VkDeviceMemory m_memory = VK_NULL_HANDLE;
+    uint8_t* m_mapped = nullptr;
+    VkDeviceSize m_alignment = 1;
+    VkDeviceSize m_bytesPerFrame = 0;
+    VkDeviceSize m_frameBase = 0;
+    VkDeviceSize m_head = 0;
+};
+
+// Per-object data for one shader interface block, delivered by the cheapest path its size allows:
+//  - PushConstants:  size <= maxPushConstantsSize
+//  - PushDescriptor: VK_KHR_push_descriptor, size <= MaxPushDescriptorSize; data in UniformRing
+//  - DynamicUniform: one UNIFORM_BUFFER_DYNAMIC set over the ring, rebound with a new offset
+// None of the paths allocates or updates a descriptor set per draw. Push constant sizes must
+// be a multiple of 4.
+//
+// GLSL side, depending on GetPath():
+//   layout(push_constant) uniform DrawData { ... };
+//   layout(set = N, binding = 0) uniform DrawData { ... };
+class PerDrawData {
+public:
+    enum class Path {
+        PushConstants,
+        PushDescriptor,
+        DynamicUniform,
+    };
+
+    // Guaranteed minimum of maxUniformBufferRange
+    static constexpr uint32_t MaxPushDescriptorSize = 16384;
+
+    PerDrawData() = default;
+    ~PerDrawData() = default;
+
+    PerDrawData(const PerDrawData&) = delete;
+    PerDrawData& operator=(const PerDrawData&) = delete;
+
+    // setIndex is only used by the descriptor paths. forcePath skips the size-based choice,
+    // e.g. to test each path on one device; fails if the device cannot use it.
+    bool Initialize(UniformRing& ring, uint32_t dataSize, VkShaderStageFlags stages,
+                    uint32_t setIndex, std::optional<Path> forcePath = std::nullopt);
+    void Cleanup();
+
+    static const char* GetPathName(Path path);
+
+    Path GetPath() const { return m_path; }
+    uint32_t GetSetIndex() const { return m_setIndex; }
+    // VK_NULL_HANDLE for PushConstants
+    VkDescriptorSetLayout GetSetLayout() const { return m_setLayout; }
+    // size == 0 unless PushConstants
+    VkPushConstantRange GetPushConstantRange() const { return m_pushConstantRange; }
+
+    // Records the data for the next draw. pipelineLayout must include GetSetLayout() at
+    // GetSetIndex() or GetPushConstantRange().
+    bool Push(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+              VkPipelineLayout pipelineLayout, const void* data);
+
+private:
+    UniformRing* m_ring = nullptr;
+    Path m_path = Path::PushConstants;
+    uint32_t m_dataSize = 0;
+    uint32_t m_setIndex = 0;
+    VkShaderStageFlags m_stages = 0;
+    VkPushConstantRange m_pushConstantRange{};
+    VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+    VkDescriptorSet m_dynamicSet = VK_NULL_HANDLE;
+    PFN_vkCmdPushDescriptorSetKHR m_pfnCmdPushDescriptorSet = nullptr;
+};
@@ -0,0 +1,195 @@
+#include "pipeline_layout_cache.h"
+#include "core/shader_reflection.h"
+#include "core/vulkan_context.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+size_t HashWords(size_t seed, const uint32_t* words, size_t count)
+{
+    // FNV-1a over 32-bit words
+    size_t hash = seed ^ 14695981039346656037ull;
+    for (size_t i = 0; i < count; ++i) {
+        hash ^= words[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+size_t PipelineLayoutCache::KeyHash::operator()(const SetLayoutKey& key) const
+{
+    return HashWords(key.flags, key.words.data(), key.words.size());
+}
+
+size_t PipelineLayoutCache::KeyHash::operator()(const PipelineLayoutKey& key) const
+{
+    size_t hash = HashWords(0, key.pushConstantWords.data(), key.pushConstantWords.size());
+    for (auto layout : key.setLayouts) {
+        hash ^= std::hash<const void*>{}(layout) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+VkDescriptorSetLayout PipelineLayoutCache::GetDescriptorSetLayout(
+    const std::vector<VkDescriptorSetLayoutBinding>& bindings,
+    VkDescriptorSetLayoutCreateFlags flags,
+    const std::vector<VkDescriptorBindingFlags>& bindingFlags)
+{
+    SetLayoutKey key{.flags = flags};
+    key.words.reserve(bindings.size() * 5);
+    for (size_t i = 0; i < bindings.size(); ++i) {
+        auto& binding = bindings[i];
+        key.words.push_back(binding.binding);
+        key.words.push_back(static_cast<uint32_t>(binding.descriptorType));
+        key.words.push_back(binding.descriptorCount);
+        key.words.push_back(binding.stageFlags);
+        key.words.push_back(i < bindingFlags.size() ? bindingFlags[i] : 0);
+    }
+
+    std::lock_guard lock(m_mutex);
+    auto it = m_setLayouts.find(key);
+    if (it != m_setLayouts.end()) {
+        return it->second;
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .bindingCount = static_cast<uint32_t>(bindingFlags.size()),
+        .pBindingFlags = bindingFlags.data(),
+    };
+    VkDescriptorSetLayoutCreateInfo createInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = bindingFlags.empty() ? nullptr : &bindingFlagsInfo,
+        .flags = flags,
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings = bindings.data(),
+    };
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    if (vkCreateDescriptorSetLayout(device, &createInfo, allocator, &layout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    m_setLayouts.emplace(std::move(key), layout);
+    return layout;
+}
+
+VkPipelineLayout
+PipelineLayoutCache::GetPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts,
+                                       const std::vector<VkPushConstantRange>& pushConstantRanges)
+{
+    PipelineLayoutKey key{.setLayouts = setLayouts};
+    for (auto& range : pushConstantRanges) {
+        key.pushConstantWords.push_back(range.stageFlags);
+        key.pushConstantWords.push_back(range.offset);
+        key.pushConstantWords.push_back(range.size);
+    }
+
+    std::lock_guard lock(m_mutex);
+    auto it = m_pipelineLayouts.find(key);
+    if (it != m_pipelineLayouts.end()) {
+        return it->second;
+    }
+
+    VkPipelineLayoutCreateInfo createInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
+        .pSetLayouts = setLayouts.data(),
+        .pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+        .pPushConstantRanges = pushConstantRanges.data(),
+    };
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    if (vkCreatePipelineLayout(device, &createInfo, allocator, &layout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    m_pipelineLayouts.emplace(std::move(key), layout);
+    return layout;
+}
+
+PipelineLayoutCache::ReflectedLayout
+PipelineLayoutCache::GetPipelineLayout(const std::vector<const ShaderReflection*>& stages)
+{
+    // Merge bindings across stages: same (set, binding) in several stages ORs the stage flags.
+    // The stages must agree on its type and count, since one layout binding serves them all.
+    std::vector<std::vector<VkDescriptorSetLayoutBinding>> setBindings;
+    VkPushConstantRange pushConstantRange{};
+    uint32_t pushConstantEnd = 0;
+
+    for (auto* stage : stages) {
+        for (auto& descriptor : stage->descriptorBindings) {
+            if (setBindings.size() <= descriptor.set) {
+                setBindings.resize(descriptor.set + 1);
+            }
+            auto& bindings = setBindings[descriptor.set];
+            auto it = std::find_if(bindings.begin(), bindings.end(), [&](auto& binding) {
+                return binding.binding == descriptor.binding;
+            });
+            if (it != bindings.end()) {
+                if (it->descriptorType != descriptor.type ||
+                    it->descriptorCount != descriptor.count) {
+                    throw std::runtime_error(
+                        "descriptor set " + std::to_string(descriptor.set) + " binding " +
+                        std::to_string(descriptor.binding) +
+                        " has a different type or count in another shader stage!");
+                }
+                it->stageFlags |= stage->stage;
+                continue;
+            }
+            bindings.push_back(VkDescriptorSetLayoutBinding{
+                .binding = descriptor.binding,
+                .descriptorType = descriptor.type,
+                .descriptorCount = descriptor.count,
+                .stageFlags = static_cast<VkShaderStageFlags>(stage->stage),
+            });
+        }
+
+        auto& range = stage->pushConstantRange;
+        if (range.size > 0) {
+            if (pushConstantEnd == 0) {
+                pushConstantRange.offset = range.offset;
+            }
+            pushConstantRange.stageFlags |= stage->stage;
+            pushConstantRange.offset = std::min(pushConstantRange.offset, range.offset);
+            pushConstantEnd = std::max(pushConstantEnd, range.offset + range.size);
+        }
+    }
+
+    ReflectedLayout result{};
+    for (auto& bindings : setBindings) {
+        std::sort(bindings.begin(), bindings.end(),
+                  [](auto& a, auto& b) { return a.binding < b.binding; });
+        result.setLayouts.push_back(GetDescriptorSetLayout(bindings));
+    }
+    if (pushConstantEnd > 0) {
+        pushConstantRange.size = pushConstantEnd - pushConstantRange.offset;
+        result.pushConstantRanges.push_back(pushConstantRange);
+    }
+    result.pipelineLayout = GetPipelineLayout(result.setLayouts, result.pushConstantRanges);
+    return result;
+}
+
+void PipelineLayoutCache::Cleanup()
+{
+    std::lock_guard lock(m_mutex);
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    for (auto& [key, layout] : m_pipelineLayouts) {
+        vkDestroyPipelineLayout(device, layout, allocator);
+    }
+    for (auto& [key, layout] : m_setLayouts) {
+        vkDestroyDescriptorSetLayout(device, layout, allocator);
+    }
+    m_pipelineLayouts.clear();
+    m_setLayouts.clear();
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct ShaderReflection;
+
+// Deduplicates descriptor set layouts and pipeline layouts by content, so pipelines with
+// identical interfaces share the same Vulkan objects. Thread-safe.
+class PipelineLayoutCache {
+public:
+    struct ReflectedLayout {
+        VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+        // Indexed by set number; unused set numbers hold an empty layout
+        std::vector<VkDescriptorSetLayout> setLayouts;
+        std::vector<VkPushConstantRange> pushConstantRanges;
+    };
+
+    PipelineLayoutCache() = default;
+    ~PipelineLayoutCache() = default;
+
+    PipelineLayoutCache(const PipelineLayoutCache&) = delete;
+    PipelineLayoutCache& operator=(const PipelineLayoutCache&) = delete;
+
+    // bindingFlags is either empty or has one entry per binding
+    VkDescriptorSetLayout
+    GetDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings,
+                           VkDescriptorSetLayoutCreateFlags flags = 0,
+                           const std::vector<VkDescriptorBindingFlags>& bindingFlags = {});
+
+    VkPipelineLayout GetPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts,
+                                       const std::vector<VkPushConstantRange>& pushConstantRanges);
+
+    // Merges the interfaces of all stages of one pipeline and returns the matching layouts;
+    // throws if two stages declare one set/binding with different types or counts
+    ReflectedLayout GetPipelineLayout(const std::vector<const ShaderReflection*>& stages);
+
+    // Destroys every cached object. Call before the device is destroyed.
+    void Cleanup();
+
+private:
+    struct SetLayoutKey {
+        VkDescriptorSetLayoutCreateFlags flags = 0;
+        // (binding, type, count, stageFlags, bindingFlags) per binding
+        std::vector<uint32_t> words;
+        bool operator==(const SetLayoutKey&) const = default;
+    };
+    struct PipelineLayoutKey {
+        std::vector<VkDescriptorSetLayout> setLayouts;
+        std::vector<uint32_t> pushConstantWords;
+        bool operator==(const PipelineLayoutKey&) const = default;
+    };
+    struct KeyHash {
+        size_t operator()(const SetLayoutKey& key) const;
+        size_t operator()(const PipelineLayoutKey& key) const;
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<SetLayoutKey, VkDescriptorSetLayout, KeyHash> m_setLayouts;
+    std::unordered_map<PipelineLayoutKey, VkPipelineLayout, KeyHash> m_pipelineLayouts;
+};
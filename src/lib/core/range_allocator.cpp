@@ -0,0 +1,85 @@
+#include "range_allocator.h"
+#include <cassert>
+#include <iterator>
+
+void RangeAllocator::Initialize(uint32_t capacity)
+{
+    m_capacity = capacity;
+    m_freeCount = 0;
+    m_freeByOffset.clear();
+    m_freeBySize.clear();
+    if (capacity > 0) {
+        InsertFree(0, capacity);
+    }
+}
+
+uint32_t RangeAllocator::Allocate(uint32_t count)
+{
+    if (count == 0) {
+        return InvalidOffset;
+    }
+    auto bySize = m_freeBySize.lower_bound(count);
+    if (bySize == m_freeBySize.end()) {
+        return InvalidOffset;
+    }
+    const uint32_t offset = bySize->second;
+    const uint32_t rangeCount = bySize->first;
+    EraseFree(m_freeByOffset.find(offset));
+    if (rangeCount > count) {
+        InsertFree(offset + count, rangeCount - count);
+    }
+    return offset;
+}
+
+void RangeAllocator::Free(uint32_t offset, uint32_t count)
+{
+    if (offset == InvalidOffset || count == 0) {
+        return;
+    }
+    assert(offset + count <= m_capacity);
+
+    // Merge with the free range that ends at offset and the one that starts at offset + count
+    auto next = m_freeByOffset.lower_bound(offset);
+    if (next != m_freeByOffset.begin()) {
+        auto prev = std::prev(next);
+        assert(prev->first + prev->second <= offset);
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            count += prev->second;
+            EraseFree(prev);
+        }
+    }
+    if (next != m_freeByOffset.end()) {
+        assert(offset + count <= next->first);
+        if (offset + count == next->first) {
+            count += next->second;
+            EraseFree(next);
+        }
+    }
+    InsertFree(offset, count);
+}
+
+uint32_t RangeAllocator::GetLargestFreeRange() const
+{
+    return m_freeBySize.empty() ? 0 : m_freeBySize.rbegin()->first;
+}
+
+void RangeAllocator::InsertFree(uint32_t offset, uint32_t count)
+{
+    m_freeByOffset.emplace(offset, count);
+    m_freeBySize.emplace(count, offset);
+    m_freeCount += count;
+}
+
+void RangeAllocator::EraseFree(std::map<uint32_t, uint32_t>::iterator it)
+{
+    auto [first, last] = m_freeBySize.equal_range(it->second);
+    for (auto bySize = first; bySize != last; ++bySize) {
+        if (bySize->second == it->first) {
+            m_freeBySize.erase(bySize);
+            break;
+        }
+    }
+    m_freeCount -= it->second;
+    m_freeByOffset.erase(it);
+}
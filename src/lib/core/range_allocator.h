@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <map>
+
+// Best-fit allocator over [0, capacity) in abstract units (vertices, indices, bytes).
+// Freed ranges are merged with free neighbours so the space does not fragment over time.
+// Not thread-safe.
+class RangeAllocator {
+public:
+    static constexpr uint32_t InvalidOffset = ~0u;
+
+    void Initialize(uint32_t capacity);
+
+    // InvalidOffset when no free range is large enough
+    uint32_t Allocate(uint32_t count);
+    void Free(uint32_t offset, uint32_t count);
+
+    uint32_t GetCapacity() const { return m_capacity; }
+    uint32_t GetFreeCount() const { return m_freeCount; }
+    uint32_t GetLargestFreeRange() const;
+
+private:
+    void InsertFree(uint32_t offset, uint32_t count);
+    void EraseFree(std::map<uint32_t, uint32_t>::iterator it);
+
+    uint32_t m_capacity = 0;
+    uint32_t m_freeCount = 0;
+    // offset -> count, and count -> offset for best-fit lookup
+    std::map<uint32_t, uint32_t> m_freeByOffset;
+    std::multimap<uint32_t, uint32_t> m_freeBySize;
+};
@@ -0,0 +1,215 @@
+#include "render_queue.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+uint32_t SortKey::QuantizeDepth(float viewDepth, float nearZ, float farZ, bool backToFront)
+{
+    constexpr uint32_t maxValue = (1u << DepthBits) - 1;
+    float t = (viewDepth - nearZ) / (farZ - nearZ);
+    t = std::clamp(t, 0.0f, 1.0f);
+    const auto value = static_cast<uint32_t>(t * float(maxValue) + 0.5f);
+    return backToFront ? maxValue - value : value;
+}
+
+uint32_t RenderQueue::RegisterPipeline(VkPipeline pipeline, VkPipelineLayout layout,
+                                       VkShaderStageFlags pushConstantStages,
+                                       VkPipelineBindPoint bindPoint)
+{
+    assert(m_pipelines.size() < (1u << SortKey::PipelineBits));
+    m_pipelines.push_back({pipeline, layout, pushConstantStages, bindPoint});
+    return static_cast<uint32_t>(m_pipelines.size() - 1);
+}
+
+uint32_t RenderQueue::RegisterMaterial(VkDescriptorSet set, uint32_t setIndex)
+{
+    assert(m_materials.size() < (1u << SortKey::MaterialBits));
+    m_materials.push_back({set, setIndex});
+    return static_cast<uint32_t>(m_materials.size() - 1);
+}
+
+uint32_t RenderQueue::RegisterMesh(VkBuffer vertexBuffer, VkBuffer indexBuffer,
+                                   VkIndexType indexType)
+{
+    assert(m_meshes.size() < (1u << SortKey::MeshBits));
+    m_meshes.push_back({vertexBuffer, indexBuffer, indexType});
+    return static_cast<uint32_t>(m_meshes.size() - 1);
+}
+
+void RenderQueue::ClearRegistrations()
+{
+    m_pipelines.clear();
+    m_materials.clear();
+    m_meshes.clear();
+}
+
+void RenderQueue::Reset()
+{
+    m_items.clear();
+    m_pushData.clear();
+    m_sorted.clear();
+    m_stats = Stats{};
+}
+
+void RenderQueue::Submit(uint64_t key, const DrawArgs& args, const void* pushConstants,
+                         uint32_t pushConstantSize)
+{
+    assert(pushConstantSize <= MaxPushConstantSize);
+    DrawItem item{
+        .args = args,
+        .pushOffset = static_cast<uint32_t>(m_pushData.size()),
+        .pushSize = pushConstants != nullptr ? pushConstantSize : 0,
+    };
+    if (item.pushSize > 0) {
+        const auto* bytes = static_cast<const uint8_t*>(pushConstants);
+        m_pushData.insert(m_pushData.end(), bytes, bytes + item.pushSize);
+    }
+    m_sorted.push_back({key, static_cast<uint32_t>(m_items.size())});
+    m_items.push_back(item);
+}
+
+void RenderQueue::Sort()
+{
+    m_stats.drawCount = static_cast<uint32_t>(m_sorted.size());
+    CountSwitches(m_stats.unsortedPipelineSwitches, m_stats.unsortedMaterialSwitches,
+                  m_stats.unsortedMeshSwitches);
+    RadixSort(m_sorted, m_scratch);
+    CountSwitches(m_stats.pipelineSwitches, m_stats.materialSwitches, m_stats.meshSwitches);
+}
+
+void RenderQueue::CountSwitches(uint32_t& pipelines, uint32_t& materials, uint32_t& meshes) const
+{
+    BindState state{};
+    pipelines = materials = meshes = 0;
+    for (const auto& item : m_sorted) {
+        bool bindPipeline = false, bindMaterial = false, bindMesh = false;
+        UpdateBindState(state, item.key, m_pipelines[SortKey::GetPipeline(item.key)].layout,
+                        bindPipeline, bindMaterial, bindMesh);
+        pipelines += bindPipeline;
+        materials += bindMaterial;
+        meshes += bindMesh;
+    }
+}
+
+void RenderQueue::RadixSort(std::vector<KeyIndex>& items, std::vector<KeyIndex>& scratch)
+{
+    constexpr uint32_t DigitCount = 8;
+    const size_t count = items.size();
+    if (count < 2) {
+        return;
+    }
+    scratch.resize(count);
+
+    // One read of the keys builds the histograms of all eight digits
+    uint32_t histograms[DigitCount][256] = {};
+    for (const auto& item : items) {
+        for (uint32_t digit = 0; digit < DigitCount; ++digit) {
+            ++histograms[digit][(item.key >> (digit * 8)) & 0xFF];
+        }
+    }
+
+    KeyIndex* src = items.data();
+    KeyIndex* dst = scratch.data();
+    for (uint32_t digit = 0; digit < DigitCount; ++digit) {
+        auto& histogram = histograms[digit];
+        // Unused key fields are constant; their passes would only copy
+        const uint32_t first = static_cast<uint32_t>((src[0].key >> (digit * 8)) & 0xFF);
+        if (histogram[first] == count) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (auto& bucket : histogram) {
+            const uint32_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+        const uint32_t shift = digit * 8;
+        for (size_t i = 0; i < count; ++i) {
+            dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    if (src != items.data()) {
+        std::memcpy(items.data(), src, count * sizeof(KeyIndex));
+    }
+}
+
+void RenderQueue::Execute(VkCommandBuffer commandBuffer)
+{
+    ExecuteRange(commandBuffer, 0, m_sorted.size());
+}
+
+void RenderQueue::Execute(VkCommandBuffer commandBuffer, uint32_t pass)
+{
+    // Sorted by pass first, so the pass is one contiguous range
+    const uint64_t passBegin = SortKey::Make(pass, 0, 0, 0, 0);
+    const uint64_t passEnd = pass + 1 < (1u << SortKey::PassBits)
+                                 ? SortKey::Make(pass + 1, 0, 0, 0, 0)
+                                 : ~0ull;
+    auto byKey = [](const KeyIndex& item, uint64_t key) { return item.key < key; };
+    auto begin = std::lower_bound(m_sorted.begin(), m_sorted.end(), passBegin, byKey);
+    auto end = passEnd == ~0ull ? m_sorted.end()
+                                : std::lower_bound(begin, m_sorted.end(), passEnd, byKey);
+    ExecuteRange(commandBuffer, begin - m_sorted.begin(), end - m_sorted.begin());
+}
+
+void RenderQueue::ExecuteRange(VkCommandBuffer commandBuffer, size_t begin, size_t end)
+{
+    // Each Execute call starts from unknown command buffer state
+    BindState state{};
+    for (size_t i = begin; i < end; ++i) {
+        const uint64_t key = m_sorted[i].key;
+        const auto& pipeline = m_pipelines[SortKey::GetPipeline(key)];
+        bool bindPipeline = false, bindMaterial = false, bindMesh = false;
+        UpdateBindState(state, key, pipeline.layout, bindPipeline, bindMaterial, bindMesh);
+
+        if (bindPipeline) {
+            vkCmdBindPipeline(commandBuffer, pipeline.bindPoint, pipeline.pipeline);
+        }
+        if (bindMaterial) {
+            const auto& material = m_materials[SortKey::GetMaterial(key)];
+            if (material.set != VK_NULL_HANDLE) {
+                vkCmdBindDescriptorSets(commandBuffer, pipeline.bindPoint, pipeline.layout,
+                                        material.setIndex, 1, &material.set, 0, nullptr);
+            }
+        }
+        if (bindMesh) {
+            const auto& mesh = m_meshes[SortKey::GetMesh(key)];
+            VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mesh.vertexBuffer, &offset);
+            vkCmdBindIndexBuffer(commandBuffer, mesh.indexBuffer, 0, mesh.indexType);
+        }
+
+        const auto& item = m_items[m_sorted[i].index];
+        if (item.pushSize > 0) {
+            vkCmdPushConstants(commandBuffer, pipeline.layout, pipeline.pushConstantStages, 0,
+                               item.pushSize, m_pushData.data() + item.pushOffset);
+        }
+        const auto& args = item.args;
+        vkCmdDrawIndexed(commandBuffer, args.indexCount, args.instanceCount, args.firstIndex,
+                         args.vertexOffset, args.firstInstance);
+    }
+}
+
+void RenderQueue::UpdateBindState(BindState& state, uint64_t key, VkPipelineLayout layout,
+                                  bool& bindPipeline, bool& bindMaterial, bool& bindMesh)
+{
+    const uint32_t pipeline = SortKey::GetPipeline(key);
+    const uint32_t material = SortKey::GetMaterial(key);
+    const uint32_t mesh = SortKey::GetMesh(key);
+
+    bindPipeline = pipeline != state.pipeline;
+    if (bindPipeline) {
+        state.pipeline = pipeline;
+        // Sets bound through an incompatible layout are disturbed; rebind conservatively
+        if (layout != state.layout) {
+            state.layout = layout;
+            state.material = ~0u;
+        }
+    }
+    bindMaterial = material != state.material;
+    state.material = material;
+    bindMesh = mesh != state.mesh;
+    state.mesh = mesh;
+}
@@ -0,0 +1,173 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+// Packed 64-bit draw sort key, compared as an integer. Fields, most significant first:
+//   pass (4) | pipeline (12) | material (16) | depth (16) | mesh (16)
+// Sorting by key groups draws by pass, then pipeline, then material, so the expensive
+// state changes happen as rarely as possible.
+struct SortKey {
+    static constexpr uint32_t PassBits = 4;
+    static constexpr uint32_t PipelineBits = 12;
+    static constexpr uint32_t MaterialBits = 16;
+    static constexpr uint32_t DepthBits = 16;
+    static constexpr uint32_t MeshBits = 16;
+
+    static constexpr uint32_t MeshShift = 0;
+    static constexpr uint32_t DepthShift = MeshShift + MeshBits;
+    static constexpr uint32_t MaterialShift = DepthShift + DepthBits;
+    static constexpr uint32_t PipelineShift = MaterialShift + MaterialBits;
+    static constexpr uint32_t PassShift = PipelineShift + PipelineBits;
+    static_assert(PassShift + PassBits == 64);
+
+    static constexpr uint64_t Make(uint32_t pass, uint32_t pipeline, uint32_t material,
+                                   uint32_t depth, uint32_t mesh)
+    {
+        return (Field(pass, PassBits) << PassShift) |
+               (Field(pipeline, PipelineBits) << PipelineShift) |
+               (Field(material, MaterialBits) << MaterialShift) |
+               (Field(depth, DepthBits) << DepthShift) | (Field(mesh, MeshBits) << MeshShift);
+    }
+
+    static constexpr uint32_t GetPass(uint64_t key) { return Get(key, PassShift, PassBits); }
+    static constexpr uint32_t GetPipeline(uint64_t key) { return Get(key, PipelineShift, PipelineBits); }
+    static constexpr uint32_t GetMaterial(uint64_t key) { return Get(key, MaterialShift, MaterialBits); }
+    static constexpr uint32_t GetDepth(uint64_t key) { return Get(key, DepthShift, DepthBits); }
+    static constexpr uint32_t GetMesh(uint64_t key) { return Get(key, MeshShift, MeshBits); }
+
+    // Maps view-space distance in [nearZ, farZ] to the depth field: front to back for opaque
+    // passes, back to front (backToFront) for blended ones
+    static uint32_t QuantizeDepth(float viewDepth, float nearZ, float farZ,
+                                  bool backToFront = false);
+
+private:
+    static constexpr uint64_t Field(uint32_t value, uint32_t bits)
+    {
+        return uint64_t(value) & ((1ull << bits) - 1);
+    }
+    static constexpr uint32_t Get(uint64_t key, uint32_t shift, uint32_t bits)
+    {
+        return static_cast<uint32_t>((key >> shift) & ((1ull << bits) - 1));
+    }
+};
+
+// Per-frame draw list. Draws are submitted in any order with a SortKey whose pipeline,
+// material and mesh fields are ids from the Register functions, radix sorted, and translated
+// into commands that skip binds whose state has not changed:
+//   queue.Reset();
+//   queue.Submit(SortKey::Make(0, pipeline, material, depth, mesh), args, &push, sizeof(push));
+//   queue.Sort();
+//   queue.Execute(cmd, 0);
+class RenderQueue {
+public:
+    static constexpr uint32_t MaxPushConstantSize = 128;
+
+    struct DrawArgs {
+        uint32_t indexCount = 0;
+        uint32_t instanceCount = 1;
+        uint32_t firstIndex = 0;
+        int32_t vertexOffset = 0;
+        uint32_t firstInstance = 0;
+    };
+
+    // State switches Execute records for the sorted list, next to what the same draws would
+    // cost in submission order. Filled by Sort.
+    struct Stats {
+        uint32_t drawCount = 0;
+        uint32_t pipelineSwitches = 0;
+        uint32_t materialSwitches = 0;
+        uint32_t meshSwitches = 0;
+        uint32_t unsortedPipelineSwitches = 0;
+        uint32_t unsortedMaterialSwitches = 0;
+        uint32_t unsortedMeshSwitches = 0;
+    };
+
+    RenderQueue() = default;
+    ~RenderQueue() = default;
+
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    // Ids stay valid until ClearRegistrations. Push constants of draws using the pipeline are
+    // pushed at offset 0 with pushConstantStages.
+    uint32_t RegisterPipeline(VkPipeline pipeline, VkPipelineLayout layout,
+                              VkShaderStageFlags pushConstantStages = 0,
+                              VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS);
+    // set may be VK_NULL_HANDLE for materials that only differ in push constants
+    uint32_t RegisterMaterial(VkDescriptorSet set, uint32_t setIndex);
+    uint32_t RegisterMesh(VkBuffer vertexBuffer, VkBuffer indexBuffer,
+                          VkIndexType indexType = VK_INDEX_TYPE_UINT32);
+    void ClearRegistrations();
+
+    // Starts a new frame's list; keeps capacity
+    void Reset();
+
+    // pushConstantSize must not exceed MaxPushConstantSize
+    void Submit(uint64_t key, const DrawArgs& args, const void* pushConstants = nullptr,
+                uint32_t pushConstantSize = 0);
+
+    // Linear-time LSD radix sort on the keys; equal keys keep submission order
+    void Sort();
+
+    // Records the sorted draws of every pass, or of one pass
+    void Execute(VkCommandBuffer commandBuffer);
+    void Execute(VkCommandBuffer commandBuffer, uint32_t pass);
+
+    uint32_t GetDrawCount() const { return static_cast<uint32_t>(m_items.size()); }
+    const Stats& GetStats() const { return m_stats; }
+
+    // Sorts (key, value) pairs by key, 8 bits per pass, skipping digits all keys share.
+    // scratch is resized as needed.
+    struct KeyIndex {
+        uint64_t key;
+        uint32_t index;
+    };
+    static void RadixSort(std::vector<KeyIndex>& items, std::vector<KeyIndex>& scratch);
+
+private:
+    struct PipelineState {
+        VkPipeline pipeline;
+        VkPipelineLayout layout;
+        VkShaderStageFlags pushConstantStages;
+        VkPipelineBindPoint bindPoint;
+    };
+    struct MaterialState {
+        VkDescriptorSet set;
+        uint32_t setIndex;
+    };
+    struct MeshState {
+        VkBuffer vertexBuffer;
+        VkBuffer indexBuffer;
+        VkIndexType indexType;
+    };
+    struct DrawItem {
+        DrawArgs args;
+        uint32_t pushOffset;
+        uint32_t pushSize;
+    };
+
+    // Ids currently bound while walking a draw list
+    struct BindState {
+        uint32_t pipeline = ~0u;
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        uint32_t material = ~0u;
+        uint32_t mesh = ~0u;
+    };
+
+    void ExecuteRange(VkCommandBuffer commandBuffer, size_t begin, size_t end);
+    void CountSwitches(uint32_t& pipelines, uint32_t& materials, uint32_t& meshes) const;
+    // Applies the bind-skipping rules to one key; returns which binds are needed
+    static void UpdateBindState(BindState& state, uint64_t key, VkPipelineLayout layout,
+                                bool& bindPipeline, bool& bindMaterial, bool& bindMesh);
+
+    std::vector<PipelineState> m_pipelines;
+    std::vector<MaterialState> m_materials;
+    std::vector<MeshState> m_meshes;
+
+    std::vector<DrawItem> m_items;
+    std::vector<uint8_t> m_pushData;
+    std::vector<KeyIndex> m_sorted;
+    std::vector<KeyIndex> m_scratch;
+    Stats m_stats;
+};
@@ -0,0 +1,200 @@
+#include "shader_compiler.h"
+#include "core/asset_archive.h"
+#include <glslang/Public/ShaderLang.h>
+#include <glslang/Public/ResourceLimits.h>
+#include <SPIRV/GlslangToSpv.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <mutex>
+#include <optional>
+
+namespace {
+
+std::optional<EShLanguage> ToShaderStage(const std::filesystem::path& path)
+{
+    const auto ext = path.extension().string();
+    if (ext == ".vert") return EShLangVertex;
+    if (ext == ".tesc") return EShLangTessControl;
+    if (ext == ".tese") return EShLangTessEvaluation;
+    if (ext == ".geom") return EShLangGeometry;
+    if (ext == ".frag") return EShLangFragment;
+    if (ext == ".comp") return EShLangCompute;
+    return std::nullopt;
+}
+
+bool ReadTextFile(const std::filesystem::path& path, std::string& text)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    text = ss.str();
+    return true;
+}
+
+// glslang must be initialized once per process before any TShader is created
+void EnsureGlslangInitialized()
+{
+    static std::once_flag initFlag;
+    std::call_once(initFlag, [] {
+        glslang::InitializeProcess();
+        std::atexit([] { glslang::FinalizeProcess(); });
+    });
+}
+
+// Resolves #include "file" relative to the including file and records every hit
+class FileIncluder : public glslang::TShader::Includer {
+public:
+    explicit FileIncluder(std::filesystem::path baseDir)
+        : m_baseDir(std::move(baseDir))
+    {
+    }
+
+    IncludeResult* includeLocal(const char* headerName, const char* includerName,
+                                size_t inclusionDepth) override
+    {
+        std::filesystem::path includerDir = m_baseDir;
+        if (inclusionDepth > 1 && includerName != nullptr) {
+            includerDir = std::filesystem::path(includerName).parent_path();
+        }
+        return Open(includerDir / headerName);
+    }
+
+    IncludeResult* includeSystem(const char* headerName, const char*, size_t) override
+    {
+        return Open(m_baseDir / headerName);
+    }
+
+    void releaseInclude(IncludeResult* result) override
+    {
+        if (result != nullptr) {
+            delete static_cast<std::string*>(result->userData);
+            delete result;
+        }
+    }
+
+    const std::vector<std::filesystem::path>& GetIncludedFiles() const { return m_includedFiles; }
+
+private:
+    IncludeResult* Open(const std::filesystem::path& path)
+    {
+        auto* text = new std::string();
+        if (!ReadTextFile(path, *text)) {
+            delete text;
+            return nullptr;
+        }
+        m_includedFiles.push_back(path.lexically_normal());
+        return new IncludeResult(path.string(), text->data(), text->size(), text);
+    }
+
+    std::filesystem::path m_baseDir;
+    std::vector<std::filesystem::path> m_includedFiles;
+};
+
+} // namespace
+
+namespace loader {
+
+bool IsGlslSourceFile(const std::filesystem::path& path)
+{
+    return ToShaderStage(path).has_value();
+}
+
+ShaderCompileResult CompileGlslToSpirv(const std::filesystem::path& sourcePath)
+{
+    ShaderCompileResult result{};
+
+    auto stage = ToShaderStage(sourcePath);
+    if (!stage) {
+        result.log = "unknown shader stage: " + sourcePath.string();
+        return result;
+    }
+
+    std::string source;
+    if (!ReadTextFile(sourcePath, source)) {
+        result.log = "failed to open shader source: " + sourcePath.string();
+        return result;
+    }
+
+    EnsureGlslangInitialized();
+
+    const std::string sourceName = sourcePath.string();
+    const char* sourceText = source.c_str();
+    const char* sourceNameText = sourceName.c_str();
+
+    glslang::TShader shader(*stage);
+    shader.setStringsWithLengthsAndNames(&sourceText, nullptr, &sourceNameText, 1);
+    shader.setEnvInput(glslang::EShSourceGlsl, *stage, glslang::EShClientVulkan, 100);
+    shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_3);
+    shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_6);
+
+    const auto messages = static_cast<EShMessages>(EShMsgSpvRules | EShMsgVulkanRules);
+    FileIncluder includer(sourcePath.parent_path());
+    if (!shader.parse(GetDefaultResources(), 450, false, messages, includer)) {
+        result.log = shader.getInfoLog();
+        return result;
+    }
+
+    glslang::TProgram program;
+    program.addShader(&shader);
+    if (!program.link(messages)) {
+        result.log = program.getInfoLog();
+        return result;
+    }
+
+    glslang::GlslangToSpv(*program.getIntermediate(*stage), result.spirv);
+    result.includedFiles = includer.GetIncludedFiles();
+    result.succeeded = !result.spirv.empty();
+    return result;
+}
+
+bool WriteSpirvFile(const std::filesystem::path& spvPath, const std::vector<uint32_t>& spirv)
+{
+    // Write to a temporary file first so a concurrent reader never sees a partial module
+    auto tempPath = spvPath;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(spirv.data()),
+                   static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t)));
+        if (!file.good()) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, spvPath, ec);
+    return !ec;
+}
+
+bool UpdateSpirvFile(const std::filesystem::path& sourcePath)
+{
+    auto spvPath = sourcePath;
+    spvPath += ".spv";
+
+    std::error_code ec;
+    const auto sourceTime = std::filesystem::last_write_time(sourcePath, ec);
+    if (ec) {
+        // No source next to the binary; use whatever .spv was shipped, loose or archived
+        return AssetExists(spvPath);
+    }
+    const auto spvTime = std::filesystem::last_write_time(spvPath, ec);
+    if (!ec && spvTime >= sourceTime) {
+        return true;
+    }
+
+    auto result = CompileGlslToSpirv(sourcePath);
+    if (!result.succeeded) {
+        std::cerr << "[shader] " << sourcePath.string() << ":\n" << result.log << std::endl;
+        return false;
+    }
+    return WriteSpirvFile(spvPath, result.spirv);
+}
+
+} // namespace loader
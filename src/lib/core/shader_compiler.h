@@ -0,0 +1,32 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace loader {
+
+    // Result of compiling one GLSL source file
+    struct ShaderCompileResult {
+        bool succeeded = false;
+        std::vector<uint32_t> spirv;
+        // Files pulled in through #include, used for dependency tracking
+        std::vector<std::filesystem::path> includedFiles;
+        std::string log;
+    };
+
+    // Returns true if the extension maps to a shader stage (.vert, .frag, .comp, ...)
+    bool IsGlslSourceFile(const std::filesystem::path& path);
+
+    // Compiles a GLSL file to SPIR-V with glslang. The stage is deduced from the extension.
+    // Thread-safe; glslang process initialization is handled internally.
+    ShaderCompileResult CompileGlslToSpirv(const std::filesystem::path& sourcePath);
+
+    // Writes SPIR-V to spvPath, replacing any existing file in one rename
+    bool WriteSpirvFile(const std::filesystem::path& spvPath, const std::vector<uint32_t>& spirv);
+
+    // Compiles sourcePath to "<sourcePath>.spv" when that file is missing or older than the
+    // source, so samples can ship GLSL only. #include dependencies are not checked.
+    bool UpdateSpirvFile(const std::filesystem::path& sourcePath);
+
+} // namespace loader
@@ -0,0 +1,403 @@
+#include "shader_hot_reloader.h"
+#include "core/asset_path.h"
+#include "core/shader_compiler.h"
+#include "core/vulkan_context.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#if defined(__linux__)
+#   include <poll.h>
+#   include <sys/inotify.h>
+#   include <unistd.h>
+#endif
+
+namespace {
+
+// Editors often save in several writes; wait this long for the burst to settle
+constexpr auto kDebounceTime = std::chrono::milliseconds(50);
+constexpr auto kPollInterval = std::chrono::milliseconds(100);
+
+bool ContainsPath(const std::vector<std::filesystem::path>& paths,
+                  const std::filesystem::path& path)
+{
+    return std::find(paths.begin(), paths.end(), path) != paths.end();
+}
+
+// Quick textual scan for #include "file" so include edits are tracked before the first
+// recompile. The compiler's own include list replaces this after every successful build.
+void ScanIncludes(const std::filesystem::path& source, std::vector<std::filesystem::path>& includes)
+{
+    std::ifstream file(source);
+    std::string line;
+    while (std::getline(file, line)) {
+        auto pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos || line.compare(pos, 8, "#include") != 0) {
+            continue;
+        }
+        auto open = line.find_first_of("\"<", pos + 8);
+        auto close = line.find_first_of("\">", open + 1);
+        if (open == std::string::npos || close == std::string::npos) {
+            continue;
+        }
+        auto included =
+            (source.parent_path() / line.substr(open + 1, close - open - 1)).lexically_normal();
+        if (!ContainsPath(includes, included)) {
+            includes.push_back(included);
+            ScanIncludes(included, includes);
+        }
+    }
+}
+
+} // namespace
+
+ShaderHotReloader::~ShaderHotReloader()
+{
+    Stop();
+}
+
+void ShaderHotReloader::Start()
+{
+    if (m_running) {
+        return;
+    }
+    m_shaderDir = GetAssetPath(AssetType::Shader, "").lexically_normal();
+
+#if defined(__linux__)
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0 || !WatchDirectory(m_shaderDir, true)) {
+        std::cerr << "[shader reload] failed to watch " << m_shaderDir << std::endl;
+        if (m_inotifyFd >= 0) {
+            close(m_inotifyFd);
+            m_inotifyFd = -1;
+        }
+        m_watchDirs.clear();
+        m_watchedDirs.clear();
+        return;
+    }
+#endif
+
+    m_running = true;
+    m_thread = std::thread(&ShaderHotReloader::WatchLoop, this);
+}
+
+void ShaderHotReloader::Stop()
+{
+    m_running = false;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+#if defined(__linux__)
+    if (m_inotifyFd >= 0) {
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+    m_watchDirs.clear();
+    m_watchedDirs.clear();
+#endif
+}
+
+void ShaderHotReloader::Cleanup()
+{
+    Stop();
+
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    {
+        std::lock_guard lock(m_readyMutex);
+        for (auto& ready : m_ready) {
+            vkDestroyPipeline(device, ready.pipeline, allocator);
+        }
+        m_ready.clear();
+    }
+
+    std::lock_guard lock(m_entryMutex);
+    for (auto& entry : m_entries) {
+        if (entry->pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, entry->pipeline, allocator);
+        }
+    }
+    m_entries.clear();
+}
+
+ShaderHotReloader::PipelineHandle
+ShaderHotReloader::RegisterPipeline(const std::vector<std::filesystem::path>& shaderSources,
+                                    PipelineBuildFunc buildFunc)
+{
+    auto entry = std::make_unique<PipelineEntry>();
+    for (auto& source : shaderSources) {
+        entry->sources.push_back(GetAssetPath(AssetType::Shader, source).lexically_normal());
+    }
+    entry->buildFunc = std::move(buildFunc);
+    entry->pipeline = entry->buildFunc();
+
+    std::lock_guard lock(m_entryMutex);
+    for (auto& source : entry->sources) {
+        auto& includes = m_includesBySource[source];
+        includes.clear();
+        ScanIncludes(source, includes);
+    }
+    m_entries.push_back(std::move(entry));
+    return static_cast<PipelineHandle>(m_entries.size() - 1);
+}
+
+VkPipeline ShaderHotReloader::GetPipeline(PipelineHandle handle) const
+{
+    std::lock_guard lock(m_entryMutex);
+    return handle < m_entries.size() ? m_entries[handle]->pipeline : VK_NULL_HANDLE;
+}
+
+bool ShaderHotReloader::Update()
+{
+    std::vector<ReadyPipeline> ready;
+    {
+        std::lock_guard lock(m_readyMutex);
+        if (m_ready.empty()) {
+            return false;
+        }
+        ready.swap(m_ready);
+    }
+
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+
+    std::lock_guard lock(m_entryMutex);
+    for (auto& [handle, pipeline] : ready) {
+        VkPipeline oldPipeline = m_entries[handle]->pipeline;
+        m_entries[handle]->pipeline = pipeline;
+        if (oldPipeline != VK_NULL_HANDLE) {
+            vulkanCtx.DeferDestroy([device, allocator, oldPipeline] {
+                vkDestroyPipeline(device, oldPipeline, allocator);
+            });
+        }
+    }
+    return true;
+}
+
+void ShaderHotReloader::WatchLoop()
+{
+    while (m_running) {
+        auto changedFiles = WaitForChanges();
+        if (!changedFiles.empty()) {
+            ProcessChanges(changedFiles);
+        }
+    }
+}
+
+#if defined(__linux__)
+bool ShaderHotReloader::WatchDirectory(const std::filesystem::path& dir, bool recursive)
+{
+    // inotify watches one directory, not its subtree; new subdirectories are added as their
+    // IN_CREATE events arrive
+    if (!m_watchedDirs.count(dir)) {
+        int wd = inotify_add_watch(m_inotifyFd, dir.c_str(),
+                                   IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (wd < 0) {
+            return false;
+        }
+        m_watchDirs[wd] = dir;
+        m_watchedDirs.insert(dir);
+    }
+    if (recursive) {
+        std::error_code ec;
+        for (auto& child : std::filesystem::directory_iterator(dir, ec)) {
+            if (child.is_directory(ec)) {
+                WatchDirectory(child.path().lexically_normal(), true);
+            }
+        }
+    }
+    return true;
+}
+
+void ShaderHotReloader::WatchIncludeDirectories()
+{
+    // Includes may live outside the shader directory (e.g. "../common/lighting.glsl")
+    std::set<std::filesystem::path> dirs;
+    {
+        std::lock_guard lock(m_entryMutex);
+        for (auto& [source, includes] : m_includesBySource) {
+            for (auto& include : includes) {
+                dirs.insert(include.parent_path());
+            }
+        }
+    }
+    for (auto& dir : dirs) {
+        if (!m_watchedDirs.count(dir) && !WatchDirectory(dir, false)) {
+            // Remember the failure too, so a missing directory is not retried every poll
+            m_watchedDirs.insert(dir);
+            std::cerr << "[shader reload] failed to watch " << dir << std::endl;
+        }
+    }
+}
+
+std::vector<std::filesystem::path> ShaderHotReloader::WaitForChanges()
+{
+    std::set<std::filesystem::path> changed;
+    auto timeout = kPollInterval;
+
+    while (m_running) {
+        WatchIncludeDirectories();
+        pollfd pfd{.fd = m_inotifyFd, .events = POLLIN, .revents = 0};
+        int ready = poll(&pfd, 1, static_cast<int>(timeout.count()));
+        if (ready <= 0) {
+            // Timed out: hand over whatever the burst produced
+            if (!changed.empty()) {
+                break;
+            }
+            continue;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length = 0;
+        while ((length = read(m_inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length;) {
+                auto* event = reinterpret_cast<inotify_event*>(p);
+                p += sizeof(inotify_event) + event->len;
+                auto dir = m_watchDirs.find(event->wd);
+                if (dir == m_watchDirs.end()) {
+                    continue;
+                }
+                if (event->mask & IN_IGNORED) {
+                    // Directory removed; a new one at the same path is watched again
+                    m_watchedDirs.erase(dir->second);
+                    m_watchDirs.erase(dir);
+                    continue;
+                }
+                if (event->len == 0) {
+                    continue;
+                }
+                auto path = (dir->second / event->name).lexically_normal();
+                if (event->mask & IN_ISDIR) {
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                        WatchDirectory(path, true);
+                    }
+                }
+                else if (!(event->mask & IN_CREATE)) {
+                    changed.insert(path);
+                }
+            }
+        }
+        timeout = kDebounceTime;
+    }
+
+    return {changed.begin(), changed.end()};
+}
+#else
+std::vector<std::filesystem::path> ShaderHotReloader::WaitForChanges()
+{
+    // Portable fallback: compare modification times of the watched files
+    std::this_thread::sleep_for(kPollInterval);
+
+    std::vector<std::filesystem::path> watched;
+    {
+        std::lock_guard lock(m_entryMutex);
+        for (auto& [source, includes] : m_includesBySource) {
+            watched.push_back(source);
+            watched.insert(watched.end(), includes.begin(), includes.end());
+        }
+    }
+
+    std::vector<std::filesystem::path> changed;
+    for (auto& path : watched) {
+        std::error_code ec;
+        auto writeTime = std::filesystem::last_write_time(path, ec);
+        if (ec) {
+            continue;
+        }
+        auto [it, inserted] = m_lastWriteTimes.try_emplace(path.string(), writeTime);
+        if (!inserted && it->second != writeTime) {
+            it->second = writeTime;
+            if (!ContainsPath(changed, path)) {
+                changed.push_back(path);
+            }
+        }
+    }
+    if (!changed.empty()) {
+        std::this_thread::sleep_for(kDebounceTime);
+    }
+    return changed;
+}
+#endif
+
+void ShaderHotReloader::ProcessChanges(const std::vector<std::filesystem::path>& changedFiles)
+{
+    // Find the pipelines touched by the change, directly or through an #include,
+    // and the GLSL sources that have to be recompiled for them
+    std::vector<PipelineHandle> dirtyEntries;
+    std::set<std::filesystem::path> sourcesToCompile;
+    {
+        std::lock_guard lock(m_entryMutex);
+        for (PipelineHandle handle = 0; handle < m_entries.size(); ++handle) {
+            auto& entry = *m_entries[handle];
+            bool dirty = false;
+            for (auto& source : entry.sources) {
+                auto& includes = m_includesBySource[source];
+                for (auto& changedFile : changedFiles) {
+                    if (source == changedFile || ContainsPath(includes, changedFile)) {
+                        sourcesToCompile.insert(source);
+                        dirty = true;
+                    }
+                }
+            }
+            if (dirty) {
+                dirtyEntries.push_back(handle);
+            }
+        }
+    }
+
+    std::set<std::filesystem::path> failedSources;
+    for (auto& source : sourcesToCompile) {
+        auto result = loader::CompileGlslToSpirv(source);
+        if (!result.succeeded) {
+            std::cerr << "[shader reload] " << source.filename().string() << " failed:\n"
+                      << result.log << std::endl;
+            failedSources.insert(source);
+            continue;
+        }
+
+        auto spvPath = source;
+        spvPath += ".spv";
+        if (!loader::WriteSpirvFile(spvPath, result.spirv)) {
+            std::cerr << "[shader reload] failed to write " << spvPath << std::endl;
+            failedSources.insert(source);
+            continue;
+        }
+
+        std::lock_guard lock(m_entryMutex);
+        m_includesBySource[source] = std::move(result.includedFiles);
+    }
+
+    for (PipelineHandle handle : dirtyEntries) {
+        PipelineBuildFunc buildFunc;
+        {
+            std::lock_guard lock(m_entryMutex);
+            auto& entry = *m_entries[handle];
+            bool anyFailed = std::any_of(entry.sources.begin(), entry.sources.end(),
+                                         [&](auto& source) { return failedSources.count(source); });
+            if (anyFailed) {
+                // Keep the last good pipeline running
+                continue;
+            }
+            buildFunc = entry.buildFunc;
+        }
+
+        // Shader module and pipeline creation are free-threaded, so build right here
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        try {
+            pipeline = buildFunc();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "[shader reload] pipeline rebuild failed: " << e.what() << std::endl;
+        }
+        if (pipeline == VK_NULL_HANDLE) {
+            continue;
+        }
+
+        std::lock_guard lock(m_readyMutex);
+        m_ready.push_back({handle, pipeline});
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Watches the shader asset directory, recompiles edited GLSL on a background thread and
+// rebuilds the pipelines that depend on it. Rebuilt pipelines are swapped in by Update(),
+// which the app calls at a frame boundary; the render loop never waits on a compile.
+class ShaderHotReloader {
+public:
+    using PipelineHandle = uint32_t;
+    // Builds a pipeline from the current .spv files. Runs on the reload thread after a change.
+    using PipelineBuildFunc = std::function<VkPipeline()>;
+
+    ShaderHotReloader() = default;
+    ~ShaderHotReloader();
+
+    ShaderHotReloader(const ShaderHotReloader&) = delete;
+    ShaderHotReloader& operator=(const ShaderHotReloader&) = delete;
+
+    // Starts watching GetAssetPath(AssetType::Shader, "") with its subdirectories, plus the
+    // directories of included files that live elsewhere
+    void Start();
+    // Stops the watcher thread (waits for a running compile to finish)
+    void Stop();
+    // Stops watching and destroys every pipeline owned by the reloader
+    void Cleanup();
+
+    // Builds the pipeline once and registers it for reloading.
+    // shaderSources are GLSL file names in the shader directory (e.g. "triangle.vert").
+    PipelineHandle RegisterPipeline(const std::vector<std::filesystem::path>& shaderSources,
+                                    PipelineBuildFunc buildFunc);
+
+    // Current pipeline for a handle; may change after Update()
+    VkPipeline GetPipeline(PipelineHandle handle) const;
+
+    // Swaps in pipelines finished since the last call and retires the replaced ones once
+    // the frames using them are complete. Call after VulkanContext::AcquireNextImage().
+    // Returns true if any pipeline changed.
+    bool Update();
+
+private:
+    struct PipelineEntry {
+        std::vector<std::filesystem::path> sources;
+        PipelineBuildFunc buildFunc;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+    };
+    struct ReadyPipeline {
+        PipelineHandle handle;
+        VkPipeline pipeline;
+    };
+
+    void WatchLoop();
+    std::vector<std::filesystem::path> WaitForChanges();
+    void ProcessChanges(const std::vector<std::filesystem::path>& changedFiles);
+#if defined(__linux__)
+    bool WatchDirectory(const std::filesystem::path& dir, bool recursive);
+    void WatchIncludeDirectories();
+#endif
+
+    std::filesystem::path m_shaderDir;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+#if defined(__linux__)
+    int m_inotifyFd = -1;
+    // Watched directory of each inotify watch descriptor
+    std::unordered_map<int, std::filesystem::path> m_watchDirs;
+    std::set<std::filesystem::path> m_watchedDirs;
+#else
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_lastWriteTimes;
+#endif
+
+    // Guards m_entries and m_includesBySource
+    mutable std::mutex m_entryMutex;
+    std::vector<std::unique_ptr<PipelineEntry>> m_entries;
+    // Files each GLSL source pulls in through #include
+    std::map<std::filesystem::path, std::vector<std::filesystem::path>> m_includesBySource;
+
+    std::mutex m_readyMutex;
+    std::vector<ReadyPipeline> m_ready;
+};
@@ -1,33 +1,48 @@
 #include "shader_loader.h"
+#include "core/asset_archive.h"
 #include "core/vulkan_context.h"
-#include <fstream>
+#include "core/shader_reflection.h"
+#include <stdexcept>
 
 namespace loader {
 
-VkShaderModule LoadShaderModule(const std::filesystem::path& shaderSpvPath)
+VkShaderModule LoadShaderModule(const std::filesystem::path& shaderSpvPath,
+                                ShaderReflection* reflection)
 {
-    std::ifstream file(shaderSpvPath, std::ios::ate | std::ios::binary);
-    if (!file.is_open()) {
+    // A view into the mapped loose file or archive; the packer stores SPIR-V uncompressed
+    AssetData spirv;
+    if (!LoadAsset(shaderSpvPath, spirv)) {
         throw std::runtime_error("failed to open shader file: " + shaderSpvPath.string());
     }
+    const auto* code = reinterpret_cast<const uint32_t*>(spirv.GetData());
 
-    size_t fileSize = static_cast<size_t>(file.tellg());
-    std::vector<char> buffer(fileSize);
-    file.seekg(0).read(buffer.data(), fileSize);
-    file.close();
+    if (reflection != nullptr &&
+        !ReflectSpirv(code, spirv.GetSize() / sizeof(uint32_t), *reflection)) {
+        throw std::runtime_error("failed to reflect shader: " + shaderSpvPath.string());
+    }
+
+    VkShaderModule shaderModule = CreateShaderModule(code, spirv.GetSize());
+    if (shaderModule == VK_NULL_HANDLE) {
+        throw std::runtime_error("failed to create shader module from file: " +
+                                 shaderSpvPath.string());
+    }
+
+    return shaderModule;
+}
 
+VkShaderModule CreateShaderModule(const uint32_t* code, size_t codeSize)
+{
     VkShaderModuleCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = buffer.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(buffer.data());
+    createInfo.codeSize = codeSize;
+    createInfo.pCode = code;
 
-    VkDevice device = VulkanContext::Get().GetVkDevice();
+    auto& vulkanCtx = VulkanContext::Get();
     VkShaderModule shaderModule{};
-    auto result = vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule);
-
+    auto result = vkCreateShaderModule(vulkanCtx.GetVkDevice(), &createInfo,
+                                       vulkanCtx.GetAllocationCallbacks(), &shaderModule);
     if (result != VK_SUCCESS) {
-        throw std::runtime_error("failed to create shader module from file: " +
-                                 shaderSpvPath.string());
+        return VK_NULL_HANDLE;
     }
 
     return shaderModule;
@@ -2,8 +2,15 @@
 #include <vulkan/vulkan.h>
 #include <filesystem>
 
+struct ShaderReflection;
+
 namespace loader {
 
-    VkShaderModule LoadShaderModule(const std::filesystem::path& shaderSpvPath);
+    // When reflection is non-null it is filled from the same SPIR-V that created the module
+    VkShaderModule LoadShaderModule(const std::filesystem::path& shaderSpvPath,
+                                    ShaderReflection* reflection = nullptr);
+
+    // Creates a shader module from SPIR-V words already in memory
+    VkShaderModule CreateShaderModule(const uint32_t* code, size_t codeSize);
 
 } // namespace loader
@@ -0,0 +1,497 @@
+#include "shader_reflection.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t kSpirvMagic = 0x07230203;
+constexpr uint32_t kHeaderWordCount = 5;
+// Deepest type nesting followed when validating; a malformed module may reference itself
+constexpr uint32_t kMaxTypeDepth = 32;
+
+// Subset of the SPIR-V opcodes/enums needed for interface reflection
+enum SpvOp : uint32_t {
+    OpEntryPoint = 15,
+    OpTypeBool = 20,
+    OpTypeInt = 21,
+    OpTypeFloat = 22,
+    OpTypeVector = 23,
+    OpTypeMatrix = 24,
+    OpTypeImage = 25,
+    OpTypeSampler = 26,
+    OpTypeSampledImage = 27,
+    OpTypeArray = 28,
+    OpTypeRuntimeArray = 29,
+    OpTypeStruct = 30,
+    OpTypePointer = 32,
+    OpConstant = 43,
+    OpVariable = 59,
+    OpDecorate = 71,
+    OpMemberDecorate = 72,
+    OpTypeAccelerationStructureKHR = 5341,
+};
+
+enum SpvDecoration : uint32_t {
+    DecorationBlock = 2,
+    DecorationBufferBlock = 3,
+    DecorationArrayStride = 6,
+    DecorationMatrixStride = 7,
+    DecorationBuiltIn = 11,
+    DecorationLocation = 30,
+    DecorationBinding = 33,
+    DecorationDescriptorSet = 34,
+    DecorationOffset = 35,
+};
+
+enum SpvStorageClass : uint32_t {
+    StorageClassUniformConstant = 0,
+    StorageClassInput = 1,
+    StorageClassUniform = 2,
+    StorageClassPushConstant = 9,
+    StorageClassStorageBuffer = 12,
+};
+
+enum SpvDim : uint32_t {
+    DimBuffer = 5,
+    DimSubpassData = 6,
+};
+
+struct SpvId {
+    uint32_t opcode = 0;
+    // Type operands (meaning depends on opcode)
+    std::vector<uint32_t> operands;
+    uint32_t storageClass = 0;
+    uint32_t typeId = 0;
+    uint32_t constantValue = 0;
+
+    bool hasLocation = false;
+    bool hasBinding = false;
+    bool hasSet = false;
+    bool isBuiltIn = false;
+    bool isBlock = false;
+    bool isBufferBlock = false;
+    uint32_t location = 0;
+    uint32_t binding = 0;
+    uint32_t set = 0;
+    uint32_t arrayStride = 0;
+
+    std::vector<uint32_t> memberOffsets;
+    std::vector<uint32_t> memberMatrixStrides;
+    bool hasBuiltInMember = false;
+};
+
+VkShaderStageFlagBits ToShaderStage(uint32_t executionModel)
+{
+    switch (executionModel) {
+    case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+    case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+    case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+    case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+    case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+    case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+    default: return VK_SHADER_STAGE_ALL;
+    }
+}
+
+class SpirvModule {
+public:
+    explicit SpirvModule(uint32_t idBound)
+        : m_ids(idBound)
+    {
+    }
+
+    SpvId& operator[](uint32_t id) { return m_ids[id]; }
+    const SpvId& operator[](uint32_t id) const { return m_ids[id]; }
+    bool IsValid(uint32_t id) const { return id < m_ids.size(); }
+
+    // True if typeId is declared and every type it refers to (components, members, array
+    // lengths) is declared with the operands the getters below index. Opcodes the getters do
+    // not look into are accepted as they are.
+    bool IsValidType(uint32_t typeId, uint32_t depth = 0) const
+    {
+        if (!IsValid(typeId) || depth > kMaxTypeDepth) {
+            return false;
+        }
+        const auto& type = m_ids[typeId];
+        const auto& operands = type.operands;
+        switch (type.opcode) {
+        case 0:
+            return false;
+        case OpTypeInt:
+            return operands.size() >= 2;
+        case OpTypeFloat:
+            return operands.size() >= 1;
+        case OpTypeVector:
+        case OpTypeMatrix:
+            return operands.size() >= 2 && operands[1] >= 1 && operands[1] <= 4 &&
+                   IsValidType(operands[0], depth + 1);
+        case OpTypeImage:
+            // sampledType, dim, depth, arrayed, ms, sampled, format
+            return operands.size() >= 7;
+        case OpTypeSampledImage:
+        case OpTypeRuntimeArray:
+            return operands.size() >= 1 && IsValidType(operands[0], depth + 1);
+        case OpTypeArray:
+            return operands.size() >= 2 && IsValid(operands[1]) &&
+                   m_ids[operands[1]].opcode == OpConstant &&
+                   IsValidType(operands[0], depth + 1);
+        case OpTypeStruct:
+            return std::all_of(operands.begin(), operands.end(), [&](uint32_t member) {
+                return IsValidType(member, depth + 1);
+            });
+        default:
+            return true;
+        }
+    }
+
+    // Size in bytes of a type as laid out in a buffer block
+    uint32_t GetTypeSize(uint32_t typeId, uint32_t matrixStride = 0) const
+    {
+        const auto& type = m_ids[typeId];
+        switch (type.opcode) {
+        case OpTypeBool:
+            return 4;
+        case OpTypeInt:
+        case OpTypeFloat:
+            return type.operands[0] / 8;
+        case OpTypeVector:
+            return GetTypeSize(type.operands[0]) * type.operands[1];
+        case OpTypeMatrix:
+            if (matrixStride != 0) {
+                return matrixStride * type.operands[1];
+            }
+            return GetTypeSize(type.operands[0]) * type.operands[1];
+        case OpTypeArray: {
+            uint32_t length = m_ids[type.operands[1]].constantValue;
+            uint32_t stride = type.arrayStride != 0 ? type.arrayStride
+                                                    : GetTypeSize(type.operands[0], matrixStride);
+            return stride * length;
+        }
+        case OpTypeStruct: {
+            uint32_t size = 0;
+            for (size_t i = 0; i < type.operands.size(); ++i) {
+                uint32_t offset = i < type.memberOffsets.size() ? type.memberOffsets[i] : 0;
+                uint32_t memberStride =
+                    i < type.memberMatrixStrides.size() ? type.memberMatrixStrides[i] : 0;
+                size = std::max(size, offset + GetTypeSize(type.operands[i], memberStride));
+            }
+            return size;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    VkFormat GetVertexFormat(uint32_t typeId) const
+    {
+        const auto& type = m_ids[typeId];
+        uint32_t componentCount = 1;
+        const SpvId* scalar = &type;
+        if (type.opcode == OpTypeVector) {
+            componentCount = type.operands[1];
+            scalar = &m_ids[type.operands[0]];
+        }
+
+        if (componentCount < 1 || componentCount > 4) {
+            return VK_FORMAT_UNDEFINED;
+        }
+        const uint32_t width = scalar->operands.empty() ? 0 : scalar->operands[0];
+        if (scalar->opcode == OpTypeFloat && width == 32) {
+            constexpr VkFormat formats[] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT,
+                                            VK_FORMAT_R32G32B32_SFLOAT,
+                                            VK_FORMAT_R32G32B32A32_SFLOAT};
+            return formats[componentCount - 1];
+        }
+        if (scalar->opcode == OpTypeFloat && width == 64) {
+            constexpr VkFormat formats[] = {VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT,
+                                            VK_FORMAT_R64G64B64_SFLOAT,
+                                            VK_FORMAT_R64G64B64A64_SFLOAT};
+            return formats[componentCount - 1];
+        }
+        if (scalar->opcode == OpTypeInt && width == 32) {
+            const bool isSigned = scalar->operands[1] != 0;
+            constexpr VkFormat sintFormats[] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT,
+                                                VK_FORMAT_R32G32B32_SINT,
+                                                VK_FORMAT_R32G32B32A32_SINT};
+            constexpr VkFormat uintFormats[] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT,
+                                                VK_FORMAT_R32G32B32_UINT,
+                                                VK_FORMAT_R32G32B32A32_UINT};
+            return isSigned ? sintFormats[componentCount - 1] : uintFormats[componentCount - 1];
+        }
+        return VK_FORMAT_UNDEFINED;
+    }
+
+    VkDescriptorType GetDescriptorType(uint32_t storageClass, uint32_t typeId) const
+    {
+        const auto& type = m_ids[typeId];
+        switch (storageClass) {
+        case StorageClassStorageBuffer:
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        case StorageClassUniform:
+            return type.isBufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                                      : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        case StorageClassUniformConstant:
+            switch (type.opcode) {
+            case OpTypeSampler:
+                return VK_DESCRIPTOR_TYPE_SAMPLER;
+            case OpTypeSampledImage:
+                return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            case OpTypeAccelerationStructureKHR:
+                return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+            case OpTypeImage: {
+                // operands: sampledType, dim, depth, arrayed, ms, sampled, format
+                const uint32_t dim = type.operands[1];
+                const uint32_t sampled = type.operands[5];
+                if (dim == DimSubpassData) {
+                    return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                }
+                if (dim == DimBuffer) {
+                    return sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER
+                                        : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                }
+                return sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+                                    : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            }
+            default:
+                return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+            }
+        default:
+            return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+        }
+    }
+
+private:
+    std::vector<SpvId> m_ids;
+};
+
+} // namespace
+
+namespace loader {
+
+bool ReflectSpirv(const uint32_t* code, size_t wordCount, ShaderReflection& reflection)
+{
+    reflection = ShaderReflection{};
+    if (code == nullptr || wordCount < kHeaderWordCount || code[0] != kSpirvMagic) {
+        return false;
+    }
+
+    SpirvModule module(code[3]);
+    std::vector<uint32_t> variables;
+
+    for (size_t pos = kHeaderWordCount; pos < wordCount;) {
+        const uint32_t opcode = code[pos] & 0xFFFF;
+        const uint32_t length = code[pos] >> 16;
+        if (length == 0 || pos + length > wordCount) {
+            return false;
+        }
+        const uint32_t* args = code + pos + 1;
+        const uint32_t argCount = length - 1;
+
+        switch (opcode) {
+        case OpEntryPoint:
+            if (argCount < 1) {
+                return false;
+            }
+            reflection.stage = ToShaderStage(args[0]);
+            break;
+        case OpDecorate: {
+            if (argCount < 2 || !module.IsValid(args[0])) {
+                return false;
+            }
+            auto& target = module[args[0]];
+            const uint32_t literal = argCount > 2 ? args[2] : 0;
+            switch (args[1]) {
+            case DecorationBlock: target.isBlock = true; break;
+            case DecorationBufferBlock: target.isBufferBlock = true; break;
+            case DecorationArrayStride: target.arrayStride = literal; break;
+            case DecorationBuiltIn: target.isBuiltIn = true; break;
+            case DecorationLocation: target.hasLocation = true; target.location = literal; break;
+            case DecorationBinding: target.hasBinding = true; target.binding = literal; break;
+            case DecorationDescriptorSet: target.hasSet = true; target.set = literal; break;
+            default: break;
+            }
+            break;
+        }
+        case OpMemberDecorate: {
+            // A struct needs a word per member, so larger indices cannot be real
+            if (!module.IsValid(args[0]) || argCount < 3 || args[1] >= wordCount) {
+                return false;
+            }
+            auto& target = module[args[0]];
+            const uint32_t member = args[1];
+            const uint32_t literal = argCount > 3 ? args[3] : 0;
+            if (args[2] == DecorationOffset) {
+                if (target.memberOffsets.size() <= member) {
+                    target.memberOffsets.resize(member + 1);
+                }
+                target.memberOffsets[member] = literal;
+            }
+            else if (args[2] == DecorationMatrixStride) {
+                if (target.memberMatrixStrides.size() <= member) {
+                    target.memberMatrixStrides.resize(member + 1);
+                }
+                target.memberMatrixStrides[member] = literal;
+            }
+            else if (args[2] == DecorationBuiltIn) {
+                target.hasBuiltInMember = true;
+            }
+            break;
+        }
+        case OpTypeBool:
+        case OpTypeInt:
+        case OpTypeFloat:
+        case OpTypeVector:
+        case OpTypeMatrix:
+        case OpTypeImage:
+        case OpTypeSampler:
+        case OpTypeSampledImage:
+        case OpTypeArray:
+        case OpTypeRuntimeArray:
+        case OpTypeStruct:
+        case OpTypeAccelerationStructureKHR: {
+            if (argCount < 1 || !module.IsValid(args[0])) {
+                return false;
+            }
+            auto& type = module[args[0]];
+            type.opcode = opcode;
+            type.operands.assign(args + 1, args + argCount);
+            break;
+        }
+        case OpTypePointer: {
+            if (!module.IsValid(args[0]) || argCount < 3) {
+                return false;
+            }
+            auto& type = module[args[0]];
+            type.opcode = opcode;
+            type.storageClass = args[1];
+            type.typeId = args[2];
+            break;
+        }
+        case OpConstant: {
+            if (!module.IsValid(args[1]) || argCount < 3) {
+                return false;
+            }
+            auto& constant = module[args[1]];
+            constant.opcode = opcode;
+            constant.constantValue = args[2];
+            break;
+        }
+        case OpVariable: {
+            if (!module.IsValid(args[1]) || argCount < 3) {
+                return false;
+            }
+            auto& variable = module[args[1]];
+            variable.opcode = opcode;
+            variable.typeId = args[0];
+            variable.storageClass = args[2];
+            variables.push_back(args[1]);
+            break;
+        }
+        default:
+            break;
+        }
+        pos += length;
+    }
+
+    for (uint32_t id : variables) {
+        const auto& variable = module[id];
+        if (!module.IsValid(variable.typeId) || module[variable.typeId].opcode != OpTypePointer) {
+            return false;
+        }
+        const auto& pointer = module[variable.typeId];
+        uint32_t typeId = pointer.typeId;
+        if (!module.IsValidType(typeId)) {
+            return false;
+        }
+
+        switch (variable.storageClass) {
+        case StorageClassInput: {
+            if (reflection.stage != VK_SHADER_STAGE_VERTEX_BIT || variable.isBuiltIn ||
+                module[typeId].hasBuiltInMember || !variable.hasLocation) {
+                break;
+            }
+            // Matrices take one location per column
+            uint32_t columns = 1;
+            if (module[typeId].opcode == OpTypeMatrix) {
+                columns = module[typeId].operands[1];
+                typeId = module[typeId].operands[0];
+            }
+            for (uint32_t column = 0; column < columns; ++column) {
+                reflection.vertexInputs.push_back({
+                    .location = variable.location + column,
+                    .format = module.GetVertexFormat(typeId),
+                    .size = module.GetTypeSize(typeId),
+                });
+            }
+            break;
+        }
+        case StorageClassPushConstant:
+            reflection.pushConstantRange = VkPushConstantRange{
+                .stageFlags = static_cast<VkShaderStageFlags>(reflection.stage),
+                .offset = 0,
+                .size = module.GetTypeSize(typeId),
+            };
+            break;
+        case StorageClassUniformConstant:
+        case StorageClassUniform:
+        case StorageClassStorageBuffer: {
+            uint32_t count = 1;
+            while (module[typeId].opcode == OpTypeArray ||
+                   module[typeId].opcode == OpTypeRuntimeArray) {
+                if (module[typeId].opcode == OpTypeArray) {
+                    count *= module[module[typeId].operands[1]].constantValue;
+                }
+                else {
+                    count = 0;
+                }
+                typeId = module[typeId].operands[0];
+            }
+            auto type = module.GetDescriptorType(variable.storageClass, typeId);
+            if (type == VK_DESCRIPTOR_TYPE_MAX_ENUM) {
+                break;
+            }
+            reflection.descriptorBindings.push_back({
+                .set = variable.set,
+                .binding = variable.binding,
+                .type = type,
+                .count = count,
+            });
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(),
+              [](auto& a, auto& b) { return a.location < b.location; });
+    std::sort(reflection.descriptorBindings.begin(), reflection.descriptorBindings.end(),
+              [](auto& a, auto& b) {
+                  return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+              });
+    return true;
+}
+
+void BuildVertexInputState(const ShaderReflection& vertexShader, uint32_t binding,
+                           VkVertexInputBindingDescription& bindingDescription,
+                           std::vector<VkVertexInputAttributeDescription>& attributes)
+{
+    attributes.clear();
+    uint32_t offset = 0;
+    for (auto& input : vertexShader.vertexInputs) {
+        attributes.push_back({
+            .location = input.location,
+            .binding = binding,
+            .format = input.format,
+            .offset = offset,
+        });
+        offset += input.size;
+    }
+    bindingDescription = VkVertexInputBindingDescription{
+        .binding = binding,
+        .stride = offset,
+        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+    };
+}
+
+} // namespace loader
@@ -0,0 +1,41 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+// Interface of a single shader stage, extracted from its SPIR-V
+struct ShaderReflection {
+    struct DescriptorBinding {
+        uint32_t set = 0;
+        uint32_t binding = 0;
+        VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+        // 0 for runtime-sized arrays; the caller decides the real size
+        uint32_t count = 1;
+    };
+
+    struct VertexInput {
+        uint32_t location = 0;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t size = 0;
+    };
+
+    VkShaderStageFlagBits stage = VK_SHADER_STAGE_VERTEX_BIT;
+    std::vector<DescriptorBinding> descriptorBindings;
+    // Sorted by location; only meaningful for the vertex stage
+    std::vector<VertexInput> vertexInputs;
+    // size == 0 when the stage declares no push constant block
+    VkPushConstantRange pushConstantRange{};
+};
+
+namespace loader {
+
+    // Parses the SPIR-V module and fills the reflection data. Returns false on malformed input.
+    bool ReflectSpirv(const uint32_t* code, size_t wordCount, ShaderReflection& reflection);
+
+    // Builds one interleaved vertex buffer binding from the vertex shader's inputs,
+    // packing attributes tightly in location order
+    void BuildVertexInputState(const ShaderReflection& vertexShader, uint32_t binding,
+                               VkVertexInputBindingDescription& bindingDescription,
+                               std::vector<VkVertexInputAttributeDescription>& attributes);
+
+} // namespace loader
@@ -0,0 +1,107 @@
+#include "startup_profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// Static initialization runs before main, which is as close to process start as portable
+// code gets
+const auto g_processStart = std::chrono::steady_clock::now();
+
+} // namespace
+
+StartupProfiler& StartupProfiler::Get()
+{
+    static StartupProfiler instance;
+    return instance;
+}
+
+double StartupProfiler::GetElapsedMs() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                     g_processStart)
+        .count();
+}
+
+void StartupProfiler::AddPhase(const std::string& name, double startMs, double endMs)
+{
+    std::lock_guard lock(m_mutex);
+    m_phases.push_back({name, GetThreadNumber(), startMs, endMs - startMs});
+}
+
+void StartupProfiler::AddEvent(const std::string& name)
+{
+    const double now = GetElapsedMs();
+    AddPhase(name, now, now);
+}
+
+void StartupProfiler::MarkFirstFrame()
+{
+    const double now = GetElapsedMs();
+    std::lock_guard lock(m_mutex);
+    if (m_firstFrameMs < 0.0) {
+        m_firstFrameMs = now;
+    }
+}
+
+double StartupProfiler::GetTimeToFirstFrameMs() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_firstFrameMs;
+}
+
+std::vector<StartupProfiler::Phase> StartupProfiler::GetPhases() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_phases;
+}
+
+void StartupProfiler::Report() const
+{
+    std::vector<Phase> phases;
+    double firstFrameMs;
+    {
+        std::lock_guard lock(m_mutex);
+        phases = m_phases;
+        firstFrameMs = m_firstFrameMs;
+    }
+    std::stable_sort(phases.begin(), phases.end(),
+                     [](const Phase& a, const Phase& b) { return a.startMs < b.startMs; });
+    std::printf("startup (ms since process start)\n");
+    std::printf("  %-40s %6s %9s %9s\n", "phase", "thread", "start", "time");
+    for (const auto& phase : phases) {
+        if (phase.durationMs > 0.0) {
+            std::printf("  %-40s %6u %9.2f %9.2f\n", phase.name.c_str(), phase.thread,
+                        phase.startMs, phase.durationMs);
+        }
+        else {
+            std::printf("  %-40s %6u %9.2f %9s\n", phase.name.c_str(), phase.thread,
+                        phase.startMs, "-");
+        }
+    }
+    if (firstFrameMs >= 0.0) {
+        std::printf("  time to first frame: %.2f ms\n", firstFrameMs);
+    }
+}
+
+uint32_t StartupProfiler::GetThreadNumber()
+{
+    const auto id = std::this_thread::get_id();
+    auto it = std::find(m_threads.begin(), m_threads.end(), id);
+    if (it == m_threads.end()) {
+        m_threads.push_back(id);
+        return static_cast<uint32_t>(m_threads.size() - 1);
+    }
+    return static_cast<uint32_t>(it - m_threads.begin());
+}
+
+ScopedStartupPhase::ScopedStartupPhase(std::string name)
+    : m_name(std::move(name)), m_startMs(StartupProfiler::Get().GetElapsedMs())
+{
+}
+
+ScopedStartupPhase::~ScopedStartupPhase()
+{
+    auto& profiler = StartupProfiler::Get();
+    profiler.AddPhase(m_name, m_startMs, profiler.GetElapsedMs());
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records how long each startup phase takes and on which thread, measured from process start,
+// plus the time to the first presented frame. Thread-safe, so phases running in parallel on a
+// JobSystem are recorded as they overlap:
+//   { ScopedStartupPhase phase("vulkan: logical device"); CreateLogicalDevice(); }
+//   ...
+//   StartupProfiler::Get().MarkFirstFrame();
+//   StartupProfiler::Get().Report();
+class StartupProfiler {
+public:
+    struct Phase {
+        std::string name;
+        // Order in which threads first recorded a phase; 0 is usually the main thread
+        uint32_t thread = 0;
+        double startMs = 0.0;
+        // 0 for instant events
+        double durationMs = 0.0;
+    };
+
+    static StartupProfiler& Get();
+
+    // Milliseconds since process start
+    double GetElapsedMs() const;
+
+    void AddPhase(const std::string& name, double startMs, double endMs);
+    // An instant, e.g. "content ready"
+    void AddEvent(const std::string& name);
+
+    // First call wins
+    void MarkFirstFrame();
+    // Negative until MarkFirstFrame
+    double GetTimeToFirstFrameMs() const;
+
+    std::vector<Phase> GetPhases() const;
+    // Phases in start order, then the time to first frame, on stdout
+    void Report() const;
+
+private:
+    StartupProfiler() = default;
+
+    uint32_t GetThreadNumber();
+
+    mutable std::mutex m_mutex;
+    std::vector<Phase> m_phases;
+    std::vector<std::thread::id> m_threads;
+    double m_firstFrameMs = -1.0;
+};
+
+// Records the phase from construction to destruction
+class ScopedStartupPhase {
+public:
+    explicit ScopedStartupPhase(std::string name);
+    ~ScopedStartupPhase();
+
+    ScopedStartupPhase(const ScopedStartupPhase&) = delete;
+    ScopedStartupPhase& operator=(const ScopedStartupPhase&) = delete;
+
+private:
+    std::string m_name;
+    double m_startMs;
+};
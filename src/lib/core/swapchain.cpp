@@ -7,6 +7,7 @@ bool Swapchain::Recreate(uint32_t width, uint32_t height)
     auto& vulkanCtx = VulkanContext::Get();
     auto vkPhysicalDevice = vulkanCtx.GetVkPhysicalDevice();
     auto vkDevice = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
     auto surface = vulkanCtx.GetSurface();
 
     VkSurfaceCapabilitiesKHR caps;
@@ -57,7 +58,7 @@ bool Swapchain::Recreate(uint32_t width, uint32_t height)
     vkDeviceWaitIdle(vkDevice);
 
     VkSwapchainKHR swapchain{};
-    if (vkCreateSwapchainKHR(vkDevice, &info, nullptr, &swapchain) != VK_SUCCESS) {
+    if (vkCreateSwapchainKHR(vkDevice, &info, allocator, &swapchain) != VK_SUCCESS) {
         throw std::runtime_error("failed to create swapchain");
     }
 
@@ -90,7 +91,7 @@ bool Swapchain::Recreate(uint32_t width, uint32_t height)
                 },
         };
         VkImageView view;
-        vkCreateImageView(vkDevice, &imageViewCI, nullptr, &view);
+        vkCreateImageView(vkDevice, &imageViewCI, allocator, &view);
         m_imageViews.push_back(view);
     }
 
@@ -103,13 +104,14 @@ void Swapchain::Cleanup()
 {
     auto& vulkanCtx = VulkanContext::Get();
     auto vkDevice = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
     DestroyFrameContext();
 
     for (auto& view : m_imageViews) {
-        vkDestroyImageView(vkDevice, view, nullptr);
+        vkDestroyImageView(vkDevice, view, allocator);
     }
     if (m_swapchain != VK_NULL_HANDLE) {
-        vkDestroySwapchainKHR(vkDevice, m_swapchain, nullptr);
+        vkDestroySwapchainKHR(vkDevice, m_swapchain, allocator);
         m_swapchain = VK_NULL_HANDLE;
     }
     m_images.clear();
@@ -171,12 +173,13 @@ void Swapchain::CreateFrameContext()
 {
     auto& vulkanCtx = VulkanContext::Get();
     auto vkDevice = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
     m_frames.resize(m_images.size());
     for (auto& frame : m_frames) {
         VkSemaphoreCreateInfo semCI{
             .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
         };
-        vkCreateSemaphore(vkDevice, &semCI, nullptr, &frame.renderComplete);
+        vkCreateSemaphore(vkDevice, &semCI, allocator, &frame.renderComplete);
     }
 
     uint32_t presentCompleteSemaphoreCount = m_images.size() + 1;
@@ -186,7 +189,7 @@ void Swapchain::CreateFrameContext()
             .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
         };
         VkSemaphore semaphore;
-        vkCreateSemaphore(vkDevice, &semCI, nullptr, &semaphore);
+        vkCreateSemaphore(vkDevice, &semCI, allocator, &semaphore);
         m_presentSemaphoreList.push_back(semaphore);
     }
 }
@@ -195,13 +198,14 @@ void Swapchain::DestroyFrameContext()
 {
     auto& vulkanCtx = VulkanContext::Get();
     auto vkDevice = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
     for (auto& frame : m_frames) {
-        vkDestroySemaphore(vkDevice, frame.presentComplete, nullptr);
-        vkDestroySemaphore(vkDevice, frame.renderComplete, nullptr);
+        vkDestroySemaphore(vkDevice, frame.presentComplete, allocator);
+        vkDestroySemaphore(vkDevice, frame.renderComplete, allocator);
     }
     m_frames.clear();
     for (auto& sem : m_presentSemaphoreList) {
-        vkDestroySemaphore(vkDevice, sem, nullptr);
+        vkDestroySemaphore(vkDevice, sem, allocator);
     }
     m_presentSemaphoreList.clear();
 }
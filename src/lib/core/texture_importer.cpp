@@ -0,0 +1,554 @@
+#include "texture_importer.h"
+#include "bc_encoder.h"
+#include "image_resource.h"
+#include "texture_loader.h"
+#include "vulkan_context.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+// Bump when encoder output changes so stale cache files are rebuilt
+constexpr uint32_t EncoderVersion = 1;
+
+uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+{
+    // FNV-1a
+    auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+struct SourceImage {
+    VkExtent2D extent{};
+    std::vector<uint8_t> rgba;
+};
+
+// Level 0 of the source as RGBA8
+bool DecodeSource(std::string bytes, const std::filesystem::path& path, bool srgb,
+                  SourceImage& image)
+{
+    std::istringstream stream(std::move(bytes));
+    TextureFileInfo info{};
+    if (!loader::ReadTextureFileInfo(stream, path, srgb, info)) {
+        return false;
+    }
+
+    bool bgra = false;
+    switch (info.format) {
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        bgra = true;
+        break;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        break;
+    default:
+        // Already compressed or not 8-bit RGBA
+        return false;
+    }
+
+    std::vector<uint8_t> levels(info.totalSize);
+    if (!loader::ReadTextureLevels(stream, info, levels.data())) {
+        return false;
+    }
+    image.extent = info.extent;
+    image.rgba.assign(levels.begin(), levels.begin() + static_cast<ptrdiff_t>(info.levels[0].size));
+    if (bgra) {
+        for (size_t i = 0; i < image.rgba.size(); i += 4) {
+            std::swap(image.rgba[i], image.rgba[i + 2]);
+        }
+    }
+    return true;
+}
+
+// 2x2 box filter; colour channels are averaged in linear space for sRGB data
+SourceImage Downsample(const SourceImage& src, bool srgb)
+{
+    static const auto ToLinear = [] {
+        std::array<float, 256> table{};
+        for (int i = 0; i < 256; ++i) {
+            float c = i / 255.0f;
+            table[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return table;
+    }();
+    auto fromLinear = [](float c) {
+        c = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+        return static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+    };
+
+    SourceImage dst;
+    dst.extent = {std::max(src.extent.width / 2, 1u), std::max(src.extent.height / 2, 1u)};
+    dst.rgba.resize(size_t(dst.extent.width) * dst.extent.height * 4);
+    for (uint32_t y = 0; y < dst.extent.height; ++y) {
+        for (uint32_t x = 0; x < dst.extent.width; ++x) {
+            const uint32_t x0 = std::min(x * 2, src.extent.width - 1);
+            const uint32_t x1 = std::min(x * 2 + 1, src.extent.width - 1);
+            const uint32_t y0 = std::min(y * 2, src.extent.height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, src.extent.height - 1);
+            const uint8_t* p[4] = {
+                &src.rgba[(size_t(y0) * src.extent.width + x0) * 4],
+                &src.rgba[(size_t(y0) * src.extent.width + x1) * 4],
+                &src.rgba[(size_t(y1) * src.extent.width + x0) * 4],
+                &src.rgba[(size_t(y1) * src.extent.width + x1) * 4],
+            };
+            uint8_t* out = &dst.rgba[(size_t(y) * dst.extent.width + x) * 4];
+            for (int c = 0; c < 4; ++c) {
+                if (srgb && c < 3) {
+                    float sum = ToLinear[p[0][c]] + ToLinear[p[1][c]] + ToLinear[p[2][c]] +
+                                ToLinear[p[3][c]];
+                    out[c] = fromLinear(sum * 0.25f);
+                } else {
+                    out[c] = static_cast<uint8_t>((p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2) / 4);
+                }
+            }
+        }
+    }
+    return dst;
+}
+
+using EncodeBlockFn = void (*)(const uint8_t*, uint8_t*);
+
+struct BlockFormatInfo {
+    EncodeBlockFn encode;
+    uint32_t bytesPerBlock;
+    // Data Format Descriptor colour model (KHR_DF_MODEL_BC*)
+    uint8_t dfdColorModel;
+};
+
+BlockFormatInfo GetBlockFormatInfo(VkFormat format)
+{
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        return {bc::EncodeBC1, 8, 128};
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+        return {bc::EncodeBC3, 16, 130};
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+        return {[](const uint8_t* rgba, uint8_t* block) { bc::EncodeBC4(rgba, block); }, 8, 131};
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        return {bc::EncodeBC5, 16, 132};
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        return {bc::EncodeBC7, 16, 134};
+    default:
+        return {nullptr, 0, 0};
+    }
+}
+
+bool IsSrgb(VkFormat format)
+{
+    return format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || format == VK_FORMAT_BC3_SRGB_BLOCK ||
+           format == VK_FORMAT_BC7_SRGB_BLOCK;
+}
+
+// Basic Data Format Descriptor for a 4x4 BC format (one or two 64-bit samples)
+std::vector<uint32_t> BuildDfd(VkFormat format, const BlockFormatInfo& block)
+{
+    struct Sample {
+        uint16_t bitOffset;
+        uint8_t bitLength;
+        uint8_t channel;
+    };
+    std::vector<Sample> samples;
+    switch (format) {
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+        samples = {{0, 63, 15}, {64, 63, 0}}; // alpha, colour
+        break;
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        samples = {{0, 63, 0}, {64, 63, 1}}; // red, green
+        break;
+    default:
+        samples = {{0, static_cast<uint8_t>(block.bytesPerBlock * 8 - 1), 0}};
+        break;
+    }
+
+    const uint32_t blockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+    std::vector<uint32_t> dfd;
+    dfd.push_back(4 + blockSize);
+    dfd.push_back(0);                                  // vendorId / descriptorType
+    dfd.push_back(2u | (blockSize << 16));             // versionNumber / descriptorBlockSize
+    dfd.push_back(block.dfdColorModel | (1u << 8) |    // BT.709 primaries
+                  ((IsSrgb(format) ? 2u : 1u) << 16)); // transfer function
+    dfd.push_back(3u | (3u << 8));                     // 4x4 texel block
+    dfd.push_back(block.bytesPerBlock);                // bytesPlane0
+    dfd.push_back(0);
+    for (auto& sample : samples) {
+        dfd.push_back(sample.bitOffset | (uint32_t(sample.bitLength) << 16) |
+                      (uint32_t(sample.channel) << 24));
+        dfd.push_back(0);          // sample position
+        dfd.push_back(0);          // sampleLower
+        dfd.push_back(0xffffffffu); // sampleUpper
+    }
+    return dfd;
+}
+
+struct EncodedLevel {
+    VkExtent2D extent{};
+    std::vector<uint8_t> blocks;
+};
+
+bool WriteKtx2(const std::filesystem::path& path, VkFormat format, const BlockFormatInfo& block,
+               const std::vector<EncodedLevel>& levels)
+{
+    static constexpr uint8_t Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0',
+                                               0xBB, '\r', '\n', 0x1A, '\n'};
+    const auto dfd = BuildDfd(format, block);
+    const uint32_t levelCount = static_cast<uint32_t>(levels.size());
+    const uint64_t levelIndexOffset = sizeof(Identifier) + 13 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+    const uint32_t dfdOffset = static_cast<uint32_t>(levelIndexOffset + levelCount * 3 * sizeof(uint64_t));
+    const uint32_t dfdLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+    // Level data is stored smallest first, each level aligned to the block size
+    std::vector<uint64_t> offsets(levelCount);
+    uint64_t offset = dfdOffset + dfdLength;
+    for (uint32_t i = levelCount; i-- > 0;) {
+        offset = (offset + block.bytesPerBlock - 1) / block.bytesPerBlock * block.bytesPerBlock;
+        offsets[i] = offset;
+        offset += levels[i].blocks.size();
+    }
+
+    // Unique per write so concurrent imports of one texture never share a temp file; the
+    // last rename wins and every version is complete
+    static std::atomic<uint32_t> s_writeCount{0};
+    std::ostringstream tempSuffix;
+    tempSuffix << '.' << std::hex << std::hash<std::thread::id>{}(std::this_thread::get_id())
+               << '.' << s_writeCount.fetch_add(1, std::memory_order_relaxed) << ".tmp";
+    auto tempPath = path;
+    tempPath += tempSuffix.str();
+    std::error_code ec;
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        auto write = [&](const void* data, size_t size) {
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        };
+        const uint32_t header[13] = {
+            static_cast<uint32_t>(format), 1, levels[0].extent.width, levels[0].extent.height,
+            0, 0, 1, levelCount, 0, dfdOffset, dfdLength, 0, 0,
+        };
+        const uint64_t sgd[2] = {0, 0};
+        write(Identifier, sizeof(Identifier));
+        write(header, sizeof(header));
+        write(sgd, sizeof(sgd));
+        for (uint32_t i = 0; i < levelCount; ++i) {
+            const uint64_t entry[3] = {offsets[i], levels[i].blocks.size(), levels[i].blocks.size()};
+            write(entry, sizeof(entry));
+        }
+        write(dfd.data(), dfdLength);
+        for (uint32_t i = levelCount; i-- > 0;) {
+            static constexpr uint8_t Padding[16] = {};
+            write(Padding, offsets[i] - static_cast<uint64_t>(file.tellp()));
+            write(levels[i].blocks.data(), levels[i].blocks.size());
+        }
+        if (!file.good()) {
+            file.close();
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::error_code removeError;
+        std::filesystem::remove(tempPath, removeError);
+        return false;
+    }
+    return true;
+}
+
+bool IsSampleable(VkFormat format)
+{
+    VkFormatProperties props{};
+    vkGetPhysicalDeviceFormatProperties(VulkanContext::Get().GetVkPhysicalDevice(), format, &props);
+    return (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
+} // namespace
+
+TextureImporter::TextureImporter(JobSystem* jobSystem, uint32_t workerCount)
+    : m_jobSystem(jobSystem)
+{
+    m_supportsBC1 = IsSampleable(VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+    m_supportsBC3 = IsSampleable(VK_FORMAT_BC3_UNORM_BLOCK);
+    m_supportsBC4 = IsSampleable(VK_FORMAT_BC4_UNORM_BLOCK);
+    m_supportsBC5 = IsSampleable(VK_FORMAT_BC5_UNORM_BLOCK);
+    m_supportsBC7 = IsSampleable(VK_FORMAT_BC7_UNORM_BLOCK);
+
+    if (m_jobSystem) {
+        return;
+    }
+    if (workerCount == 0) {
+        workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(&TextureImporter::WorkerLoop, this);
+    }
+}
+
+TextureImporter::~TextureImporter()
+{
+    if (m_jobSystem) {
+        m_jobSystem->Wait(m_pendingJobs);
+        return;
+    }
+    {
+        std::lock_guard lock(m_taskMutex);
+        m_stop = true;
+    }
+    m_taskCondition.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+std::future<std::filesystem::path> TextureImporter::Import(const std::filesystem::path& source,
+                                                           const TextureImportSettings& settings)
+{
+    auto task = std::make_shared<std::packaged_task<std::filesystem::path()>>(
+        [this, source, settings] { return ImportOnWorker(source, settings); });
+    auto result = task->get_future();
+    if (!m_jobSystem) {
+        Enqueue([task] { (*task)(); });
+        return result;
+    }
+
+    // Read on an I/O thread, then encode on the workers. The encode job is submitted against
+    // the same counter, so the destructor waits for it too.
+    auto promise = std::make_shared<std::promise<std::filesystem::path>>();
+    auto future = promise->get_future();
+    m_jobSystem->Submit(
+        [this, source, settings, promise] {
+            std::string bytes;
+            std::ifstream file(source, std::ios::binary);
+            if (!file.is_open()) {
+                promise->set_value(source);
+                return;
+            }
+            bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            m_jobSystem->Submit(
+                [this, source, settings, promise, bytes = std::move(bytes)]() mutable {
+                    promise->set_value(ImportBytes(source, std::move(bytes), settings));
+                },
+                &m_pendingJobs);
+        },
+        &m_pendingJobs, JobSystem::Affinity::Io);
+    return future;
+}
+
+std::shared_ptr<Texture2D> TextureImporter::Load(const std::filesystem::path& source,
+                                                 const TextureImportSettings& settings)
+{
+    // A blocking get could starve a JobSystem whose only thread is this one, so import here;
+    // the encode still spreads over the workers
+    auto path = m_jobSystem ? ImportOnWorker(source, settings) : Import(source, settings).get();
+    return Texture2D::LoadFromFile(path, settings.srgb, settings.generateMipmaps);
+}
+
+VkFormat TextureImporter::SelectFormat(const TextureImportSettings& settings, bool hasAlpha) const
+{
+    switch (settings.usage) {
+    case TextureImportSettings::Usage::NormalMap:
+        return m_supportsBC5 ? VK_FORMAT_BC5_UNORM_BLOCK : VK_FORMAT_UNDEFINED;
+    case TextureImportSettings::Usage::Mask:
+        return m_supportsBC4 ? VK_FORMAT_BC4_UNORM_BLOCK : VK_FORMAT_UNDEFINED;
+    case TextureImportSettings::Usage::Color:
+        break;
+    }
+    if (m_supportsBC7) {
+        return settings.srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+    }
+    if (hasAlpha) {
+        if (m_supportsBC3) {
+            return settings.srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+        }
+    } else if (m_supportsBC1) {
+        return settings.srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    }
+    return VK_FORMAT_UNDEFINED;
+}
+
+std::filesystem::path TextureImporter::ImportOnWorker(const std::filesystem::path& source,
+                                                      const TextureImportSettings& settings)
+{
+    std::string bytes;
+    {
+        std::ifstream file(source, std::ios::binary);
+        if (!file.is_open()) {
+            return source;
+        }
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    return ImportBytes(source, std::move(bytes), settings);
+}
+
+std::filesystem::path TextureImporter::ImportBytes(const std::filesystem::path& source,
+                                                   std::string bytes,
+                                                   const TextureImportSettings& settings)
+{
+
+    // Key: source content, settings, encoder version and which BC formats the device samples
+    const uint32_t keyFields[] = {
+        EncoderVersion,
+        static_cast<uint32_t>(settings.usage),
+        settings.srgb,
+        settings.generateMipmaps,
+        uint32_t(m_supportsBC1) | (m_supportsBC3 << 1) | (m_supportsBC4 << 2) |
+            (m_supportsBC5 << 3) | (m_supportsBC7 << 4),
+    };
+    const uint64_t hash = HashBytes(keyFields, sizeof(keyFields), HashBytes(bytes.data(), bytes.size()));
+    char hashText[17];
+    std::snprintf(hashText, sizeof(hashText), "%016llx", static_cast<unsigned long long>(hash));
+    const auto prefix = source.filename().string() + ".";
+    auto cachePath = source;
+    cachePath.replace_filename(prefix + hashText + ".ktx2");
+
+    std::error_code ec;
+    if (std::filesystem::exists(cachePath, ec)) {
+        return cachePath;
+    }
+
+    SourceImage image;
+    if (!DecodeSource(std::move(bytes), source, settings.srgb, image)) {
+        return source;
+    }
+    bool hasAlpha = false;
+    for (size_t i = 3; i < image.rgba.size() && !hasAlpha; i += 4) {
+        hasAlpha = image.rgba[i] != 0xff;
+    }
+    const VkFormat format = SelectFormat(settings, hasAlpha);
+    const BlockFormatInfo block = GetBlockFormatInfo(format);
+    if (!block.encode) {
+        return source;
+    }
+
+    const bool linearizeMips = settings.srgb && settings.usage == TextureImportSettings::Usage::Color;
+    const uint32_t levelCount = settings.generateMipmaps ? Texture2D::GetFullMipCount(image.extent) : 1;
+    std::vector<EncodedLevel> levels(levelCount);
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        if (level > 0) {
+            image = Downsample(image, linearizeMips);
+        }
+        const uint32_t blocksX = (image.extent.width + 3) / 4;
+        const uint32_t blocksY = (image.extent.height + 3) / 4;
+        auto& encoded = levels[level];
+        encoded.extent = image.extent;
+        encoded.blocks.resize(size_t(blocksX) * blocksY * block.bytesPerBlock);
+
+        // One task per row of blocks; edge blocks repeat the last row / column
+        ParallelFor(blocksY, [&](uint32_t by) {
+            uint8_t texels[64];
+            for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                for (uint32_t i = 0; i < 16; ++i) {
+                    const uint32_t x = std::min(bx * 4 + (i & 3), image.extent.width - 1);
+                    const uint32_t y = std::min(by * 4 + (i >> 2), image.extent.height - 1);
+                    std::memcpy(texels + i * 4, &image.rgba[(size_t(y) * image.extent.width + x) * 4], 4);
+                }
+                block.encode(texels, &encoded.blocks[(size_t(by) * blocksX + bx) * block.bytesPerBlock]);
+            }
+        });
+    }
+
+    if (!WriteKtx2(cachePath, format, block, levels)) {
+        return source;
+    }
+
+    // Drop cache files from earlier versions of this source
+    for (auto& entry : std::filesystem::directory_iterator(source.parent_path().empty()
+                                                               ? std::filesystem::path(".")
+                                                               : source.parent_path(), ec)) {
+        const auto name = entry.path().filename().string();
+        if (name != cachePath.filename().string() && name.starts_with(prefix) &&
+            name.ends_with(".ktx2") && name.size() == prefix.size() + 16 + 5) {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+    return cachePath;
+}
+
+void TextureImporter::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& body)
+{
+    if (m_jobSystem) {
+        m_jobSystem->ParallelFor(count, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                body(i);
+            }
+        });
+        return;
+    }
+
+    struct Batch {
+        std::atomic<uint32_t> next{0};
+        std::atomic<uint32_t> done{0};
+        uint32_t count = 0;
+        const std::function<void(uint32_t)>* body = nullptr;
+        std::mutex mutex;
+        std::condition_variable finished;
+
+        void Run()
+        {
+            uint32_t index;
+            while ((index = next.fetch_add(1)) < count) {
+                (*body)(index);
+                if (done.fetch_add(1) + 1 == count) {
+                    std::lock_guard lock(mutex);
+                    finished.notify_all();
+                }
+            }
+        }
+    };
+
+    auto batch = std::make_shared<Batch>();
+    batch->count = count;
+    batch->body = &body;
+    const uint32_t helpers =
+        count > 1 ? std::min(static_cast<uint32_t>(m_workers.size()), count) - 1 : 0;
+    for (uint32_t i = 0; i < helpers; ++i) {
+        Enqueue([batch] { batch->Run(); });
+    }
+    batch->Run();
+
+    std::unique_lock lock(batch->mutex);
+    batch->finished.wait(lock, [&] { return batch->done.load() == batch->count; });
+}
+
+void TextureImporter::Enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard lock(m_taskMutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_taskCondition.notify_one();
+}
+
+void TextureImporter::WorkerLoop()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(m_taskMutex);
+            m_taskCondition.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+            if (m_stop && m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
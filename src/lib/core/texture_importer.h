@@ -0,0 +1,85 @@
+#pragma once
+#include "core/job_system.h"
+#include <vulkan/vulkan.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Texture2D;
+
+struct TextureImportSettings {
+    enum class Usage {
+        Color,     // BC7, else BC3 (alpha) / BC1 (opaque)
+        NormalMap, // BC5 (RG)
+        Mask,      // BC4 (R)
+    };
+
+    Usage usage = Usage::Color;
+    bool srgb = true;
+    bool generateMipmaps = true;
+};
+
+// Transcodes TGA / uncompressed KTX2 sources to block-compressed KTX2 on worker threads.
+// Results are cached next to the source as "<file>.<content hash>.ktx2", so later runs only
+// hash the source and hand the cached blocks to Texture2D::LoadFromFile.
+// With a JobSystem the source is read by an Affinity::Io job and blocks are encoded with its
+// ParallelFor; without one the importer starts its own workerCount threads.
+class TextureImporter {
+public:
+    // workerCount 0 = one per hardware thread; ignored when jobSystem is set
+    explicit TextureImporter(JobSystem* jobSystem = nullptr, uint32_t workerCount = 0);
+    ~TextureImporter();
+
+    TextureImporter(const TextureImporter&) = delete;
+    TextureImporter& operator=(const TextureImporter&) = delete;
+
+    // Resolves to the KTX2 to load; the source itself when the device has no usable BC format
+    // or the import fails
+    std::future<std::filesystem::path> Import(const std::filesystem::path& source,
+                                              const TextureImportSettings& settings);
+
+    // Import and load; call from the thread that owns uploads
+    std::shared_ptr<Texture2D> Load(const std::filesystem::path& source,
+                                    const TextureImportSettings& settings);
+
+    // Block-compressed format for the settings, VK_FORMAT_UNDEFINED when none is sampleable
+    VkFormat SelectFormat(const TextureImportSettings& settings, bool hasAlpha) const;
+
+private:
+    std::filesystem::path ImportOnWorker(const std::filesystem::path& source,
+                                         const TextureImportSettings& settings);
+    // Everything after reading the source file
+    std::filesystem::path ImportBytes(const std::filesystem::path& source, std::string bytes,
+                                      const TextureImportSettings& settings);
+    // Runs body(0..count-1) across the JobSystem or the own threads; the caller works too, so
+    // it is safe from a worker
+    void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& body);
+    void Enqueue(std::function<void()> task);
+    void WorkerLoop();
+
+    // Sampleable with optimal tiling, queried once at construction
+    bool m_supportsBC1 = false;
+    bool m_supportsBC3 = false;
+    bool m_supportsBC4 = false;
+    bool m_supportsBC5 = false;
+    bool m_supportsBC7 = false;
+
+    JobSystem* m_jobSystem = nullptr;
+    // Import jobs on m_jobSystem, waited on by the destructor
+    JobCounter m_pendingJobs;
+
+    // Own threads, only without a JobSystem
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_taskMutex;
+    std::condition_variable m_taskCondition;
+    bool m_stop = false;
+};
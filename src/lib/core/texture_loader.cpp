@@ -0,0 +1,305 @@
+#include "texture_loader.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+constexpr VkDeviceSize LevelAlignment = 16;
+
+struct FormatBlock {
+    uint32_t blockWidth;
+    uint32_t blockHeight;
+    uint32_t bytesPerBlock;
+};
+
+FormatBlock GetFormatBlock(VkFormat format)
+{
+    switch (format) {
+    case VK_FORMAT_R8_UNORM:
+    case VK_FORMAT_R8_SNORM:
+    case VK_FORMAT_R8_SRGB:
+        return {1, 1, 1};
+    case VK_FORMAT_R8G8_UNORM:
+    case VK_FORMAT_R8G8_SNORM:
+    case VK_FORMAT_R8G8_SRGB:
+    case VK_FORMAT_R16_UNORM:
+    case VK_FORMAT_R16_SFLOAT:
+        return {1, 1, 2};
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+    case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+    case VK_FORMAT_R16G16_UNORM:
+    case VK_FORMAT_R16G16_SFLOAT:
+    case VK_FORMAT_R32_SFLOAT:
+        return {1, 1, 4};
+    case VK_FORMAT_R16G16B16A16_UNORM:
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+    case VK_FORMAT_R32G32_SFLOAT:
+        return {1, 1, 8};
+    case VK_FORMAT_R32G32B32A32_SFLOAT:
+        return {1, 1, 16};
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+    case VK_FORMAT_BC4_SNORM_BLOCK:
+        return {4, 4, 8};
+    case VK_FORMAT_BC2_UNORM_BLOCK:
+    case VK_FORMAT_BC2_SRGB_BLOCK:
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC5_SNORM_BLOCK:
+    case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+    case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+    case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+        return {4, 4, 16};
+    default:
+        return {0, 0, 0};
+    }
+}
+
+template <typename T> bool ReadValue(std::istream& stream, T& value)
+{
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// ---- KTX2 ----
+
+bool ReadKtx2Info(std::istream& stream, TextureFileInfo& info)
+{
+    // Identifier has already been checked; the header follows it
+    struct Header {
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+    } header{};
+    // sgdByteOffset / sgdByteLength (read separately: the struct would be padded before them)
+    uint64_t sgd[2]{};
+    if (!ReadValue(stream, header) || !ReadValue(stream, sgd)) {
+        return false;
+    }
+    // Plain 2D textures only; Basis Universal (VK_FORMAT_UNDEFINED) and supercompression
+    // need a transcoder
+    if (header.vkFormat == VK_FORMAT_UNDEFINED || header.supercompressionScheme != 0 ||
+        header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1) {
+        return false;
+    }
+
+    info.container = TextureFileInfo::Container::Ktx2;
+    info.format = static_cast<VkFormat>(header.vkFormat);
+    info.extent = {header.pixelWidth, header.pixelHeight};
+    info.requestsGeneratedMips = header.levelCount == 0;
+
+    const uint32_t levelCount = std::max(header.levelCount, 1u);
+    info.levels.resize(levelCount);
+    VkDeviceSize dstOffset = 0;
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        uint64_t byteOffset = 0, byteLength = 0, uncompressedByteLength = 0;
+        if (!ReadValue(stream, byteOffset) || !ReadValue(stream, byteLength) ||
+            !ReadValue(stream, uncompressedByteLength)) {
+            return false;
+        }
+        auto& level = info.levels[i];
+        level.extent = {std::max(info.extent.width >> i, 1u),
+                        std::max(info.extent.height >> i, 1u)};
+        level.fileOffset = byteOffset;
+        level.size = byteLength;
+        if (level.size != loader::GetImageByteSize(info.format, level.extent)) {
+            return false;
+        }
+        level.dstOffset = dstOffset;
+        dstOffset = AlignUp(dstOffset + level.size, LevelAlignment);
+    }
+    info.totalSize = dstOffset;
+    return true;
+}
+
+// ---- TGA ----
+
+bool ReadTgaInfo(std::istream& stream, bool srgb, TextureFileInfo& info)
+{
+    std::array<uint8_t, 18> header{};
+    if (!stream.read(reinterpret_cast<char*>(header.data()), header.size())) {
+        return false;
+    }
+    const uint8_t idLength = header[0];
+    const uint8_t colorMapType = header[1];
+    const uint8_t imageType = header[2];
+    const uint32_t width = header[12] | (header[13] << 8);
+    const uint32_t height = header[14] | (header[15] << 8);
+    const uint8_t bitsPerPixel = header[16];
+    const uint8_t descriptor = header[17];
+
+    // Uncompressed (2) or RLE (10) true-colour, 24 or 32 bits
+    if (colorMapType != 0 || (imageType != 2 && imageType != 10) ||
+        (bitsPerPixel != 24 && bitsPerPixel != 32) || width == 0 || height == 0) {
+        return false;
+    }
+
+    info.container = TextureFileInfo::Container::Tga;
+    info.format = srgb ? VK_FORMAT_B8G8R8A8_SRGB : VK_FORMAT_B8G8R8A8_UNORM;
+    info.extent = {width, height};
+    info.requestsGeneratedMips = true;
+    info.tgaImageType = imageType;
+    info.tgaBitsPerPixel = bitsPerPixel;
+    info.tgaTopToBottom = (descriptor & 0x20) != 0;
+    info.levels = {TextureFileInfo::Level{
+        .extent = info.extent,
+        .fileOffset = static_cast<VkDeviceSize>(header.size() + idLength),
+        .size = VkDeviceSize(width) * height * 4,
+        .dstOffset = 0,
+    }};
+    info.totalSize = info.levels[0].size;
+    return true;
+}
+
+bool ReadTgaPixels(std::istream& stream, const TextureFileInfo& info, uint8_t* dst)
+{
+    const uint32_t width = info.extent.width;
+    const uint32_t height = info.extent.height;
+    const uint32_t srcBytes = info.tgaBitsPerPixel / 8;
+    auto dstRow = [&](uint32_t y) {
+        uint32_t row = info.tgaTopToBottom ? y : height - 1 - y;
+        return dst + size_t(row) * width * 4;
+    };
+
+    stream.seekg(static_cast<std::streamoff>(info.levels[0].fileOffset));
+
+    if (info.tgaImageType == 2) {
+        if (srcBytes == 4) {
+            // BGRA8 already: read each row straight into place
+            for (uint32_t y = 0; y < height; ++y) {
+                if (!stream.read(reinterpret_cast<char*>(dstRow(y)), size_t(width) * 4)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        // BGR8: read the row into the tail of its destination and expand forwards in place
+        for (uint32_t y = 0; y < height; ++y) {
+            uint8_t* row = dstRow(y);
+            uint8_t* packed = row + size_t(width);
+            if (!stream.read(reinterpret_cast<char*>(packed), size_t(width) * 3)) {
+                return false;
+            }
+            for (uint32_t x = 0; x < width; ++x) {
+                uint8_t b = packed[x * 3 + 0], g = packed[x * 3 + 1], r = packed[x * 3 + 2];
+                row[x * 4 + 0] = b;
+                row[x * 4 + 1] = g;
+                row[x * 4 + 2] = r;
+                row[x * 4 + 3] = 0xff;
+            }
+        }
+        return true;
+    }
+
+    // RLE: packets may cross row boundaries
+    uint32_t x = 0, y = 0;
+    uint8_t pixel[4] = {0, 0, 0, 0xff};
+    auto emit = [&] {
+        std::memcpy(dstRow(y) + size_t(x) * 4, pixel, 4);
+        if (++x == width) {
+            x = 0;
+            ++y;
+        }
+    };
+    while (y < height) {
+        uint8_t packetHeader = 0;
+        if (!ReadValue(stream, packetHeader)) {
+            return false;
+        }
+        const uint32_t count = (packetHeader & 0x7f) + 1u;
+        const bool runLength = (packetHeader & 0x80) != 0;
+        for (uint32_t i = 0; i < count && y < height; ++i) {
+            if (i == 0 || !runLength) {
+                if (!stream.read(reinterpret_cast<char*>(pixel), srcBytes)) {
+                    return false;
+                }
+            }
+            emit();
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+namespace loader {
+
+bool ReadTextureFileInfo(std::istream& stream, const std::filesystem::path& path, bool srgb,
+                         TextureFileInfo& info)
+{
+    static constexpr uint8_t Ktx2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0',
+                                                   0xBB, '\r', '\n', 0x1A, '\n'};
+    uint8_t identifier[12]{};
+    if (stream.read(reinterpret_cast<char*>(identifier), sizeof(identifier)) &&
+        std::memcmp(identifier, Ktx2Identifier, sizeof(identifier)) == 0) {
+        return ReadKtx2Info(stream, info);
+    }
+
+    // TGA has no magic number; go by extension
+    auto extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".tga") {
+        stream.clear();
+        stream.seekg(0);
+        return ReadTgaInfo(stream, srgb, info);
+    }
+    return false;
+}
+
+bool ReadTextureLevels(std::istream& stream, const TextureFileInfo& info, void* dst)
+{
+    auto* bytes = static_cast<uint8_t*>(dst);
+    if (info.container == TextureFileInfo::Container::Tga) {
+        return ReadTgaPixels(stream, info, bytes);
+    }
+
+    for (auto& level : info.levels) {
+        stream.seekg(static_cast<std::streamoff>(level.fileOffset));
+        if (!stream.read(reinterpret_cast<char*>(bytes + level.dstOffset),
+                         static_cast<std::streamsize>(level.size))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+VkDeviceSize GetImageByteSize(VkFormat format, VkExtent2D extent)
+{
+    auto block = GetFormatBlock(format);
+    if (block.bytesPerBlock == 0) {
+        return 0;
+    }
+    VkDeviceSize blocksX = (extent.width + block.blockWidth - 1) / block.blockWidth;
+    VkDeviceSize blocksY = (extent.height + block.blockHeight - 1) / block.blockHeight;
+    return blocksX * blocksY * block.bytesPerBlock;
+}
+
+} // namespace loader
@@ -0,0 +1,51 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <vector>
+
+// Header parsing and streaming pixel reads for texture files (KTX2 and TGA).
+// Pixel data is read straight into caller-provided memory (normally a mapped staging buffer).
+struct TextureFileInfo {
+    enum class Container {
+        Ktx2,
+        Tga,
+    };
+
+    struct Level {
+        VkExtent2D extent{};
+        VkDeviceSize fileOffset = 0;
+        VkDeviceSize size = 0;
+        // Offset of this level in the destination memory passed to ReadTextureLevels
+        VkDeviceSize dstOffset = 0;
+    };
+
+    Container container = Container::Ktx2;
+    VkExtent2D extent{};
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    // Levels stored in the file, largest first
+    std::vector<Level> levels;
+    // KTX2 with levelCount == 0 asks the loader to generate the chain
+    bool requestsGeneratedMips = false;
+    VkDeviceSize totalSize = 0;
+
+    // TGA specifics
+    uint8_t tgaImageType = 0;
+    uint8_t tgaBitsPerPixel = 0;
+    bool tgaTopToBottom = false;
+};
+
+namespace loader {
+
+    // srgb selects the colour space for containers that do not store a VkFormat (TGA)
+    bool ReadTextureFileInfo(std::istream& stream, const std::filesystem::path& path, bool srgb,
+                             TextureFileInfo& info);
+
+    // Reads every level into dst (info.totalSize bytes) at Level::dstOffset
+    bool ReadTextureLevels(std::istream& stream, const TextureFileInfo& info, void* dst);
+
+    // Size in bytes of a width x height region of format (block-compressed formats included)
+    VkDeviceSize GetImageByteSize(VkFormat format, VkExtent2D extent);
+
+} // namespace loader
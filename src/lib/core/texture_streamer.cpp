@@ -0,0 +1,519 @@
+#include "texture_streamer.h"
+#include "core/bindless_resource_table.h"
+#include "core/buffer_resource.h"
+#include "core/command_buffer.h"
+#include "core/gpu_memory_tracker.h"
+#include "core/image_resource.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace {
+
+constexpr uint32_t NoFeedback = ~0u;
+constexpr VkDeviceSize SliceAlignment = 16;
+
+} // namespace
+
+bool TextureStreamer::Initialize(const Settings& settings, JobSystem* jobSystem)
+{
+    m_settings = settings;
+    m_jobSystem = jobSystem;
+    auto& vulkanCtx = VulkanContext::Get();
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+
+    // One host-visible feedback region per frame in flight, one uint per bindless slot
+    m_feedbackSlots = BindlessResourceTable::DefaultSampledImageCount;
+    const VkDeviceSize regionSize = VkDeviceSize(m_feedbackSlots) * sizeof(uint32_t);
+    VkBufferCreateInfo bufferInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = regionSize * VulkanContext::MaxInflightFrame,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    if (vkCreateBuffer(device, &bufferInfo, allocator, &m_feedbackBuffer) != VK_SUCCESS) {
+        return false;
+    }
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device, m_feedbackBuffer, &memRequirements);
+    m_feedbackMemory = vulkanCtx.AllocateMemory(
+        memRequirements,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        GpuMemoryCategory::Buffer, "TextureStreamer feedback");
+    if (m_feedbackMemory == VK_NULL_HANDLE) {
+        Cleanup();
+        return false;
+    }
+    vkBindBufferMemory(device, m_feedbackBuffer, m_feedbackMemory, 0);
+    void* mapped = nullptr;
+    vkMapMemory(device, m_feedbackMemory, 0, VK_WHOLE_SIZE, 0, &mapped);
+    m_feedbackMapped = static_cast<uint32_t*>(mapped);
+    std::fill_n(m_feedbackMapped, size_t(m_feedbackSlots) * VulkanContext::MaxInflightFrame,
+                NoFeedback);
+    vulkanCtx.SetDebugObjectName(reinterpret_cast<void*>(m_feedbackBuffer), VK_OBJECT_TYPE_BUFFER,
+                                 "TextureStreamer feedback");
+
+    auto& bindless = vulkanCtx.GetBindlessResourceTable();
+    for (uint32_t i = 0; i < VulkanContext::MaxInflightFrame; ++i) {
+        m_feedbackIndices.push_back(
+            bindless.RegisterStorageBuffer(m_feedbackBuffer, regionSize * i, regionSize));
+    }
+    m_handleBySlot.assign(m_feedbackSlots, InvalidHandle);
+    return true;
+}
+
+void TextureStreamer::Cleanup()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    for (uint32_t handle = 0; handle < m_entries.size(); ++handle) {
+        if (m_entries[handle].used) {
+            Release(handle);
+        }
+    }
+    m_entries.clear();
+    m_freeHandles.clear();
+
+    auto& bindless = vulkanCtx.GetBindlessResourceTable();
+    for (uint32_t index : m_feedbackIndices) {
+        bindless.ReleaseStorageBuffer(index);
+    }
+    m_feedbackIndices.clear();
+
+    VkDevice device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    if (m_feedbackMapped != nullptr) {
+        vkUnmapMemory(device, m_feedbackMemory);
+        m_feedbackMapped = nullptr;
+    }
+    // Frames in flight may still write feedback
+    VkBuffer buffer = m_feedbackBuffer;
+    VkDeviceMemory memory = m_feedbackMemory;
+    vulkanCtx.DeferDestroy([&vulkanCtx, device, allocator, buffer, memory] {
+        vkDestroyBuffer(device, buffer, allocator);
+        vulkanCtx.FreeMemory(memory);
+    });
+    m_feedbackBuffer = VK_NULL_HANDLE;
+    m_feedbackMemory = VK_NULL_HANDLE;
+    m_residentBytes = 0;
+    m_pendingBytes = 0;
+}
+
+uint32_t TextureStreamer::Register(const std::filesystem::path& path, bool srgb)
+{
+    Entry entry;
+    entry.path = path;
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open() || !loader::ReadTextureFileInfo(file, path, srgb, entry.info)) {
+            return InvalidHandle;
+        }
+    }
+
+    const uint32_t levelCount = static_cast<uint32_t>(entry.info.levels.size());
+    if (levelCount > 1) {
+        // First level small enough to pin; a chain that never gets that small pins its last level
+        entry.tailMip = levelCount - 1;
+        for (uint32_t i = 0; i < levelCount; ++i) {
+            const auto& extent = entry.info.levels[i].extent;
+            if (std::max(extent.width, extent.height) <= m_settings.tailSize) {
+                entry.tailMip = i;
+                break;
+            }
+        }
+        auto slice = SliceLevels(entry.info, entry.tailMip);
+        auto staging = StagingBuffer::Create(slice.totalSize);
+        if (!staging) {
+            return InvalidHandle;
+        }
+        std::ifstream file(path, std::ios::binary);
+        const bool read = loader::ReadTextureLevels(file, slice, staging->Map());
+        staging->Unmap();
+        entry.tail = read ? CreateTexture(slice) : nullptr;
+        if (!entry.tail) {
+            return InvalidHandle;
+        }
+        auto& vulkanCtx = VulkanContext::Get();
+        auto commandBuffer = vulkanCtx.CreateCommandBuffer();
+        commandBuffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        std::vector<VkBufferImageCopy> regions;
+        for (uint32_t level = 0; auto& sliceLevel : slice.levels) {
+            regions.push_back(VkBufferImageCopy{
+                .bufferOffset = sliceLevel.dstOffset,
+                .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level++, 0, 1},
+                .imageExtent = {sliceLevel.extent.width, sliceLevel.extent.height, 1},
+            });
+        }
+        entry.tail->RecordUpload(*commandBuffer, *staging, regions);
+        commandBuffer->End();
+        vulkanCtx.SubmitAndWait(commandBuffer);
+    }
+    else {
+        // Nothing to stream
+        entry.tail = Texture2D::LoadFromFile(path, srgb);
+        if (!entry.tail) {
+            return InvalidHandle;
+        }
+    }
+    entry.residentMip = entry.tailMip;
+    entry.requestedMip = entry.tailMip;
+    entry.wantedMip = entry.tailMip;
+    entry.lastUsedFrame = m_frame;
+    entry.bindlessIndex =
+        VulkanContext::Get().GetBindlessResourceTable().RegisterSampledImage(entry.tail->GetVkImageView());
+    if (entry.bindlessIndex == BindlessResourceTable::InvalidIndex) {
+        return InvalidHandle;
+    }
+    entry.used = true;
+
+    uint32_t handle;
+    if (!m_freeHandles.empty()) {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+        m_entries[handle] = std::move(entry);
+    }
+    else {
+        handle = static_cast<uint32_t>(m_entries.size());
+        m_entries.push_back(std::move(entry));
+    }
+    if (m_entries[handle].bindlessIndex < m_feedbackSlots) {
+        m_handleBySlot[m_entries[handle].bindlessIndex] = handle;
+    }
+    return handle;
+}
+
+void TextureStreamer::Release(uint32_t handle)
+{
+    if (handle >= m_entries.size() || !m_entries[handle].used) {
+        return;
+    }
+    auto& entry = m_entries[handle];
+    ClearPending(entry);
+
+    auto& vulkanCtx = VulkanContext::Get();
+    vulkanCtx.GetBindlessResourceTable().ReleaseSampledImage(entry.bindlessIndex);
+    if (entry.bindlessIndex < m_feedbackSlots) {
+        m_handleBySlot[entry.bindlessIndex] = InvalidHandle;
+    }
+    vulkanCtx.DeferDestroy([tail = std::move(entry.tail), detail = std::move(entry.detail)] {});
+    m_residentBytes -= entry.detailBytes;
+    entry = Entry{};
+    m_freeHandles.push_back(handle);
+}
+
+uint32_t TextureStreamer::GetBindlessIndex(uint32_t handle) const
+{
+    return handle < m_entries.size() ? m_entries[handle].bindlessIndex
+                                     : BindlessResourceTable::InvalidIndex;
+}
+
+uint32_t TextureStreamer::GetFeedbackBufferIndex() const
+{
+    return m_feedbackIndices[VulkanContext::Get().GetCurrentFrameIndex()];
+}
+
+uint32_t TextureStreamer::GetResidentMip(uint32_t handle) const
+{
+    return handle < m_entries.size() ? m_entries[handle].residentMip : 0;
+}
+
+void TextureStreamer::RequestMip(uint32_t handle, uint32_t mip)
+{
+    if (handle >= m_entries.size() || !m_entries[handle].used) {
+        return;
+    }
+    auto& entry = m_entries[handle];
+    entry.requestedMip = std::min({entry.requestedMip, mip, entry.tailMip});
+    entry.lastUsedFrame = m_frame;
+}
+
+void TextureStreamer::Update()
+{
+    // Requests accumulated since the last Update plus this frame's feedback. Textures nobody
+    // asked for want only their tail, but keep their detail until the budget needs it.
+    ReadFeedback();
+    for (auto& entry : m_entries) {
+        entry.wantedMip = entry.requestedMip;
+        entry.requestedMip = entry.tailMip;
+    }
+
+    for (uint32_t handle = 0; handle < m_entries.size(); ++handle) {
+        if (m_entries[handle].pending) {
+            PollUpload(handle);
+        }
+    }
+
+    // Largest detail deficit first
+    std::vector<uint32_t> candidates;
+    uint32_t pendingCount = 0;
+    for (uint32_t handle = 0; handle < m_entries.size(); ++handle) {
+        const auto& entry = m_entries[handle];
+        if (entry.pending) {
+            ++pendingCount;
+        }
+        else if (entry.used && entry.wantedMip < entry.residentMip) {
+            candidates.push_back(handle);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) {
+        const auto& ea = m_entries[a];
+        const auto& eb = m_entries[b];
+        return ea.residentMip - ea.wantedMip > eb.residentMip - eb.wantedMip;
+    });
+
+    VkDeviceSize startedBytes = 0;
+    for (uint32_t handle : candidates) {
+        if (pendingCount >= m_settings.maxPendingUploads ||
+            (startedBytes > 0 && startedBytes >= m_settings.maxUploadBytesPerFrame)) {
+            break;
+        }
+        if (StartUpload(handle, m_entries[handle].wantedMip)) {
+            startedBytes += m_entries[handle].pending->bytes;
+            ++pendingCount;
+        }
+    }
+    ++m_frame;
+}
+
+void TextureStreamer::ReadFeedback()
+{
+    // This frame's fence has been waited, so its region holds complete feedback
+    const uint32_t frameIndex = VulkanContext::Get().GetCurrentFrameIndex();
+    uint32_t* feedback = m_feedbackMapped + size_t(frameIndex) * m_feedbackSlots;
+    for (uint32_t slot = 0; slot < m_feedbackSlots; ++slot) {
+        const uint32_t value = feedback[slot];
+        if (value == NoFeedback) {
+            continue;
+        }
+        feedback[slot] = NoFeedback;
+        const uint32_t handle = m_handleBySlot[slot];
+        if (handle == InvalidHandle) {
+            continue;
+        }
+        // The LOD is relative to the image that was bound: file mip = resident + lod
+        const auto& entry = m_entries[handle];
+        const int64_t mip = int64_t(entry.residentMip) + int64_t(value) - FeedbackLodBias;
+        RequestMip(handle, static_cast<uint32_t>(std::max<int64_t>(mip, 0)));
+    }
+}
+
+bool TextureStreamer::StartUpload(uint32_t handle, uint32_t firstMip)
+{
+    auto& entry = m_entries[handle];
+    auto upload = std::make_unique<PendingUpload>();
+    upload->firstMip = firstMip;
+    upload->info = SliceLevels(entry.info, firstMip);
+    for (auto& level : upload->info.levels) {
+        upload->bytes += level.size;
+    }
+    if (upload->bytes > m_settings.budgetBytes || !MakeRoom(upload->bytes, handle)) {
+        return false;
+    }
+    upload->staging = StagingBuffer::Create(upload->info.totalSize);
+    if (!upload->staging) {
+        return false;
+    }
+
+    // Read on an I/O thread straight into the mapped staging memory
+    void* dst = upload->staging->Map();
+    auto read = [path = entry.path, info = upload->info, dst] {
+        std::ifstream file(path, std::ios::binary);
+        return file.is_open() && loader::ReadTextureLevels(file, info, dst);
+    };
+    if (m_jobSystem) {
+        auto result = std::make_shared<std::promise<bool>>();
+        upload->read = result->get_future();
+        m_jobSystem->Submit([result, read] { result->set_value(read()); }, &upload->readJob,
+                            JobSystem::Affinity::Io);
+    }
+    else {
+        upload->read = std::async(std::launch::async, read);
+    }
+    m_pendingBytes += upload->bytes;
+    entry.pending = std::move(upload);
+    return true;
+}
+
+void TextureStreamer::PollUpload(uint32_t handle)
+{
+    auto& entry = m_entries[handle];
+    auto& upload = *entry.pending;
+    auto& vulkanCtx = VulkanContext::Get();
+
+    if (upload.read.valid()) {
+        if (upload.read.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+        const bool read = upload.read.get();
+        upload.staging->Unmap();
+        upload.texture = read ? CreateTexture(upload.info) : nullptr;
+        if (!upload.texture) {
+            ClearPending(entry);
+            return;
+        }
+
+        upload.commandBuffer = vulkanCtx.CreateCommandBuffer();
+        upload.commandBuffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        std::vector<VkBufferImageCopy> regions;
+        for (uint32_t level = 0; auto& sliceLevel : upload.info.levels) {
+            regions.push_back(VkBufferImageCopy{
+                .bufferOffset = sliceLevel.dstOffset,
+                .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level++, 0, 1},
+                .imageExtent = {sliceLevel.extent.width, sliceLevel.extent.height, 1},
+            });
+        }
+        upload.texture->RecordUpload(*upload.commandBuffer, *upload.staging, regions);
+        upload.commandBuffer->End();
+
+        VkFenceCreateInfo fenceCI{
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        };
+        vkCreateFence(vulkanCtx.GetVkDevice(), &fenceCI, vulkanCtx.GetAllocationCallbacks(),
+                      &upload.fence);
+        VkCommandBuffer vkCommandBuffer = upload.commandBuffer->Get();
+        VkSubmitInfo submitInfo{
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &vkCommandBuffer,
+        };
+        vkQueueSubmit(vulkanCtx.GetGraphicsQueue(), 1, &submitInfo, upload.fence);
+        return;
+    }
+
+    if (vkGetFenceStatus(vulkanCtx.GetVkDevice(), upload.fence) != VK_SUCCESS) {
+        return;
+    }
+    auto texture = std::move(upload.texture);
+    const uint32_t firstMip = upload.firstMip;
+    const VkDeviceSize bytes = upload.bytes;
+    ClearPending(entry);
+    SwapIn(handle, std::move(texture), firstMip, bytes);
+}
+
+void TextureStreamer::SwapIn(uint32_t handle, std::shared_ptr<Texture2D> texture,
+                             uint32_t residentMip, VkDeviceSize bytes)
+{
+    auto& entry = m_entries[handle];
+    Rebind(handle, texture->GetVkImageView());
+    if (entry.detail) {
+        VulkanContext::Get().DeferDestroy([detail = std::move(entry.detail)] {});
+        m_residentBytes -= entry.detailBytes;
+    }
+    entry.detail = std::move(texture);
+    entry.detailBytes = bytes;
+    entry.residentMip = residentMip;
+    m_residentBytes += bytes;
+}
+
+void TextureStreamer::DropDetail(uint32_t handle)
+{
+    auto& entry = m_entries[handle];
+    if (!entry.detail) {
+        return;
+    }
+    Rebind(handle, entry.tail->GetVkImageView());
+    VulkanContext::Get().DeferDestroy([detail = std::move(entry.detail)] {});
+    m_residentBytes -= entry.detailBytes;
+    entry.detailBytes = 0;
+    entry.residentMip = entry.tailMip;
+}
+
+void TextureStreamer::Rebind(uint32_t handle, VkImageView view)
+{
+    // A new index rather than an in-place update: frames already recorded keep sampling the
+    // old image through the old index until they retire, then both are recycled
+    auto& entry = m_entries[handle];
+    auto& bindless = VulkanContext::Get().GetBindlessResourceTable();
+    const uint32_t index = bindless.RegisterSampledImage(view);
+    if (index == BindlessResourceTable::InvalidIndex) {
+        // Table full: repoint in place rather than leave the index on a retired image
+        bindless.UpdateSampledImage(entry.bindlessIndex, view);
+        return;
+    }
+    bindless.ReleaseSampledImage(entry.bindlessIndex);
+    if (entry.bindlessIndex < m_feedbackSlots) {
+        m_handleBySlot[entry.bindlessIndex] = InvalidHandle;
+    }
+    entry.bindlessIndex = index;
+    if (index < m_feedbackSlots) {
+        m_handleBySlot[index] = handle;
+    }
+}
+
+void TextureStreamer::SetBudgetBytes(VkDeviceSize bytes)
+{
+    m_settings.budgetBytes = bytes;
+    MakeRoom(0, InvalidHandle);
+}
+
+bool TextureStreamer::MakeRoom(VkDeviceSize bytes, uint32_t requester)
+{
+    while (m_residentBytes + m_pendingBytes + bytes > m_settings.budgetBytes) {
+        // Least recently used detail image that was not requested this frame
+        uint32_t victim = InvalidHandle;
+        for (uint32_t handle = 0; handle < m_entries.size(); ++handle) {
+            const auto& entry = m_entries[handle];
+            if (handle == requester || !entry.detail || entry.pending ||
+                entry.lastUsedFrame >= m_frame) {
+                continue;
+            }
+            if (victim == InvalidHandle ||
+                entry.lastUsedFrame < m_entries[victim].lastUsedFrame) {
+                victim = handle;
+            }
+        }
+        if (victim == InvalidHandle) {
+            return false;
+        }
+        DropDetail(victim);
+    }
+    return true;
+}
+
+void TextureStreamer::ClearPending(Entry& entry)
+{
+    if (!entry.pending) {
+        return;
+    }
+    auto& upload = *entry.pending;
+    auto& vulkanCtx = VulkanContext::Get();
+    if (upload.read.valid()) {
+        // The read writes into the staging memory. Waiting on the JobSystem runs the job here
+        // if no other thread has picked it up.
+        if (m_jobSystem) {
+            m_jobSystem->Wait(upload.readJob);
+        }
+        upload.read.wait();
+        upload.staging->Unmap();
+    }
+    if (upload.fence != VK_NULL_HANDLE) {
+        vkWaitForFences(vulkanCtx.GetVkDevice(), 1, &upload.fence, VK_TRUE, UINT64_MAX);
+        vkDestroyFence(vulkanCtx.GetVkDevice(), upload.fence, vulkanCtx.GetAllocationCallbacks());
+    }
+    m_pendingBytes -= upload.bytes;
+    entry.pending.reset();
+}
+
+TextureFileInfo TextureStreamer::SliceLevels(const TextureFileInfo& info, uint32_t firstMip)
+{
+    TextureFileInfo slice = info;
+    slice.levels.assign(info.levels.begin() + firstMip, info.levels.end());
+    slice.extent = slice.levels[0].extent;
+    VkDeviceSize offset = 0;
+    for (auto& level : slice.levels) {
+        level.dstOffset = offset;
+        offset = (offset + level.size + SliceAlignment - 1) & ~(SliceAlignment - 1);
+    }
+    slice.totalSize = offset;
+    return slice;
+}
+
+std::shared_ptr<Texture2D> TextureStreamer::CreateTexture(const TextureFileInfo& slice)
+{
+    auto texture =
+        Texture2D::Create(slice.extent, slice.format, static_cast<uint32_t>(slice.levels.size()));
+    if (texture) {
+        texture->SetDebugName("TextureStreamer");
+    }
+    return texture;
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include "core/job_system.h"
+#include "core/texture_loader.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <vector>
+
+class CommandBuffer;
+class StagingBuffer;
+class Texture2D;
+
+// Streams mip chains of KTX2 textures (e.g. TextureImporter output) under a VRAM budget.
+//
+// Each texture keeps a small pinned mip tail. Detail chains are requested from feedback and
+// loaded as a separate image (file read on an I/O thread, upload submitted without waiting). Once
+// the upload's fence has signalled the texture gets a new bindless index pointing at the new
+// image and the old index and image are retired with DeferDestroy, so a frame only ever sees
+// a complete chain. Over budget, the detail images of the least recently used textures are
+// dropped back to their tails.
+//
+// GPU feedback: shaders atomicMin the biased LOD they sample into the current frame's buffer,
+// indexed by the texture's bindless index:
+//   float lod = textureQueryLod(sampler2D(g_textures[i], s), uv).y;
+//   atomicMin(g_buffers[feedbackIndex].data[i], uint(clamp(lod + 16.0, 0.0, 31.0)));
+class TextureStreamer {
+public:
+    static constexpr uint32_t InvalidHandle = ~0u;
+    // Added to the shader LOD so requests for more detail than resident stay unsigned
+    static constexpr uint32_t FeedbackLodBias = 16;
+
+    struct Settings {
+        // Detail images only; pinned tails are not counted
+        VkDeviceSize budgetBytes = 256ull << 20;
+        // Mips whose largest side is at most this many texels stay resident
+        uint32_t tailSize = 64;
+        uint32_t maxPendingUploads = 4;
+        VkDeviceSize maxUploadBytesPerFrame = 32ull << 20;
+    };
+
+    TextureStreamer() = default;
+    ~TextureStreamer() = default;
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // File reads run as Affinity::Io jobs on jobSystem, or on std::async threads without one
+    bool Initialize(const Settings& settings, JobSystem* jobSystem = nullptr);
+    void Cleanup();
+
+    // Loads the tail and registers it in the bindless table. Files without a stored mip chain
+    // are loaded whole and never streamed.
+    uint32_t Register(const std::filesystem::path& path, bool srgb = true);
+    void Release(uint32_t handle);
+
+    // Changes when a new chain is swapped in; fetch when writing per-draw data
+    uint32_t GetBindlessIndex(uint32_t handle) const;
+    // Bindless storage buffer index of the current frame's feedback buffer
+    uint32_t GetFeedbackBufferIndex() const;
+
+    // CPU-side request (e.g. from projected screen size) merged with GPU feedback
+    void RequestMip(uint32_t handle, uint32_t mip);
+
+    // Once per frame after VulkanContext::AcquireNextImage, on the render thread
+    void Update();
+
+    uint32_t GetResidentMip(uint32_t handle) const;
+    VkDeviceSize GetResidentBytes() const { return m_residentBytes; }
+    VkDeviceSize GetBudgetBytes() const { return m_settings.budgetBytes; }
+    // Lowering the budget drops least recently used detail images right away, e.g. from a
+    // GpuMemoryTracker budget callback
+    void SetBudgetBytes(VkDeviceSize bytes);
+
+private:
+    struct PendingUpload {
+        uint32_t firstMip = 0;
+        VkDeviceSize bytes = 0;
+        TextureFileInfo info;
+        std::shared_ptr<StagingBuffer> staging;
+        std::future<bool> read;
+        // The read job on the JobSystem, waited on by ClearPending
+        JobCounter readJob;
+        std::shared_ptr<Texture2D> texture;
+        std::shared_ptr<CommandBuffer> commandBuffer;
+        VkFence fence = VK_NULL_HANDLE;
+    };
+
+    struct Entry {
+        bool used = false;
+        std::filesystem::path path;
+        TextureFileInfo info;
+        uint32_t tailMip = 0;
+        std::shared_ptr<Texture2D> tail;
+        std::shared_ptr<Texture2D> detail;
+        uint32_t residentMip = 0;
+        VkDeviceSize detailBytes = 0;
+        uint32_t bindlessIndex = ~0u;
+        // Smallest mip requested since the last Update / as of the last Update
+        uint32_t requestedMip = 0;
+        uint32_t wantedMip = 0;
+        uint64_t lastUsedFrame = 0;
+        std::unique_ptr<PendingUpload> pending;
+    };
+
+    // Levels firstMip.. of info with destination offsets for a tightly packed staging buffer
+    static TextureFileInfo SliceLevels(const TextureFileInfo& info, uint32_t firstMip);
+    static std::shared_ptr<Texture2D> CreateTexture(const TextureFileInfo& slice);
+
+    void ReadFeedback();
+    bool StartUpload(uint32_t handle, uint32_t firstMip);
+    void PollUpload(uint32_t handle);
+    void SwapIn(uint32_t handle, std::shared_ptr<Texture2D> texture, uint32_t residentMip,
+                VkDeviceSize bytes);
+    void DropDetail(uint32_t handle);
+    // Moves the texture to a fresh bindless index for view and retires the old one
+    void Rebind(uint32_t handle, VkImageView view);
+    // Evicts LRU detail images until extra bytes fit, false if they cannot
+    bool MakeRoom(VkDeviceSize bytes, uint32_t requester);
+    // Waits for any outstanding read / upload and frees it
+    void ClearPending(Entry& entry);
+
+    Settings m_settings;
+    JobSystem* m_jobSystem = nullptr;
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_freeHandles;
+    // Bindless sampled image index -> handle, for mapping feedback slots
+    std::vector<uint32_t> m_handleBySlot;
+
+    VkBuffer m_feedbackBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory m_feedbackMemory = VK_NULL_HANDLE;
+    uint32_t* m_feedbackMapped = nullptr;
+    uint32_t m_feedbackSlots = 0;
+    std::vector<uint32_t> m_feedbackIndices;
+
+    VkDeviceSize m_residentBytes = 0;
+    VkDeviceSize m_pendingBytes = 0;
+    uint64_t m_frame = 0;
+};
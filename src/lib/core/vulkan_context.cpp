@@ -2,11 +2,21 @@
 #include "command_buffer.h"
 #include "swapchain.h"
 #include "surface_provider.h"
+#include "pipeline_layout_cache.h"
+#include "bindless_resource_table.h"
+#include "job_system.h"
+#include "startup_profiler.h"
+#include "gpu_memory_tracker.h"
+#include "host_allocator.h"
 
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
 #include <assert.h>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
 #if defined(WIN32)
 #   include <Windows.h>
 #endif
@@ -45,14 +55,108 @@ VulkanContext &VulkanContext::Get()
 }
 
 void VulkanContext::Initialize(const char *appName,
-                               ISurfaceProvider *surfaceProvider) {
+                               ISurfaceProvider *surfaceProvider, JobSystem* jobSystem) {
+    ScopedStartupPhase initializePhase("vulkan: initialize");
     m_surfaceProvider = surfaceProvider;
-    CreateInstance(appName); // CX^X̍쐬
-    PickPhysicalDevice();    // foCX̑I
-    CreateDebugMessenger(); // fobO@\̏
-    CreateLogicalDevice();  // _foCX̍쐬
-    CreateCommandPool();    // R}hv[̍쐬
-    CreateDescriptorPool(); // fBXNv^v[̍쐬
+
+    // The cache file does not depend on the device, so it is read while the device is created.
+    // Shared with the read job, which may outlive this call if device creation throws.
+    struct PipelineCacheFile {
+        std::vector<uint8_t> data;
+        JobCounter read;
+    };
+    auto cacheFile = std::make_shared<PipelineCacheFile>();
+    auto readPipelineCache = [path = m_pipelineCachePath, cacheFile] {
+        ScopedStartupPhase phase("vulkan: pipeline cache read");
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (file) {
+            cacheFile->data.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0).read(reinterpret_cast<char*>(cacheFile->data.data()),
+                               std::streamsize(cacheFile->data.size()));
+            if (!file) {
+                cacheFile->data.clear();
+            }
+        }
+    };
+    if (!m_pipelineCachePath.empty()) {
+        if (jobSystem) {
+            jobSystem->Submit(readPipelineCache, &cacheFile->read, JobSystem::Affinity::Io);
+        }
+        else {
+            readPipelineCache();
+        }
+    }
+
+    if (!m_hostAllocator) {
+        m_hostAllocator = std::make_unique<HostAllocator>();
+    }
+    m_allocationCallbacks = m_hostAllocatorEnabled ? m_hostAllocator->GetCallbacks() : nullptr;
+
+    {
+        ScopedStartupPhase phase("vulkan: instance");
+        CreateInstance(appName); // CX^X̍쐬
+    }
+    {
+        ScopedStartupPhase phase("vulkan: physical device");
+        PickPhysicalDevice();    // foCX̑I
+    }
+    {
+        ScopedStartupPhase phase("vulkan: debug messenger");
+        CreateDebugMessenger(); // fobO@\̏
+    }
+    {
+        ScopedStartupPhase phase("vulkan: logical device");
+        CreateLogicalDevice();  // _foCX̍쐬
+    }
+    m_memoryTracker = std::make_unique<GpuMemoryTracker>();
+    m_memoryTracker->Initialize(m_vkPhysicalDevice, m_memoryBudgetSupported);
+
+    // Objects that only need the device; created as jobs when there is a job system.
+    // Exceptions are carried back to this thread.
+    m_pipelineLayoutCache = std::make_unique<PipelineLayoutCache>();
+    m_bindlessResourceTable = std::make_unique<BindlessResourceTable>();
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    JobCounter deviceObjects;
+    auto create = [&](const char* name, std::function<void()> function) {
+        auto job = [&error, &errorMutex, name, function = std::move(function)] {
+            ScopedStartupPhase phase(name);
+            try {
+                function();
+            }
+            catch (...) {
+                std::lock_guard lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        };
+        if (jobSystem) {
+            jobSystem->Submit(std::move(job), &deviceObjects);
+        }
+        else {
+            job();
+        }
+    };
+    create("vulkan: command pool", [this] {
+        CreateCommandPool();    // R}hv[̍쐬
+    });
+    create("vulkan: descriptor pool", [this] {
+        CreateDescriptorPool(); // fBXNv^v[̍쐬
+    });
+    create("vulkan: bindless table", [this] { m_bindlessResourceTable->Initialize(); });
+    create("vulkan: pipeline cache", [this, jobSystem, cacheFile] {
+        if (jobSystem) {
+            jobSystem->Wait(cacheFile->read);
+        }
+        CreatePipelineCache(cacheFile->data);
+    });
+    if (jobSystem) {
+        jobSystem->Wait(deviceObjects);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
 }
 
 void VulkanContext::Cleanup()
@@ -61,7 +165,27 @@ void VulkanContext::Cleanup()
     vkDeviceWaitIdle(m_vkDevice);
 
     DestroyFrameContexts();
-    vkDestroyCommandPool(m_vkDevice, m_commandPool, nullptr);
+    if (m_bindlessResourceTable) {
+        m_bindlessResourceTable->Cleanup();
+        m_bindlessResourceTable.reset();
+    }
+    if (m_pipelineLayoutCache) {
+        m_pipelineLayoutCache->Cleanup();
+        m_pipelineLayoutCache.reset();
+    }
+    SavePipelineCache();
+    if (m_memoryTracker) {
+        if (auto count = m_memoryTracker->GetAllocationCount(); count > 0) {
+            std::cerr << "[memory] " << count << " allocation(s), "
+                      << m_memoryTracker->GetTrackedBytes() << " bytes still live at Cleanup"
+                      << std::endl;
+        }
+    }
+    vkDestroyPipelineCache(m_vkDevice, m_pipelineCache, m_allocationCallbacks);
+    m_pipelineCache = VK_NULL_HANDLE;
+    vkDestroyDescriptorPool(m_vkDevice, m_descriptorPool, m_allocationCallbacks);
+    m_descriptorPool = VK_NULL_HANDLE;
+    vkDestroyCommandPool(m_vkDevice, m_commandPool, m_allocationCallbacks);
 
     if (m_debugMessenger != VK_NULL_HANDLE) {
         auto func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(
@@ -82,7 +206,7 @@ void VulkanContext::Cleanup()
         m_surface = VK_NULL_HANDLE;
     }
 
-    vkDestroyDevice(m_vkDevice, nullptr);
+    vkDestroyDevice(m_vkDevice, m_allocationCallbacks);
     vkDestroyInstance(m_vkInstance, nullptr);
     m_vkDevice = VK_NULL_HANDLE;
     m_vkInstance = VK_NULL_HANDLE;
@@ -122,10 +246,24 @@ std::shared_ptr<CommandBuffer> VulkanContext::CreateCommandBuffer()
 
 VkDescriptorSet
 VulkanContext::AllocateDescriptorSet(VkDescriptorSetLayout layout) {
-  return VkDescriptorSet();
+    VkDescriptorSetAllocateInfo allocInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = m_descriptorPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &layout,
+    };
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    if (vkAllocateDescriptorSets(m_vkDevice, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+    return descriptorSet;
 }
 
-void VulkanContext::FreeDescriptorSet(VkDescriptorSet descriptorSet) {}
+void VulkanContext::FreeDescriptorSet(VkDescriptorSet descriptorSet) {
+    if (descriptorSet != VK_NULL_HANDLE) {
+        vkFreeDescriptorSets(m_vkDevice, m_descriptorPool, 1, &descriptorSet);
+    }
+}
 
 VkResult VulkanContext::AcquireNextImage()
 {
@@ -133,6 +271,10 @@ VkResult VulkanContext::AcquireNextImage()
     auto fence = frame->inFlightFence;
     vkWaitForFences(m_vkDevice, 1, &fence, VK_TRUE, UINT64_MAX);
 
+    RunDeferredDestroy(*frame);
+    m_memoryTracker->OnFrame();
+    m_hostAllocator->OnFrame();
+
     auto result = m_swapchain->AcquireNextImage();
     if (result == VK_SUCCESS) {
         vkResetFences(m_vkDevice, 1, &fence);
@@ -165,6 +307,7 @@ void VulkanContext::SubmitPresent()
     submitInfo.signalSemaphoreCount = 1;
     submitInfo.pSignalSemaphores = &renderCompleteSem;
     auto result = vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, frame.inFlightFence);
+    ++m_submitCount;
     assert(result != VK_ERROR_DEVICE_LOST); // foCXXgԂȂ炱ŏI
 
     // GraphicesQueuePresentT|[gĂƂ̓`FbNς
@@ -175,6 +318,56 @@ void VulkanContext::SubmitPresent()
 void VulkanContext::SubmitAndWait(
     std::shared_ptr<CommandBuffer> commandBuffer)
 {
+    VkFenceCreateInfo fenceCI{
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+    VkFence fence = VK_NULL_HANDLE;
+    vkCreateFence(m_vkDevice, &fenceCI, m_allocationCallbacks, &fence);
+
+    VkCommandBuffer vkCommandBuffer = commandBuffer->Get();
+    VkSubmitInfo submitInfo{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &vkCommandBuffer,
+    };
+    auto result = vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, fence);
+    ++m_submitCount;
+    assert(result != VK_ERROR_DEVICE_LOST);
+    vkWaitForFences(m_vkDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+    vkDestroyFence(m_vkDevice, fence, m_allocationCallbacks);
+}
+
+void VulkanContext::CreateOffscreenFrames()
+{
+    if (m_frameContext.empty()) {
+        CreateFrameContexts();
+    }
+}
+
+void VulkanContext::BeginOffscreenFrame()
+{
+    auto* frame = GetCurrentFrameContext();
+    auto fence = frame->inFlightFence;
+    vkWaitForFences(m_vkDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+    RunDeferredDestroy(*frame);
+    m_memoryTracker->OnFrame();
+    m_hostAllocator->OnFrame();
+    vkResetFences(m_vkDevice, 1, &fence);
+}
+
+void VulkanContext::SubmitOffscreenFrame()
+{
+    auto& frame = m_frameContext[GetCurrentFrameIndex()];
+    VkCommandBuffer commandBuffer = frame.commandBuffer->Get();
+    VkSubmitInfo submitInfo{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer,
+    };
+    auto result = vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, frame.inFlightFence);
+    ++m_submitCount;
+    assert(result != VK_ERROR_DEVICE_LOST);
+    AdvanceFrame();
 }
 
 VulkanContext::FrameContext* VulkanContext::GetCurrentFrameContext()
@@ -182,6 +375,25 @@ VulkanContext::FrameContext* VulkanContext::GetCurrentFrameContext()
     return &m_frameContext[m_currentFrameIndex];
 }
 
+void VulkanContext::DeferDestroy(std::function<void()> destroyFunc)
+{
+    if (m_frameContext.empty()) {
+        // No frames in flight yet
+        destroyFunc();
+        return;
+    }
+    GetCurrentFrameContext()->deferredDestroy.push_back(std::move(destroyFunc));
+}
+
+void VulkanContext::RunDeferredDestroy(FrameContext& frame)
+{
+    auto pending = std::move(frame.deferredDestroy);
+    frame.deferredDestroy.clear();
+    for (auto& destroyFunc : pending) {
+        destroyFunc();
+    }
+}
+
 uint32_t VulkanContext::FindMemoryType(const VkMemoryRequirements &requirements,
                                        VkMemoryPropertyFlags properties) const
 {
@@ -198,6 +410,56 @@ uint32_t VulkanContext::FindMemoryType(const VkMemoryRequirements &requirements,
   return 0;
 }
 
+bool VulkanContext::HasMemoryType(const VkMemoryRequirements& requirements,
+                                  VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++) {
+        if ((requirements.memoryTypeBits & (1 << i)) != 0 &&
+            (m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return true;
+        }
+    }
+    return false;
+}
+
+VkDeviceMemory VulkanContext::AllocateMemory(const VkMemoryRequirements& requirements,
+                                             VkMemoryPropertyFlags properties,
+                                             GpuMemoryCategory category, const char* name,
+                                             const void* pNext)
+{
+    const uint32_t memoryTypeIndex = FindMemoryType(requirements, properties);
+    VkMemoryAllocateInfo allocInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = pNext,
+        .allocationSize = requirements.size,
+        .memoryTypeIndex = memoryTypeIndex,
+    };
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    if (vkAllocateMemory(m_vkDevice, &allocInfo, m_allocationCallbacks, &memory) != VK_SUCCESS) {
+        std::cerr << "[memory] failed to allocate " << requirements.size << " bytes for "
+                  << (name != nullptr ? name : "unnamed") << std::endl;
+        return VK_NULL_HANDLE;
+    }
+    m_memoryTracker->OnAllocate(memory, requirements.size, memoryTypeIndex, category, name);
+    SetDebugObjectName(reinterpret_cast<void*>(memory), VK_OBJECT_TYPE_DEVICE_MEMORY, name);
+    return memory;
+}
+
+void VulkanContext::FreeMemory(VkDeviceMemory memory)
+{
+    if (memory == VK_NULL_HANDLE) {
+        return;
+    }
+    m_memoryTracker->OnFree(memory);
+    vkFreeMemory(m_vkDevice, memory, m_allocationCallbacks);
+}
+
+void VulkanContext::SetMemoryName(VkDeviceMemory memory, const char* name)
+{
+    m_memoryTracker->SetName(memory, name);
+    SetDebugObjectName(reinterpret_cast<void*>(memory), VK_OBJECT_TYPE_DEVICE_MEMORY, name);
+}
+
 void VulkanContext::SetDebugObjectName(void* objectHandle, VkObjectType type, const char* name)
 {
 #if _DEBUG || DEBUG
@@ -295,6 +557,17 @@ void VulkanContext::CreateLogicalDevice() {
     std::vector<const char*> deviceExtensions = {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME,
     };
+    if (m_descriptorBufferSupported) {
+        deviceExtensions.push_back(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+    }
+    m_pushDescriptorSupported = IsDeviceExtensionSupported(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+    if (m_pushDescriptorSupported) {
+        deviceExtensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+    }
+    m_memoryBudgetSupported = IsDeviceExtensionSupported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (m_memoryBudgetSupported) {
+        deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
 
     float priority = 1.0f;
     VkDeviceQueueCreateInfo queueInfo{};
@@ -313,7 +586,8 @@ void VulkanContext::CreateLogicalDevice() {
     deviceInfo.pNext = &m_physicalDevFeatures;
     deviceInfo.pEnabledFeatures = nullptr; // VkPhysicalDeviceFeatures͎gȂ
 
-    auto result = vkCreateDevice(m_vkPhysicalDevice, &deviceInfo, nullptr, &m_vkDevice);
+    auto result =
+        vkCreateDevice(m_vkPhysicalDevice, &deviceInfo, m_allocationCallbacks, &m_vkDevice);
     if (result != VK_SUCCESS) {
         throw std::runtime_error("failed to create logical device!");
     }
@@ -349,11 +623,84 @@ void VulkanContext::CreateCommandPool() {
     };
     commandPoolCI.queueFamilyIndex = m_graphicsQueueFamilyIndex;
     commandPoolCI.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    vkCreateCommandPool(m_vkDevice, &commandPoolCI, nullptr, &m_commandPool);
+    vkCreateCommandPool(m_vkDevice, &commandPoolCI, m_allocationCallbacks, &m_commandPool);
 }
 
 void VulkanContext::CreateDescriptorPool()
 {
+    // Long-lived sets; per-frame descriptors come from DescriptorAllocator
+    constexpr uint32_t maxSets = 1024;
+    VkDescriptorPoolSize poolSizes[] = {
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, maxSets},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, maxSets},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxSets},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxSets},
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, maxSets},
+        {VK_DESCRIPTOR_TYPE_SAMPLER, maxSets},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, maxSets},
+    };
+    VkDescriptorPoolCreateInfo poolCI{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
+        .maxSets = maxSets,
+        .poolSizeCount = static_cast<uint32_t>(std::size(poolSizes)),
+        .pPoolSizes = poolSizes,
+    };
+    if (vkCreateDescriptorPool(m_vkDevice, &poolCI, m_allocationCallbacks, &m_descriptorPool) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+}
+
+void VulkanContext::CreatePipelineCache(const std::vector<uint8_t>& initialData)
+{
+    // Data from another driver or device is dropped here rather than handed to the driver
+    VkPipelineCacheHeaderVersionOne header{};
+    bool usable = initialData.size() >= sizeof(header);
+    if (usable) {
+        std::memcpy(&header, initialData.data(), sizeof(header));
+        usable = header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                 header.vendorID == m_physicalDeviceProperties.vendorID &&
+                 header.deviceID == m_physicalDeviceProperties.deviceID &&
+                 std::memcmp(header.pipelineCacheUUID, m_physicalDeviceProperties.pipelineCacheUUID,
+                             VK_UUID_SIZE) == 0;
+    }
+    VkPipelineCacheCreateInfo cacheCI{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = usable ? initialData.size() : 0,
+        .pInitialData = usable ? initialData.data() : nullptr,
+    };
+    if (vkCreatePipelineCache(m_vkDevice, &cacheCI, m_allocationCallbacks, &m_pipelineCache) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+}
+
+void VulkanContext::SavePipelineCache()
+{
+    if (m_pipelineCache == VK_NULL_HANDLE || m_pipelineCachePath.empty()) {
+        return;
+    }
+    size_t size = 0;
+    vkGetPipelineCacheData(m_vkDevice, m_pipelineCache, &size, nullptr);
+    std::vector<uint8_t> data(size);
+    if (size == 0 ||
+        vkGetPipelineCacheData(m_vkDevice, m_pipelineCache, &size, data.data()) != VK_SUCCESS) {
+        return;
+    }
+    // Written beside the old file and renamed, so an interrupted write never leaves a torn cache
+    auto tempPath = m_pipelineCachePath;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), std::streamsize(size));
+        if (!file) {
+            std::cerr << "[vulkan] failed to write " << tempPath.string() << std::endl;
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, m_pipelineCachePath, ec);
 }
 
 void VulkanContext::CreateFrameContexts()
@@ -365,14 +712,16 @@ void VulkanContext::CreateFrameContexts()
             .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
             .flags = VK_FENCE_CREATE_SIGNALED_BIT,
         };
-        vkCreateFence(m_vkDevice, &fenceCI, nullptr, &frame.inFlightFence);
+        vkCreateFence(m_vkDevice, &fenceCI, m_allocationCallbacks, &frame.inFlightFence);
     }
 }
 
 void VulkanContext::DestroyFrameContexts()
 {
+    // Callers guarantee the device is idle here
     for (auto& frame : m_frameContext) {
-        vkDestroyFence(m_vkDevice, frame.inFlightFence, nullptr);
+        RunDeferredDestroy(frame);
+        vkDestroyFence(m_vkDevice, frame.inFlightFence, m_allocationCallbacks);
     }
     m_frameContext.clear();
 }
@@ -385,12 +734,77 @@ void VulkanContext::AdvanceFrame()
 void VulkanContext::BuildVkFeatures(){
     // foCXT|[g͈͂̏擾ŁAĝL
     // ŃT|[gĂȂ@\LɂƁAfoCX쐬ɃG[ɂȂ
-    BuildVkExtentionChain(m_physicalDevFeatures, m_vulkan11Features,
-                          m_vulkan12Features, m_vulkan13Features);
+    m_descriptorBufferSupported = IsDeviceExtensionSupported(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+    if (m_descriptorBufferSupported) {
+        BuildVkExtentionChain(m_physicalDevFeatures, m_vulkan11Features, m_vulkan12Features,
+                              m_vulkan13Features, m_descriptorBufferFeatures);
+    }
+    else {
+        BuildVkExtentionChain(m_physicalDevFeatures, m_vulkan11Features,
+                              m_vulkan12Features, m_vulkan13Features);
+    }
     // T|[g擾
     vkGetPhysicalDeviceFeatures2(m_vkPhysicalDevice, &m_physicalDevFeatures);
 
     // @\L
     m_vulkan13Features.dynamicRendering = VK_TRUE;
     m_vulkan13Features.synchronization2 = VK_TRUE;
+
+    // Descriptor indexing for the global bindless table
+    const bool descriptorIndexingSupported =
+        m_vulkan12Features.descriptorIndexing &&
+        m_vulkan12Features.runtimeDescriptorArray &&
+        m_vulkan12Features.descriptorBindingPartiallyBound &&
+        m_vulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+        m_vulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+        m_vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+        m_vulkan12Features.shaderSampledImageArrayNonUniformIndexing;
+    if (!descriptorIndexingSupported) {
+        throw std::runtime_error("physical device does not support descriptor indexing!");
+    }
+    m_vulkan12Features.descriptorIndexing = VK_TRUE;
+    m_vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+    m_vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+    m_vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    m_vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    m_vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    m_vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+
+    // Optional GPU-driven drawing: compute-written commands whose count is read from a buffer,
+    // with the object index carried in firstInstance
+    m_drawIndirectCountSupported = m_vulkan12Features.drawIndirectCount &&
+                                   m_physicalDevFeatures.features.multiDrawIndirect &&
+                                   m_physicalDevFeatures.features.drawIndirectFirstInstance;
+    if (m_drawIndirectCountSupported) {
+        m_vulkan12Features.drawIndirectCount = VK_TRUE;
+        m_physicalDevFeatures.features.multiDrawIndirect = VK_TRUE;
+        m_physicalDevFeatures.features.drawIndirectFirstInstance = VK_TRUE;
+    }
+
+    // VK_EXT_descriptor_buffer is optional; DescriptorAllocator falls back to descriptor sets
+    m_descriptorBufferSupported = m_descriptorBufferSupported &&
+                                  m_descriptorBufferFeatures.descriptorBuffer &&
+                                  m_vulkan12Features.bufferDeviceAddress;
+    if (m_descriptorBufferSupported) {
+        m_descriptorBufferFeatures.descriptorBuffer = VK_TRUE;
+        m_vulkan12Features.bufferDeviceAddress = VK_TRUE;
+    }
+    else {
+        // Drop the extension struct from the chain; the extension will not be enabled
+        m_vulkan13Features.pNext = nullptr;
+    }
+}
+
+bool VulkanContext::IsDeviceExtensionSupported(const char* name) const
+{
+    uint32_t count = 0;
+    vkEnumerateDeviceExtensionProperties(m_vkPhysicalDevice, nullptr, &count, nullptr);
+    std::vector<VkExtensionProperties> extensions(count);
+    vkEnumerateDeviceExtensionProperties(m_vkPhysicalDevice, nullptr, &count, extensions.data());
+    for (const auto& extension : extensions) {
+        if (strcmp(extension.extensionName, name) == 0) {
+            return true;
+        }
+    }
+    return false;
 }
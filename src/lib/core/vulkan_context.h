@@ -3,18 +3,35 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <filesystem>
 #include <cstdint>
 
+class JobSystem;
 class Swapchain;
 class CommandBuffer;
 class ISurfaceProvider;
+class PipelineLayoutCache;
+class BindlessResourceTable;
+class GpuMemoryTracker;
+class HostAllocator;
+enum class GpuMemoryCategory : uint32_t;
 
 class VulkanContext {
 public:
     static constexpr uint32_t MaxInflightFrame = 2;
     static VulkanContext& Get();
 
-    void Initialize(const char* appName, ISurfaceProvider* surfaceProvider);
+    // Every phase is recorded in StartupProfiler. With a job system the pipeline cache file is
+    // read on an I/O thread while the instance and device are created, and the objects that
+    // only need the device are created in parallel.
+    void Initialize(const char* appName, ISurfaceProvider* surfaceProvider,
+                    JobSystem* jobSystem = nullptr);
+
+    // Before Initialize. The pipeline cache is loaded from this file and written back in
+    // Cleanup; empty keeps it in memory only.
+    void SetPipelineCachePath(const std::filesystem::path& path) { m_pipelineCachePath = path; }
+    // Before Initialize. Off passes nullptr allocation callbacks to the driver everywhere.
+    void SetHostAllocatorEnabled(bool enabled) { m_hostAllocatorEnabled = enabled; }
 
     void Cleanup();
 
@@ -26,6 +43,28 @@ public:
     VkDevice GetVkDevice() const { return m_vkDevice; }
     VkPhysicalDevice GetVkPhysicalDevice() const { return m_vkPhysicalDevice; }
     VkDescriptorPool GetVkDescriptorPool() const { return m_descriptorPool; }
+    // Shared by every pipeline creation; internally synchronized
+    VkPipelineCache GetPipelineCache() const { return m_pipelineCache; }
+
+    // True when VK_EXT_descriptor_buffer (and buffer device address) were enabled
+    bool IsDescriptorBufferSupported() const { return m_descriptorBufferSupported; }
+    // True when VK_KHR_push_descriptor was enabled
+    bool IsPushDescriptorSupported() const { return m_pushDescriptorSupported; }
+    // True when drawIndirectCount, multiDrawIndirect and drawIndirectFirstInstance were enabled
+    bool IsDrawIndirectCountSupported() const { return m_drawIndirectCountSupported; }
+    // True when VK_EXT_memory_budget was enabled; GpuMemoryTracker reports driver budgets
+    bool IsMemoryBudgetSupported() const { return m_memoryBudgetSupported; }
+
+    const VkPhysicalDeviceProperties& GetPhysicalDeviceProperties() const
+    {
+        return m_physicalDeviceProperties;
+    }
+    // Sample counts usable for a color attachment together with a depth attachment
+    VkSampleCountFlags GetSupportedSampleCounts() const
+    {
+        const auto& limits = m_physicalDeviceProperties.limits;
+        return limits.framebufferColorSampleCounts & limits.framebufferDepthSampleCounts;
+    }
 
     VkQueue GetGraphicsQueue() const { return m_graphicsQueue; }
     uint32_t GetGraphicsFamily() const { return m_graphicsQueueFamilyIndex; }
@@ -46,6 +85,8 @@ public:
     struct FrameContext {
       std::shared_ptr<CommandBuffer> commandBuffer;
       VkFence inFlightFence = VK_NULL_HANDLE;
+      // Destruction deferred until this frame's fence has been waited on again
+      std::vector<std::function<void()>> deferredDestroy;
     };
     // ݂̃t[ReLXg擾
     uint32_t GetCurrentFrameIndex() const { return m_currentFrameIndex; }
@@ -61,12 +102,56 @@ public:
     // ݂̃t[ReLXg̎擾
     FrameContext* GetCurrentFrameContext();
 
+    // Headless rendering without a surface: creates the frame contexts that
+    // BeginOffscreenFrame / SubmitOffscreenFrame use in place of AcquireNextImage / SubmitPresent
+    void CreateOffscreenFrames();
+    // Waits for the current frame slot, runs its deferred destruction and resets its fence
+    void BeginOffscreenFrame();
+    // Submits the current frame context's command buffer and advances the frame
+    void SubmitOffscreenFrame();
+
+    // Queue submissions made through this context since Initialize
+    uint64_t GetSubmitCount() const { return m_submitCount; }
+
+    // Defers destroying an object that in-flight frames may still reference.
+    // The function runs once every frame submitted before this call has completed.
+    void DeferDestroy(std::function<void()> destroyFunc);
+
     // Xbv`FC̎擾
     std::unique_ptr<Swapchain> &GetSwapchain() { return m_swapchain; }
 
+    // Shared descriptor set layout / pipeline layout cache
+    PipelineLayoutCache& GetPipelineLayoutCache() { return *m_pipelineLayoutCache; }
+
+    // Global bindless descriptor set (descriptor indexing)
+    BindlessResourceTable& GetBindlessResourceTable() { return *m_bindlessResourceTable; }
+
     // ^Cv̎擾
     uint32_t FindMemoryType(const VkMemoryRequirements &requirements,
                             VkMemoryPropertyFlags properties) const;
+    // Like FindMemoryType, but reports a missing type instead of throwing
+    bool HasMemoryType(const VkMemoryRequirements& requirements,
+                       VkMemoryPropertyFlags properties) const;
+
+    // Allocates device memory from a type matching requirements and properties, tagged for
+    // GpuMemoryTracker. pNext is chained onto VkMemoryAllocateInfo. Returns VK_NULL_HANDLE on
+    // failure.
+    VkDeviceMemory AllocateMemory(const VkMemoryRequirements& requirements,
+                                  VkMemoryPropertyFlags properties, GpuMemoryCategory category,
+                                  const char* name, const void* pNext = nullptr);
+    void FreeMemory(VkDeviceMemory memory);
+    // Renames an allocation in the tracker and, in debug builds, for validation / capture tools
+    void SetMemoryName(VkDeviceMemory memory, const char* name);
+
+    // Live device memory by category and heap, budget callbacks and JSON dumps
+    GpuMemoryTracker& GetMemoryTracker() { return *m_memoryTracker; }
+
+    // For every vkCreate* / vkDestroy* / vkAllocateMemory / vkFreeMemory on the device; an
+    // object must be destroyed with the callbacks it was created with. nullptr when the host
+    // allocator is disabled.
+    const VkAllocationCallbacks* GetAllocationCallbacks() const { return m_allocationCallbacks; }
+    // Driver host allocation statistics and the steady-state allocation check
+    HostAllocator& GetHostAllocator() { return *m_hostAllocator; }
 
     // Function Callback(s)
     std::function<void(std::vector<const char*>&)> GetWindowSystemExtensions;
@@ -86,11 +171,15 @@ private:
     void CreateDebugMessenger();
     void CreateCommandPool();
     void CreateDescriptorPool();
+    void CreatePipelineCache(const std::vector<uint8_t>& initialData);
+    void SavePipelineCache();
     void CreateFrameContexts();
     void DestroyFrameContexts();
 
     void AdvanceFrame();
+    void RunDeferredDestroy(FrameContext& frame);
     void BuildVkFeatures();
+    bool IsDeviceExtensionSupported(const char* name) const;
 
     ISurfaceProvider* m_surfaceProvider{};
     VkInstance m_vkInstance{};
@@ -106,13 +195,26 @@ private:
     VkSurfaceKHR m_surface;
     VkCommandPool m_commandPool{};
     VkDescriptorPool m_descriptorPool{};
+    VkPipelineCache m_pipelineCache{};
+    std::filesystem::path m_pipelineCachePath;
     std::vector<FrameContext> m_frameContext;
     std::unique_ptr<Swapchain> m_swapchain{};
+    std::unique_ptr<PipelineLayoutCache> m_pipelineLayoutCache{};
+    std::unique_ptr<BindlessResourceTable> m_bindlessResourceTable{};
+    std::unique_ptr<GpuMemoryTracker> m_memoryTracker{};
+    std::unique_ptr<HostAllocator> m_hostAllocator{};
+    const VkAllocationCallbacks* m_allocationCallbacks{};
+    bool m_hostAllocatorEnabled = true;
 
     VkDebugUtilsMessengerEXT m_debugMessenger{};
     PFN_vkSetDebugUtilsObjectNameEXT m_pfnSetDebugUtilsObjectNameEXT{};
 
     uint32_t m_currentFrameIndex{0};
+    uint64_t m_submitCount{0};
+    bool m_descriptorBufferSupported = false;
+    bool m_pushDescriptorSupported = false;
+    bool m_drawIndirectCountSupported = false;
+    bool m_memoryBudgetSupported = false;
 
     // ------- Vulkan Feature Structures -------
     VkPhysicalDeviceFeatures2 m_physicalDevFeatures {
@@ -127,6 +229,9 @@ private:
     VkPhysicalDeviceVulkan13Features m_vulkan13Features {
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES
     };
+    VkPhysicalDeviceDescriptorBufferFeaturesEXT m_descriptorBufferFeatures {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT
+    };
     VkPhysicalDeviceShaderAtomicFloatFeaturesEXT m_atomicFloatFeatures {
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_ATOMIC_FLOAT_FEATURES_EXT
     };
@@ -0,0 +1,260 @@
+#include "async_load_app.h"
+#include "core/asset_archive.h"
+#include "core/asset_path.h"
+#include "core/command_buffer.h"
+#include "core/graphics_pipeline_builder.h"
+#include "core/pipeline_layout_cache.h"
+#include "core/startup_profiler.h"
+#include "core/swapchain.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr uint32_t CubeCount = AsyncLoadApp::GridSize * AsyncLoadApp::GridSize * AsyncLoadApp::GridSize;
+// Distance between neighbouring cube centers
+constexpr float GridSpacing = 1.5f;
+
+} // namespace
+
+void AsyncLoadApp::OnPreInitialize()
+{
+    ScopedStartupPhase phase("app: request assets");
+    auto assetPath = FindAssetRootPath();
+    if (!assetPath.empty()) {
+        SetAssetRootPath(assetPath);
+    }
+    // Packed assets when assets.vpak exists; loose files still take precedence
+    MountAssetArchive(GetDefaultAssetArchivePath());
+
+    // No device yet: I/O starts now, device work waits for OnDeviceReady
+    AssetManager::Settings settings{};
+    settings.deviceReady = false;
+    if (!m_assets.Initialize(m_jobSystem, settings)) {
+        throw std::runtime_error("Failed to start asset manager.");
+    }
+    RequestAssets();
+}
+
+void AsyncLoadApp::OnInitialize()
+{
+    // Only what the first frame needs is created here; everything else is already loading
+    auto& swapchain = VulkanContext::Get().GetSwapchain();
+    m_depthBuffer = DepthBuffer::Create(swapchain->GetExtent(), DepthFormat);
+    if (!m_depthBuffer) {
+        throw std::runtime_error("Failed to create depth buffer.");
+    }
+    constexpr uint32_t MaxVertices = 64 * 1024;
+    constexpr uint32_t MaxIndices = 256 * 1024;
+    if (!m_geometry.Initialize(sizeof(Vertex), MaxVertices, MaxIndices)) {
+        throw std::runtime_error("Failed to create geometry arena.");
+    }
+    if (!m_instanceStream.Initialize(sizeof(Instance), CubeCount)) {
+        throw std::runtime_error("Failed to create instance stream.");
+    }
+    m_assets.OnDeviceReady();
+    m_startTime = std::chrono::steady_clock::now();
+}
+
+void AsyncLoadApp::OnDrawFrame()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto& swapchain = vulkanCtx.GetSwapchain();
+
+    if (vulkanCtx.AcquireNextImage() != VK_SUCCESS) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        return;
+    }
+
+    // Frame boundary: submit uploads whose decode finished, publish finished assets
+    m_assets.Update();
+    const bool contentReady = IsContentReady();
+    const bool contentDone = m_pipeline.GetState() != AssetState::Pending &&
+                             m_cube.GetState() != AssetState::Pending;
+    if (contentDone && !m_contentReported) {
+        m_contentReported = true;
+        auto& profiler = StartupProfiler::Get();
+        profiler.AddEvent(contentReady ? "content ready" : "content failed");
+        profiler.Report();
+        std::printf("AsyncLoad: asset load times (vert %.2f, frag %.2f, pipeline %.2f, "
+                    "cube %.2f ms after request)\n",
+                    m_vertexShader.GetLoadMs(), m_fragmentShader.GetLoadMs(),
+                    m_pipeline.GetLoadMs(), m_cube.GetLoadMs());
+    }
+
+    const float time = std::chrono::duration<float>(std::chrono::steady_clock::now() - m_startTime)
+                           .count();
+    InstanceStream::Range range{};
+    if (contentReady) {
+        m_instanceStream.BeginFrame(vulkanCtx.GetCurrentFrameIndex());
+        range = m_instanceStream.Allocate(CubeCount);
+        WriteInstances(time, static_cast<Instance*>(range.mapped));
+    }
+
+    auto* frameCtx = vulkanCtx.GetCurrentFrameContext();
+    auto& commandBuffer = frameCtx->commandBuffer;
+    commandBuffer->Begin();
+
+    VkImageSubresourceRange colorRange{
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+    VkImageSubresourceRange depthRange = colorRange;
+    depthRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    commandBuffer->TransitionLayout(swapchain->GetCurrentImage(), colorRange,
+                                    ImageLayoutTransition::FromUndefinedToColorAttachment());
+    commandBuffer->TransitionLayout(m_depthBuffer->GetVkImage(), depthRange,
+                                    ImageLayoutTransition::FromUndefinedToDepthAttachment());
+
+    VkRenderingAttachmentInfo colorAttachment{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = swapchain->GetCurrentView(),
+        .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+        .clearValue = VkClearValue{.color = {{0.1f, 0.1f, 0.12f, 1.0f}}},
+    };
+    VkRenderingAttachmentInfo depthAttachment{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = m_depthBuffer->GetVkImageView(),
+        .imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        .clearValue = VkClearValue{.depthStencil = {1.0f, 0}},
+    };
+    VkRenderingInfo renderingInfo{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .renderArea = {{0, 0}, swapchain->GetExtent()},
+        .layerCount = 1,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &colorAttachment,
+        .pDepthAttachment = &depthAttachment,
+    };
+    vkCmdBeginRendering(*commandBuffer, &renderingInfo);
+
+    if (contentReady) {
+        const auto& pipeline = m_pipeline.Get();
+        const auto& cube = m_cube.Get().geometry;
+        vkCmdBindPipeline(*commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.pipeline);
+        const glm::mat4 viewProj = GetViewProjection(time);
+        vkCmdPushConstants(*commandBuffer, pipeline.layout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                           sizeof(viewProj), &viewProj);
+        m_geometry.Bind(*commandBuffer);
+        m_instanceStream.Bind(*commandBuffer, 1);
+        vkCmdDrawIndexed(*commandBuffer, cube.indexCount, range.count, cube.firstIndex,
+                         static_cast<int32_t>(cube.firstVertex), range.firstInstance);
+    }
+
+    vkCmdEndRendering(*commandBuffer);
+    commandBuffer->TransitionLayout(swapchain->GetCurrentImage(), colorRange,
+                                    ImageLayoutTransition::FromColorToPresent());
+    commandBuffer->End();
+    vulkanCtx.SubmitPresent();
+
+    if (!m_firstFramePresented) {
+        m_firstFramePresented = true;
+        StartupProfiler::Get().MarkFirstFrame();
+    }
+}
+
+void AsyncLoadApp::OnCleanup()
+{
+    vkDeviceWaitIdle(VulkanContext::Get().GetVkDevice());
+    m_assets.Cleanup();
+    m_instanceStream.Cleanup();
+    m_geometry.Cleanup();
+    m_depthBuffer.reset();
+}
+
+void AsyncLoadApp::RequestAssets()
+{
+    // shader file -> module -> pipeline, and glTF decode -> upload, all in flight together
+    m_vertexShader = m_assets.LoadShader("draw_stress.vert");
+    m_fragmentShader = m_assets.LoadShader("draw_stress.frag");
+
+    // The builder runs on a worker after OnDeviceReady, when the swapchain exists
+    m_pipeline = m_assets.LoadPipeline(
+        {m_vertexShader, m_fragmentShader},
+        [](std::span<const ShaderAsset* const> shaders, PipelineAsset& pipeline) {
+            auto& swapchain = VulkanContext::Get().GetSwapchain();
+            const auto& vert = *shaders[0];
+            const auto& frag = *shaders[1];
+            auto layout = VulkanContext::Get().GetPipelineLayoutCache().GetPipelineLayout(
+                {&vert.reflection, &frag.reflection});
+            pipeline.layout = layout.pipelineLayout;
+
+            GraphicsPipelineBuilder builder{};
+            builder.AddShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vert.module);
+            builder.AddShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, frag.module);
+            // Locations 0-1 per vertex (binding 0), location 2 per instance (binding 1)
+            builder.SetVertexInputInstanced(vert.reflection, 2);
+            builder.SetViewport(swapchain->GetExtent());
+            builder.SetRasterizationState(VkPipelineRasterizationStateCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+                .polygonMode = VK_POLYGON_MODE_FILL,
+                .cullMode = VK_CULL_MODE_BACK_BIT,
+                .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+                .lineWidth = 1.0f,
+            });
+            builder.SetDepthStencilState(VkPipelineDepthStencilStateCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+                .depthTestEnable = VK_TRUE,
+                .depthWriteEnable = VK_TRUE,
+                .depthCompareOp = VK_COMPARE_OP_LESS,
+            });
+            builder.SetPipelineLayout(pipeline.layout);
+            builder.UseDynamicRendering(swapchain->GetFormat().format, DepthFormat);
+            pipeline.pipeline = builder.Build();
+            return pipeline.pipeline != VK_NULL_HANDLE;
+        });
+
+    GltfVertexLayout layout{
+        .stride = sizeof(Vertex),
+        .attributes = {
+            {.semantic = "POSITION", .offset = offsetof(Vertex, position), .components = 3},
+            {.semantic = "COLOR_0", .offset = offsetof(Vertex, color), .components = 3,
+             .defaultValue = {1.0f, 1.0f, 1.0f, 1.0f}},
+        },
+    };
+    m_cube = m_assets.LoadModel("cube.gltf", layout, m_geometry);
+}
+
+bool AsyncLoadApp::IsContentReady() const
+{
+    return m_pipeline.IsReady() && m_cube.IsReady();
+}
+
+void AsyncLoadApp::WriteInstances(float time, Instance* instances) const
+{
+    const float half = 0.5f * GridSpacing * float(GridSize - 1);
+    for (uint32_t i = 0; i < CubeCount; ++i) {
+        const uint32_t x = i % GridSize;
+        const uint32_t y = (i / GridSize) % GridSize;
+        const uint32_t z = i / (GridSize * GridSize);
+        const float bob = 0.25f * std::sin(time * 2.0f + float(i) * 0.37f);
+        instances[i].positionScale = glm::vec4(GridSpacing * float(x) - half,
+                                               GridSpacing * float(y) - half + bob,
+                                               GridSpacing * float(z) - half, 1.0f);
+    }
+}
+
+glm::mat4 AsyncLoadApp::GetViewProjection(float time) const
+{
+    const float radius = 1.8f * GridSpacing * float(GridSize) + 2.0f;
+    const float angle = time * 0.2f;
+    const glm::vec3 eye{radius * std::cos(angle), 0.4f * radius, radius * std::sin(angle)};
+    const glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    const auto extent = VulkanContext::Get().GetSwapchain()->GetExtent();
+    const float aspect = float(extent.width) / float(extent.height);
+    // SetViewport flips Y, so the GL-style projection is used as is
+    const glm::mat4 proj = glm::perspective(glm::radians(60.0f), aspect, 0.1f, 4.0f * radius);
+    return proj * view;
+}
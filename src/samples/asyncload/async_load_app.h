@@ -0,0 +1,59 @@
+#pragma once
+#include "common/ISampleApp.h"
+#include "core/asset_manager.h"
+#include "core/geometry_arena.h"
+#include "core/image_resource.h"
+#include "core/instance_stream.h"
+#include "core/job_system.h"
+#include <glm/glm.hpp>
+#include <chrono>
+
+// Presents from the first frame while shaders, the pipeline and the cube model load through
+// AssetManager; the cube grid appears once its assets are ready. Loads are requested before the
+// device exists, so file I/O and SPIR-V reflection overlap device creation. Prints the startup
+// phases, time to first frame, time to content and each asset's load time.
+class AsyncLoadApp : public ISampleApp {
+public:
+    // Cubes per side of the grid
+    static constexpr uint32_t GridSize = 12;
+    static constexpr VkFormat DepthFormat = VK_FORMAT_D32_SFLOAT;
+
+    explicit AsyncLoadApp(JobSystem& jobSystem) : m_jobSystem(jobSystem) {}
+
+    virtual void OnPreInitialize() override;
+    virtual void OnInitialize() override;
+    virtual void OnDrawFrame() override;
+    virtual void OnCleanup() override;
+
+    struct Vertex {
+        glm::vec3 position;
+        glm::vec3 color;
+    };
+
+    // Per-instance vertex input (binding 1)
+    struct Instance {
+        glm::vec4 positionScale;
+    };
+
+private:
+    void RequestAssets();
+    bool IsContentReady() const;
+    void WriteInstances(float time, Instance* instances) const;
+    glm::mat4 GetViewProjection(float time) const;
+
+    std::shared_ptr<DepthBuffer> m_depthBuffer;
+    GeometryArena m_geometry;
+    InstanceStream m_instanceStream;
+
+    JobSystem& m_jobSystem;
+    AssetManager m_assets;
+    AssetHandle<ShaderAsset> m_vertexShader;
+    AssetHandle<ShaderAsset> m_fragmentShader;
+    AssetHandle<PipelineAsset> m_pipeline;
+    AssetHandle<ModelAsset> m_cube;
+
+    // Animation clock
+    std::chrono::steady_clock::time_point m_startTime;
+    bool m_firstFramePresented = false;
+    bool m_contentReported = false;
+};
@@ -0,0 +1,60 @@
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include "core/vulkan_context.h"
+#include "core/glfw_surface_provider.h"
+#include "core/job_system.h"
+#include "core/startup_profiler.h"
+#include "async_load_app.h"
+
+int main()
+{
+    // The job system comes first so asset I/O overlaps window and device creation
+    JobSystem jobSystem;
+    jobSystem.Initialize(JobSystem::Settings{});
+    AsyncLoadApp theApp{jobSystem};
+    theApp.OnPreInitialize();
+
+    GLFWwindow* window = nullptr;
+    {
+        ScopedStartupPhase phase("window");
+        glfwInit();
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+        window = glfwCreateWindow(1280, 720, "AsyncLoad", nullptr, nullptr);
+    }
+    GLFWSurfaceProvider surfaceProvider{window};
+
+    auto& vulkanCtx = VulkanContext::Get();
+    vulkanCtx.GetWindowSystemExtensions = [=](auto& extensionList) {
+        uint32_t extCount = 0;
+        const char** extensions = glfwGetRequiredInstanceExtensions(&extCount);
+        if (extCount > 0) {
+            extensionList.insert(extensionList.end(), extensions, extensions + extCount);
+        }
+    };
+    vulkanCtx.SetPipelineCachePath("AsyncLoad.pipeline_cache");
+    vulkanCtx.Initialize("AsyncLoad", &surfaceProvider, &jobSystem);
+    {
+        ScopedStartupPhase phase("vulkan: swapchain");
+        vulkanCtx.RecreateSwapchain();
+    }
+    {
+        ScopedStartupPhase phase("app: initialize");
+        theApp.OnInitialize();
+    }
+
+    while (glfwWindowShouldClose(window) == GLFW_FALSE)
+    {
+        glfwPollEvents();
+
+        theApp.OnDrawFrame();
+    }
+
+    theApp.OnCleanup();
+    vulkanCtx.Cleanup();
+    jobSystem.Cleanup();
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
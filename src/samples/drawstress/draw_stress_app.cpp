@@ -0,0 +1,660 @@
+#include "draw_stress_app.h"
+#include "core/asset_archive.h"
+#include "core/asset_path.h"
+#include "core/command_buffer.h"
+#include "core/gltf_loader.h"
+#include "core/graphics_pipeline_builder.h"
+#include "core/pipeline_layout_cache.h"
+#include "core/shader_compiler.h"
+#include "core/shader_loader.h"
+#include "core/shader_reflection.h"
+#include "core/swapchain.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Distance between neighbouring cube centers
+constexpr float GridSpacing = 1.5f;
+// Clip planes; the far plane is this multiple of the camera's orbit radius
+constexpr float NearPlane = 0.1f;
+constexpr float FarPlaneScale = 4.0f;
+
+} // namespace
+
+DrawStressApp::DrawStressApp(uint32_t cubeCount, double targetGpuMs,
+                             std::optional<PerDrawData::Path> perDrawPath)
+    : m_cubeCount(std::max(cubeCount, 1u))
+    , m_targetGpuMs(targetGpuMs)
+    , m_perDrawPath(perDrawPath)
+{
+    m_gridSize = static_cast<uint32_t>(std::ceil(std::cbrt(double(m_cubeCount))));
+}
+
+void DrawStressApp::OnInitialize()
+{
+    auto assetPath = FindAssetRootPath();
+    if (!assetPath.empty()) {
+        SetAssetRootPath(assetPath);
+    }
+    // Packed assets when assets.vpak exists; loose files still take precedence
+    MountAssetArchive(GetDefaultAssetArchivePath());
+
+    m_gpuTimerSupported = m_gpuTimer.Initialize(TimestampCount);
+    if (!m_gpuTimerSupported) {
+        std::printf("Timestamps are not supported on the graphics queue; GPU time not reported\n");
+    }
+
+    CreateRenderTargets();
+    CreateCubeGeometry();
+    CreateIndirectCommands();
+    CreateGraphicsPipeline();
+    CreatePerDrawPipeline();
+    CreateRenderQueue();
+
+    if (!m_instanceStream.Initialize(sizeof(Instance), m_cubeCount)) {
+        throw std::runtime_error("Failed to create instance stream.");
+    }
+
+    std::printf("DrawStress: %u cubes, %.0f s per mode\n", m_cubeCount, ModeDuration);
+    m_startTime = std::chrono::steady_clock::now();
+    m_modeStartTime = m_startTime;
+}
+
+void DrawStressApp::OnDrawFrame()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto& swapchain = vulkanCtx.GetSwapchain();
+
+    if (vulkanCtx.AcquireNextImage() != VK_SUCCESS) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<float>(now - m_modeStartTime).count() >= ModeDuration) {
+        NextMode(now);
+    }
+    const float time = std::chrono::duration<float>(now - m_startTime).count();
+    const uint32_t frameIndex = vulkanCtx.GetCurrentFrameIndex();
+
+    // Same per-instance data in every mode, so only the draw submission differs
+    m_instanceStream.BeginFrame(frameIndex);
+    m_uniformRing.BeginFrame(frameIndex);
+    auto range = m_instanceStream.Allocate(m_cubeCount);
+    WriteInstances(time, m_mode == Mode::PerDraw ? m_perDrawInstances.data()
+                                                 : static_cast<Instance*>(range.mapped));
+
+    const auto recordStart = std::chrono::steady_clock::now();
+    auto* frameCtx = vulkanCtx.GetCurrentFrameContext();
+    auto& commandBuffer = frameCtx->commandBuffer;
+    commandBuffer->Begin();
+
+    if (m_gpuTimerSupported) {
+        // Results of the frame that last used this slot
+        m_gpuTimer.BeginFrame(*commandBuffer);
+        const double gpuMs = m_gpuTimer.GetElapsedMs(DrawBegin, DrawEnd);
+        if (gpuMs >= 0.0 && m_slotMode[frameIndex] == m_mode) {
+            m_timings.gpuMs += gpuMs;
+            ++m_timings.gpuFrames;
+        }
+        m_slotMode[frameIndex] = m_mode;
+        if (m_dynamicResolutionEnabled) {
+            m_dynamicResolution.Update(gpuMs, m_slotScale[frameIndex]);
+            m_slotScale[frameIndex] = m_dynamicResolution.GetScale();
+        }
+    }
+
+    VkImageSubresourceRange colorRange{
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+    VkImageSubresourceRange depthRange = colorRange;
+    depthRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+
+    const auto extent = swapchain->GetExtent();
+    VkExtent2D renderExtent = extent;
+    VkImageView colorView = swapchain->GetCurrentView();
+    VkImageView depthView = VK_NULL_HANDLE;
+    if (m_dynamicResolutionEnabled) {
+        m_dynamicResolution.BeginFrame(*commandBuffer);
+        renderExtent = m_dynamicResolution.GetRenderExtent();
+        colorView = m_dynamicResolution.GetColorTarget().GetVkImageView();
+        depthView = m_dynamicResolution.GetDepthBuffer().GetVkImageView();
+        m_timings.scale += m_dynamicResolution.GetScale();
+    }
+    else {
+        commandBuffer->TransitionLayout(swapchain->GetCurrentImage(), colorRange,
+                                        ImageLayoutTransition::FromUndefinedToColorAttachment());
+        commandBuffer->TransitionLayout(m_depthBuffer->GetVkImage(), depthRange,
+                                        ImageLayoutTransition::FromUndefinedToDepthAttachment());
+        depthView = m_depthBuffer->GetVkImageView();
+    }
+
+    VkRenderingAttachmentInfo colorAttachment{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = colorView,
+        .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+        .clearValue = VkClearValue{.color = {{0.1f, 0.1f, 0.12f, 1.0f}}},
+    };
+    VkRenderingAttachmentInfo depthAttachment{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = depthView,
+        .imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        .clearValue = VkClearValue{.depthStencil = {1.0f, 0}},
+    };
+    VkRenderingInfo renderingInfo{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .renderArea = {{0, 0}, renderExtent},
+        .layerCount = 1,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &colorAttachment,
+        .pDepthAttachment = &depthAttachment,
+    };
+
+    if (m_gpuTimerSupported) {
+        m_gpuTimer.WriteTimestamp(*commandBuffer, DrawBegin, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    }
+    vkCmdBeginRendering(*commandBuffer, &renderingInfo);
+
+    // The render queue binds the pipeline and geometry itself
+    const bool perDraw = m_mode == Mode::PerDraw;
+    const bool queued = m_mode == Mode::Individual;
+    if (!queued) {
+        vkCmdBindPipeline(*commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          perDraw ? m_perDrawPipeline : m_pipeline);
+        m_geometry.Bind(*commandBuffer);
+    }
+    if (m_dynamicResolutionEnabled) {
+        m_dynamicResolution.SetViewportAndScissor(*commandBuffer);
+    }
+    const glm::mat4 viewProj = GetViewProjection(time);
+    if (perDraw) {
+        RecordPerDraws(*commandBuffer, viewProj);
+    }
+    else {
+        vkCmdPushConstants(*commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                           sizeof(viewProj), &viewProj);
+        m_instanceStream.Bind(*commandBuffer, 1);
+        if (queued) {
+            RecordQueuedDraws(*commandBuffer, range, viewProj, time);
+        }
+        else {
+            RecordDraws(*commandBuffer, range);
+        }
+    }
+
+    vkCmdEndRendering(*commandBuffer);
+    // The upscale is part of the cost the resolution controller has to keep in budget
+    if (m_dynamicResolutionEnabled) {
+        m_dynamicResolution.RecordUpscale(*commandBuffer, swapchain->GetCurrentImage(), extent);
+    }
+    if (m_gpuTimerSupported) {
+        m_gpuTimer.WriteTimestamp(*commandBuffer, DrawEnd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    }
+
+    commandBuffer->TransitionLayout(swapchain->GetCurrentImage(), colorRange,
+                                    m_dynamicResolutionEnabled
+                                        ? ImageLayoutTransition::FromTransferDstToPresent()
+                                        : ImageLayoutTransition::FromColorToPresent());
+    commandBuffer->End();
+    const auto recordEnd = std::chrono::steady_clock::now();
+
+    vulkanCtx.SubmitPresent();
+    const auto submitEnd = std::chrono::steady_clock::now();
+
+    m_timings.recordMs += std::chrono::duration<double, std::milli>(recordEnd - recordStart).count();
+    m_timings.submitMs += std::chrono::duration<double, std::milli>(submitEnd - recordEnd).count();
+    ++m_timings.frames;
+}
+
+void DrawStressApp::OnCleanup()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+
+    vkDeviceWaitIdle(device);
+    m_renderQueue.ClearRegistrations();
+    vkDestroyPipeline(device, m_pipeline, allocator);
+    m_pipeline = VK_NULL_HANDLE;
+    vkDestroyPipeline(device, m_perDrawPipeline, allocator);
+    m_perDrawPipeline = VK_NULL_HANDLE;
+    m_perDrawData.Cleanup();
+    m_uniformRing.Cleanup();
+    m_gpuTimer.Cleanup();
+    m_instanceStream.Cleanup();
+    m_indirectCommands.reset();
+    m_geometry.Cleanup();
+    m_dynamicResolution.Cleanup();
+    m_depthBuffer.reset();
+}
+
+void DrawStressApp::CreateRenderTargets()
+{
+    auto& swapchain = VulkanContext::Get().GetSwapchain();
+    if (m_targetGpuMs > 0.0) {
+        if (!m_gpuTimerSupported) {
+            std::printf("Dynamic resolution needs timestamps; rendering at full resolution\n");
+        }
+        else {
+            DynamicResolution::Settings settings;
+            settings.targetGpuMs = m_targetGpuMs;
+            if (!m_dynamicResolution.Initialize(swapchain->GetExtent(),
+                                                swapchain->GetFormat().format, DepthFormat,
+                                                settings)) {
+                throw std::runtime_error("Failed to create dynamic resolution targets.");
+            }
+            m_dynamicResolutionEnabled = true;
+            std::fill(std::begin(m_slotScale), std::end(m_slotScale),
+                      m_dynamicResolution.GetScale());
+            std::printf("Dynamic resolution: GPU target %.2f ms\n", m_targetGpuMs);
+            return;
+        }
+    }
+
+    m_depthBuffer = DepthBuffer::Create(swapchain->GetExtent(), DepthFormat);
+    if (!m_depthBuffer) {
+        throw std::runtime_error("Failed to create depth buffer.");
+    }
+}
+
+void DrawStressApp::CreateCubeGeometry()
+{
+    GltfVertexLayout layout{
+        .stride = sizeof(Vertex),
+        .attributes = {
+            {.semantic = "POSITION", .offset = offsetof(Vertex, position), .components = 3},
+            {.semantic = "COLOR_0", .offset = offsetof(Vertex, color), .components = 3,
+             .defaultValue = {1.0f, 1.0f, 1.0f, 1.0f}},
+        },
+    };
+    GltfModel model;
+    if (!loader::LoadGltf(GetAssetPath(AssetType::Model, "cube.gltf"), layout, model)) {
+        throw std::runtime_error("Failed to load cube.gltf.");
+    }
+
+    if (!m_geometry.Initialize(sizeof(Vertex), model.vertexCount, model.indexCount)) {
+        throw std::runtime_error("Failed to create geometry arena.");
+    }
+    m_cubeGeometry = m_geometry.Allocate(model.vertexCount, model.indexCount);
+
+    auto& vulkanCtx = VulkanContext::Get();
+    auto commandBuffer = vulkanCtx.CreateCommandBuffer();
+    commandBuffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    m_geometry.RecordUpload(*commandBuffer, *model.staging, 0, model.indexOffset, m_cubeGeometry);
+    commandBuffer->End();
+    vulkanCtx.SubmitAndWait(commandBuffer);
+}
+
+void DrawStressApp::CreateIndirectCommands()
+{
+    // multiDrawIndirect and drawIndirectFirstInstance are part of the same feature check
+    auto& vulkanCtx = VulkanContext::Get();
+    m_indirectSupported = vulkanCtx.IsDrawIndirectCountSupported();
+    if (!m_indirectSupported) {
+        std::printf("multiDrawIndirect / drawIndirectFirstInstance not supported; "
+                    "indirect mode skipped\n");
+        return;
+    }
+
+    // The instance stream hands out one range per frame, so firstInstance is the cube index
+    std::vector<VkDrawIndexedIndirectCommand> commands(m_cubeCount);
+    for (uint32_t i = 0; i < m_cubeCount; ++i) {
+        commands[i] = {
+            .indexCount = m_cubeGeometry.indexCount,
+            .instanceCount = 1,
+            .firstIndex = m_cubeGeometry.firstIndex,
+            .vertexOffset = static_cast<int32_t>(m_cubeGeometry.firstVertex),
+            .firstInstance = i,
+        };
+    }
+    const VkDeviceSize bytes = sizeof(VkDrawIndexedIndirectCommand) * commands.size();
+    m_indirectCommands = StorageBuffer::Create(bytes, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                               VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+    auto staging = StagingBuffer::Create(bytes);
+    if (!m_indirectCommands || !staging) {
+        throw std::runtime_error("Failed to create indirect command buffer.");
+    }
+    std::memcpy(staging->Map(), commands.data(), static_cast<size_t>(bytes));
+    staging->Unmap();
+
+    auto commandBuffer = vulkanCtx.CreateCommandBuffer();
+    commandBuffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    VkBufferCopy copy{.srcOffset = 0, .dstOffset = 0, .size = bytes};
+    vkCmdCopyBuffer(*commandBuffer, staging->GetVkBuffer(), m_indirectCommands->GetVkBuffer(), 1,
+                    &copy);
+    commandBuffer->End();
+    vulkanCtx.SubmitAndWait(commandBuffer);
+}
+
+void DrawStressApp::CreateGraphicsPipeline()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto& swapchain = vulkanCtx.GetSwapchain();
+
+    const auto vertPath = GetAssetPath(AssetType::Shader, "draw_stress.vert");
+    const auto fragPath = GetAssetPath(AssetType::Shader, "draw_stress.frag");
+    if (!loader::UpdateSpirvFile(vertPath) || !loader::UpdateSpirvFile(fragPath)) {
+        throw std::runtime_error("Failed to compile draw stress shaders.");
+    }
+
+    ShaderReflection vertReflection{};
+    ShaderReflection fragReflection{};
+    VkShaderModule vertShaderModule =
+        loader::LoadShaderModule(vertPath.string() + ".spv", &vertReflection);
+    VkShaderModule fragShaderModule =
+        loader::LoadShaderModule(fragPath.string() + ".spv", &fragReflection);
+
+    auto layout =
+        vulkanCtx.GetPipelineLayoutCache().GetPipelineLayout({&vertReflection, &fragReflection});
+    m_pipelineLayout = layout.pipelineLayout;
+
+    GraphicsPipelineBuilder builder{};
+    builder.AddShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vertShaderModule);
+    builder.AddShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragShaderModule);
+    // Locations 0-1 per vertex (binding 0), location 2 per instance (binding 1)
+    builder.SetVertexInputInstanced(vertReflection, 2);
+    builder.SetViewport(swapchain->GetExtent());
+    builder.SetRasterizationState(VkPipelineRasterizationStateCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_BACK_BIT,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .lineWidth = 1.0f,
+    });
+    builder.SetDepthStencilState(VkPipelineDepthStencilStateCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = VK_TRUE,
+        .depthCompareOp = VK_COMPARE_OP_LESS,
+    });
+    if (m_dynamicResolutionEnabled) {
+        builder.AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT);
+        builder.AddDynamicState(VK_DYNAMIC_STATE_SCISSOR);
+    }
+    builder.SetPipelineLayout(m_pipelineLayout);
+    builder.UseDynamicRendering(swapchain->GetFormat().format, DepthFormat);
+    m_pipeline = builder.Build();
+
+    auto device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    vkDestroyShaderModule(device, vertShaderModule, allocator);
+    vkDestroyShaderModule(device, fragShaderModule, allocator);
+    if (m_pipeline == VK_NULL_HANDLE) {
+        throw std::runtime_error("Failed to create graphics pipeline.");
+    }
+}
+
+void DrawStressApp::CreatePerDrawPipeline()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto& swapchain = vulkanCtx.GetSwapchain();
+
+    // Every cube takes one slice per frame on the descriptor paths
+    const VkDeviceSize alignment =
+        vulkanCtx.GetPhysicalDeviceProperties().limits.minUniformBufferOffsetAlignment;
+    const VkDeviceSize sliceSize = (sizeof(PerDraw) + alignment - 1) & ~(alignment - 1);
+    if (!m_uniformRing.Initialize(sliceSize * m_cubeCount)) {
+        throw std::runtime_error("Failed to create uniform ring.");
+    }
+    if (!m_perDrawData.Initialize(m_uniformRing, sizeof(PerDraw), VK_SHADER_STAGE_VERTEX_BIT, 0,
+                                  m_perDrawPath)) {
+        std::printf("Per-draw data: %s not available; per-draw mode skipped\n",
+                    m_perDrawPath ? PerDrawData::GetPathName(*m_perDrawPath) : "no path");
+        return;
+    }
+    const auto path = m_perDrawData.GetPath();
+    const bool pushConstants = path == PerDrawData::Path::PushConstants;
+
+    const auto vertPath = GetAssetPath(AssetType::Shader, pushConstants
+                                                              ? "draw_stress_push.vert"
+                                                              : "draw_stress_uniform.vert");
+    const auto fragPath = GetAssetPath(AssetType::Shader, "draw_stress.frag");
+    if (!loader::UpdateSpirvFile(vertPath) || !loader::UpdateSpirvFile(fragPath)) {
+        throw std::runtime_error("Failed to compile per-draw shaders.");
+    }
+    ShaderReflection vertReflection{};
+    VkShaderModule vertShaderModule =
+        loader::LoadShaderModule(vertPath.string() + ".spv", &vertReflection);
+    VkShaderModule fragShaderModule = loader::LoadShaderModule(fragPath.string() + ".spv");
+
+    // The layout comes from PerDrawData, so check the shader declares the block where
+    // PerDrawData delivers it
+    bool compatible = false;
+    if (pushConstants) {
+        const auto& range = vertReflection.pushConstantRange;
+        compatible = vertReflection.descriptorBindings.empty() && range.offset == 0 &&
+                     range.size == m_perDrawData.GetPushConstantRange().size;
+    }
+    else if (vertReflection.descriptorBindings.size() == 1) {
+        const auto& binding = vertReflection.descriptorBindings[0];
+        compatible = vertReflection.pushConstantRange.size == 0 &&
+                     binding.set == m_perDrawData.GetSetIndex() && binding.binding == 0 &&
+                     binding.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER && binding.count == 1;
+    }
+
+    auto& layoutCache = vulkanCtx.GetPipelineLayoutCache();
+    m_perDrawPipelineLayout =
+        pushConstants ? layoutCache.GetPipelineLayout({}, {m_perDrawData.GetPushConstantRange()})
+                      : layoutCache.GetPipelineLayout({m_perDrawData.GetSetLayout()}, {});
+
+    GraphicsPipelineBuilder builder{};
+    builder.AddShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vertShaderModule);
+    builder.AddShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragShaderModule);
+    builder.SetVertexInput(vertReflection);
+    builder.SetViewport(swapchain->GetExtent());
+    builder.SetRasterizationState(VkPipelineRasterizationStateCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_BACK_BIT,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .lineWidth = 1.0f,
+    });
+    builder.SetDepthStencilState(VkPipelineDepthStencilStateCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = VK_TRUE,
+        .depthCompareOp = VK_COMPARE_OP_LESS,
+    });
+    if (m_dynamicResolutionEnabled) {
+        builder.AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT);
+        builder.AddDynamicState(VK_DYNAMIC_STATE_SCISSOR);
+    }
+    builder.SetPipelineLayout(m_perDrawPipelineLayout);
+    builder.UseDynamicRendering(swapchain->GetFormat().format, DepthFormat);
+    if (compatible) {
+        m_perDrawPipeline = builder.Build();
+    }
+
+    auto device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    vkDestroyShaderModule(device, vertShaderModule, allocator);
+    vkDestroyShaderModule(device, fragShaderModule, allocator);
+    if (!compatible) {
+        throw std::runtime_error("Per-draw shader does not match the PerDrawData layout.");
+    }
+    if (m_perDrawPipeline == VK_NULL_HANDLE) {
+        throw std::runtime_error("Failed to create per-draw pipeline.");
+    }
+
+    m_perDrawInstances.resize(m_cubeCount);
+    m_perDrawSupported = true;
+    std::printf("Per-draw data: %s (%zu bytes per draw)\n", PerDrawData::GetPathName(path),
+                sizeof(PerDraw));
+}
+
+void DrawStressApp::CreateRenderQueue()
+{
+    // Push constants are recorded once per frame ahead of the queue, not per draw
+    m_queuePipeline = m_renderQueue.RegisterPipeline(m_pipeline, m_pipelineLayout);
+    m_queueMaterial = m_renderQueue.RegisterMaterial(VK_NULL_HANDLE, 0);
+    m_queueMesh = m_renderQueue.RegisterMesh(m_geometry.GetVertexBuffer()->GetVkBuffer(),
+                                             m_geometry.GetIndexBuffer()->GetVkBuffer());
+}
+
+void DrawStressApp::WriteInstances(float time, Instance* instances) const
+{
+    for (uint32_t i = 0; i < m_cubeCount; ++i) {
+        instances[i].positionScale = glm::vec4(GetCubePosition(i, time), 1.0f);
+    }
+}
+
+void DrawStressApp::RecordDraws(VkCommandBuffer commandBuffer,
+                                const InstanceStream::Range& range) const
+{
+    const auto& cube = m_cubeGeometry;
+    const auto vertexOffset = static_cast<int32_t>(cube.firstVertex);
+    switch (m_mode) {
+    case Mode::Instanced:
+        vkCmdDrawIndexed(commandBuffer, cube.indexCount, range.count, cube.firstIndex,
+                         vertexOffset, range.firstInstance);
+        break;
+    case Mode::Indirect: {
+        const uint32_t maxDrawCount =
+            VulkanContext::Get().GetPhysicalDeviceProperties().limits.maxDrawIndirectCount;
+        constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+        for (uint32_t first = 0; first < range.count; first += maxDrawCount) {
+            const uint32_t count = std::min(maxDrawCount, range.count - first);
+            vkCmdDrawIndexedIndirect(commandBuffer, m_indirectCommands->GetVkBuffer(),
+                                     VkDeviceSize(first) * stride, count, stride);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void DrawStressApp::RecordQueuedDraws(VkCommandBuffer commandBuffer,
+                                      const InstanceStream::Range& range,
+                                      const glm::mat4& viewProj, float time)
+{
+    // One call per cube, each selecting its instance data with firstInstance. Sorted front to
+    // back so depth testing rejects hidden fragments early; the camera moves, so the list is
+    // rebuilt and sorted every frame.
+    const auto& cube = m_cubeGeometry;
+    RenderQueue::DrawArgs args{
+        .indexCount = cube.indexCount,
+        .firstIndex = cube.firstIndex,
+        .vertexOffset = static_cast<int32_t>(cube.firstVertex),
+    };
+    const float farZ = FarPlaneScale * GetViewRadius();
+    m_renderQueue.Reset();
+    for (uint32_t i = 0; i < range.count; ++i) {
+        // Clip w is the view-space depth
+        const float viewDepth = (viewProj * glm::vec4(GetCubePosition(i, time), 1.0f)).w;
+        const uint32_t depth = SortKey::QuantizeDepth(viewDepth, NearPlane, farZ);
+        args.firstInstance = range.firstInstance + i;
+        m_renderQueue.Submit(
+            SortKey::Make(0, m_queuePipeline, m_queueMaterial, depth, m_queueMesh), args);
+    }
+    m_renderQueue.Sort();
+    m_renderQueue.Execute(commandBuffer);
+}
+
+void DrawStressApp::RecordPerDraws(VkCommandBuffer commandBuffer, const glm::mat4& viewProj)
+{
+    const auto& cube = m_cubeGeometry;
+    const auto vertexOffset = static_cast<int32_t>(cube.firstVertex);
+    PerDraw data{.viewProj = viewProj};
+    for (uint32_t i = 0; i < m_cubeCount; ++i) {
+        data.positionScale = m_perDrawInstances[i].positionScale;
+        // The ring is sized for every cube, so this only fails if that sizing is wrong
+        if (!m_perDrawData.Push(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                m_perDrawPipelineLayout, &data)) {
+            break;
+        }
+        vkCmdDrawIndexed(commandBuffer, cube.indexCount, 1, cube.firstIndex, vertexOffset, 0);
+    }
+}
+
+glm::vec3 DrawStressApp::GetCubePosition(uint32_t index, float time) const
+{
+    const float half = 0.5f * GridSpacing * float(m_gridSize - 1);
+    const uint32_t x = index % m_gridSize;
+    const uint32_t y = (index / m_gridSize) % m_gridSize;
+    const uint32_t z = index / (m_gridSize * m_gridSize);
+    const float bob = 0.25f * std::sin(time * 2.0f + float(index) * 0.37f);
+    return {GridSpacing * float(x) - half, GridSpacing * float(y) - half + bob,
+            GridSpacing * float(z) - half};
+}
+
+float DrawStressApp::GetViewRadius() const
+{
+    return 1.8f * GridSpacing * float(m_gridSize) + 2.0f;
+}
+
+glm::mat4 DrawStressApp::GetViewProjection(float time) const
+{
+    const float radius = GetViewRadius();
+    const float angle = time * 0.2f;
+    const glm::vec3 eye{radius * std::cos(angle), 0.4f * radius, radius * std::sin(angle)};
+    const glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    const auto extent = VulkanContext::Get().GetSwapchain()->GetExtent();
+    const float aspect = float(extent.width) / float(extent.height);
+    // SetViewport flips Y, so the GL-style projection is used as is
+    const glm::mat4 proj =
+        glm::perspective(glm::radians(60.0f), aspect, NearPlane, FarPlaneScale * radius);
+    return proj * view;
+}
+
+void DrawStressApp::NextMode(std::chrono::steady_clock::time_point now)
+{
+    if (m_timings.frames > 0) {
+        const double frames = m_timings.frames;
+        std::printf("%-10s %6u cubes: CPU record %7.3f ms, submit %6.3f ms, ",
+                    GetModeName(m_mode), m_cubeCount, m_timings.recordMs / frames,
+                    m_timings.submitMs / frames);
+        if (m_timings.gpuFrames > 0) {
+            std::printf("GPU %7.3f ms", m_timings.gpuMs / m_timings.gpuFrames);
+        }
+        else {
+            std::printf("GPU n/a");
+        }
+        if (m_dynamicResolutionEnabled) {
+            std::printf(", scale %.2f", m_timings.scale / frames);
+        }
+        std::printf("\n");
+    }
+
+    do {
+        m_mode = static_cast<Mode>((static_cast<uint32_t>(m_mode) + 1) %
+                                   static_cast<uint32_t>(Mode::Count));
+    } while ((m_mode == Mode::Indirect && !m_indirectSupported) ||
+             (m_mode == Mode::PerDraw && !m_perDrawSupported));
+    m_timings = Timings{};
+    m_modeStartTime = now;
+}
+
+const char* DrawStressApp::GetModeName(Mode mode)
+{
+    switch (mode) {
+    case Mode::Individual:
+        return "individual";
+    case Mode::PerDraw:
+        return "per-draw";
+    case Mode::Instanced:
+        return "instanced";
+    case Mode::Indirect:
+        return "indirect";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include "common/ISampleApp.h"
+#include "core/buffer_resource.h"
+#include "core/dynamic_resolution.h"
+#include "core/geometry_arena.h"
+#include "core/gpu_timer.h"
+#include "core/image_resource.h"
+#include "core/instance_stream.h"
+#include "core/per_draw_data.h"
+#include "core/render_queue.h"
+#include <glm/glm.hpp>
+#include <chrono>
+#include <optional>
+#include <vector>
+
+// SimpleCube scaled up: N cubes drawn as N individual draws submitted through a RenderQueue
+// sorted front to back, N draws that each get their data through PerDrawData, one instanced
+// draw, or one multi-draw indirect call. Cycles through the
+// modes and prints CPU record / submit time and GPU time for each. With a GPU time target the
+// cubes are rendered at a dynamic resolution that holds that target, and the average render
+// scale is printed as well.
+class DrawStressApp : public ISampleApp {
+public:
+    static constexpr uint32_t DefaultCubeCount = 20000;
+    // Seconds spent in each mode before switching
+    static constexpr float ModeDuration = 3.0f;
+    static constexpr VkFormat DepthFormat = VK_FORMAT_D32_SFLOAT;
+
+    // targetGpuMs > 0 enables dynamic resolution (needs timestamp support). perDrawPath forces
+    // the PerDrawData path of the per-draw mode instead of the one chosen by size.
+    DrawStressApp(uint32_t cubeCount, double targetGpuMs = 0.0,
+                  std::optional<PerDrawData::Path> perDrawPath = std::nullopt);
+
+    virtual void OnInitialize() override;
+    virtual void OnDrawFrame() override;
+    virtual void OnCleanup() override;
+
+    struct Vertex {
+        glm::vec3 position;
+        glm::vec3 color;
+    };
+
+    // Per-instance vertex input (binding 1)
+    struct Instance {
+        glm::vec4 positionScale;
+    };
+
+    // Data pushed with every draw of the per-draw mode (draw_stress_push.vert /
+    // draw_stress_uniform.vert)
+    struct PerDraw {
+        glm::mat4 viewProj;
+        glm::vec4 positionScale;
+    };
+
+    enum class Mode : uint32_t {
+        Individual,
+        PerDraw,
+        Instanced,
+        Indirect,
+        Count,
+    };
+
+private:
+    enum Timestamp : uint32_t {
+        DrawBegin,
+        DrawEnd,
+        TimestampCount,
+    };
+
+    struct Timings {
+        double recordMs = 0.0;
+        double submitMs = 0.0;
+        double gpuMs = 0.0;
+        uint32_t frames = 0;
+        uint32_t gpuFrames = 0;
+        double scale = 0.0;
+    };
+
+    // Depth buffer at swapchain size, or the dynamic resolution targets
+    void CreateRenderTargets();
+    void CreateCubeGeometry();
+    void CreateIndirectCommands();
+    void CreateGraphicsPipeline();
+    // Sets m_perDrawSupported; the mode is skipped when the forced path is unavailable
+    void CreatePerDrawPipeline();
+    // Registers the cube pipeline and geometry with m_renderQueue
+    void CreateRenderQueue();
+
+    void WriteInstances(float time, Instance* instances) const;
+    void RecordDraws(VkCommandBuffer commandBuffer, const InstanceStream::Range& range) const;
+    void RecordQueuedDraws(VkCommandBuffer commandBuffer, const InstanceStream::Range& range,
+                           const glm::mat4& viewProj, float time);
+    void RecordPerDraws(VkCommandBuffer commandBuffer, const glm::mat4& viewProj);
+    glm::vec3 GetCubePosition(uint32_t index, float time) const;
+    float GetViewRadius() const;
+    glm::mat4 GetViewProjection(float time) const;
+    void NextMode(std::chrono::steady_clock::time_point now);
+
+    static const char* GetModeName(Mode mode);
+
+    uint32_t m_cubeCount = 0;
+    uint32_t m_gridSize = 1;
+
+    std::shared_ptr<DepthBuffer> m_depthBuffer;
+    double m_targetGpuMs = 0.0;
+    DynamicResolution m_dynamicResolution;
+    bool m_dynamicResolutionEnabled = false;
+    GeometryArena m_geometry;
+    GeometryAllocation m_cubeGeometry;
+    InstanceStream m_instanceStream;
+    std::shared_ptr<StorageBuffer> m_indirectCommands;
+    bool m_indirectSupported = false;
+
+    std::optional<PerDrawData::Path> m_perDrawPath;
+    UniformRing m_uniformRing;
+    PerDrawData m_perDrawData;
+    bool m_perDrawSupported = false;
+    // Instance data of the per-draw mode; kept in system memory since every Push copies it
+    std::vector<Instance> m_perDrawInstances;
+
+    // Draw list of the individual mode, rebuilt and sorted every frame
+    RenderQueue m_renderQueue;
+    uint32_t m_queuePipeline = 0;
+    uint32_t m_queueMaterial = 0;
+    uint32_t m_queueMesh = 0;
+
+    GpuTimer m_gpuTimer;
+    bool m_gpuTimerSupported = false;
+    // Mode each frame slot last recorded, to attribute its timestamps when they come back
+    Mode m_slotMode[VulkanContext::MaxInflightFrame] = {};
+    // Render scale each frame slot last used, to interpret its GPU time
+    float m_slotScale[VulkanContext::MaxInflightFrame] = {};
+
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout m_perDrawPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_perDrawPipeline = VK_NULL_HANDLE;
+
+    Mode m_mode = Mode::Individual;
+    Timings m_timings;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::steady_clock::time_point m_modeStartTime;
+};
@@ -0,0 +1,76 @@
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include "core/vulkan_context.h"
+#include "core/glfw_surface_provider.h"
+#include "draw_stress_app.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Usage: DrawStress [cubeCount] [targetGpuMs] [push|descriptor|dynamic]
+// targetGpuMs turns on dynamic resolution: the render scale follows the measured GPU time so
+// frames stay within that budget (0 leaves it off). The last argument forces the PerDrawData
+// path of the per-draw mode: push constants, push descriptor or dynamic uniform.
+int main(int argc, char** argv)
+{
+    uint32_t cubeCount = DrawStressApp::DefaultCubeCount;
+    if (argc > 1) {
+        cubeCount = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+    double targetGpuMs = 0.0;
+    if (argc > 2) {
+        targetGpuMs = std::strtod(argv[2], nullptr);
+    }
+    std::optional<PerDrawData::Path> perDrawPath;
+    if (argc > 3) {
+        if (std::strcmp(argv[3], "push") == 0) {
+            perDrawPath = PerDrawData::Path::PushConstants;
+        }
+        else if (std::strcmp(argv[3], "descriptor") == 0) {
+            perDrawPath = PerDrawData::Path::PushDescriptor;
+        }
+        else if (std::strcmp(argv[3], "dynamic") == 0) {
+            perDrawPath = PerDrawData::Path::DynamicUniform;
+        }
+        else {
+            std::printf("Unknown per-draw path '%s'; expected push, descriptor or dynamic\n",
+                        argv[3]);
+            return 1;
+        }
+    }
+
+    glfwInit();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+
+    auto window = glfwCreateWindow(1280, 720, "DrawStress", nullptr, nullptr);
+    GLFWSurfaceProvider surfaceProvider{window};
+
+    auto& vulkanCtx = VulkanContext::Get();
+    vulkanCtx.GetWindowSystemExtensions = [=](auto& extensionList) {
+        uint32_t extCount = 0;
+        const char** extensions = glfwGetRequiredInstanceExtensions(&extCount);
+        if (extCount > 0) {
+            extensionList.insert(extensionList.end(), extensions, extensions + extCount);
+        }
+    };
+    vulkanCtx.Initialize("DrawStress", &surfaceProvider);
+    vulkanCtx.RecreateSwapchain();
+
+    DrawStressApp theApp{cubeCount, targetGpuMs, perDrawPath};
+    theApp.OnInitialize();
+
+    while (glfwWindowShouldClose(window) == GLFW_FALSE)
+    {
+        glfwPollEvents();
+
+        theApp.OnDrawFrame();
+    }
+
+    theApp.OnCleanup();
+    vulkanCtx.Cleanup();
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
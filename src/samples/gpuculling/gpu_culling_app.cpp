@@ -0,0 +1,380 @@
+#include "gpu_culling_app.h"
+#include "core/asset_archive.h"
+#include "core/asset_path.h"
+#include "core/bindless_resource_table.h"
+#include "core/command_buffer.h"
+#include "core/graphics_pipeline_builder.h"
+#include "core/shader_compiler.h"
+#include "core/shader_loader.h"
+#include "core/shader_reflection.h"
+#include "core/swapchain.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Side length of the cube the objects are scattered in
+constexpr float FieldSize = 400.0f;
+
+// Appends a quad (two CCW triangles seen from +normal, u x v == normal)
+void AddQuad(std::vector<GpuCullingApp::Vertex>& vertices, std::vector<uint32_t>& indices,
+             glm::vec3 normal, glm::vec3 u, glm::vec3 v)
+{
+    const auto base = static_cast<uint32_t>(vertices.size());
+    const glm::vec3 center = normal * 0.5f;
+    vertices.push_back({center - 0.5f * u - 0.5f * v, normal});
+    vertices.push_back({center + 0.5f * u - 0.5f * v, normal});
+    vertices.push_back({center + 0.5f * u + 0.5f * v, normal});
+    vertices.push_back({center - 0.5f * u + 0.5f * v, normal});
+    indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+}
+
+} // namespace
+
+void GpuCullingApp::OnInitialize()
+{
+    auto assetPath = FindAssetRootPath();
+    if (!assetPath.empty()) {
+        SetAssetRootPath(assetPath);
+    }
+    // Packed assets when assets.vpak exists; loose files still take precedence
+    MountAssetArchive(GetDefaultAssetArchivePath());
+
+    CreateDepthBuffer();
+    CreateMeshes();
+    CreateObjects();
+    CreateGraphicsPipelines();
+
+    m_startTime = std::chrono::steady_clock::now();
+    m_statsTime = m_startTime;
+}
+
+void GpuCullingApp::OnDrawFrame()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto& swapchain = vulkanCtx.GetSwapchain();
+
+    if (vulkanCtx.AcquireNextImage() != VK_SUCCESS) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        return;
+    }
+
+    // Recording cost stays the same whatever the object count or visibility
+    const auto recordStart = std::chrono::steady_clock::now();
+    const float time = std::chrono::duration<float>(recordStart - m_startTime).count();
+    const glm::mat4 viewProj = GetViewProjection(time);
+
+    auto* frameCtx = vulkanCtx.GetCurrentFrameContext();
+    auto& commandBuffer = frameCtx->commandBuffer;
+    commandBuffer->Begin();
+
+    m_culler.RecordCull(*commandBuffer, glm::value_ptr(viewProj));
+
+    VkImageSubresourceRange colorRange{
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+    VkImageSubresourceRange depthRange = colorRange;
+    depthRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    commandBuffer->TransitionLayout(swapchain->GetCurrentImage(), colorRange,
+                                    ImageLayoutTransition::FromUndefinedToColorAttachment());
+    commandBuffer->TransitionLayout(m_depthBuffer->GetVkImage(), depthRange,
+                                    ImageLayoutTransition::FromUndefinedToDepthAttachment());
+
+    auto extent = swapchain->GetExtent();
+    VkRenderingAttachmentInfo colorAttachment{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = swapchain->GetCurrentView(),
+        .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+        .clearValue = VkClearValue{.color = {{0.05f, 0.05f, 0.08f, 1.0f}}},
+    };
+    VkRenderingAttachmentInfo depthAttachment{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = m_depthBuffer->GetVkImageView(),
+        .imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        .clearValue = VkClearValue{.depthStencil = {1.0f, 0}},
+    };
+    VkRenderingInfo renderingInfo{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .renderArea = {{0, 0}, extent},
+        .layerCount = 1,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &colorAttachment,
+        .pDepthAttachment = &depthAttachment,
+    };
+    vkCmdBeginRendering(*commandBuffer, &renderingInfo);
+
+    vulkanCtx.GetBindlessResourceTable().Bind(*commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                              m_pipelineLayout);
+    DrawParams drawParams{.viewProj = viewProj, .instanceBuffer = m_instanceIndex};
+    vkCmdPushConstants(*commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                       sizeof(DrawParams), &drawParams);
+    m_geometry.Bind(*commandBuffer);
+    for (uint32_t batch = 0; batch < BatchCount; ++batch) {
+        vkCmdBindPipeline(*commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelines[batch]);
+        m_culler.RecordDraw(*commandBuffer, batch);
+    }
+
+    vkCmdEndRendering(*commandBuffer);
+
+    commandBuffer->TransitionLayout(swapchain->GetCurrentImage(), colorRange,
+                                    ImageLayoutTransition::FromColorToPresent());
+    commandBuffer->End();
+
+    const auto recordEnd = std::chrono::steady_clock::now();
+    PrintStatistics(std::chrono::duration<double, std::micro>(recordEnd - recordStart).count());
+
+    vulkanCtx.SubmitPresent();
+}
+
+void GpuCullingApp::OnCleanup()
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+
+    vkDeviceWaitIdle(device);
+    for (auto& pipeline : m_pipelines) {
+        vkDestroyPipeline(device, pipeline, allocator);
+        pipeline = VK_NULL_HANDLE;
+    }
+    m_culler.Cleanup();
+    if (m_instanceIndex != BindlessResourceTable::InvalidIndex) {
+        vulkanCtx.GetBindlessResourceTable().ReleaseStorageBuffer(m_instanceIndex);
+        m_instanceIndex = BindlessResourceTable::InvalidIndex;
+    }
+    m_instances.reset();
+    m_geometry.Cleanup();
+    m_depthBuffer.reset();
+}
+
+void GpuCullingApp::CreateDepthBuffer()
+{
+    auto& swapchain = VulkanContext::Get().GetSwapchain();
+    m_depthBuffer = DepthBuffer::Create(swapchain->GetExtent(), VK_FORMAT_D32_SFLOAT);
+    if (!m_depthBuffer) {
+        throw std::runtime_error("Failed to create depth buffer.");
+    }
+}
+
+void GpuCullingApp::CreateMeshes()
+{
+    if (!m_geometry.Initialize(sizeof(Vertex), 1024, 4096)) {
+        throw std::runtime_error("Failed to create geometry arena.");
+    }
+
+    // Cube with flat faces
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    const glm::vec3 x{1, 0, 0}, y{0, 1, 0}, z{0, 0, 1};
+    AddQuad(vertices, indices, x, y, z);
+    AddQuad(vertices, indices, -x, z, y);
+    AddQuad(vertices, indices, y, z, x);
+    AddQuad(vertices, indices, -y, x, z);
+    AddQuad(vertices, indices, z, x, y);
+    AddQuad(vertices, indices, -z, y, x);
+    m_meshes[0] = m_geometry.Allocate(static_cast<uint32_t>(vertices.size()),
+                                      static_cast<uint32_t>(indices.size()));
+    if (!m_meshes[0].IsValid() || !m_geometry.Upload(m_meshes[0], vertices.data(), indices.data())) {
+        throw std::runtime_error("Failed to upload cube mesh.");
+    }
+    m_meshRadius[0] = 0.8660254f;
+
+    // Octahedron with flat faces
+    vertices.clear();
+    indices.clear();
+    for (int i = 0; i < 8; ++i) {
+        const glm::vec3 sign{(i & 1) ? -1.0f : 1.0f, (i & 2) ? -1.0f : 1.0f,
+                             (i & 4) ? -1.0f : 1.0f};
+        glm::vec3 a = sign * x * 0.6f, b = sign * y * 0.6f, c = sign * z * 0.6f;
+        if (sign.x * sign.y * sign.z < 0.0f) {
+            std::swap(b, c);
+        }
+        const glm::vec3 normal = glm::normalize(sign);
+        const auto base = static_cast<uint32_t>(vertices.size());
+        vertices.insert(vertices.end(), {{a, normal}, {b, normal}, {c, normal}});
+        indices.insert(indices.end(), {base, base + 1, base + 2});
+    }
+    m_meshes[1] = m_geometry.Allocate(static_cast<uint32_t>(vertices.size()),
+                                      static_cast<uint32_t>(indices.size()));
+    if (!m_meshes[1].IsValid() || !m_geometry.Upload(m_meshes[1], vertices.data(), indices.data())) {
+        throw std::runtime_error("Failed to upload octahedron mesh.");
+    }
+    m_meshRadius[1] = 0.6f;
+}
+
+void GpuCullingApp::CreateObjects()
+{
+    std::mt19937 rng{12345};
+    std::uniform_real_distribution<float> position{-0.5f * FieldSize, 0.5f * FieldSize};
+    std::uniform_real_distribution<float> scale{0.5f, 2.5f};
+    std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+
+    std::vector<Instance> instances(ObjectCount);
+    std::vector<GpuCullObject> objects(ObjectCount);
+    for (uint32_t i = 0; i < ObjectCount; ++i) {
+        const glm::vec3 center{position(rng), position(rng), position(rng)};
+        const float s = scale(rng);
+        const uint32_t mesh = i & 1;
+        instances[i] = {
+            .positionScale = glm::vec4(center, s),
+            .color = glm::vec4(0.3f + 0.7f * unit(rng), 0.3f + 0.7f * unit(rng),
+                               0.3f + 0.7f * unit(rng), 1.0f),
+        };
+
+        // Every fourth object uses the unlit pipeline
+        auto& object = objects[i];
+        object.center[0] = center.x;
+        object.center[1] = center.y;
+        object.center[2] = center.z;
+        object.radius = m_meshRadius[mesh] * s;
+        object.firstIndex = m_meshes[mesh].firstIndex;
+        object.indexCount = m_meshes[mesh].indexCount;
+        object.vertexOffset = static_cast<int32_t>(m_meshes[mesh].firstVertex);
+        object.batch = (i % 4 == 0) ? UnlitBatch : LitBatch;
+    }
+
+    if (!m_culler.Initialize(ObjectCount, BatchCount) || !m_culler.SetObjects(objects)) {
+        throw std::runtime_error("Failed to initialize GPU culling.");
+    }
+
+    // Object i is drawn with firstInstance i, so instance data is indexed the same way
+    const VkDeviceSize instanceBytes = sizeof(Instance) * instances.size();
+    m_instances = StorageBuffer::Create(instanceBytes, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    auto staging = StagingBuffer::Create(instanceBytes);
+    if (!m_instances || !staging) {
+        throw std::runtime_error("Failed to create instance buffer.");
+    }
+    std::memcpy(staging->Map(), instances.data(), static_cast<size_t>(instanceBytes));
+    staging->Unmap();
+
+    auto& vulkanCtx = VulkanContext::Get();
+    auto commandBuffer = vulkanCtx.CreateCommandBuffer();
+    commandBuffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    VkBufferCopy copy{.srcOffset = 0, .dstOffset = 0, .size = instanceBytes};
+    vkCmdCopyBuffer(*commandBuffer, staging->GetVkBuffer(), m_instances->GetVkBuffer(), 1, &copy);
+    commandBuffer->End();
+    vulkanCtx.SubmitAndWait(commandBuffer);
+
+    m_instanceIndex =
+        vulkanCtx.GetBindlessResourceTable().RegisterStorageBuffer(m_instances->GetVkBuffer());
+    if (m_instanceIndex == BindlessResourceTable::InvalidIndex) {
+        throw std::runtime_error("Bindless table is full.");
+    }
+}
+
+void GpuCullingApp::CreateGraphicsPipelines()
+{
+    VkPushConstantRange pushConstantRange{
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        .offset = 0,
+        .size = sizeof(DrawParams),
+    };
+    m_pipelineLayout =
+        VulkanContext::Get().GetBindlessResourceTable().GetPipelineLayout({pushConstantRange});
+
+    m_pipelines[LitBatch] = BuildGraphicsPipeline("gpu_culling.frag");
+    m_pipelines[UnlitBatch] = BuildGraphicsPipeline("gpu_culling_unlit.frag");
+}
+
+VkPipeline GpuCullingApp::BuildGraphicsPipeline(const char* fragmentShader)
+{
+    auto& vulkanCtx = VulkanContext::Get();
+    auto& swapchain = vulkanCtx.GetSwapchain();
+
+    // The sample ships GLSL only; compile on first run or after an edit
+    const auto vertPath = GetAssetPath(AssetType::Shader, "gpu_culling.vert");
+    const auto fragPath = GetAssetPath(AssetType::Shader, fragmentShader);
+    if (!loader::UpdateSpirvFile(vertPath) || !loader::UpdateSpirvFile(fragPath)) {
+        throw std::runtime_error("Failed to compile gpu culling shaders.");
+    }
+
+    ShaderReflection vertReflection{};
+    VkShaderModule vertShaderModule =
+        loader::LoadShaderModule(vertPath.string() + ".spv", &vertReflection);
+    VkShaderModule fragShaderModule = loader::LoadShaderModule(fragPath.string() + ".spv");
+
+    GraphicsPipelineBuilder builder{};
+    builder.AddShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vertShaderModule);
+    builder.AddShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragShaderModule);
+    builder.SetVertexInput(vertReflection);
+    builder.SetViewport(swapchain->GetExtent());
+    // Meshes are wound counter-clockwise seen from outside
+    builder.SetRasterizationState(VkPipelineRasterizationStateCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_BACK_BIT,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .lineWidth = 1.0f,
+    });
+    builder.SetDepthStencilState(VkPipelineDepthStencilStateCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = VK_TRUE,
+        .depthCompareOp = VK_COMPARE_OP_LESS,
+    });
+    builder.SetPipelineLayout(m_pipelineLayout);
+    builder.UseDynamicRendering(swapchain->GetFormat().format, m_depthBuffer->GetFormat());
+    VkPipeline pipeline = builder.Build();
+
+    auto device = vulkanCtx.GetVkDevice();
+    const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+    vkDestroyShaderModule(device, vertShaderModule, allocator);
+    vkDestroyShaderModule(device, fragShaderModule, allocator);
+    if (pipeline == VK_NULL_HANDLE) {
+        throw std::runtime_error("Failed to create graphics pipeline.");
+    }
+    return pipeline;
+}
+
+glm::mat4 GpuCullingApp::GetViewProjection(float time) const
+{
+    // Camera in the middle of the field, slowly turning, so visibility changes every frame
+    const glm::vec3 eye{0.0f, 0.0f, 0.0f};
+    const float yaw = time * 0.3f;
+    const float pitch = 0.3f * std::sin(time * 0.2f);
+    const glm::vec3 forward{std::cos(yaw) * std::cos(pitch), std::sin(pitch),
+                            std::sin(yaw) * std::cos(pitch)};
+    const glm::mat4 view = glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+
+    const auto extent = VulkanContext::Get().GetSwapchain()->GetExtent();
+    const float aspect = float(extent.width) / float(extent.height);
+    // SetViewport flips Y, so the GL-style projection is used as is
+    const glm::mat4 proj =
+        glm::perspective(glm::radians(60.0f), aspect, 0.5f, 0.5f * FieldSize);
+    return proj * view;
+}
+
+void GpuCullingApp::PrintStatistics(double recordMicroseconds)
+{
+    ++m_statsFrames;
+    m_statsRecordMicroseconds += recordMicroseconds;
+
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed = std::chrono::duration<double>(now - m_statsTime).count();
+    if (elapsed < 1.0) {
+        return;
+    }
+    // Counts lag by MaxInflightFrame frames; read back without stalling
+    std::printf("%u objects: %u lit + %u unlit visible, %.1f fps, CPU record %.1f us/frame\n",
+                m_culler.GetObjectCount(), m_culler.GetVisibleCount(LitBatch),
+                m_culler.GetVisibleCount(UnlitBatch), m_statsFrames / elapsed,
+                m_statsRecordMicroseconds / m_statsFrames);
+    m_statsTime = now;
+    m_statsFrames = 0;
+    m_statsRecordMicroseconds = 0.0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "common/ISampleApp.h"
+#include "core/buffer_resource.h"
+#include "core/geometry_arena.h"
+#include "core/gpu_culling.h"
+#include "core/image_resource.h"
+#include <glm/glm.hpp>
+#include <chrono>
+
+// 128k objects culled on the GPU and drawn with one indirect-count draw per pipeline
+class GpuCullingApp : public ISampleApp {
+public:
+    virtual void OnInitialize() override;
+    virtual void OnDrawFrame() override;
+    virtual void OnCleanup() override;
+
+    struct Vertex {
+        glm::vec3 position;
+        glm::vec3 normal;
+    };
+
+    // Per-object data read by gpu_culling.vert through gl_InstanceIndex
+    struct Instance {
+        glm::vec4 positionScale;
+        glm::vec4 color;
+    };
+
+    // Matches the push constant block in gpu_culling.vert
+    struct DrawParams {
+        glm::mat4 viewProj;
+        uint32_t instanceBuffer;
+    };
+
+    static constexpr uint32_t ObjectCount = 128 * 1024;
+
+    // One batch per pipeline
+    enum Batch : uint32_t {
+        LitBatch = 0,
+        UnlitBatch,
+        BatchCount,
+    };
+
+private:
+    void CreateDepthBuffer();
+    void CreateMeshes();
+    void CreateObjects();
+    void CreateGraphicsPipelines();
+    VkPipeline BuildGraphicsPipeline(const char* fragmentShader);
+
+    glm::mat4 GetViewProjection(float time) const;
+    void PrintStatistics(double recordMicroseconds);
+
+    std::shared_ptr<DepthBuffer> m_depthBuffer;
+    GeometryArena m_geometry;
+    GeometryAllocation m_meshes[2];
+    float m_meshRadius[2] = {};
+
+    std::shared_ptr<StorageBuffer> m_instances;
+    uint32_t m_instanceIndex = ~0u;
+    GpuCuller m_culler;
+
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_pipelines[BatchCount] = {};
+
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::steady_clock::time_point m_statsTime;
+    uint32_t m_statsFrames = 0;
+    double m_statsRecordMicroseconds = 0.0;
+};
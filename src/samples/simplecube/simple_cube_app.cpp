@@ -1,6 +1,12 @@
 #include "simple_cube_app.h"
+#include "core/asset_archive.h"
 #include "core/asset_path.h"
+#include "core/command_buffer.h"
+#include "core/gltf_loader.h"
 #include "core/swapchain.h"
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
 
 void SimpleCubeApp::OnInitialize()
 {
@@ -8,6 +14,8 @@ void SimpleCubeApp::OnInitialize()
     if (!assetPath.empty()) {
         SetAssetRootPath(assetPath);
     }
+    // Packed assets when assets.vpak exists; loose files still take precedence
+    MountAssetArchive(GetDefaultAssetArchivePath());
 
     CreateDepthBuffer();
     CreateCubeGeometry();
@@ -27,6 +35,11 @@ void SimpleCubeApp::OnDrawFrame()
 void SimpleCubeApp::OnCleanup()
 {
     // Cleanup code for the simple cube application
+    vkDeviceWaitIdle(VulkanContext::Get().GetVkDevice());
+    m_objectData.Cleanup();
+    m_uniformRing.Cleanup();
+    // Releases every range at once; no per-mesh Free needed after the device is idle
+    m_geometry.Cleanup();
 }
 
 void SimpleCubeApp::InitializeTriangleVertexBuffer()
@@ -49,6 +62,50 @@ void SimpleCubeApp::CreateDepthBuffer()
 
 void SimpleCubeApp::CreateCubeGeometry()
 {
+    GltfVertexLayout layout{
+        .stride = sizeof(Vertex),
+        .attributes = {
+            {.semantic = "POSITION", .offset = offsetof(Vertex, position), .components = 3},
+            {.semantic = "COLOR_0", .offset = offsetof(Vertex, color), .components = 3,
+             .defaultValue = {1.0f, 1.0f, 1.0f, 1.0f}},
+        },
+    };
+    GltfModel model;
+    if (!loader::LoadGltf(GetAssetPath(AssetType::Model, "cube.gltf"), layout, model)) {
+        throw std::runtime_error("Failed to load cube.gltf.");
+    }
+    std::printf("cube.gltf: map %.2f ms, parse %.2f ms, staging %.2f ms, decode %.2f ms "
+                "(%u threads), total %.2f ms\n",
+                model.stats.mapMs, model.stats.parseMs, model.stats.stagingMs,
+                model.stats.decodeMs, model.stats.decodeThreads, model.stats.totalMs);
+
+    // Cache / overdraw / fetch ordering, then half positions and unorm8 colours
+    m_vertexLayout = mesh::BuildQuantizedLayout(layout);
+    mesh::ProcessSettings processSettings{.quantize = &m_vertexLayout};
+    auto processStats = mesh::ProcessModel(model, layout, processSettings);
+    std::printf("cube.gltf: %u -> %u vertex shader invocations (ACMR %.2f -> %.2f), "
+                "%u -> %u bytes per vertex\n",
+                processStats.vertexInvocationsBefore, processStats.vertexInvocationsAfter,
+                processStats.GetAcmrBefore(), processStats.GetAcmrAfter(),
+                processStats.bytesPerVertexBefore, processStats.bytesPerVertexAfter);
+
+    // Room for more meshes of this vertex format in the same buffers
+    constexpr uint32_t MaxVertices = 64 * 1024;
+    constexpr uint32_t MaxIndices = 256 * 1024;
+    if (!m_geometry.Initialize(m_vertexLayout.stride, MaxVertices, MaxIndices)) {
+        throw std::runtime_error("Failed to create geometry arena.");
+    }
+    m_cubeGeometry = m_geometry.Allocate(model.vertexCount, model.indexCount);
+    if (!m_cubeGeometry.IsValid()) {
+        throw std::runtime_error("Geometry arena is too small for cube.gltf.");
+    }
+
+    auto& vulkanCtx = VulkanContext::Get();
+    auto commandBuffer = vulkanCtx.CreateCommandBuffer();
+    commandBuffer->Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    m_geometry.RecordUpload(*commandBuffer, *model.staging, 0, model.indexOffset, m_cubeGeometry);
+    commandBuffer->End();
+    vulkanCtx.SubmitAndWait(commandBuffer);
 }
 
 void SimpleCubeApp::CreateDescriptorSetLayout()
@@ -57,10 +114,17 @@ void SimpleCubeApp::CreateDescriptorSetLayout()
 
 void SimpleCubeApp::CreateUniformBuffers()
 {
+    if (!m_uniformRing.Initialize()) {
+        throw std::runtime_error("Failed to create uniform ring.");
+    }
 }
 
 void SimpleCubeApp::CreateDescriptorSets()
 {
+    // Picks push constants / push descriptor / dynamic uniform by size; no per-object sets
+    if (!m_objectData.Initialize(m_uniformRing, sizeof(ObjectData), VK_SHADER_STAGE_VERTEX_BIT, 0)) {
+        throw std::runtime_error("Failed to initialize per-object data.");
+    }
 }
 
 void SimpleCubeApp::CreateGraphicsPipeline()
@@ -1,7 +1,10 @@
 #pragma once
 #include "common/ISampleApp.h"
 #include "core/buffer_resource.h"
+#include "core/geometry_arena.h"
 #include "core/image_resource.h"
+#include "core/mesh_processing.h"
+#include "core/per_draw_data.h"
 #include <glm/glm.hpp>
 
 class SimpleCubeApp : public ISampleApp {
@@ -10,11 +13,18 @@ public:
     virtual void OnDrawFrame() override;
     virtual void OnCleanup() override;
 
+    // Import layout; the GPU copy is quantized (see m_vertexLayout)
     struct Vertex {
         glm::vec3 position;
         glm::vec3 color;
     };
 
+    // Per-object data; 128 bytes fits the guaranteed push constant size
+    struct ObjectData {
+        glm::mat4 world;
+        glm::mat4 viewProj;
+    };
+
 private:
     void InitializeTriangleVertexBuffer();
     void InitializeGraphicsPipeline();
@@ -27,7 +37,13 @@ private:
     void CreateGraphicsPipeline();
 
     std::shared_ptr<VertexBuffer> m_vertexBuffer;
+    GeometryArena m_geometry;
+    GeometryAllocation m_cubeGeometry;
+    // Packed vertex format in m_geometry, for the pipeline's vertex input
+    mesh::QuantizedLayout m_vertexLayout;
     std::shared_ptr<DepthBuffer> m_depthBuffer;
+    UniformRing m_uniformRing;
+    PerDrawData m_objectData;
     VkPipeline m_pipeline = VK_NULL_HANDLE;
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
 };
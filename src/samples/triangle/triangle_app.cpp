@@ -1,13 +1,41 @@
 #include "triangle_app.h"
+#include "core/asset_archive.h"
 #include "core/asset_path.h"
 #include "core/vulkan_context.h"
 #include "core/command_buffer.h"
 #include "core/swapchain.h"
 #include "core/shader_loader.h"
 #include "core/graphics_pipeline_builder.h"
-#include <array>
+#include "core/pipeline_layout_cache.h"
+#include "core/shader_reflection.h"
 #include <thread>
-#include <stdexcept>
+
+namespace {
+
+// Destroys the shader modules however the pipeline build ends, also when it throws
+struct ShaderModules {
+    VkShaderModule vert = VK_NULL_HANDLE;
+    VkShaderModule frag = VK_NULL_HANDLE;
+
+    ShaderModules() = default;
+    ShaderModules(const ShaderModules&) = delete;
+    ShaderModules& operator=(const ShaderModules&) = delete;
+
+    ~ShaderModules()
+    {
+        auto& vulkanCtx = VulkanContext::Get();
+        auto device = vulkanCtx.GetVkDevice();
+        const auto* allocator = vulkanCtx.GetAllocationCallbacks();
+        if (vert != VK_NULL_HANDLE) {
+            vkDestroyShaderModule(device, vert, allocator);
+        }
+        if (frag != VK_NULL_HANDLE) {
+            vkDestroyShaderModule(device, frag, allocator);
+        }
+    }
+};
+
+} // namespace
 
 void TriangleApp::OnInitialize()
 {
@@ -15,6 +43,8 @@ void TriangleApp::OnInitialize()
     if (!assetPath.empty()) {
         SetAssetRootPath(assetPath);
     }
+    // Packed assets when assets.vpak exists; loose files still take precedence
+    MountAssetArchive(GetDefaultAssetArchivePath());
     InitializeTriangleVertexBuffer();
     InitializeGraphicsPipeline();
 }
@@ -30,6 +60,10 @@ void TriangleApp::OnDrawFrame()
         return;
     }
 
+    // Frame boundary: pick up pipelines rebuilt by the shader watcher
+    m_shaderReloader.Update();
+    m_pipeline = m_shaderReloader.GetPipeline(m_pipelineHandle);
+
     auto* frameCtx = vulkanCtx.GetCurrentFrameContext();
     auto& commandBuffer = frameCtx->commandBuffer;
     commandBuffer->Begin();
@@ -90,14 +124,8 @@ void TriangleApp::OnCleanup()
     auto device = vulkanCtx.GetVkDevice();
 
     vkDeviceWaitIdle(device);
-    if (m_pipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(device, m_pipeline, nullptr);
-        m_pipeline = VK_NULL_HANDLE;
-    }
-    if (m_pipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(device, m_pipelineLayout, nullptr);
-        m_pipelineLayout = VK_NULL_HANDLE;
-    }
+    m_shaderReloader.Cleanup();
+    m_pipeline = VK_NULL_HANDLE;
     m_vertexBuffer->Creanup();
     m_vertexBuffer.reset();
 }
@@ -118,55 +146,38 @@ void TriangleApp::InitializeTriangleVertexBuffer()
 }
 
 void TriangleApp::InitializeGraphicsPipeline()
+{
+    // Rebuilt on the watcher thread whenever triangle.vert / triangle.frag are saved
+    m_pipelineHandle = m_shaderReloader.RegisterPipeline({"triangle.vert", "triangle.frag"},
+                                                         [this] { return BuildGraphicsPipeline(); });
+    m_pipeline = m_shaderReloader.GetPipeline(m_pipelineHandle);
+    m_shaderReloader.Start();
+}
+
+VkPipeline TriangleApp::BuildGraphicsPipeline()
 {
     auto& vulkanCtx = VulkanContext::Get();
     auto& swapchain = vulkanCtx.GetSwapchain();
 
-    VkPipelineLayoutCreateInfo layoutInfo{
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-    };
-    auto result =
-        vkCreatePipelineLayout(vulkanCtx.GetVkDevice(), &layoutInfo, nullptr, &m_pipelineLayout);
-    if (result != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create pipeline layout.");
-    }
-
-    vulkanCtx.SetDebugObjectName(
-        reinterpret_cast<void*>(m_pipelineLayout),
-        VK_OBJECT_TYPE_PIPELINE_LAYOUT, "MyPipelineLayout");
-
-    VkShaderModule vertShaderModule =
-        loader::LoadShaderModule(GetAssetPath(AssetType::Shader, "triangle.vert.spv"));
-    VkShaderModule fragShaderModule =
-        loader::LoadShaderModule(GetAssetPath(AssetType::Shader, "triangle.frag.spv"));
-
-    VkVertexInputBindingDescription bindingDescription{
-        .binding = 0,
-        .stride = sizeof(Vertex),
-        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
-    };
-
-    std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{
-        VkVertexInputAttributeDescription{
-            .location = 0,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(Vertex, position),
-        },
-        VkVertexInputAttributeDescription{
-            .location = 1,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32_SFLOAT,
-            .offset = offsetof(Vertex, color),
-        },
-    };
+    ShaderReflection vertReflection{};
+    ShaderReflection fragReflection{};
+    ShaderModules shaderModules;
+    shaderModules.vert = loader::LoadShaderModule(
+        GetAssetPath(AssetType::Shader, "triangle.vert.spv"), &vertReflection);
+    shaderModules.frag = loader::LoadShaderModule(
+        GetAssetPath(AssetType::Shader, "triangle.frag.spv"), &fragReflection);
+
+    // Layout and vertex input come from the shaders themselves, so edits picked up by
+    // the hot reloader that change the interface still produce a matching pipeline
+    auto layout =
+        vulkanCtx.GetPipelineLayoutCache().GetPipelineLayout({&vertReflection, &fragReflection});
+    vulkanCtx.SetDebugObjectName(reinterpret_cast<void*>(layout.pipelineLayout),
+                                 VK_OBJECT_TYPE_PIPELINE_LAYOUT, "MyPipelineLayout");
 
     GraphicsPipelineBuilder builder{};
-    builder.AddShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vertShaderModule);
-    builder.AddShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragShaderModule);
-    builder.SetVertexInput(&bindingDescription, 1,
-                           attributeDescriptions.data(),
-                           static_cast<uint32_t>(attributeDescriptions.size()));
+    builder.AddShaderStage(VK_SHADER_STAGE_VERTEX_BIT, shaderModules.vert);
+    builder.AddShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, shaderModules.frag);
+    builder.SetVertexInput(vertReflection);
     auto swapchainExtent = swapchain->GetExtent();
     VkRect2D scissor{
         .offset = {0, 0},
@@ -181,13 +192,9 @@ void TriangleApp::InitializeGraphicsPipeline()
         .maxDepth = 1.0f,
     };
     builder.setViewport(viewport, scissor);
-    builder.SetPipelineLayout(m_pipelineLayout);
+    builder.SetPipelineLayout(layout.pipelineLayout);
 
     auto colorFormat = swapchain->GetFormat().format;
     builder.UseDynamicRendering(colorFormat);
-    m_pipeline = builder.Build();
-
-    auto device = vulkanCtx.GetVkDevice();
-    vkDestroyShaderModule(device, vertShaderModule, nullptr);
-    vkDestroyShaderModule(device, fragShaderModule, nullptr);
+    return builder.Build();
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "common/ISampleApp.h"
 #include "core/buffer_resource.h"
+#include "core/shader_hot_reloader.h"
 #include <glm/glm.hpp>
 
 class TriangleApp : public ISampleApp {
@@ -17,9 +18,11 @@ public:
 private:
     void InitializeTriangleVertexBuffer();
     void InitializeGraphicsPipeline();
+    VkPipeline BuildGraphicsPipeline();
 
     std::shared_ptr<VertexBuffer> m_vertexBuffer;
+    ShaderHotReloader m_shaderReloader;
+    ShaderHotReloader::PipelineHandle m_pipelineHandle{};
     VkPipeline m_pipeline = VK_NULL_HANDLE;
-    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
 };
 
@@ -0,0 +1,198 @@
+// Packs an asset directory into a .vpak archive (see core/asset_archive.h).
+//   AssetPacker <asset dir> [output.vpak] [--store]
+// Text and other compressible files are LZ4-compressed when that saves at least 1/8. Vertex/index
+// buffers and already-compressed textures are stored raw so the runtime can hand them out as
+// views into the mapping. --store disables compression entirely. Build artifacts the runtime
+// regenerates from their sources are skipped: compiled .spv shaders, the texture importer's
+// "<file>.<16 hex digits>.ktx2" caches and its temp files.
+#include "core/asset_archive.h"
+#include "core/lz4.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Consumed in place at runtime, or not worth compressing
+constexpr std::array<std::string_view, 3> RawExtensions = {".bin", ".glb", ".ktx2"};
+
+struct SourceFile {
+    std::filesystem::path path;
+    std::string key;
+};
+
+bool ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& data)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    data.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0).read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()));
+    return bool(file);
+}
+
+bool IsBuildArtifact(const std::filesystem::path& path)
+{
+    const auto extension = path.extension();
+    if (extension == ".spv" || extension == ".tmp" || extension == ".vpak") {
+        return true;
+    }
+    if (extension != ".ktx2") {
+        return false;
+    }
+    // Importer cache: the stem ends in "." and the 16 hex digits of the source's content hash
+    const auto hash = path.stem().extension().string();
+    return hash.size() == 17 && std::all_of(hash.begin() + 1, hash.end(), [](char c) {
+               return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+           });
+}
+
+bool KeepRaw(const std::filesystem::path& path)
+{
+    const auto extension = path.extension().string();
+    return std::find(RawExtensions.begin(), RawExtensions.end(), extension) !=
+           RawExtensions.end();
+}
+
+void Pad(std::ofstream& out, uint64_t& offset, uint64_t alignment)
+{
+    static const char zeros[AssetArchive::BlobAlignment] = {};
+    const uint64_t padding = (alignment - offset % alignment) % alignment;
+    out.write(zeros, std::streamsize(padding));
+    offset += padding;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path assetDir;
+    std::filesystem::path outputPath;
+    bool store = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--store") {
+            store = true;
+        }
+        else if (assetDir.empty()) {
+            assetDir = arg;
+        }
+        else {
+            outputPath = arg;
+        }
+    }
+    if (assetDir.empty()) {
+        std::printf("usage: AssetPacker <asset dir> [output.vpak] [--store]\n");
+        return EXIT_FAILURE;
+    }
+    assetDir = assetDir.lexically_normal();
+    if (!assetDir.has_filename()) {
+        assetDir = assetDir.parent_path();
+    }
+    if (outputPath.empty()) {
+        outputPath = assetDir;
+        outputPath += ".vpak";
+    }
+
+    // Sorted by key so the same tree always produces the same archive
+    std::vector<SourceFile> sources;
+    std::error_code ec;
+    for (const auto& item : std::filesystem::recursive_directory_iterator(assetDir, ec)) {
+        if (item.is_regular_file() && !IsBuildArtifact(item.path())) {
+            sources.push_back(
+                {item.path(), item.path().lexically_relative(assetDir).generic_string()});
+        }
+    }
+    if (ec) {
+        std::printf("cannot read %s: %s\n", assetDir.string().c_str(), ec.message().c_str());
+        return EXIT_FAILURE;
+    }
+    std::sort(sources.begin(), sources.end(),
+              [](const SourceFile& a, const SourceFile& b) { return a.key < b.key; });
+
+    std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::printf("cannot create %s\n", outputPath.string().c_str());
+        return EXIT_FAILURE;
+    }
+    AssetArchive::Header header{
+        .magic = AssetArchive::Magic,
+        .version = AssetArchive::Version,
+        .entryCount = static_cast<uint32_t>(sources.size()),
+    };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t offset = sizeof(header);
+
+    std::vector<AssetArchive::Entry> entries;
+    std::string names;
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> compressed;
+    uint64_t totalSize = 0;
+    uint64_t totalStored = 0;
+    for (const auto& source : sources) {
+        if (!ReadFile(source.path, data)) {
+            std::printf("cannot read %s\n", source.path.string().c_str());
+            return EXIT_FAILURE;
+        }
+
+        const uint8_t* stored = data.data();
+        size_t storedSize = data.size();
+        uint32_t flags = 0;
+        if (!store && !KeepRaw(source.path) && !data.empty()) {
+            compressed.resize(lz4::CompressBound(data.size()));
+            const size_t size =
+                lz4::Compress(data.data(), data.size(), compressed.data(), compressed.size());
+            if (size > 0 && size <= data.size() - data.size() / 8) {
+                stored = compressed.data();
+                storedSize = size;
+                flags |= AssetArchive::EntryCompressed;
+            }
+        }
+
+        Pad(out, offset, AssetArchive::BlobAlignment);
+        entries.push_back({
+            .hash = AssetArchive::HashKey(source.key),
+            .offset = offset,
+            .storedSize = storedSize,
+            .size = data.size(),
+            .nameOffset = static_cast<uint32_t>(names.size()),
+            .nameLength = static_cast<uint32_t>(source.key.size()),
+            .flags = flags,
+        });
+        names += source.key;
+        out.write(reinterpret_cast<const char*>(stored), std::streamsize(storedSize));
+        offset += storedSize;
+        totalSize += data.size();
+        totalStored += storedSize;
+        std::printf("  %-40s %10zu -> %10zu %s\n", source.key.c_str(), data.size(), storedSize,
+                    (flags & AssetArchive::EntryCompressed) != 0 ? "lz4" : "raw");
+    }
+
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const auto& a, const auto& b) { return a.hash < b.hash; });
+    Pad(out, offset, alignof(AssetArchive::Entry));
+    header.indexOffset = offset;
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              std::streamsize(entries.size() * sizeof(AssetArchive::Entry)));
+    offset += entries.size() * sizeof(AssetArchive::Entry);
+    header.nameTableOffset = offset;
+    header.nameTableSize = static_cast<uint32_t>(names.size());
+    out.write(names.data(), std::streamsize(names.size()));
+
+    out.seekp(0).write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out.flush()) {
+        std::printf("write to %s failed\n", outputPath.string().c_str());
+        return EXIT_FAILURE;
+    }
+    std::printf("%zu files, %llu -> %llu bytes: %s\n", sources.size(),
+                static_cast<unsigned long long>(totalSize),
+                static_cast<unsigned long long>(totalStored), outputPath.string().c_str());
+    return EXIT_SUCCESS;
+}